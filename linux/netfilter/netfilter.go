@@ -18,6 +18,7 @@ import (
   "net"
   "bytes"
   "errors"
+  "strings"
   "unsafe"
 
   "C"
@@ -64,6 +65,11 @@ type nftCtx struct {
   preroute    *nftables.Chain
   preroute_v6 *nftables.Chain
   addrset     *nftables.Set
+  portset     *nftables.Set
+  exclude_v4  *nftables.Set
+  exclude_v6  *nftables.Set
+  cgroupset   *nftables.Set
+  ports       map[uint16]int
   fwmark      uint32
   conn        nftables.Conn
 }
@@ -84,6 +90,109 @@ func nftIfname(n string) []byte {
   return b
 }
 
+// Netlink batches are limited by the size of the socket buffer. Set updates
+// are committed in chunks of elements which stay well below it.
+const nftMaxBatchElements = 2048
+
+type nftSetUpdate struct {
+  set      *nftables.Set
+  elements []nftables.SetElement
+}
+
+func (ctx* nftCtx) nftQueueSetUpdate(update nftSetUpdate, add bool) error {
+  if add {
+    return ctx.conn.SetAddElements(update.set, update.elements)
+  }
+  return ctx.conn.SetDeleteElements(update.set, update.elements)
+}
+
+// Each chunk is a transaction of its own: an update of more than
+// nftMaxBatchElements elements is not atomic. If a chunk fails, the chunks
+// already committed are reverted, most recent first, and the sets are left as
+// they were. The daemon only adds the elements which are not in the sets yet,
+// and deletes the ones it added, so reverting does not lose any element.
+func (ctx* nftCtx) nftUpdateSets(updates []nftSetUpdate, add bool) int32 {
+  var chunks []nftSetUpdate
+  for _, update := range updates {
+    elements := update.elements
+    for len(elements) > 0 {
+      count := len(elements)
+      if count > nftMaxBatchElements {
+        count = nftMaxBatchElements
+      }
+      chunks = append(chunks, nftSetUpdate{ update.set, elements[:count] })
+      elements = elements[count:]
+    }
+  }
+
+  for i, chunk := range chunks {
+    if err := ctx.nftQueueSetUpdate(chunk, add); err != nil {
+      log.Println("Failed to update set", chunk.set.Name, err)
+      ctx.nftRevertSets(chunks[:i], add)
+      return -1
+    }
+    if ctx.nftCommit() != 0 {
+      ctx.nftRevertSets(chunks[:i], add)
+      return -1
+    }
+  }
+  return 0
+}
+
+func (ctx* nftCtx) nftRevertSets(chunks []nftSetUpdate, add bool) {
+  if len(chunks) > 0 {
+    log.Println("Reverting", len(chunks), "committed set updates")
+  }
+  for i := len(chunks) - 1; i >= 0; i-- {
+    if err := ctx.nftQueueSetUpdate(chunks[i], !add); err != nil {
+      log.Println("Failed to revert set", chunks[i].set.Name, err)
+      return
+    }
+    if ctx.nftCommit() != 0 {
+      return
+    }
+  }
+}
+
+// Match packets with a source, or a destination, address in the set. The set
+// holds either IPv4 or IPv6 addresses.
+func nftMatchAddrSet(set *nftables.Set, dest bool) []expr.Any {
+  family := byte(linux.NFPROTO_IPV4)
+  offset := uint32(12)
+  length := uint32(4)
+  if set.KeyType == nftables.TypeIP6Addr {
+    family = byte(linux.NFPROTO_IPV6)
+    offset = 8
+    length = 16
+  }
+  if dest {
+    offset += length
+  }
+
+  return []expr.Any{
+    &expr.Meta{
+      Key:            expr.MetaKeyNFPROTO,
+      Register:       1,
+    },
+    &expr.Cmp{
+      Op:             expr.CmpOpEq,
+      Register:       1,
+      Data:           []byte{family},
+    },
+    &expr.Payload{
+      DestRegister:   1,
+      Base:           expr.PayloadBaseNetworkHeader,
+      Offset:         offset,
+      Len:            length,
+    },
+    &expr.Lookup{
+      SourceRegister: 1,
+      SetName:        set.Name,
+      SetID:          set.ID,
+    },
+  }
+}
+
 // A Conntrack zone used for traffic excluded from the VPN tunnel.
 // The value is not important, so long as it's constant, unique,
 // and non-zero.
@@ -160,6 +269,18 @@ func (ctx* nftCtx) nftIfup(ifname string) {
         SetName:        ctx.addrset.Name,
         SetID:          ctx.addrset.ID,
       },
+      // Lookup the UDP source port.
+      &expr.Payload{
+        DestRegister:   1,
+        Base:           expr.PayloadBaseTransportHeader,
+        Offset:         uint32(0),
+        Len:            uint32(2),
+      },
+      &expr.Lookup{
+        SourceRegister: 1,
+        SetName:        ctx.portset.Name,
+        SetID:          ctx.portset.ID,
+      },
       // Set the firewall mark.
       &expr.Immediate{
         Register:       1,
@@ -175,6 +296,89 @@ func (ctx* nftCtx) nftIfup(ifname string) {
       &setctzone,
     },
   })
+
+  var setmark = []expr.Any{
+    &expr.Immediate{
+      Register:       1,
+      Data:           binaryutil.NativeEndian.PutUint32(ctx.fwmark),
+    },
+    &expr.Meta{
+      Key:            expr.MetaKeyMARK,
+      Register:       1,
+      SourceRegister: true,
+    },
+  }
+
+  // Traffic to the excluded addresses is matched with a single lookup in
+  // the exclusion sets, whatever the number of addresses.
+  for _, set := range []*nftables.Set{ctx.exclude_v4, ctx.exclude_v6} {
+    // Mark outbound packets to excluded addresses, to route them outside
+    // of the tunnel.
+    exprs := nftMatchAddrSet(set, true)
+    exprs = append(exprs, setmark...)
+    ctx.conn.AddRule(&nftables.Rule{
+      Table: ctx.table_inet,
+      Chain: ctx.mangle,
+      Exprs: exprs,
+    })
+
+    // Mark forwarded packets to excluded addresses before the routing
+    // decision, and move them into the external conntrack zone with their
+    // replies.
+    exprs = nftMatchAddrSet(set, true)
+    exprs = append(exprs, setmark...)
+    exprs = append(exprs, &immctzone, &setctzone)
+    ctx.conn.AddRule(&nftables.Rule{
+      Table: ctx.table_inet,
+      Chain: ctx.preroute,
+      Exprs: exprs,
+    })
+
+    // Masquerade the local ones: their source address may have been selected
+    // for the tunnel, before they were rerouted. Forwarded packets keep their
+    // source address.
+    exprs = nftMatchAddrSet(set, true)
+    exprs = append(exprs,
+      &expr.Meta{
+        Key:        expr.MetaKeyMARK,
+        Register:   1,
+      },
+      &expr.Cmp{
+        Op:         expr.CmpOpEq,
+        Register:   1,
+        Data:       binaryutil.NativeEndian.PutUint32(ctx.fwmark),
+      },
+      &expr.Fib{
+        Register:       1,
+        FlagSADDR:      true,
+        ResultADDRTYPE: true,
+      },
+      &expr.Cmp{
+        Op:         expr.CmpOpEq,
+        Register:   1,
+        Data:       binaryutil.NativeEndian.PutUint32(linux.RTN_LOCAL),
+      },
+      &expr.Masq{},
+    )
+    ctx.conn.AddRule(&nftables.Rule{
+      Table: ctx.table_inet,
+      Chain: ctx.nat,
+      Exprs: exprs,
+    })
+
+    // The replies should be marked for RPF and moved into the external
+    // conntrack zone, like the outbound packets.
+    exprs = nftMatchAddrSet(set, false)
+    exprs = append(exprs, setmark...)
+    exprs = append(exprs, &immctzone, &setctzone)
+    ctx.conn.AddRule(&nftables.Rule{
+      Table: ctx.table_inet,
+      Chain: ctx.preroute,
+      Exprs: exprs,
+    })
+  }
+
+  ctx.nftMarkCgroup1netcls()
 }
 
 func nftXtCgroupMatch(cgroup string) expr.Match {
@@ -264,12 +468,26 @@ func (ctx* nftCtx) nftMarkCgroup2xt(cgroup string) {
   })
 }
 
+// Delete the rules matching against the cgroup v2 path of xtmatch, or against
+// any cgroup v2 path if it has no info.
 func (ctx* nftCtx) nftDelCgroup2xt(rules []*nftables.Rule, xtmatch *expr.Match) {
-  cgdata, _ := xt.Marshal(0, xtmatch.Rev, xtmatch.Info)
+  var cgdata []byte
+  if xtmatch.Info != nil {
+    cgdata, _ = xt.Marshal(0, xtmatch.Rev, xtmatch.Info)
+  }
 
   for _, r := range rules {
-    rr := r.Exprs[0].(*expr.Match)
-    if rr.Name != xtmatch.Name || rr.Rev != xtmatch.Rev {
+    // The chains also hold the rules matching against the sets.
+    if len(r.Exprs) == 0 {
+      continue
+    }
+    rr, ok := r.Exprs[0].(*expr.Match)
+    if !ok || rr.Name != xtmatch.Name || rr.Rev != xtmatch.Rev {
+      continue
+    }
+    if xtmatch.Info == nil {
+      log.Println("Deleting", r.Chain.Name, "rule handle", r.Handle)
+      ctx.conn.DelRule(r);
       continue
     }
     rrdata, err := xt.Marshal(0, rr.Rev, rr.Info)
@@ -283,16 +501,16 @@ func (ctx* nftCtx) nftDelCgroup2xt(rules []*nftables.Rule, xtmatch *expr.Match)
   }
 }
 
-func (ctx* nftCtx) nftMarkCgroup1netcls(cgroup uint32) {
-  // Match packets originating from the cgroup/net_cls
+func (ctx* nftCtx) nftMarkCgroup1netcls() {
+  // Match packets originating from the cgroups/net_cls in the set
   var loadcgroup = expr.Meta{
     Key:      expr.MetaKeyCGROUP,
     Register: 1,
   }
-  var matchcgroup = expr.Cmp{
-    Op:       expr.CmpOpEq,
-    Register: 1,
-    Data:     binaryutil.NativeEndian.PutUint32(cgroup),
+  var matchcgroup = expr.Lookup{
+    SourceRegister: 1,
+    SetName:        ctx.cgroupset.Name,
+    SetID:          ctx.cgroupset.ID,
   }
 
   ctx.conn.AddRule(&nftables.Rule{
@@ -434,6 +652,35 @@ func NetfilterCreateTables() int32 {
   }
   mozvpn_ctx.conn.AddSet(mozvpn_ctx.addrset, nil)
 
+  mozvpn_ctx.portset = &nftables.Set{
+    Table:      mozvpn_ctx.table_inet,
+    Name:       "mozvpn-portset",
+    KeyType:    nftables.TypeInetService,
+  }
+  mozvpn_ctx.conn.AddSet(mozvpn_ctx.portset, nil)
+  mozvpn_ctx.ports = make(map[uint16]int)
+
+  mozvpn_ctx.exclude_v4 = &nftables.Set{
+    Table:      mozvpn_ctx.table_inet,
+    Name:       "mozvpn-exclude-v4",
+    KeyType:    nftables.TypeIPAddr,
+  }
+  mozvpn_ctx.conn.AddSet(mozvpn_ctx.exclude_v4, nil)
+
+  mozvpn_ctx.exclude_v6 = &nftables.Set{
+    Table:      mozvpn_ctx.table_inet,
+    Name:       "mozvpn-exclude-v6",
+    KeyType:    nftables.TypeIP6Addr,
+  }
+  mozvpn_ctx.conn.AddSet(mozvpn_ctx.exclude_v6, nil)
+
+  mozvpn_ctx.cgroupset = &nftables.Set{
+    Table:      mozvpn_ctx.table_inet,
+    Name:       "mozvpn-cgroupset",
+    KeyType:    nftables.TypeClassID,
+  }
+  mozvpn_ctx.conn.AddSet(mozvpn_ctx.cgroupset, nil)
+
   log.Println("Creating netfilter tables")
   return mozvpn_ctx.nftCommit()
 }
@@ -456,6 +703,11 @@ func NetfilterClearTables() int32 {
   mozvpn_ctx.conn.FlushChain(mozvpn_ctx.preroute)
   mozvpn_ctx.conn.FlushChain(mozvpn_ctx.preroute_v6)
   mozvpn_ctx.conn.FlushSet(mozvpn_ctx.addrset)
+  mozvpn_ctx.conn.FlushSet(mozvpn_ctx.portset)
+  mozvpn_ctx.conn.FlushSet(mozvpn_ctx.exclude_v4)
+  mozvpn_ctx.conn.FlushSet(mozvpn_ctx.exclude_v6)
+  mozvpn_ctx.conn.FlushSet(mozvpn_ctx.cgroupset)
+  mozvpn_ctx.ports = make(map[uint16]int)
 
   log.Println("Clearing netfilter tables")
   return mozvpn_ctx.nftCommit()
@@ -477,24 +729,85 @@ func NetfilterMarkInbound(ipaddr string, port uint32) int32 {
   element := []nftables.SetElement{
     { Key: net.ParseIP(ipaddr).To4(), },
   }
- 
+
   mozvpn_ctx.conn.SetAddElements(mozvpn_ctx.addrset, element)
 
+  // The servers can share a port: it is in the set until its last server
+  // is cleared.
+  mozvpn_ctx.ports[uint16(port)]++
+  if mozvpn_ctx.ports[uint16(port)] == 1 {
+    mozvpn_ctx.conn.SetAddElements(mozvpn_ctx.portset, []nftables.SetElement{
+      { Key: binaryutil.BigEndian.PutUint16(uint16(port)), },
+    })
+  }
+
   log.Println("Marking inbound traffic from server")
   return mozvpn_ctx.nftCommit()
 }
 
 //export NetfilterClearInbound
-func NetfilterClearInbound(ipaddr string) int32 {
+func NetfilterClearInbound(ipaddr string, port uint32) int32 {
   element := []nftables.SetElement{
     { Key: net.ParseIP(ipaddr).To4(), },
   }
 
   mozvpn_ctx.conn.SetDeleteElements(mozvpn_ctx.addrset, element)
+
+  if mozvpn_ctx.ports[uint16(port)] > 0 {
+    mozvpn_ctx.ports[uint16(port)]--
+    if mozvpn_ctx.ports[uint16(port)] == 0 {
+      delete(mozvpn_ctx.ports, uint16(port))
+      mozvpn_ctx.conn.SetDeleteElements(mozvpn_ctx.portset, []nftables.SetElement{
+        { Key: binaryutil.BigEndian.PutUint16(uint16(port)), },
+      })
+    }
+  }
   log.Println("Clearing traffic marks for server")
   return mozvpn_ctx.nftCommit()
 }
 
+func nftExclusionElements(addrs string) ([]nftables.SetElement, []nftables.SetElement) {
+  var v4, v6 []nftables.SetElement
+  for _, addr := range strings.Split(addrs, ",") {
+    if len(addr) == 0 {
+      continue
+    }
+    ip := net.ParseIP(addr)
+    if ip == nil {
+      log.Println("Ignoring invalid address", addr)
+    } else if ip.To4() != nil {
+      v4 = append(v4, nftables.SetElement{ Key: ip.To4(), })
+    } else {
+      v6 = append(v6, nftables.SetElement{ Key: ip.To16(), })
+    }
+  }
+  return v4, v6
+}
+
+func (ctx* nftCtx) nftUpdateExclusions(addrs string, add bool) int32 {
+  v4, v6 := nftExclusionElements(addrs)
+  return ctx.nftUpdateSets([]nftSetUpdate{
+    { ctx.exclude_v4, v4 },
+    { ctx.exclude_v6, v6 },
+  }, add)
+}
+
+// Both take a comma-separated list of addresses, and update the exclusion
+// sets in a single transaction, unless the list is very long. A long list is
+// committed in several transactions, which are reverted if one of them fails.
+
+//export NetfilterExcludeAddresses
+func NetfilterExcludeAddresses(addrs string) int32 {
+  log.Println("Excluding traffic to addresses")
+  return mozvpn_ctx.nftUpdateExclusions(addrs, true)
+}
+
+//export NetfilterResetAddresses
+func NetfilterResetAddresses(addrs string) int32 {
+  log.Println("Permitting traffic to addresses")
+  return mozvpn_ctx.nftUpdateExclusions(addrs, false)
+}
+
 //export NetfilterIsolateIpv6
 func NetfilterIsolateIpv6(ifname string, ipv6addr string) int32 {
   // Inbound packets from any interface other than the tunnel should
@@ -554,7 +867,9 @@ func NetfilterMarkCgroupV1(cgroup uint32) int32 {
     return -1
   }
 
-  mozvpn_ctx.nftMarkCgroup1netcls(cgroup)
+  mozvpn_ctx.conn.SetAddElements(mozvpn_ctx.cgroupset, []nftables.SetElement{
+    { Key: binaryutil.NativeEndian.PutUint32(cgroup), },
+  })
 
   log.Println("Marking traffic from cgroup", cgroup)
   return mozvpn_ctx.nftCommit()
@@ -599,8 +914,27 @@ func NetfilterResetCgroupV2(cgroup string) int32 {
 //export NetfilterResetAllCgroupsV2
 func NetfilterResetAllCgroupsV2() int32 {
   log.Println("Clearing all cgroup traffic marks")
-  mozvpn_ctx.conn.FlushChain(mozvpn_ctx.mangle)
-  mozvpn_ctx.conn.FlushChain(mozvpn_ctx.nat)
+
+  // Only delete the cgroup rules: the chains also hold the exclusion rules.
+  xtcgroup := expr.Match{
+    Name:     "cgroup",
+    Rev:      2,
+  }
+
+  rules, err := mozvpn_ctx.conn.GetRules(mozvpn_ctx.table_inet, mozvpn_ctx.mangle)
+  if err != nil {
+    log.Println("Failed to inspect inet/mangle rules", err)
+  } else {
+    mozvpn_ctx.nftDelCgroup2xt(rules, &xtcgroup)
+  }
+
+  rules, err = mozvpn_ctx.conn.GetRules(mozvpn_ctx.table_inet, mozvpn_ctx.nat)
+  if err != nil {
+    log.Println("Failed to inspect inet/nat rules", err)
+  } else {
+    mozvpn_ctx.nftDelCgroup2xt(rules, &xtcgroup)
+  }
+
   return mozvpn_ctx.nftCommit()
 }
 
@@ -0,0 +1,185 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+package main
+
+import (
+  "fmt"
+  "os"
+  "strconv"
+  "strings"
+  "testing"
+  "time"
+
+  "github.com/google/nftables"
+)
+
+// These tests program the firewall: they only run in a network namespace,
+// through scripts/tests/netfilter_netns.sh.
+func setupNetns(t *testing.T) {
+  if os.Getenv("MOZVPN_NETFILTER_NETNS") == "" {
+    t.Skip("Run through scripts/tests/netfilter_netns.sh")
+  }
+
+  if NetfilterCreateTables() != 0 {
+    t.Fatal("Failed to create the tables")
+  }
+  if NetfilterIfup("moz0", 0xca6c) != 0 {
+    t.Fatal("Failed to start the tables")
+  }
+}
+
+func teardownNetns(t *testing.T) {
+  if NetfilterClearTables() != 0 {
+    t.Error("Failed to clear the tables")
+  }
+  if NetfilterRemoveTables() != 0 {
+    t.Error("Failed to remove the tables")
+  }
+}
+
+// The number of excluded addresses of each family.
+func excludedCount() int {
+  count, err := strconv.Atoi(os.Getenv("MOZVPN_NETFILTER_COUNT"))
+  if err != nil || count <= 0 {
+    return 5000
+  }
+  return count
+}
+
+func excludedAddresses(first int, count int) string {
+  addrs := make([]string, 0, 2 * count)
+  for i := first; i < first + count; i++ {
+    addrs = append(addrs, fmt.Sprintf("10.%d.%d.%d",
+                                      (i >> 16) & 0xff, (i >> 8) & 0xff, i & 0xff))
+    addrs = append(addrs, fmt.Sprintf("fd00:%x::%x", i >> 16, i & 0xffff))
+  }
+  return strings.Join(addrs, ",")
+}
+
+func countElements(t *testing.T, set *nftables.Set) int {
+  elements, err := mozvpn_ctx.conn.GetSetElements(set)
+  if err != nil {
+    t.Fatal("Failed to list", set.Name, err)
+  }
+  return len(elements)
+}
+
+func countRules(t *testing.T, chain *nftables.Chain) int {
+  rules, err := mozvpn_ctx.conn.GetRules(mozvpn_ctx.table_inet, chain)
+  if err != nil {
+    t.Fatal("Failed to list", chain.Name, err)
+  }
+  return len(rules)
+}
+
+func checkElements(t *testing.T, count int) {
+  if n := countElements(t, mozvpn_ctx.exclude_v4); n != count {
+    t.Errorf("%s has %d elements, expected %d", mozvpn_ctx.exclude_v4.Name, n, count)
+  }
+  if n := countElements(t, mozvpn_ctx.exclude_v6); n != count {
+    t.Errorf("%s has %d elements, expected %d", mozvpn_ctx.exclude_v6.Name, n, count)
+  }
+}
+
+func TestExclusions(t *testing.T) {
+  setupNetns(t)
+  defer teardownNetns(t)
+
+  count := excludedCount()
+  mangle := countRules(t, mozvpn_ctx.mangle)
+  nat := countRules(t, mozvpn_ctx.nat)
+  preroute := countRules(t, mozvpn_ctx.preroute)
+
+  // The inbound server rule, then the forwarded packets and the replies of
+  // each family.
+  if preroute != 5 {
+    t.Errorf("%s has %d rules, expected 5", mozvpn_ctx.preroute.Name, preroute)
+  }
+
+  start := time.Now()
+  if NetfilterExcludeAddresses(excludedAddresses(0, count)) != 0 {
+    t.Fatal("Failed to exclude the addresses")
+  }
+  t.Logf("Excluded %d addresses in %v", 2 * count, time.Since(start))
+  checkElements(t, count)
+
+  // Excluding an address again is harmless.
+  if NetfilterExcludeAddresses(excludedAddresses(0, 1)) != 0 {
+    t.Error("Failed to exclude an address twice")
+  }
+  checkElements(t, count)
+
+  // The number of rules does not depend on the number of addresses.
+  if countRules(t, mozvpn_ctx.mangle) != mangle ||
+     countRules(t, mozvpn_ctx.nat) != nat ||
+     countRules(t, mozvpn_ctx.preroute) != preroute {
+    t.Error("The exclusions changed the rules")
+  }
+
+  start = time.Now()
+  if NetfilterResetAddresses(excludedAddresses(0, count / 2)) != 0 {
+    t.Fatal("Failed to reset the addresses")
+  }
+  t.Logf("Reset %d addresses in %v", 2 * (count / 2), time.Since(start))
+  checkElements(t, count - count / 2)
+
+  // Resetting all the cgroups keeps the exclusion rules.
+  if NetfilterResetAllCgroupsV2() != 0 {
+    t.Error("Failed to reset the cgroups")
+  }
+  if countRules(t, mozvpn_ctx.mangle) != mangle ||
+     countRules(t, mozvpn_ctx.nat) != nat {
+    t.Error("Resetting the cgroups deleted the exclusion rules")
+  }
+
+  if NetfilterClearTables() != 0 {
+    t.Fatal("Failed to clear the tables")
+  }
+  checkElements(t, 0)
+}
+
+func TestInboundPorts(t *testing.T) {
+  setupNetns(t)
+  defer teardownNetns(t)
+
+  // Two servers share a port.
+  NetfilterMarkInbound("192.0.2.1", 51820)
+  NetfilterMarkInbound("192.0.2.2", 51820)
+  NetfilterMarkInbound("192.0.2.3", 443)
+  if n := countElements(t, mozvpn_ctx.addrset); n != 3 {
+    t.Errorf("%s has %d elements, expected 3", mozvpn_ctx.addrset.Name, n)
+  }
+  if n := countElements(t, mozvpn_ctx.portset); n != 2 {
+    t.Errorf("%s has %d elements, expected 2", mozvpn_ctx.portset.Name, n)
+  }
+
+  // The port is kept until its last server is cleared.
+  NetfilterClearInbound("192.0.2.1", 51820)
+  if n := countElements(t, mozvpn_ctx.portset); n != 2 {
+    t.Errorf("%s has %d elements, expected 2", mozvpn_ctx.portset.Name, n)
+  }
+  NetfilterClearInbound("192.0.2.2", 51820)
+  if n := countElements(t, mozvpn_ctx.portset); n != 1 {
+    t.Errorf("%s has %d elements, expected 1", mozvpn_ctx.portset.Name, n)
+  }
+}
+
+func TestCgroupV1(t *testing.T) {
+  setupNetns(t)
+  defer teardownNetns(t)
+
+  mangle := countRules(t, mozvpn_ctx.mangle)
+  for classid := uint32(0x00110011); classid < 0x00110111; classid++ {
+    if NetfilterMarkCgroupV1(classid) != 0 {
+      t.Fatal("Failed to mark the cgroup", classid)
+    }
+  }
+  if n := countElements(t, mozvpn_ctx.cgroupset); n != 256 {
+    t.Errorf("%s has %d elements, expected 256", mozvpn_ctx.cgroupset.Name, n)
+  }
+  if countRules(t, mozvpn_ctx.mangle) != mangle {
+    t.Error("The cgroups changed the rules")
+  }
+}
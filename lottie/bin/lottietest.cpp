@@ -53,6 +53,11 @@ int main(int argc, char* argv[]) {
       "fillMode");
   parser.addOption(fillModeOption);
 
+  QCommandLineOption nativeOption(QStringList() << "n"
+                                                << "native",
+                                  "Use the native renderer");
+  parser.addOption(nativeOption);
+
   parser.process(app);
 
   const QStringList args = parser.positionalArguments();
@@ -108,6 +113,7 @@ int main(int argc, char* argv[]) {
   }
 
   ctx->setContextProperty("REVERSE", parser.isSet(reverseOption));
+  ctx->setContextProperty("NATIVE", parser.isSet(nativeOption));
 
   {
     QString fillMode = "stretch";
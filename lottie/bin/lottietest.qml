@@ -21,6 +21,7 @@ Window {
         speed: SPEED
         reverse: REVERSE
         fillMode: FILLMODE
+        nativeRenderer: NATIVE
     }
 
     Connections {
@@ -41,6 +41,18 @@ Item {
     // - "pad": the image is not transformed
     property alias fillMode: lottiePrivate.fillMode
 
+    // Render the frames natively, in a worker thread, instead of with
+    // lottie-web. The animations using features which are not supported
+    // natively are still played by lottie-web. The native output has not been
+    // compared with lottie-web pixel by pixel yet. Default: false
+    property alias nativeRenderer: lottiePrivate.nativeRenderer
+
+    // Keep the rendered frames in memory: after the first loop, the animation
+    // costs a texture upload per frame. Frames are shared by all the items
+    // playing the same source at the same size. Only the animations rendered
+    // natively are cached. Default: false
+    property alias cacheFrames: lottiePrivate.cacheFrames
+
     function play() { lottiePrivate.play(); }
     function pause() { lottiePrivate.pause(); }
     function stop() { lottiePrivate.stop(); }
@@ -79,6 +91,8 @@ Item {
 
     LottiePrivate {
         id: lottiePrivate
+        // The native renderer paints the frames in this item.
+        anchors.fill: parent
 
         property bool componentCompleted: false
 
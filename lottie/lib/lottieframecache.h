@@ -0,0 +1,85 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef LOTTIEFRAMECACHE_H
+#define LOTTIEFRAMECACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+
+// An LRU cache of the frames rendered by the native player, shared by all the
+// items with `cacheFrames` set. After the first loop, playing an animation
+// costs the decompression of a frame and a texture upload instead of a
+// rendering.
+//
+// Frames are keyed by animation (source, size, device pixel ratio and fill
+// mode) and frame number. The speed does not matter: the cached frames are
+// whole frames, and any speed plays a subset of them.
+//
+// The frames are stored zlib-compressed: uncompressed, a looping animation at
+// a high device pixel ratio would not fit in any reasonable budget, while its
+// flat colors and transparent background compress well.
+//
+// The cache is thread-safe: the render workers compress and decompress the
+// frames, outside of the lock.
+class LottieFrameCache final {
+ public:
+  static LottieFrameCache* instance();
+
+  static QString animationKey(const QString& source, const QSize& size,
+                              qreal devicePixelRatio, int fillMode);
+
+  // An animation larger than the cache is not cached: looping over it would
+  // evict each frame before its reuse. Its size is estimated from the frames
+  // already compressed. The first frame is always accepted.
+  bool accepts(const QString& animationKey, int frames) const;
+
+  QImage find(const QString& animationKey, int frame);
+  void insert(const QString& animationKey, int frame, const QImage& image);
+  void clear();
+
+  qint64 maxBytes() const;
+  void setMaxBytes(qint64 maxBytes);
+
+  qint64 bytes() const;
+  int count() const;
+  quint64 hits() const;
+  quint64 misses() const;
+
+ private:
+  LottieFrameCache();
+  Q_DISABLE_COPY_MOVE(LottieFrameCache)
+
+  struct Frame {
+    QSize m_size;
+    QImage::Format m_format = QImage::Format_Invalid;
+    int m_bytesPerLine = 0;
+    qreal m_devicePixelRatio = 1;
+    QByteArray m_data;
+  };
+
+  // The compressed frames inserted so far, by animation.
+  struct Sample {
+    qint64 m_bytes = 0;
+    int m_frames = 0;
+  };
+
+ private:
+  mutable QMutex m_mutex;
+
+  // The cost of a frame is its compressed size in KB.
+  QCache<QString, Frame> m_cache;
+  QHash<QString, Sample> m_samples;
+  qint64 m_maxBytes;
+
+  quint64 m_hits = 0;
+  quint64 m_misses = 0;
+};
+
+#endif  // LOTTIEFRAMECACHE_H
@@ -3,23 +3,53 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "lottieprivate.h"
+#include "lottieframecache.h"
 #include "lottieprivatedocument.h"
 #include "lottieprivatenavigator.h"
 #include "lottieprivatewindow.h"
+#include "lottiescene.h"
 #include "lottiestatus.h"
 
 #include <QFile>
 #include <QGlobalStatic>
+#include <QHash>
 #include <QJSEngine>
+#include <QQuickWindow>
+#include <QSGImageNode>
+#include <QWeakPointer>
+#include <QtMath>
+
+#include <cmath>
 
 constexpr const char* FILLMODE_STRETCH = "stretch";
 constexpr const char* FILLMODE_PAD = "pad";
 constexpr const char* FILLMODE_PRESERVEASPECTFIT = "preserveAspectFit";
 constexpr const char* FILLMODE_PRESERVEASPECTCROP = "preserveAspectCrop";
 
+// The native player renders at the frame rate of the animation, within these
+// bounds.
+constexpr int NATIVE_MIN_INTERVAL_MSEC = 16;
+constexpr int NATIVE_MAX_INTERVAL_MSEC = 100;
+
 namespace {
 static QJSEngine* s_engine = nullptr;
 Q_GLOBAL_STATIC(QString, s_userAgent);
+
+// Parsed scenes, shared by the items playing the same source.
+using SceneCache = QHash<QString, QWeakPointer<const LottieScene>>;
+Q_GLOBAL_STATIC(SceneCache, s_scenes);
+
+LottieRenderer::FillMode toRendererFillMode(const QString& fillMode) {
+  if (fillMode == FILLMODE_PAD) return LottieRenderer::Pad;
+
+  if (fillMode == FILLMODE_PRESERVEASPECTFIT)
+    return LottieRenderer::PreserveAspectFit;
+
+  if (fillMode == FILLMODE_PRESERVEASPECTCROP)
+    return LottieRenderer::PreserveAspectCrop;
+
+  return LottieRenderer::Stretch;
+}
 }  // namespace
 
 // static
@@ -48,7 +78,15 @@ const QString LottiePrivate::userAgent() {
 }
 
 LottiePrivate::LottiePrivate(QQuickItem* parent)
-    : QQuickItem(parent), m_loops(false) {}
+    : QQuickItem(parent), m_loops(false) {
+  setFlag(ItemHasContents);
+
+  m_nativeTimer.setTimerType(Qt::PreciseTimer);
+  connect(&m_nativeTimer, &QTimer::timeout, this, &LottiePrivate::nativeTick);
+
+  connect(&m_frameRenderer, &LottieRenderer::frameReady, this,
+          &LottiePrivate::showNativeFrame);
+}
 
 void LottiePrivate::setSource(const QString& source) {
   m_source = source;
@@ -68,6 +106,15 @@ void LottiePrivate::setReadyToPlay(bool readyToPlay) {
     }
   }
 
+  if (m_nativePlaying) {
+    if (m_readyToPlay) {
+      m_nativeClock.start();
+      m_nativeTimer.start();
+    } else {
+      m_nativeTimer.stop();
+    }
+  }
+
   createAnimation();
 }
 
@@ -81,6 +128,8 @@ void LottiePrivate::setCanvasAndContainer(QQuickItem* canvas,
 void LottiePrivate::createAnimation() {
   if (!m_readyToPlay || !m_canvas || m_source.isEmpty()) return;
 
+  if (m_nativeRenderer && createNativeAnimation()) return;
+
   if (!m_lottieModule.isObject()) {
     m_lottieModule = engine()->importModule(":/lottie/lottie/lottie.mjs");
     if (m_lottieModule.isError()) {
@@ -173,6 +222,236 @@ void LottiePrivate::createAnimation() {
   applyDirection();
 }
 
+bool LottiePrivate::createNativeAnimation() {
+  if (m_scene && m_sceneSource == m_source) {
+    requestNativeFrame();
+    return true;
+  }
+
+  QSharedPointer<const LottieScene> scene =
+      s_scenes->value(m_source).toStrongRef();
+  if (!scene) {
+    // The JS player reports the errors.
+    QFile file(m_source);
+    if (!file.open(QFile::ReadOnly)) {
+      return false;
+    }
+
+    QString errorString;
+    scene = LottieScene::fromJson(file.readAll(), &errorString);
+    if (!scene) {
+      return false;
+    }
+
+    s_scenes->insert(m_source, scene);
+  }
+
+  if (!scene->isSupported()) {
+    qDebug() << "Using the JS player for" << m_source
+             << "- unsupported:" << scene->unsupportedFeature();
+    return false;
+  }
+
+  destroyAnimation();
+
+  m_scene = scene;
+  m_sceneSource = m_source;
+  m_frameRenderer.setScene(scene);
+  m_currentFrame = nativeStartFrame();
+  updateNativeInterval();
+
+  // Like the JS player, the status changes with the first frames.
+  if (m_autoPlay) {
+    playNative();
+  }
+
+  requestNativeFrame();
+  return true;
+}
+
+void LottiePrivate::destroyNativeAnimation() {
+  m_nativeTimer.stop();
+  m_nativePlaying = false;
+  m_nativeCompleted = false;
+  m_playCount = 0;
+  m_currentFrame = 0;
+
+  if (!m_scene) {
+    return;
+  }
+
+  m_scene.clear();
+  m_sceneSource.clear();
+  m_frameRenderer.setScene(QSharedPointer<const LottieScene>());
+
+  m_frameImage = QImage();
+  update();
+}
+
+qreal LottiePrivate::nativeStartFrame() const {
+  Q_ASSERT(m_scene);
+  return m_reverse ? m_scene->totalFrames() : 0;
+}
+
+void LottiePrivate::updateNativeInterval() {
+  if (!m_scene) {
+    return;
+  }
+
+  qreal framesPerSecond = m_scene->frameRate() * std::abs(m_speed);
+  int interval = framesPerSecond > 0 ? qRound(1000 / framesPerSecond)
+                                     : NATIVE_MAX_INTERVAL_MSEC;
+  m_nativeTimer.setInterval(
+      qBound(NATIVE_MIN_INTERVAL_MSEC, interval, NATIVE_MAX_INTERVAL_MSEC));
+}
+
+QSize LottiePrivate::nativeFrameSize() const {
+  return QSize(qCeil(width()), qCeil(height()));
+}
+
+qreal LottiePrivate::nativeDevicePixelRatio() const {
+  return window() ? window()->effectiveDevicePixelRatio() : 1;
+}
+
+void LottiePrivate::requestNativeFrame() {
+  if (!m_scene || width() <= 0 || height() <= 0) {
+    return;
+  }
+
+  // The last frame is `totalFrames() - 1`: the layers end at `totalFrames()`.
+  qreal frame = qBound(0.0, m_currentFrame, m_scene->totalFrames() - 1.0);
+
+  // The cache contains whole frames only. The renderer looks them up, and
+  // inserts the missing ones, in its worker thread.
+  if (m_cacheFrames) {
+    frame = std::floor(frame);
+  }
+
+  m_frameRenderer.requestFrame(frame, nativeFrameSize(),
+                               nativeDevicePixelRatio(),
+                               toRendererFillMode(m_fillMode),
+                               frameCacheKey(frame));
+}
+
+void LottiePrivate::showNativeFrame(const QImage& image) {
+  m_frameImage = image;
+  m_frameChanged = true;
+  update();
+}
+
+// Returns the key of the animation in the frame cache, or an empty string if
+// the frame cannot be cached.
+QString LottiePrivate::frameCacheKey(qreal frame) const {
+  if (!m_cacheFrames || !m_scene || frame != std::floor(frame)) {
+    return QString();
+  }
+
+  QString key = LottieFrameCache::animationKey(
+      m_sceneSource, nativeFrameSize(), nativeDevicePixelRatio(),
+      toRendererFillMode(m_fillMode));
+  if (!LottieFrameCache::instance()->accepts(key, m_scene->totalFrames())) {
+    return QString();
+  }
+
+  return key;
+}
+
+void LottiePrivate::playNative() {
+  Q_ASSERT(m_scene);
+
+  if (m_nativeCompleted) {
+    m_nativeCompleted = false;
+    m_currentFrame = nativeStartFrame();
+  }
+
+  m_nativePlaying = true;
+  m_nativeClock.start();
+  if (m_readyToPlay) {
+    m_nativeTimer.start();
+  }
+}
+
+void LottiePrivate::nativeTick() {
+  Q_ASSERT(m_scene);
+
+  qreal delta =
+      m_nativeClock.restart() * m_scene->frameRate() * m_speed / 1000;
+  if (m_reverse) {
+    delta = -delta;
+  }
+
+  if (delta == 0) {
+    return;
+  }
+
+  int totalFrames = m_scene->totalFrames();
+  qreal frame = m_currentFrame + delta;
+
+  bool looped = false;
+  if (frame >= totalFrames || frame < 0) {
+    // Same as lottie-web: with `loops: n`, the animation is played n more
+    // times.
+    bool infinite = m_loops.isBool() && m_loops.toBool();
+    if (!infinite && (m_loops.isBool() || m_playCount >= m_loops.toInt())) {
+      completeNativeAnimation();
+      return;
+    }
+
+    ++m_playCount;
+    frame = std::fmod(frame, totalFrames);
+    if (frame < 0) {
+      frame += totalFrames;
+    }
+    looped = true;
+  }
+
+  m_currentFrame = frame;
+  requestNativeFrame();
+  m_status.updateAndNotify(true, m_currentFrame, totalFrames);
+
+  if (looped) {
+    emit loopCompleted();
+  }
+}
+
+void LottiePrivate::completeNativeAnimation() {
+  m_nativeTimer.stop();
+  m_nativePlaying = false;
+  m_nativeCompleted = true;
+  m_playCount = 0;
+
+  // The last frame stays visible.
+  m_currentFrame = m_reverse ? 0 : m_scene->totalFrames();
+  requestNativeFrame();
+
+  m_status.resetAndNotify();
+}
+
+QSGNode* LottiePrivate::updatePaintNode(QSGNode* oldNode,
+                                        UpdatePaintNodeData* data) {
+  Q_UNUSED(data);
+
+  QSGImageNode* node = static_cast<QSGImageNode*>(oldNode);
+  if (m_frameImage.isNull()) {
+    delete node;
+    return nullptr;
+  }
+
+  if (!node) {
+    node = window()->createImageNode();
+    node->setOwnsTexture(true);
+    m_frameChanged = true;
+  }
+
+  if (m_frameChanged) {
+    m_frameChanged = false;
+    node->setTexture(window()->createTextureFromImage(m_frameImage));
+  }
+
+  node->setRect(boundingRect());
+  return node;
+}
+
 void LottiePrivate::setSpeed(qreal speed) {
   m_speed = speed;
   emit speedChanged();
@@ -211,6 +490,25 @@ void LottiePrivate::setFillMode(const QString& fillMode) {
   destroyAndRecreate();
 }
 
+void LottiePrivate::setNativeRenderer(bool nativeRenderer) {
+  if (m_nativeRenderer == nativeRenderer) {
+    return;
+  }
+
+  m_nativeRenderer = nativeRenderer;
+  emit nativeRendererChanged();
+  destroyAndRecreate();
+}
+
+void LottiePrivate::setCacheFrames(bool cacheFrames) {
+  if (m_cacheFrames == cacheFrames) {
+    return;
+  }
+
+  m_cacheFrames = cacheFrames;
+  emit cacheFramesChanged();
+}
+
 QJSValue LottiePrivate::createWindowObject() {
   if (!m_window) {
     m_window = new LottiePrivateWindow(this);
@@ -245,6 +543,7 @@ bool LottiePrivate::runAnimationFunction(const QString& functionName,
 }
 
 void LottiePrivate::applySpeed() {
+  updateNativeInterval();
   runAnimationFunction("setSpeed", QList<QJSValue>{m_speed});
 }
 
@@ -253,6 +552,7 @@ void LottiePrivate::applyDirection() {
 }
 
 void LottiePrivate::destroyAnimation() {
+  destroyNativeAnimation();
   runAnimationFunction("destroy", QList<QJSValue>());
   m_animation = QJSValue();
 }
@@ -260,6 +560,7 @@ void LottiePrivate::destroyAnimation() {
 void LottiePrivate::clearAndResize() {
   clearCanvas();
   resizeAnimation();
+  requestNativeFrame();
 }
 
 void LottiePrivate::clearCanvas() {
@@ -314,18 +615,42 @@ void LottiePrivate::destroyAndRecreate() {
 }
 
 void LottiePrivate::play() {
+  if (m_scene) {
+    playNative();
+    m_status.updateAndNotify(true);
+    return;
+  }
+
   if (runAnimationFunction("play", QList<QJSValue>())) {
     m_status.updateAndNotify(true);
   }
 }
 
 void LottiePrivate::pause() {
+  if (m_scene) {
+    m_nativeTimer.stop();
+    m_nativePlaying = false;
+    m_status.updateAndNotify(false);
+    return;
+  }
+
   if (runAnimationFunction("pause", QList<QJSValue>())) {
     m_status.updateAndNotify(false);
   }
 }
 
 void LottiePrivate::stop() {
+  if (m_scene) {
+    m_nativeTimer.stop();
+    m_nativePlaying = false;
+    m_nativeCompleted = false;
+    m_playCount = 0;
+    m_currentFrame = nativeStartFrame();
+    requestNativeFrame();
+    m_status.resetAndNotify();
+    return;
+  }
+
   if (runAnimationFunction("stop", QList<QJSValue>())) {
     m_status.resetAndNotify();
   }
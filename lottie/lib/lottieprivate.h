@@ -5,13 +5,19 @@
 #ifndef LOTTIEPRIVATE_H
 #define LOTTIEPRIVATE_H
 
+#include "lottierenderer.h"
 #include "lottiestatus.h"
 
+#include <QElapsedTimer>
+#include <QImage>
 #include <QJSValue>
+#include <QSharedPointer>
+#include <QTimer>
 #include <QtQuick/QQuickItem>
 
 class QJSEngine;
 class LottiePrivateWindow;
+class LottieScene;
 
 class LottiePrivate : public QQuickItem {
   Q_OBJECT
@@ -26,6 +32,10 @@ class LottiePrivate : public QQuickItem {
       bool autoPlay READ autoPlay WRITE setAutoPlay NOTIFY autoPlayChanged)
   Q_PROPERTY(
       QString fillMode READ fillMode WRITE setFillMode NOTIFY fillModeChanged)
+  Q_PROPERTY(bool nativeRenderer READ nativeRenderer WRITE setNativeRenderer
+                 NOTIFY nativeRendererChanged)
+  Q_PROPERTY(bool cacheFrames READ cacheFrames WRITE setCacheFrames NOTIFY
+                 cacheFramesChanged)
   QML_ELEMENT
 
  public:
@@ -71,6 +81,12 @@ class LottiePrivate : public QQuickItem {
   const QString& fillMode() const { return m_fillMode; }
   void setFillMode(const QString& fillMode);
 
+  bool nativeRenderer() const { return m_nativeRenderer; }
+  void setNativeRenderer(bool nativeRenderer);
+
+  bool cacheFrames() const { return m_cacheFrames; }
+  void setCacheFrames(bool cacheFrames);
+
   QQuickItem* canvas() const { return m_canvas; }
 
   QJSValue lottieInstance() const { return m_lottieInstance; }
@@ -84,8 +100,14 @@ class LottiePrivate : public QQuickItem {
   void reverseChanged();
   void autoPlayChanged();
   void fillModeChanged();
+  void nativeRendererChanged();
+  void cacheFramesChanged();
   void loopCompleted();
 
+ protected:
+  QSGNode* updatePaintNode(QSGNode* oldNode,
+                           UpdatePaintNodeData* data) override;
+
  private:
   QJSValue createWindowObject();
   QJSValue createNavigatorObject();
@@ -101,6 +123,21 @@ class LottiePrivate : public QQuickItem {
 
   QString fillModeToAspectRatio() const;
 
+  // When enabled, the native renderer is used if the animation does not need
+  // anything unsupported by LottieScene. The JS player is the fallback.
+  bool createNativeAnimation();
+  void destroyNativeAnimation();
+  void playNative();
+  void nativeTick();
+  void completeNativeAnimation();
+  void updateNativeInterval();
+  void requestNativeFrame();
+  void showNativeFrame(const QImage& image);
+  qreal nativeStartFrame() const;
+  QSize nativeFrameSize() const;
+  qreal nativeDevicePixelRatio() const;
+  QString frameCacheKey(qreal frame) const;
+
   bool runFunction(QJSValue& object, const QString& functionName,
                    const QList<QJSValue>& params);
 
@@ -116,6 +153,8 @@ class LottiePrivate : public QQuickItem {
   LottieStatus m_status;
   bool m_autoPlay = false;
   QString m_fillMode = "stretch";
+  bool m_nativeRenderer = false;
+  bool m_cacheFrames = false;
   const QString m_context_type = "2d";
   const QString m_renderer = "canvas";
 
@@ -127,6 +166,19 @@ class LottiePrivate : public QQuickItem {
   QJSValue m_animation;
 
   LottiePrivateWindow* m_window = nullptr;
+
+  QSharedPointer<const LottieScene> m_scene;
+  QString m_sceneSource;
+  LottieRenderer m_frameRenderer;
+  QTimer m_nativeTimer;
+  QElapsedTimer m_nativeClock;
+  qreal m_currentFrame = 0;
+  int m_playCount = 0;
+  bool m_nativePlaying = false;
+  bool m_nativeCompleted = false;
+
+  QImage m_frameImage;
+  bool m_frameChanged = false;
 };
 
 #endif  // LOTTIEPRIVATE_H
@@ -0,0 +1,187 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "lottierenderer.h"
+#include "lottieframecache.h"
+#include "lottiescene.h"
+
+#include <QGlobalStatic>
+#include <QMetaObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QTransform>
+
+#include <algorithm>
+
+namespace {
+
+// Rendering is CPU bound. Let's leave some cores to the GUI and the
+// scenegraph threads.
+class RenderPool final : public QThreadPool {
+ public:
+  RenderPool() {
+    setMaxThreadCount(std::max(1, QThread::idealThreadCount() / 2));
+  }
+};
+
+Q_GLOBAL_STATIC(RenderPool, s_renderPool);
+
+QTransform fillModeTransform(const QSizeF& sceneSize, const QSizeF& size,
+                             LottieRenderer::FillMode fillMode) {
+  qreal sx = size.width() / sceneSize.width();
+  qreal sy = size.height() / sceneSize.height();
+
+  switch (fillMode) {
+    case LottieRenderer::Stretch:
+      break;
+    case LottieRenderer::PreserveAspectFit:
+      sx = sy = std::min(sx, sy);
+      break;
+    case LottieRenderer::PreserveAspectCrop:
+      sx = sy = std::max(sx, sy);
+      break;
+    case LottieRenderer::Pad:
+      sx = sy = 1;
+      break;
+  }
+
+  // Centered, as the canvas renderer of lottie-web does.
+  QTransform transform;
+  transform.translate((size.width() - sceneSize.width() * sx) / 2,
+                      (size.height() - sceneSize.height() * sy) / 2);
+  transform.scale(sx, sy);
+  return transform;
+}
+
+}  // namespace
+
+struct LottieRenderer::Handle {
+  QMutex m_mutex;
+  LottieRenderer* m_renderer = nullptr;
+};
+
+LottieRenderer::LottieRenderer(QObject* parent)
+    : QObject(parent), m_handle(new Handle()) {
+  m_handle->m_renderer = this;
+}
+
+LottieRenderer::~LottieRenderer() {
+  // A running job must not call us back.
+  QMutexLocker locker(&m_handle->m_mutex);
+  m_handle->m_renderer = nullptr;
+}
+
+void LottieRenderer::setScene(const QSharedPointer<const LottieScene>& scene) {
+  m_scene = scene;
+  m_hasPendingRequest = false;
+  ++m_generation;
+}
+
+void LottieRenderer::requestFrame(qreal frame, const QSize& size,
+                                  qreal devicePixelRatio, FillMode fillMode,
+                                  const QString& cacheKey) {
+  if (!m_scene) {
+    return;
+  }
+
+  Request request;
+  request.m_frame = frame;
+  request.m_size = size;
+  request.m_devicePixelRatio = devicePixelRatio;
+  request.m_fillMode = fillMode;
+  request.m_cacheKey = cacheKey;
+
+  if (m_busy) {
+    m_pendingRequest = request;
+    m_hasPendingRequest = true;
+    return;
+  }
+
+  startJob(request);
+}
+
+void LottieRenderer::startJob(const Request& request) {
+  Q_ASSERT(m_scene);
+  Q_ASSERT(!m_busy);
+
+  m_busy = true;
+
+  QSharedPointer<const LottieScene> scene = m_scene;
+  QSharedPointer<Handle> handle = m_handle;
+  quint64 generation = m_generation;
+
+  s_renderPool->start(
+      QRunnable::create([scene, handle, generation, request]() {
+        LottieFrameCache* cache = LottieFrameCache::instance();
+        int cacheFrame = static_cast<int>(request.m_frame);
+
+        QImage image;
+        if (!request.m_cacheKey.isEmpty()) {
+          image = cache->find(request.m_cacheKey, cacheFrame);
+        }
+
+        if (image.isNull()) {
+          image = render(*scene, request.m_frame, request.m_size,
+                         request.m_devicePixelRatio, request.m_fillMode);
+          if (!request.m_cacheKey.isEmpty()) {
+            cache->insert(request.m_cacheKey, cacheFrame, image);
+          }
+        }
+
+        QMutexLocker locker(&handle->m_mutex);
+        LottieRenderer* renderer = handle->m_renderer;
+        if (!renderer) {
+          return;
+        }
+
+        // Queued events are discarded if the renderer is deleted in the
+        // meantime.
+        QMetaObject::invokeMethod(
+            renderer,
+            [renderer, generation, image, frame = request.m_frame]() {
+              renderer->jobCompleted(generation, image, frame);
+            },
+            Qt::QueuedConnection);
+      }));
+}
+
+void LottieRenderer::jobCompleted(quint64 generation, const QImage& image,
+                                  qreal frame) {
+  m_busy = false;
+
+  if (m_hasPendingRequest) {
+    m_hasPendingRequest = false;
+    startJob(m_pendingRequest);
+  }
+
+  if (generation == m_generation && !image.isNull()) {
+    emit frameReady(image, frame);
+  }
+}
+
+// static
+QImage LottieRenderer::render(const LottieScene& scene, qreal frame,
+                              const QSize& size, qreal devicePixelRatio,
+                              FillMode fillMode) {
+  QSize pixelSize = (QSizeF(size) * devicePixelRatio).toSize();
+  if (pixelSize.isEmpty() || !scene.isSupported()) {
+    return QImage();
+  }
+
+  QImage image(pixelSize, QImage::Format_ARGB32_Premultiplied);
+  image.setDevicePixelRatio(devicePixelRatio);
+  image.fill(Qt::transparent);
+
+  QPainter painter(&image);
+  painter.setRenderHint(QPainter::Antialiasing);
+  painter.setTransform(fillModeTransform(scene.size(), size, fillMode));
+  scene.render(&painter, frame);
+  painter.end();
+
+  return image;
+}
@@ -0,0 +1,80 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef LOTTIERENDERER_H
+#define LOTTIERENDERER_H
+
+#include <QImage>
+#include <QObject>
+#include <QSharedPointer>
+#include <QSize>
+#include <QString>
+
+class LottieScene;
+
+// Rasterizes the frames of a LottieScene in a worker thread. At most one
+// frame is rendered at a time: when the worker is busy, only the most recent
+// request is kept and the others are dropped.
+//
+// A request with a key of the LottieFrameCache is served from the cache when
+// possible, and its rendered frame is inserted in it. The frame is
+// decompressed or compressed by the worker too.
+class LottieRenderer final : public QObject {
+  Q_OBJECT
+  Q_DISABLE_COPY_MOVE(LottieRenderer)
+
+ public:
+  enum FillMode {
+    Stretch,
+    PreserveAspectFit,
+    PreserveAspectCrop,
+    Pad,
+  };
+
+  explicit LottieRenderer(QObject* parent = nullptr);
+  ~LottieRenderer();
+
+  const QSharedPointer<const LottieScene>& scene() const { return m_scene; }
+  void setScene(const QSharedPointer<const LottieScene>& scene);
+
+  // `frameReady` is emitted when the frame is ready. Frames requested before
+  // a `setScene()` call are never delivered.
+  void requestFrame(qreal frame, const QSize& size, qreal devicePixelRatio,
+                    FillMode fillMode, const QString& cacheKey = QString());
+
+  // Renders a frame synchronously. `size` is in device independent pixels.
+  static QImage render(const LottieScene& scene, qreal frame,
+                       const QSize& size, qreal devicePixelRatio,
+                       FillMode fillMode);
+
+ signals:
+  void frameReady(const QImage& image, qreal frame);
+
+ private:
+  struct Request {
+    qreal m_frame = 0;
+    QSize m_size;
+    qreal m_devicePixelRatio = 1;
+    FillMode m_fillMode = Stretch;
+    QString m_cacheKey;
+  };
+
+  struct Handle;
+
+  void startJob(const Request& request);
+  void jobCompleted(quint64 generation, const QImage& image, qreal frame);
+
+ private:
+  QSharedPointer<const LottieScene> m_scene;
+
+  // Shared with the running job, to know if we are still alive.
+  QSharedPointer<Handle> m_handle;
+
+  quint64 m_generation = 0;
+  bool m_busy = false;
+  bool m_hasPendingRequest = false;
+  Request m_pendingRequest;
+};
+
+#endif  // LOTTIERENDERER_H
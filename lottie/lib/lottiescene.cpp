@@ -0,0 +1,1285 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "lottiescene.h"
+
+#include <QColor>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLineF>
+#include <QList>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPolygonF>
+#include <QTransform>
+#include <QVarLengthArray>
+#include <QVector>
+#include <QtMath>
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <iterator>
+
+namespace {
+
+constexpr int MAX_DIMENSIONS = 4;
+
+// Precompositions and parents can reference each other. Let's not loop
+// forever on broken files.
+constexpr int MAX_COMPOSITION_DEPTH = 16;
+constexpr int MAX_PARENT_DEPTH = 64;
+
+enum LayerType {
+  LayerPrecomp = 0,
+  LayerSolid = 1,
+  LayerNull = 3,
+  LayerShape = 4,
+};
+
+// A property value: a number, a point, a size or a color.
+struct Vec {
+  qreal v[MAX_DIMENSIONS] = {0, 0, 0, 0};
+  int count = 0;
+};
+
+Vec makeVec(std::initializer_list<qreal> values) {
+  Vec vec;
+  for (qreal value : values) {
+    vec.v[vec.count++] = value;
+  }
+  return vec;
+}
+
+void readValue(const QJsonValue& value, Vec* vec) {
+  *vec = Vec();
+
+  if (value.isDouble()) {
+    vec->v[0] = value.toDouble();
+    vec->count = 1;
+    return;
+  }
+
+  const QJsonArray array = value.toArray();
+  vec->count = std::min(static_cast<int>(array.count()), MAX_DIMENSIONS);
+  for (int i = 0; i < vec->count; ++i) {
+    vec->v[i] = array.at(i).toDouble();
+  }
+}
+
+// A bezier path, as stored in the `sh` shapes.
+struct Bezier {
+  bool closed = false;
+  QVector<QPointF> vertices;
+  QVector<QPointF> inTangents;
+  QVector<QPointF> outTangents;
+};
+
+QVector<QPointF> toPoints(const QJsonValue& value, int count) {
+  const QJsonArray array = value.toArray();
+
+  QVector<QPointF> points(count);
+  for (int i = 0; i < count && i < array.count(); ++i) {
+    const QJsonArray point = array.at(i).toArray();
+    points[i] = QPointF(point.at(0).toDouble(), point.at(1).toDouble());
+  }
+  return points;
+}
+
+void readValue(const QJsonValue& value, Bezier* bezier) {
+  // Keyframe values are wrapped in an array.
+  const QJsonObject obj = value.isArray()
+                              ? value.toArray().at(0).toObject()
+                              : value.toObject();
+
+  int count = obj["v"].toArray().count();
+  bezier->closed = obj["c"].toBool();
+  bezier->vertices = toPoints(obj["v"], count);
+  bezier->inTangents = toPoints(obj["i"], count);
+  bezier->outTangents = toPoints(obj["o"], count);
+}
+
+QPainterPath toPath(const Bezier& bezier) {
+  QPainterPath path;
+
+  int count = bezier.vertices.count();
+  if (count == 0) {
+    return path;
+  }
+
+  path.moveTo(bezier.vertices.at(0));
+  for (int i = 1; i < count; ++i) {
+    path.cubicTo(bezier.vertices.at(i - 1) + bezier.outTangents.at(i - 1),
+                 bezier.vertices.at(i) + bezier.inTangents.at(i),
+                 bezier.vertices.at(i));
+  }
+
+  if (bezier.closed) {
+    path.cubicTo(bezier.vertices.at(count - 1) +
+                     bezier.outTangents.at(count - 1),
+                 bezier.vertices.at(0) + bezier.inTangents.at(0),
+                 bezier.vertices.at(0));
+    path.closeSubpath();
+  }
+
+  return path;
+}
+
+// The easing of one dimension of a keyframe: a cubic bezier from (0, 0) to
+// (1, 1).
+struct Easing {
+  qreal x1 = 0;
+  qreal y1 = 0;
+  qreal x2 = 1;
+  qreal y2 = 1;
+
+  qreal valueForProgress(qreal x) const;
+};
+
+qreal Easing::valueForProgress(qreal x) const {
+  if (x <= 0) return 0;
+  if (x >= 1) return 1;
+  if (x1 == y1 && x2 == y2) return x;
+
+  auto curve = [](qreal t, qreal p1, qreal p2) {
+    qreal u = 1 - t;
+    return 3 * u * u * t * p1 + 3 * u * t * t * p2 + t * t * t;
+  };
+
+  // Newton-Raphson first...
+  qreal t = x;
+  for (int i = 0; i < 8; ++i) {
+    qreal error = curve(t, x1, x2) - x;
+    if (std::abs(error) < 1e-6) {
+      return curve(t, y1, y2);
+    }
+
+    qreal u = 1 - t;
+    qreal slope = 3 * u * u * x1 + 6 * u * t * (x2 - x1) + 3 * t * t * (1 - x2);
+    if (std::abs(slope) < 1e-6) {
+      break;
+    }
+
+    t -= error / slope;
+  }
+
+  // ... and a bisection when the curve is too flat.
+  qreal low = 0;
+  qreal high = 1;
+  t = x;
+  for (int i = 0; i < 32; ++i) {
+    qreal value = curve(t, x1, x2);
+    if (std::abs(value - x) < 1e-6) {
+      break;
+    }
+
+    if (value < x) {
+      low = t;
+    } else {
+      high = t;
+    }
+    t = (low + high) / 2;
+  }
+
+  return curve(t, y1, y2);
+}
+
+qreal component(const QJsonValue& value, int index) {
+  if (!value.isArray()) {
+    return value.toDouble();
+  }
+
+  const QJsonArray array = value.toArray();
+  if (array.isEmpty()) {
+    return 0;
+  }
+
+  return array.at(std::min(index, static_cast<int>(array.count()) - 1))
+      .toDouble();
+}
+
+Easing toEasing(const QJsonObject& keyframe, int dimension) {
+  const QJsonObject out = keyframe["o"].toObject();
+  const QJsonObject in = keyframe["i"].toObject();
+
+  Easing easing;
+  if (out.isEmpty() || in.isEmpty()) {
+    return easing;
+  }
+
+  easing.x1 = component(out["x"], dimension);
+  easing.y1 = component(out["y"], dimension);
+  easing.x2 = component(in["x"], dimension);
+  easing.y2 = component(in["y"], dimension);
+  return easing;
+}
+
+template <typename T>
+struct Segment {
+  qreal startTime = 0;
+  qreal endTime = 0;
+  T from;
+  T to;
+  bool hold = false;
+  Easing easing[MAX_DIMENSIONS];
+
+  // Positions can move along a curve.
+  QPainterPath spatialPath;
+  qreal spatialLength = 0;
+};
+
+void setSpatial(Segment<Vec>& segment, const QJsonObject& keyframe) {
+  Vec out;
+  Vec in;
+  readValue(keyframe["to"], &out);
+  readValue(keyframe["ti"], &in);
+
+  if (out.count < 2 || in.count < 2 || segment.from.count < 2 ||
+      segment.to.count < 2) {
+    return;
+  }
+
+  if (out.v[0] == 0 && out.v[1] == 0 && in.v[0] == 0 && in.v[1] == 0) {
+    return;
+  }
+
+  QPointF from(segment.from.v[0], segment.from.v[1]);
+  QPointF to(segment.to.v[0], segment.to.v[1]);
+  segment.spatialPath.moveTo(from);
+  segment.spatialPath.cubicTo(from + QPointF(out.v[0], out.v[1]),
+                              to + QPointF(in.v[0], in.v[1]), to);
+  segment.spatialLength = segment.spatialPath.length();
+}
+
+void setSpatial(Segment<Bezier>&, const QJsonObject&) {}
+
+Vec interpolate(const Segment<Vec>& segment, const qreal* progress) {
+  Vec result;
+  result.count = std::max(segment.from.count, segment.to.count);
+  for (int i = 0; i < result.count; ++i) {
+    result.v[i] = segment.from.v[i] +
+                  (segment.to.v[i] - segment.from.v[i]) * progress[i];
+  }
+
+  if (segment.spatialLength > 0) {
+    // The position moves at the eased speed along the curve.
+    qreal length = qBound(0.0, progress[0], 1.0) * segment.spatialLength;
+    QPointF point = segment.spatialPath.pointAtPercent(
+        segment.spatialPath.percentAtLength(length));
+    result.v[0] = point.x();
+    result.v[1] = point.y();
+  }
+
+  return result;
+}
+
+QPointF interpolate(const QPointF& from, const QPointF& to, qreal progress) {
+  return from + (to - from) * progress;
+}
+
+Bezier interpolate(const Segment<Bezier>& segment, const qreal* progress) {
+  const Bezier& from = segment.from;
+  const Bezier& to = segment.to;
+
+  if (from.vertices.count() != to.vertices.count()) {
+    return progress[0] < 1 ? from : to;
+  }
+
+  Bezier result;
+  result.closed = from.closed;
+
+  int count = from.vertices.count();
+  result.vertices.resize(count);
+  result.inTangents.resize(count);
+  result.outTangents.resize(count);
+  for (int i = 0; i < count; ++i) {
+    result.vertices[i] =
+        interpolate(from.vertices.at(i), to.vertices.at(i), progress[0]);
+    result.inTangents[i] =
+        interpolate(from.inTangents.at(i), to.inTangents.at(i), progress[0]);
+    result.outTangents[i] =
+        interpolate(from.outTangents.at(i), to.outTangents.at(i), progress[0]);
+  }
+
+  return result;
+}
+
+bool isKeyframes(const QJsonValue& value) {
+  if (!value.isArray()) {
+    return false;
+  }
+
+  const QJsonArray array = value.toArray();
+  return !array.isEmpty() && array.at(0).isObject() &&
+         array.at(0).toObject().contains("t");
+}
+
+// A property, animated or not.
+template <typename T>
+class Animated final {
+ public:
+  // Returns false if the property is driven by an expression.
+  bool parse(const QJsonValue& value, const T& defaultValue);
+
+  bool isAnimated() const { return !m_segments.isEmpty(); }
+
+  T value(qreal frame) const;
+
+ private:
+  T m_value;
+  QList<Segment<T>> m_segments;
+};
+
+template <typename T>
+bool Animated<T>::parse(const QJsonValue& value, const T& defaultValue) {
+  m_value = defaultValue;
+  m_segments.clear();
+
+  if (!value.isObject()) {
+    return true;
+  }
+
+  const QJsonObject obj = value.toObject();
+  if (obj["x"].isString()) {
+    return false;
+  }
+
+  QJsonValue k = obj["k"];
+  if (!isKeyframes(k)) {
+    if (!k.isUndefined()) {
+      readValue(k, &m_value);
+    }
+    return true;
+  }
+
+  const QJsonArray keyframes = k.toArray();
+  for (int i = 0; i + 1 < keyframes.count(); ++i) {
+    const QJsonObject keyframe = keyframes.at(i).toObject();
+    const QJsonObject next = keyframes.at(i + 1).toObject();
+
+    Segment<T> segment;
+    segment.startTime = keyframe["t"].toDouble();
+    segment.endTime = next["t"].toDouble();
+    segment.hold = keyframe["h"].toInt() == 1;
+    readValue(keyframe["s"], &segment.from);
+
+    // Old files store the end value in the keyframe itself.
+    if (keyframe.contains("e")) {
+      readValue(keyframe["e"], &segment.to);
+    } else if (next.contains("s")) {
+      readValue(next["s"], &segment.to);
+    } else {
+      segment.to = segment.from;
+    }
+
+    for (int d = 0; d < MAX_DIMENSIONS; ++d) {
+      segment.easing[d] = toEasing(keyframe, d);
+    }
+
+    setSpatial(segment, keyframe);
+    m_segments.append(segment);
+  }
+
+  const QJsonObject last = keyframes.last().toObject();
+  if (last.contains("s")) {
+    readValue(last["s"], &m_value);
+  } else if (!m_segments.isEmpty()) {
+    m_value = m_segments.last().to;
+  }
+
+  return true;
+}
+
+template <typename T>
+T Animated<T>::value(qreal frame) const {
+  if (m_segments.isEmpty()) {
+    return m_value;
+  }
+
+  if (frame < m_segments.first().startTime) {
+    return m_segments.first().from;
+  }
+
+  for (const Segment<T>& segment : m_segments) {
+    if (frame >= segment.endTime) {
+      continue;
+    }
+
+    if (segment.hold || segment.endTime <= segment.startTime) {
+      return segment.from;
+    }
+
+    qreal x =
+        (frame - segment.startTime) / (segment.endTime - segment.startTime);
+
+    qreal progress[MAX_DIMENSIONS];
+    for (int d = 0; d < MAX_DIMENSIONS; ++d) {
+      progress[d] = segment.easing[d].valueForProgress(x);
+    }
+
+    return interpolate(segment, progress);
+  }
+
+  return m_value;
+}
+
+// Blend modes 1 to 11 have a QPainter equivalent. The others (hue,
+// saturation, color and luminosity) are not supported.
+constexpr QPainter::CompositionMode BLEND_MODES[] = {
+    QPainter::CompositionMode_SourceOver,
+    QPainter::CompositionMode_Multiply,
+    QPainter::CompositionMode_Screen,
+    QPainter::CompositionMode_Overlay,
+    QPainter::CompositionMode_Darken,
+    QPainter::CompositionMode_Lighten,
+    QPainter::CompositionMode_ColorDodge,
+    QPainter::CompositionMode_ColorBurn,
+    QPainter::CompositionMode_HardLight,
+    QPainter::CompositionMode_SoftLight,
+    QPainter::CompositionMode_Difference,
+    QPainter::CompositionMode_Exclusion,
+};
+
+QColor toColor(const Vec& color, qreal opacity) {
+  // Old files use the 0-255 range.
+  qreal max = std::max({color.v[0], color.v[1], color.v[2]});
+  qreal scale = max > 1 ? 255 : 1;
+
+  qreal alpha = color.count > 3 ? color.v[3] / scale : 1;
+  return QColor::fromRgbF(qBound(0.0, color.v[0] / scale, 1.0),
+                          qBound(0.0, color.v[1] / scale, 1.0),
+                          qBound(0.0, color.v[2] / scale, 1.0),
+                          qBound(0.0, alpha * opacity, 1.0));
+}
+
+class Transform final {
+ public:
+  bool parse(const QJsonObject& obj);
+
+  QTransform matrix(qreal frame) const;
+  qreal opacity(qreal frame) const { return m_opacity.value(frame).v[0] / 100; }
+
+ private:
+  Animated<Vec> m_anchor;
+  Animated<Vec> m_position;
+  Animated<Vec> m_positionX;
+  Animated<Vec> m_positionY;
+  Animated<Vec> m_scale;
+  Animated<Vec> m_rotation;
+  Animated<Vec> m_opacity;
+  Animated<Vec> m_skew;
+  Animated<Vec> m_skewAxis;
+  bool m_splitPosition = false;
+};
+
+bool Transform::parse(const QJsonObject& obj) {
+  const QJsonObject position = obj["p"].toObject();
+  m_splitPosition = position["s"].toBool();
+
+  bool ok = m_anchor.parse(obj["a"], makeVec({0, 0})) &&
+            m_scale.parse(obj["s"], makeVec({100, 100})) &&
+            m_rotation.parse(obj.contains("r") ? obj["r"] : obj["rz"],
+                             makeVec({0})) &&
+            m_opacity.parse(obj["o"], makeVec({100})) &&
+            m_skew.parse(obj["sk"], makeVec({0})) &&
+            m_skewAxis.parse(obj["sa"], makeVec({0}));
+
+  if (m_splitPosition) {
+    return ok && m_positionX.parse(position["x"], makeVec({0})) &&
+           m_positionY.parse(position["y"], makeVec({0}));
+  }
+
+  return ok && m_position.parse(obj["p"], makeVec({0, 0}));
+}
+
+QTransform Transform::matrix(qreal frame) const {
+  QPointF position;
+  if (m_splitPosition) {
+    position = QPointF(m_positionX.value(frame).v[0],
+                       m_positionY.value(frame).v[0]);
+  } else {
+    Vec p = m_position.value(frame);
+    position = QPointF(p.v[0], p.v[1]);
+  }
+
+  Vec anchor = m_anchor.value(frame);
+  Vec scale = m_scale.value(frame);
+  qreal rotation = m_rotation.value(frame).v[0];
+  qreal skew = m_skew.value(frame).v[0];
+
+  // Anchor, scale, skew, rotation and position, in this order.
+  QTransform transform;
+  transform.translate(position.x(), position.y());
+  if (rotation != 0) {
+    transform.rotate(rotation);
+  }
+  if (skew != 0) {
+    qreal axis = m_skewAxis.value(frame).v[0];
+    transform.rotate(axis);
+    transform.shear(std::tan(qDegreesToRadians(-skew)), 0);
+    transform.rotate(-axis);
+  }
+  transform.scale(scale.v[0] / 100,
+                  (scale.count > 1 ? scale.v[1] : scale.v[0]) / 100);
+  transform.translate(-anchor.v[0], -anchor.v[1]);
+  return transform;
+}
+
+struct TrimPaths {
+  Animated<Vec> start;
+  Animated<Vec> end;
+  Animated<Vec> offset;
+};
+
+struct ShapeGeometry {
+  enum Type {
+    Path,
+    Rectangle,
+    Ellipse,
+  };
+
+  Type type = Path;
+  int group = 0;
+
+  // The trim paths applied to this shape, innermost first.
+  QList<int> trims;
+
+  Animated<Bezier> path;
+  Animated<Vec> position;
+  Animated<Vec> size;
+  Animated<Vec> roundness;
+
+  bool isStatic = false;
+  QPainterPath staticPath;
+
+  bool isAnimated() const {
+    return path.isAnimated() || position.isAnimated() || size.isAnimated() ||
+           roundness.isAnimated();
+  }
+};
+
+struct ShapeGroup {
+  int parent = -1;
+  Transform transform;
+};
+
+// A fill or a stroke, and the shapes it paints.
+struct ShapeStyle {
+  bool stroke = false;
+  int group = 0;
+
+  Animated<Vec> color;
+  Animated<Vec> opacity;
+  Animated<Vec> width;
+  Qt::PenCapStyle cap = Qt::FlatCap;
+  Qt::PenJoinStyle join = Qt::MiterJoin;
+  qreal miterLimit = 4;
+  Qt::FillRule fillRule = Qt::WindingFill;
+
+  struct Target {
+    int shape;
+    // The groups from the one of the shape to the one of the style,
+    // excluded.
+    QVector<int> groups;
+  };
+  QList<Target> targets;
+};
+
+// The content of a shape layer. Items are flattened: a style references the
+// shapes it paints, a shape references the trim paths that modify it.
+struct ShapeContent {
+  // The first group is the layer itself.
+  QList<ShapeGroup> groups;
+  QList<ShapeGeometry> shapes;
+  QList<TrimPaths> trims;
+  // In painting order: the bottom style first.
+  QList<ShapeStyle> styles;
+};
+
+QVector<int> groupChain(const ShapeContent& content, int from, int to) {
+  QVector<int> chain;
+  for (int group = from; group >= 0 && group != to;
+       group = content.groups.at(group).parent) {
+    chain.append(group);
+  }
+  return chain;
+}
+
+bool parseStyle(const QJsonObject& item, ShapeStyle* style,
+                QString* unsupported) {
+  style->stroke = item["ty"].toString() == "st";
+
+  if (!style->color.parse(item["c"], makeVec({0, 0, 0, 1})) ||
+      !style->opacity.parse(item["o"], makeVec({100})) ||
+      !style->width.parse(item["w"], makeVec({1}))) {
+    *unsupported = "expressions";
+    return false;
+  }
+
+  if (!item["d"].toArray().isEmpty()) {
+    *unsupported = "dashed strokes";
+    return false;
+  }
+
+  switch (item["lc"].toInt(1)) {
+    case 2:
+      style->cap = Qt::RoundCap;
+      break;
+    case 3:
+      style->cap = Qt::SquareCap;
+      break;
+    default:
+      style->cap = Qt::FlatCap;
+      break;
+  }
+
+  switch (item["lj"].toInt(1)) {
+    case 2:
+      style->join = Qt::RoundJoin;
+      break;
+    case 3:
+      style->join = Qt::BevelJoin;
+      break;
+    default:
+      style->join = Qt::SvgMiterJoin;
+      break;
+  }
+
+  style->miterLimit = item["ml"].toDouble(4);
+  style->fillRule = item["r"].toInt(1) == 2 ? Qt::OddEvenFill : Qt::WindingFill;
+  return true;
+}
+
+bool parseGeometry(const QJsonObject& item, ShapeGeometry* shape) {
+  QString type = item["ty"].toString();
+
+  if (type == "sh") {
+    shape->type = ShapeGeometry::Path;
+    return shape->path.parse(item["ks"], Bezier());
+  }
+
+  if (type == "rc") {
+    shape->type = ShapeGeometry::Rectangle;
+    return shape->position.parse(item["p"], makeVec({0, 0})) &&
+           shape->size.parse(item["s"], makeVec({0, 0})) &&
+           shape->roundness.parse(item["r"], makeVec({0}));
+  }
+
+  Q_ASSERT(type == "el");
+  shape->type = ShapeGeometry::Ellipse;
+  return shape->position.parse(item["p"], makeVec({0, 0})) &&
+         shape->size.parse(item["s"], makeVec({0, 0}));
+}
+
+// Items are visited from the last one, as lottie-web does: a style paints
+// the shapes before it, in its group and in the nested groups. The same for
+// the trim paths.
+bool parseShapeItems(const QJsonArray& items, int group, QList<int> styles,
+                     QList<int> trims, ShapeContent* content,
+                     QString* unsupported) {
+  for (int i = items.count() - 1; i >= 0; --i) {
+    const QJsonObject item = items.at(i).toObject();
+    if (item["hd"].toBool()) {
+      continue;
+    }
+
+    QString type = item["ty"].toString();
+
+    // The group transform is parsed with the group. Merge paths are ignored
+    // by lottie-web: let's render the same animations.
+    if (type == "tr" || type == "mm") {
+      continue;
+    }
+
+    if (type == "fl" || type == "st") {
+      ShapeStyle style;
+      style.group = group;
+      if (!parseStyle(item, &style, unsupported)) {
+        return false;
+      }
+
+      content->styles.append(style);
+      styles.append(content->styles.count() - 1);
+      continue;
+    }
+
+    if (type == "tm") {
+      TrimPaths trim;
+      if (!trim.start.parse(item["s"], makeVec({0})) ||
+          !trim.end.parse(item["e"], makeVec({100})) ||
+          !trim.offset.parse(item["o"], makeVec({0}))) {
+        *unsupported = "expressions";
+        return false;
+      }
+
+      content->trims.append(trim);
+      trims.prepend(content->trims.count() - 1);
+      continue;
+    }
+
+    if (type == "gr") {
+      ShapeGroup child;
+      child.parent = group;
+      child.transform.parse(QJsonObject());
+
+      const QJsonArray children = item["it"].toArray();
+      for (const QJsonValue& value : children) {
+        const QJsonObject obj = value.toObject();
+        if (obj["ty"].toString() == "tr" && !child.transform.parse(obj)) {
+          *unsupported = "expressions";
+          return false;
+        }
+      }
+
+      content->groups.append(child);
+      if (!parseShapeItems(children, content->groups.count() - 1, styles,
+                           trims, content, unsupported)) {
+        return false;
+      }
+      continue;
+    }
+
+    if (type == "sh" || type == "rc" || type == "el") {
+      ShapeGeometry shape;
+      shape.group = group;
+      shape.trims = trims;
+      if (!parseGeometry(item, &shape)) {
+        *unsupported = "expressions";
+        return false;
+      }
+
+      content->shapes.append(shape);
+      int index = content->shapes.count() - 1;
+
+      for (int style : styles) {
+        ShapeStyle& shapeStyle = content->styles[style];
+        shapeStyle.targets.append(ShapeStyle::Target{
+            index, groupChain(*content, group, shapeStyle.group)});
+      }
+      continue;
+    }
+
+    *unsupported = QString("shape type '%1'").arg(type);
+    return false;
+  }
+
+  return true;
+}
+
+QPainterPath buildPath(const ShapeGeometry& shape, qreal frame) {
+  QPainterPath path;
+
+  switch (shape.type) {
+    case ShapeGeometry::Path:
+      path = toPath(shape.path.value(frame));
+      break;
+
+    case ShapeGeometry::Rectangle: {
+      Vec position = shape.position.value(frame);
+      Vec size = shape.size.value(frame);
+      QRectF rect(position.v[0] - size.v[0] / 2, position.v[1] - size.v[1] / 2,
+                  size.v[0], size.v[1]);
+      qreal radius = std::min(shape.roundness.value(frame).v[0],
+                              std::min(rect.width(), rect.height()) / 2);
+      if (radius > 0) {
+        path.addRoundedRect(rect, radius, radius);
+      } else {
+        path.addRect(rect);
+      }
+      break;
+    }
+
+    case ShapeGeometry::Ellipse: {
+      Vec position = shape.position.value(frame);
+      Vec size = shape.size.value(frame);
+      path.addEllipse(QPointF(position.v[0], position.v[1]), size.v[0] / 2,
+                      size.v[1] / 2);
+      break;
+    }
+  }
+
+  return path;
+}
+
+void appendTrimmedRange(QPainterPath& result, const QList<QPolygonF>& polygons,
+                        qreal from, qreal to) {
+  qreal position = 0;
+  for (const QPolygonF& polygon : polygons) {
+    bool drawing = false;
+    for (int i = 1; i < polygon.count(); ++i) {
+      QLineF line(polygon.at(i - 1), polygon.at(i));
+      qreal length = line.length();
+      qreal segmentStart = position;
+      position += length;
+
+      if (length <= 0 || position <= from || segmentStart >= to) {
+        drawing = false;
+        continue;
+      }
+
+      qreal a = std::max(from, segmentStart);
+      qreal b = std::min(to, position);
+      if (!drawing) {
+        result.moveTo(line.pointAt((a - segmentStart) / length));
+        drawing = true;
+      }
+      result.lineTo(line.pointAt((b - segmentStart) / length));
+    }
+  }
+}
+
+QPainterPath trimPath(const QPainterPath& path, const TrimPaths& trim,
+                      qreal frame) {
+  qreal start = trim.start.value(frame).v[0] / 100;
+  qreal end = trim.end.value(frame).v[0] / 100;
+  qreal offset = trim.offset.value(frame).v[0] / 360;
+
+  if (start > end) {
+    std::swap(start, end);
+  }
+
+  qreal length = end - start;
+  if (length >= 1) {
+    return path;
+  }
+  if (length <= 0) {
+    return QPainterPath();
+  }
+
+  start += offset;
+  start -= std::floor(start);
+  end = start + length;
+
+  const QList<QPolygonF> polygons = path.toSubpathPolygons();
+
+  qreal total = 0;
+  for (const QPolygonF& polygon : polygons) {
+    for (int i = 1; i < polygon.count(); ++i) {
+      total += QLineF(polygon.at(i - 1), polygon.at(i)).length();
+    }
+  }
+
+  QPainterPath result;
+  if (total <= 0) {
+    return result;
+  }
+
+  appendTrimmedRange(result, polygons, start * total,
+                     std::min(end, 1.0) * total);
+  if (end > 1) {
+    appendTrimmedRange(result, polygons, 0, (end - 1) * total);
+  }
+
+  return result;
+}
+
+QPainterPath shapePath(const ShapeContent& content, const ShapeGeometry& shape,
+                       qreal frame) {
+  if (shape.isStatic && shape.trims.isEmpty()) {
+    return shape.staticPath;
+  }
+
+  QPainterPath path =
+      shape.isStatic ? shape.staticPath : buildPath(shape, frame);
+  for (int trim : shape.trims) {
+    path = trimPath(path, content.trims.at(trim), frame);
+  }
+  return path;
+}
+
+void renderShapes(QPainter* painter, const ShapeContent& content,
+                  qreal frame) {
+  int groupCount = content.groups.count();
+
+  // Transformations and opacities of the groups. `world` is relative to the
+  // layer, `local` to the parent group.
+  QVarLengthArray<QTransform, 64> local(groupCount);
+  QVarLengthArray<QTransform, 64> world(groupCount);
+  QVarLengthArray<qreal, 64> opacity(groupCount);
+  for (int i = 0; i < groupCount; ++i) {
+    const ShapeGroup& group = content.groups.at(i);
+    if (group.parent < 0) {
+      opacity[i] = 1;
+      continue;
+    }
+
+    // Parents are always before their children.
+    Q_ASSERT(group.parent < i);
+    local[i] = group.transform.matrix(frame);
+    world[i] = local[i] * world[group.parent];
+    opacity[i] = group.transform.opacity(frame) * opacity[group.parent];
+  }
+
+  const QTransform base = painter->transform();
+
+  for (const ShapeStyle& style : content.styles) {
+    QColor color =
+        toColor(style.color.value(frame),
+                style.opacity.value(frame).v[0] / 100 * opacity[style.group]);
+    if (color.alpha() == 0) {
+      continue;
+    }
+
+    qreal width = style.stroke ? style.width.value(frame).v[0] : 0;
+    if (style.stroke && width <= 0) {
+      continue;
+    }
+
+    QPainterPath path;
+    path.setFillRule(style.fillRule);
+
+    for (const ShapeStyle::Target& target : style.targets) {
+      QPainterPath targetPath =
+          shapePath(content, content.shapes.at(target.shape), frame);
+      if (targetPath.isEmpty()) {
+        continue;
+      }
+
+      if (target.groups.isEmpty()) {
+        path.addPath(targetPath);
+        continue;
+      }
+
+      QTransform transform;
+      for (int group : target.groups) {
+        transform = transform * local[group];
+      }
+      path.addPath(transform.map(targetPath));
+    }
+
+    if (path.isEmpty()) {
+      continue;
+    }
+
+    painter->setTransform(world[style.group] * base);
+
+    if (style.stroke) {
+      QPen pen(color, width, Qt::SolidLine, style.cap, style.join);
+      pen.setMiterLimit(style.miterLimit);
+      painter->strokePath(path, pen);
+    } else {
+      painter->fillPath(path, color);
+    }
+  }
+
+  painter->setTransform(base);
+}
+
+}  // namespace
+
+struct LottieScene::Layer {
+  int type = LayerNull;
+  int index = -1;
+  int parent = -1;
+  int parentPosition = -1;
+
+  qreal inPoint = 0;
+  qreal outPoint = 0;
+  qreal startTime = 0;
+  qreal stretch = 1;
+  bool hidden = false;
+  QPainter::CompositionMode blendMode = QPainter::CompositionMode_SourceOver;
+
+  Transform transform;
+
+  // Precomposition layers
+  QString refId;
+  QSizeF size;
+  const Composition* composition = nullptr;
+
+  // Solid layers
+  QColor solidColor;
+  QSizeF solidSize;
+
+  // Shape layers
+  ShapeContent shapes;
+};
+
+struct LottieScene::Composition {
+  // The first layer is the top one.
+  QList<Layer> layers;
+};
+
+LottieScene::~LottieScene() {
+  delete m_root;
+  qDeleteAll(m_assets);
+}
+
+// static
+QSharedPointer<const LottieScene> LottieScene::fromJson(
+    const QByteArray& json, QString* errorString) {
+  Q_ASSERT(errorString);
+
+  QJsonParseError parseError;
+  QJsonDocument doc = QJsonDocument::fromJson(json, &parseError);
+  if (!doc.isObject()) {
+    *errorString = parseError.error != QJsonParseError::NoError
+                       ? parseError.errorString()
+                       : QString("The JSON is not an object");
+    return nullptr;
+  }
+
+  const QJsonObject obj = doc.object();
+  if (!obj["layers"].isArray() || !obj["fr"].isDouble() ||
+      !obj["op"].isDouble() || !obj["w"].isDouble() || !obj["h"].isDouble()) {
+    *errorString = "The JSON is not a lottie animation";
+    return nullptr;
+  }
+
+  QSharedPointer<LottieScene> scene(new LottieScene());
+  scene->m_size = QSizeF(obj["w"].toDouble(), obj["h"].toDouble());
+  scene->m_frameRate = obj["fr"].toDouble();
+  scene->m_inPoint = obj["ip"].toDouble();
+  scene->m_outPoint = obj["op"].toDouble();
+
+  if (scene->m_frameRate <= 0 || scene->m_size.isEmpty() ||
+      scene->totalFrames() <= 0) {
+    *errorString = "Invalid lottie animation size or duration";
+    return nullptr;
+  }
+
+  scene->m_root = new Composition();
+  if (!scene->parseComposition(obj["layers"].toArray(), scene->m_root)) {
+    return scene;
+  }
+
+  const QJsonArray assets = obj["assets"].toArray();
+  for (const QJsonValue& value : assets) {
+    const QJsonObject asset = value.toObject();
+    // Images are not compositions. Image layers are not supported anyway.
+    if (!asset.contains("layers")) {
+      continue;
+    }
+
+    Composition* composition = new Composition();
+    scene->m_assets.insert(asset["id"].toString(), composition);
+    if (!scene->parseComposition(asset["layers"].toArray(), composition)) {
+      return scene;
+    }
+  }
+
+  QList<Composition*> compositions = scene->m_assets.values();
+  compositions.append(scene->m_root);
+  for (Composition* composition : compositions) {
+    for (Layer& layer : composition->layers) {
+      if (layer.type != LayerPrecomp) {
+        continue;
+      }
+
+      layer.composition = scene->m_assets.value(layer.refId);
+      if (!layer.composition) {
+        scene->setUnsupported(
+            QString("missing precomposition '%1'").arg(layer.refId));
+        return scene;
+      }
+    }
+  }
+
+  return scene;
+}
+
+int LottieScene::totalFrames() const {
+  return std::max(0, qRound(m_outPoint - m_inPoint));
+}
+
+void LottieScene::setUnsupported(const QString& feature) {
+  if (m_unsupportedFeature.isEmpty()) {
+    m_unsupportedFeature = feature;
+  }
+}
+
+bool LottieScene::parseComposition(const QJsonArray& layers,
+                                   Composition* composition) {
+  for (const QJsonValue& value : layers) {
+    Layer layer;
+    if (!parseLayer(value.toObject(), &layer)) {
+      return false;
+    }
+    composition->layers.append(layer);
+  }
+
+  // Parents are referenced by index.
+  for (Layer& layer : composition->layers) {
+    if (layer.parent < 0) {
+      continue;
+    }
+
+    for (int i = 0; i < composition->layers.count(); ++i) {
+      if (composition->layers.at(i).index == layer.parent) {
+        layer.parentPosition = i;
+        break;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool LottieScene::parseLayer(const QJsonObject& obj, Layer* layer) {
+  layer->type = obj["ty"].toInt(-1);
+  layer->index = obj["ind"].toInt(-1);
+  layer->parent = obj.contains("parent") ? obj["parent"].toInt(-1) : -1;
+  layer->inPoint = obj["ip"].toDouble();
+  layer->outPoint = obj["op"].toDouble();
+  layer->startTime = obj["st"].toDouble();
+  layer->stretch = obj["sr"].toDouble(1);
+  if (layer->stretch <= 0) {
+    layer->stretch = 1;
+  }
+  layer->hidden = obj["hd"].toBool();
+
+  if (obj["ddd"].toInt() != 0) {
+    setUnsupported("3D layers");
+    return false;
+  }
+
+  if (obj["hasMask"].toBool() || !obj["masksProperties"].toArray().isEmpty()) {
+    setUnsupported("masks");
+    return false;
+  }
+
+  if (obj["tt"].toInt() != 0 || obj["td"].toInt() != 0) {
+    setUnsupported("mattes");
+    return false;
+  }
+
+  if (!obj["ef"].toArray().isEmpty()) {
+    setUnsupported("effects");
+    return false;
+  }
+
+  int blendMode = obj["bm"].toInt();
+  if (blendMode < 0 || blendMode >= static_cast<int>(std::size(BLEND_MODES))) {
+    setUnsupported(QString("blend mode %1").arg(blendMode));
+    return false;
+  }
+  layer->blendMode = BLEND_MODES[blendMode];
+
+  if (obj.contains("tm")) {
+    setUnsupported("time remapping");
+    return false;
+  }
+
+  if (!layer->transform.parse(obj["ks"].toObject())) {
+    setUnsupported("expressions");
+    return false;
+  }
+
+  switch (layer->type) {
+    case LayerPrecomp:
+      layer->refId = obj["refId"].toString();
+      layer->size = QSizeF(obj["w"].toDouble(), obj["h"].toDouble());
+      return true;
+
+    case LayerSolid:
+      layer->solidColor = QColor(obj["sc"].toString());
+      layer->solidSize = QSizeF(obj["sw"].toDouble(), obj["sh"].toDouble());
+      return true;
+
+    case LayerNull:
+      return true;
+
+    case LayerShape: {
+      ShapeGroup root;
+      layer->shapes.groups.append(root);
+
+      QString unsupported;
+      if (!parseShapeItems(obj["shapes"].toArray(), 0, QList<int>(),
+                           QList<int>(), &layer->shapes, &unsupported)) {
+        setUnsupported(unsupported);
+        return false;
+      }
+
+      // Most of the shapes do not change: let's build their paths once.
+      for (ShapeGeometry& shape : layer->shapes.shapes) {
+        shape.isStatic = !shape.isAnimated();
+        if (shape.isStatic) {
+          shape.staticPath = buildPath(shape, 0);
+        }
+      }
+      return true;
+    }
+
+    default:
+      setUnsupported(QString("layer type %1").arg(layer->type));
+      return false;
+  }
+}
+
+void LottieScene::render(QPainter* painter, qreal frame) const {
+  Q_ASSERT(painter);
+
+  if (!isSupported() || !m_root) {
+    return;
+  }
+
+  renderComposition(painter, *m_root, m_inPoint + frame, 0);
+}
+
+void LottieScene::renderComposition(QPainter* painter,
+                                    const Composition& composition,
+                                    qreal frame, int depth) const {
+  if (depth > MAX_COMPOSITION_DEPTH) {
+    return;
+  }
+
+  for (int i = composition.layers.count() - 1; i >= 0; --i) {
+    const Layer& layer = composition.layers.at(i);
+    if (layer.hidden || layer.type == LayerNull) {
+      continue;
+    }
+
+    if (frame < layer.inPoint || frame >= layer.outPoint) {
+      continue;
+    }
+
+    qreal layerFrame = frame - layer.startTime;
+    qreal opacity = layer.transform.opacity(layerFrame);
+    if (opacity <= 0) {
+      continue;
+    }
+
+    // The opacity of the parents is not inherited, their transformation is.
+    QTransform matrix = layer.transform.matrix(layerFrame);
+    int parent = layer.parentPosition;
+    for (int j = 0; parent >= 0 && j < MAX_PARENT_DEPTH; ++j) {
+      const Layer& parentLayer = composition.layers.at(parent);
+      matrix = matrix *
+               parentLayer.transform.matrix(frame - parentLayer.startTime);
+      parent = parentLayer.parentPosition;
+    }
+
+    painter->save();
+    painter->setTransform(matrix, true);
+    painter->setOpacity(painter->opacity() * opacity);
+    if (layer.blendMode != QPainter::CompositionMode_SourceOver) {
+      painter->setCompositionMode(layer.blendMode);
+    }
+
+    switch (layer.type) {
+      case LayerPrecomp:
+        Q_ASSERT(layer.composition);
+        painter->setClipRect(QRectF(QPointF(0, 0), layer.size),
+                             Qt::IntersectClip);
+        renderComposition(painter, *layer.composition,
+                          layerFrame / layer.stretch, depth + 1);
+        break;
+
+      case LayerSolid:
+        painter->fillRect(QRectF(QPointF(0, 0), layer.solidSize),
+                          layer.solidColor);
+        break;
+
+      case LayerShape:
+        renderShapes(painter, layer.shapes, layerFrame);
+        break;
+
+      default:
+        break;
+    }
+
+    painter->restore();
+  }
+}
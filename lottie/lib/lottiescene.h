@@ -0,0 +1,73 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef LOTTIESCENE_H
+#define LOTTIESCENE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QSharedPointer>
+#include <QSizeF>
+#include <QString>
+
+class QJsonArray;
+class QJsonObject;
+class QPainter;
+
+// A lottie animation parsed into a tree of layers and shapes, ready to be
+// rasterized with QPainter. A scene is immutable: it can be shared between
+// items and rendered from any thread.
+//
+// Only the subset of the format used by our animations is supported: shape,
+// solid, null and precomposition layers with parenting and blend modes;
+// groups, paths, rectangles, ellipses, fills, strokes and trim paths. Merge
+// paths are ignored, as lottie-web does. When the animation uses anything
+// else (masks, mattes, effects, text, images, expressions...),
+// `unsupportedFeature()` says what.
+class LottieScene final {
+ public:
+  ~LottieScene();
+
+  // Returns nullptr if the JSON is not a lottie animation.
+  static QSharedPointer<const LottieScene> fromJson(const QByteArray& json,
+                                                    QString* errorString);
+
+  bool isSupported() const { return m_unsupportedFeature.isEmpty(); }
+  const QString& unsupportedFeature() const { return m_unsupportedFeature; }
+
+  const QSizeF& size() const { return m_size; }
+  qreal frameRate() const { return m_frameRate; }
+  int totalFrames() const;
+
+  // Renders the frame `frame`, between 0 and `totalFrames()`. The painter
+  // transformation must map the scene coordinates, from (0, 0) to `size()`.
+  void render(QPainter* painter, qreal frame) const;
+
+ private:
+  LottieScene() = default;
+  Q_DISABLE_COPY_MOVE(LottieScene)
+
+  struct Composition;
+  struct Layer;
+
+  bool parseComposition(const QJsonArray& layers, Composition* composition);
+  bool parseLayer(const QJsonObject& obj, Layer* layer);
+  void setUnsupported(const QString& feature);
+
+  void renderComposition(QPainter* painter, const Composition& composition,
+                         qreal frame, int depth) const;
+
+ private:
+  QSizeF m_size;
+  qreal m_frameRate = 0;
+  qreal m_inPoint = 0;
+  qreal m_outPoint = 0;
+
+  Composition* m_root = nullptr;
+  QHash<QString, Composition*> m_assets;
+
+  QString m_unsupportedFeature;
+};
+
+#endif  // LOTTIESCENE_H
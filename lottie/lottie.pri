@@ -3,16 +3,22 @@
 # file, You can obtain one at http://mozilla.org/MPL/2.0/.
 
 SOURCES += $$PWD/lib/lottie.cpp \
+           $$PWD/lib/lottieframecache.cpp \
            $$PWD/lib/lottieprivate.cpp \
            $$PWD/lib/lottieprivatedocument.cpp \
            $$PWD/lib/lottieprivatenavigator.cpp \
-           $$PWD/lib/lottieprivatewindow.cpp
+           $$PWD/lib/lottieprivatewindow.cpp \
+           $$PWD/lib/lottierenderer.cpp \
+           $$PWD/lib/lottiescene.cpp
 
 HEADERS += $$PWD/lib/lottie.h \
+           $$PWD/lib/lottieframecache.h \
            $$PWD/lib/lottieprivate.h \
            $$PWD/lib/lottieprivatedocument.h \
            $$PWD/lib/lottieprivatenavigator.h \
            $$PWD/lib/lottieprivatewindow.h \
+           $$PWD/lib/lottierenderer.h \
+           $$PWD/lib/lottiescene.h \
            $$PWD/lib/lottiestatus.h
 
 # wrap lottie in a single file before using it as resource.
@@ -0,0 +1,176 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "testframecache.h"
+#include "../../lib/lottieframecache.h"
+
+#include <QAtomicInt>
+#include <QImage>
+#include <QRunnable>
+#include <QThreadPool>
+
+namespace {
+
+// 100x100 ARGB32 frames of a single color: 40000 bytes, compressed to less
+// than 1 KB.
+QImage frameImage(QRgb color) {
+  QImage image(100, 100, QImage::Format_ARGB32_Premultiplied);
+  image.fill(color);
+  return image;
+}
+
+// 100x100 ARGB32 frames of noise: they do not compress, and take 40 KB in the
+// cache.
+QImage noiseImage(quint32 seed) {
+  QImage image(100, 100, QImage::Format_ARGB32_Premultiplied);
+  for (int y = 0; y < image.height(); ++y) {
+    QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+    for (int x = 0; x < image.width(); ++x) {
+      seed = seed * 1103515245 + 12345;
+      line[x] = qRgb(seed >> 24, seed >> 16, seed >> 8);
+    }
+  }
+  return image;
+}
+
+}  // namespace
+
+void TestFrameCache::cleanup() {
+  LottieFrameCache* cache = LottieFrameCache::instance();
+  cache->setMaxBytes(32 * 1024 * 1024);
+  cache->clear();
+}
+
+void TestFrameCache::key() {
+  auto key = [](const QString& source, const QSize& size, qreal ratio,
+                int fillMode) {
+    return LottieFrameCache::animationKey(source, size, ratio, fillMode);
+  };
+
+  QString a = key(":/a.json", QSize(10, 20), 2, 1);
+
+  QVERIFY(a != key(":/b.json", QSize(10, 20), 2, 1));
+  QVERIFY(a != key(":/a.json", QSize(20, 10), 2, 1));
+  QVERIFY(a != key(":/a.json", QSize(10, 20), 1, 1));
+  QVERIFY(a != key(":/a.json", QSize(10, 20), 2, 0));
+  QCOMPARE(a, key(":/a.json", QSize(10, 20), 2, 1));
+}
+
+void TestFrameCache::findAndInsert() {
+  LottieFrameCache* cache = LottieFrameCache::instance();
+
+  QVERIFY(cache->find("a", 0).isNull());
+  QCOMPARE(cache->misses(), quint64(1));
+  QCOMPARE(cache->hits(), quint64(0));
+
+  QImage frame = noiseImage(1);
+  frame.setDevicePixelRatio(2);
+  cache->insert("a", 0, frame);
+  QCOMPARE(cache->count(), 1);
+
+  QImage image = cache->find("a", 0);
+  QVERIFY(!image.isNull());
+  QCOMPARE(image, frame);
+  QCOMPARE(image.devicePixelRatio(), 2.0);
+  QCOMPARE(cache->hits(), quint64(1));
+
+  // Frames are per animation.
+  QVERIFY(cache->find("a", 1).isNull());
+  QVERIFY(cache->find("b", 0).isNull());
+
+  // Null images are not cached.
+  cache->insert("a", 1, QImage());
+  QCOMPARE(cache->count(), 1);
+}
+
+void TestFrameCache::compression() {
+  LottieFrameCache* cache = LottieFrameCache::instance();
+
+  cache->insert("a", 0, frameImage(qRgb(255, 0, 0)));
+  QCOMPARE(cache->bytes(), qint64(1024));
+  QCOMPARE(cache->find("a", 0).pixel(99, 99), qRgb(255, 0, 0));
+
+  cache->insert("a", 1, noiseImage(1));
+  QVERIFY(cache->bytes() >= 1024 + 40000);
+}
+
+void TestFrameCache::eviction() {
+  LottieFrameCache* cache = LottieFrameCache::instance();
+
+  // Room for 3 uncompressible frames.
+  cache->setMaxBytes(130 * 1024);
+
+  cache->insert("a", 0, noiseImage(1));
+  cache->insert("a", 1, noiseImage(2));
+  cache->insert("a", 2, noiseImage(3));
+  QCOMPARE(cache->count(), 3);
+
+  // Frame 0 is now the most recently used frame.
+  QVERIFY(!cache->find("a", 0).isNull());
+
+  cache->insert("a", 3, noiseImage(4));
+  QCOMPARE(cache->count(), 3);
+  QVERIFY(cache->bytes() <= cache->maxBytes());
+  QVERIFY(cache->find("a", 1).isNull());
+  QVERIFY(!cache->find("a", 0).isNull());
+  QVERIFY(!cache->find("a", 2).isNull());
+  QVERIFY(!cache->find("a", 3).isNull());
+
+  // Shrinking the cache evicts frames too.
+  cache->setMaxBytes(45 * 1024);
+  QCOMPARE(cache->count(), 1);
+}
+
+void TestFrameCache::accepts() {
+  LottieFrameCache* cache = LottieFrameCache::instance();
+  cache->setMaxBytes(1024 * 1024);
+
+  // Nothing is known about these animations yet.
+  QVERIFY(cache->accepts("flat", 1000));
+  QVERIFY(cache->accepts("noise", 1000));
+
+  // The estimate follows the compressed frames: 1000 flat frames fit in 1 MB,
+  // 1000 frames of noise do not.
+  cache->insert("flat", 0, frameImage(qRgb(255, 0, 0)));
+  cache->insert("noise", 0, noiseImage(1));
+  QVERIFY(cache->accepts("flat", 1000));
+  QVERIFY(!cache->accepts("noise", 1000));
+  QVERIFY(cache->accepts("noise", 20));
+}
+
+// The render workers insert and find frames concurrently.
+void TestFrameCache::threads() {
+  LottieFrameCache* cache = LottieFrameCache::instance();
+
+  // Room for about 50 uncompressible frames: the workers evict each other's
+  // frames too.
+  cache->setMaxBytes(50 * 40 * 1024);
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(4);
+
+  QAtomicInt corrupted;
+  for (int worker = 0; worker < 4; ++worker) {
+    pool.start(QRunnable::create([cache, worker, &corrupted]() {
+      QString key = QString("worker%1").arg(worker);
+      for (int frame = 0; frame < 100; ++frame) {
+        QImage image = noiseImage(worker * 100 + frame);
+        cache->insert(key, frame, image);
+
+        QImage cached = cache->find(key, frame);
+        if (!cached.isNull() && cached != image) {
+          corrupted.ref();
+        }
+      }
+    }));
+  }
+  QVERIFY(pool.waitForDone(30000));
+
+  QCOMPARE(corrupted.loadRelaxed(), 0);
+  QCOMPARE(cache->hits() + cache->misses(), quint64(400));
+  QVERIFY(cache->count() > 0);
+  QVERIFY(cache->bytes() <= cache->maxBytes());
+}
+
+static TestFrameCache s_testFrameCache;
@@ -0,0 +1,142 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "testscene.h"
+#include "../../lib/lottierenderer.h"
+#include "../../lib/lottiescene.h"
+
+#include <QFile>
+#include <QImage>
+#include <QSignalSpy>
+
+namespace {
+
+QByteArray readFile(const QString& fileName) {
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return QByteArray();
+  }
+  return file.readAll();
+}
+
+// A 100x100 scene: a red 20x20 rect moving from (10, 10) to (90, 10) in 10
+// frames.
+const char* s_movingRect = R"({
+  "v": "5.7.0", "fr": 10, "ip": 0, "op": 10, "w": 100, "h": 100,
+  "layers": [{
+    "ty": 4, "ind": 1, "ip": 0, "op": 10, "st": 0,
+    "ks": {
+      "p": {"a": 1, "k": [
+        {"t": 0, "s": [10, 10], "o": {"x": 0, "y": 0}, "i": {"x": 1, "y": 1}},
+        {"t": 10, "s": [90, 10]}
+      ]}
+    },
+    "shapes": [{
+      "ty": "gr",
+      "it": [
+        {"ty": "rc", "p": {"a": 0, "k": [0, 0]}, "s": {"a": 0, "k": [20, 20]},
+         "r": {"a": 0, "k": 0}},
+        {"ty": "fl", "c": {"a": 0, "k": [1, 0, 0, 1]}, "o": {"a": 0, "k": 100}},
+        {"ty": "tr"}
+      ]
+    }]
+  }]
+})";
+
+}  // namespace
+
+void TestScene::invalidJson() {
+  QString errorString;
+  QVERIFY(!LottieScene::fromJson("not json", &errorString));
+  QVERIFY(!errorString.isEmpty());
+
+  errorString.clear();
+  QVERIFY(!LottieScene::fromJson("{\"foo\": 42}", &errorString));
+  QVERIFY(!errorString.isEmpty());
+}
+
+void TestScene::unsupported_data() {
+  QTest::addColumn<QString>("fileName");
+
+  // Expressions
+  QTest::addRow("a.json") << QFINDTESTDATA("../qml/a.json");
+  // Masks, mattes and effects
+  QTest::addRow("b.json") << QFINDTESTDATA("../qml/b.json");
+}
+
+// These animations are played by lottie-web.
+void TestScene::unsupported() {
+  QFETCH(QString, fileName);
+
+  QByteArray json = readFile(fileName);
+  QVERIFY(!json.isEmpty());
+
+  QString errorString;
+  QSharedPointer<const LottieScene> scene =
+      LottieScene::fromJson(json, &errorString);
+  QVERIFY(scene);
+  QVERIFY(!scene->isSupported());
+  QVERIFY(!scene->unsupportedFeature().isEmpty());
+  QCOMPARE(scene->totalFrames(), 42);
+
+  // Nothing is rendered.
+  QVERIFY(LottieRenderer::render(*scene, 0, QSize(100, 100), 1,
+                                 LottieRenderer::Stretch)
+              .isNull());
+}
+
+void TestScene::animatedRect() {
+  QString errorString;
+  QSharedPointer<const LottieScene> scene =
+      LottieScene::fromJson(s_movingRect, &errorString);
+  QVERIFY2(scene, qPrintable(errorString));
+  QVERIFY(scene->isSupported());
+  QCOMPARE(scene->totalFrames(), 10);
+
+  QImage first = LottieRenderer::render(*scene, 0, QSize(100, 100), 1,
+                                        LottieRenderer::Stretch);
+  QCOMPARE(first.pixel(10, 10), qRgb(255, 0, 0));
+  QCOMPARE(qAlpha(first.pixel(50, 10)), 0);
+
+  QImage middle = LottieRenderer::render(*scene, 5, QSize(100, 100), 1,
+                                         LottieRenderer::Stretch);
+  QCOMPARE(qAlpha(middle.pixel(10, 10)), 0);
+  QCOMPARE(middle.pixel(50, 10), qRgb(255, 0, 0));
+
+  // Scaled by the device pixel ratio.
+  QImage hiDpi = LottieRenderer::render(*scene, 0, QSize(100, 100), 2,
+                                        LottieRenderer::Stretch);
+  QCOMPARE(hiDpi.size(), QSize(200, 200));
+  QCOMPARE(hiDpi.pixel(20, 20), qRgb(255, 0, 0));
+}
+
+void TestScene::renderer() {
+  QString errorString;
+  QSharedPointer<const LottieScene> scene =
+      LottieScene::fromJson(s_movingRect, &errorString);
+  QVERIFY(scene);
+
+  LottieRenderer renderer;
+  QSignalSpy spy(&renderer, &LottieRenderer::frameReady);
+
+  // No scene, no frames.
+  renderer.requestFrame(0, QSize(100, 100), 1, LottieRenderer::Stretch);
+  QVERIFY(!spy.wait(100));
+
+  renderer.setScene(scene);
+
+  // Only the last pending request is rendered.
+  for (int frame = 0; frame < 10; ++frame) {
+    renderer.requestFrame(frame, QSize(100, 100), 1, LottieRenderer::Stretch);
+  }
+
+  QTRY_COMPARE(spy.count(), 2);
+  QCOMPARE(spy.at(0).at(1).toReal(), 0.0);
+  QCOMPARE(spy.at(1).at(1).toReal(), 9.0);
+
+  QImage image = spy.at(1).at(0).value<QImage>();
+  QCOMPARE(image.pixel(90, 10), qRgb(255, 0, 0));
+}
+
+static TestScene s_testScene;
@@ -52,6 +52,7 @@ VPNFlickable {
                 spacing: VPNTheme.theme.listSpacing * 0.5
                 // IP Adresses
                 VPNIPAddress {
+                    objectName: "connectionInfoIpv4"
                     //% "IPv4:"
                     //: The abbreviation for Internet Protocol. This is followed by the user’s IPv4 address.
                     property var ipv4label: qsTrId("vpn.connectionInfo.ipv4")
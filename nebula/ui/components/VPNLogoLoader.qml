@@ -26,6 +26,9 @@ Item {
 
     VPNLottieAnimation {
         id: loadingAnimation
+        // Looped for as long as the connection benchmark runs. The frames
+        // are only cached once `nativeRenderer` is enabled.
+        cacheFrames: true
         source: ":/nebula/resources/animations/vpnlogo-kinetic_animation.json"
     }
 
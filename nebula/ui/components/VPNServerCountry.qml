@@ -166,11 +166,12 @@ VPNClickableRow {
             id: citiesRepeater
             model: cities
 
+            // The roles of the cities shadow the ones of the country.
             delegate: VPNRadioDelegate {
-                property string _cityName: modelData.name
-                property string _countryCode: code
-                property string _localizedCityName: modelData.localizedName
-                property string locationScore: VPNServerCountryModel.cityConnectionScore(code, modelData.code)
+                property string _cityName: model.name
+                property string _countryCode: serverCountry._countryCode
+                property string _localizedCityName: model.localizedName
+                property string locationScore: VPNServerCountryModel.cityConnectionScore(_countryCode, model.code)
                 property bool isAvailable: locationScore >= 0
                 property int itemHeight: 54
 
@@ -190,7 +191,7 @@ VPNClickableRow {
                     }
 
                     if (currentServer.whichHop === "singleHopServer") {
-                        VPNController.changeServer(code, del._cityName);
+                        VPNController.changeServer(del._countryCode, del._cityName);
                         return stackview.pop();
                     }
 
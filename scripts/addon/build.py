@@ -226,6 +226,40 @@ def copy_files(path, dest_path):
             copy_files(file_path, dir_path)
 
 
+def get_script_list(path):
+    script_list = []
+    for file in os.listdir(path):
+        file_path = os.path.join(path, file)
+        if os.path.isfile(file_path) and file_path.endswith(".js"):
+            script_list.append(file_path)
+            continue
+
+        if os.path.isdir(file_path):
+            script_list += get_script_list(file_path)
+
+    return script_list
+
+
+def compile_scripts(path, qmlcachegen):
+    # The scripts only expose a function: the module exports it. The client
+    # imports the module instead of evaluating the script when both exist.
+    cache_path = tempfile.mkdtemp()
+    for script in get_script_list(path):
+        module = script[:-3] + ".mjs"
+        with open(script, "r", encoding="utf-8") as f:
+            source = f.read().strip()
+        with open(module, "w", encoding="utf-8") as f:
+            f.write(f"export default {source}\n")
+
+        # The bytecode cannot be loaded from a package, but qmlcachegen
+        # rejects the modules which do not compile.
+        cache_file = os.path.join(cache_path, "module.mjsc")
+        if os.system(f"{qmlcachegen} {module} -o {cache_file}") != 0:
+            exit(f"Unable to compile {os.path.basename(script)} as a module")
+
+    shutil.rmtree(cache_path)
+
+
 def get_file_list(path, prefix):
     file_list = []
     for file in os.listdir(path):
@@ -267,6 +301,13 @@ parser.add_argument(
     dest="qtpath",
     help="The QT binary path. If not set, we try to guess.",
 )
+parser.add_argument(
+    "--compile-scripts",
+    default=False,
+    action="store_true",
+    dest="compilescripts",
+    help="Add an ES module, checked by qmlcachegen, next to each script.",
+)
 args = parser.parse_args()
 
 
@@ -297,12 +338,14 @@ if not os.path.isdir(qtbinpath):
 lconvert = os.path.join(qtbinpath, "lconvert")
 lrelease = os.path.join(qtbinpath, "lrelease")
 
-rcc_bin = "rcc"
-if os.name == "nt":
-    rcc_bin = "rcc.exe"
+def qttool(name):
+    if os.name == "nt":
+        name = f"{name}.exe"
+
+    tool = os.path.join(qtbinpath, name)
+    if os.path.isfile(tool):
+        return tool
 
-rcc = os.path.join(qtbinpath, rcc_bin)
-if not os.path.isfile(rcc):
     qtlibexecpath = qtquery(os.path.join(qtbinpath, "qmake"), "QT_INSTALL_LIBEXECS")
     if qtlibexecpath is None:
         qtlibexecpath = qtquery(
@@ -311,10 +354,14 @@ if not os.path.isfile(rcc):
     if qtlibexecpath is None:
         print("Unable to locate qmake libexec path.")
         sys.exit(1)
-    rcc = os.path.join(qtlibexecpath, rcc_bin)
-    if not os.path.isfile(rcc):
-        print("Unable to locate rcc path.")
+    tool = os.path.join(qtlibexecpath, name)
+    if not os.path.isfile(tool):
+        print(f"Unable to locate {name} path.")
         sys.exit(1)
+    return tool
+
+
+rcc = qttool("rcc")
 
 if not os.path.isfile(args.source):
     exit(f"`{args.source}` is not a file")
@@ -335,6 +382,10 @@ with open(args.source, "r", encoding="utf-8") as file:
     tmp_path = tempfile.mkdtemp()
     copy_files(os.path.dirname(args.source), tmp_path)
 
+    if args.compilescripts:
+        print("Compiling the scripts...")
+        compile_scripts(tmp_path, qttool("qmlcachegen"))
+
     strings = {}
 
     if "translatable" not in manifest or manifest["translatable"] == True:
@@ -18,6 +18,13 @@ parser.add_argument(
     dest="qtpath",
     help="The QT binary path. If not set, we try to guess.",
 )
+parser.add_argument(
+    "--compile-scripts",
+    default=False,
+    action="store_true",
+    dest="compilescripts",
+    help="Add an ES module, checked by qmlcachegen, next to each script.",
+)
 args = parser.parse_args()
 
 lang_path = os.path.join(os.path.dirname(os.path.realpath(__file__)), "..", "utils", "import_languages.py")
@@ -51,6 +58,8 @@ for file in os.listdir(addons_path):
     if args.qtpath:
         build_cmd.append("-q")
         build_cmd.append(args.qtpath)
+    if args.compilescripts:
+        build_cmd.append("--compile-scripts")
     subprocess.call(build_cmd)
 
     generated_addon_path = os.path.join(generated_path, file + ".rcc")
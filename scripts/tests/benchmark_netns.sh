@@ -0,0 +1,76 @@
+#!/bin/bash
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+# Runs a command, by default the benchmark functional tests, against a
+# stand-in server living in a network namespace behind a shaped link. The
+# shaper has a large queue: under load, the latency grows by hundreds of msecs.
+#
+# Requires root, iproute2 and python3. The link can be tuned with:
+#   BENCHMARK_RATE  - the rate of the link, in both directions (20mbit)
+#   BENCHMARK_DELAY - the one-way delay of the link (10ms)
+#   BENCHMARK_QUEUE - the size of the queue, in bytes (1000000)
+
+set -e
+
+. $(dirname $0)/../utils/commons.sh
+
+NETNS=mvpn-benchmark
+HOST_IF=mvpn-bench0
+NETNS_IF=mvpn-bench1
+HOST_ADDRESS=10.213.0.1
+NETNS_ADDRESS=10.213.0.2
+PORT=8080
+
+RATE=${BENCHMARK_RATE:-20mbit}
+DELAY=${BENCHMARK_DELAY:-10ms}
+QUEUE=${BENCHMARK_QUEUE:-1000000}
+
+if [[ $(id -u) -ne 0 ]]; then
+  die "This script must run as root"
+fi
+
+cleanup() {
+  [[ -n "$SERVER_PID" ]] && kill "$SERVER_PID" 2>/dev/null
+  ip link del "$HOST_IF" 2>/dev/null
+  ip netns del "$NETNS" 2>/dev/null
+}
+trap cleanup EXIT
+
+print Y "Creating the network namespace..."
+ip netns add "$NETNS"
+ip link add "$HOST_IF" type veth peer name "$NETNS_IF"
+ip link set "$NETNS_IF" netns "$NETNS"
+ip addr add "$HOST_ADDRESS/30" dev "$HOST_IF"
+ip link set "$HOST_IF" up
+ip netns exec "$NETNS" ip addr add "$NETNS_ADDRESS/30" dev "$NETNS_IF"
+ip netns exec "$NETNS" ip link set "$NETNS_IF" up
+ip netns exec "$NETNS" ip link set lo up
+print G "done."
+
+print Y "Shaping the link: $RATE, $DELAY, $QUEUE bytes of queue..."
+shape() {
+  $1 tc qdisc add dev "$2" root handle 1: netem delay "$DELAY"
+  $1 tc qdisc add dev "$2" parent 1: handle 2: tbf rate "$RATE" \
+    burst 32kbit limit "$QUEUE"
+}
+shape "" "$HOST_IF"
+shape "ip netns exec $NETNS" "$NETNS_IF"
+print G "done."
+
+print Y "Starting the stand-in server..."
+ip netns exec "$NETNS" python3 "$(dirname $0)/benchmark_server.py" \
+  -a "$NETNS_ADDRESS" -p "$PORT" &
+SERVER_PID=$!
+sleep 1
+print G "done."
+
+export MVPN_BENCHMARK_URL="http://$NETNS_ADDRESS:$PORT/"
+export MVPN_BENCHMARK_PING_ADDRESS="$NETNS_ADDRESS"
+
+if [[ $# -eq 0 ]]; then
+  set -- npm run functionalTest -- tests/functional/testBenchmark.js
+fi
+
+"$@"
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+## Stand-in server for the connection benchmark: it serves the download,
+## accepts the upload and answers the DNS pings of the latency probe.
+
+import argparse
+import socketserver
+import struct
+import threading
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+CHUNK = bytes(65536)
+
+parser = argparse.ArgumentParser(description='Connection benchmark server')
+parser.add_argument('-a', '--address', default='0.0.0.0',
+                    help='Address to listen on')
+parser.add_argument('-p', '--port', type=int, default=8080,
+                    help='HTTP port')
+parser.add_argument('-s', '--size', type=int, default=64,
+                    help='Download size, in megabytes')
+args = parser.parse_args()
+
+
+class BenchmarkHandler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+
+    def do_GET(self):
+        chunks = args.size * 1024 * 1024 // len(CHUNK)
+        self.send_response(200)
+        self.send_header('Content-Type', 'application/octet-stream')
+        self.send_header('Content-Length', str(chunks * len(CHUNK)))
+        self.end_headers()
+        try:
+            for _ in range(chunks):
+                self.wfile.write(CHUNK)
+        except (BrokenPipeError, ConnectionResetError):
+            pass
+
+    def do_POST(self):
+        remaining = int(self.headers.get('Content-Length', 0))
+        while remaining > 0:
+            data = self.rfile.read(min(remaining, len(CHUNK)))
+            if not data:
+                break
+            remaining -= len(data)
+        self.send_response(200)
+        self.send_header('Content-Length', '2')
+        self.end_headers()
+        self.wfile.write(b'OK')
+
+    def log_message(self, format, *args):
+        pass
+
+
+class DnsPingHandler(socketserver.BaseRequestHandler):
+    ## Any query gets an empty answer: the client only checks the header.
+    def handle(self):
+        data, sock = self.request
+        if len(data) < 12:
+            return
+        (ident, flags) = struct.unpack('!HH', data[:4])
+        reply = struct.pack('!HHHHHH', ident, flags | 0x8000, 0, 0, 0, 0)
+        sock.sendto(reply, self.client_address)
+
+
+dns = socketserver.ThreadingUDPServer((args.address, 53), DnsPingHandler)
+threading.Thread(target=dns.serve_forever, daemon=True).start()
+
+ThreadingHTTPServer((args.address, args.port), BenchmarkHandler).serve_forever()
@@ -0,0 +1,146 @@
+#!/bin/bash
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+# Measures how long the Linux daemon takes to notice the first handshake with
+# a local WireGuard server, and how much CPU it uses meanwhile.
+#
+# The daemon runs in a network namespace, and the server in another one. The
+# configuration is activated for the hop 1: the hop 0 would configure the DNS
+# of the host.
+#
+# Requires root, iproute2, wireguard-tools, dbus-send and dbus-monitor, the
+# D-Bus policy of the daemon (org.mozilla.vpn.conf), and no other running
+# daemon. The test can be tuned with:
+#   MOZVPN_BIN      - the mozillavpn binary (./build/src/mozillavpn)
+#   HANDSHAKE_DELAY - the one-way delay to the server (50ms)
+#   ROUNDS          - the number of activations (10)
+
+set -e
+
+. $(dirname $0)/../utils/commons.sh
+
+CLIENT=mvpn-hs-client
+SERVER=mvpn-hs-server
+GATEWAY=10.64.0.1
+CLIENT_ADDRESS=10.64.0.2
+PORT=51820
+
+BIN=${MOZVPN_BIN:-./build/src/mozillavpn}
+DELAY=${HANDSHAKE_DELAY:-50ms}
+ROUNDS=${ROUNDS:-10}
+
+DBUS_DEST="--system --print-reply --dest=org.mozilla.vpn.dbus /"
+DBUS_IFACE=org.mozilla.vpn.dbus
+
+if [[ $(id -u) -ne 0 ]]; then
+  die "This script must run as root"
+fi
+if ! [[ -x "$BIN" ]]; then
+  die "No mozillavpn binary: set MOZVPN_BIN"
+fi
+
+cleanup() {
+  [[ -n "$MONITOR_PID" ]] && kill "$MONITOR_PID" 2>/dev/null
+  [[ -n "$DAEMON_PID" ]] && kill "$DAEMON_PID" 2>/dev/null
+  ip netns del "$CLIENT" 2>/dev/null
+  ip netns del "$SERVER" 2>/dev/null
+  rm -f "$SIGNALS"
+}
+trap cleanup EXIT
+
+inns() {
+  local ns=$1
+  shift
+  ip netns exec "$ns" "$@"
+}
+
+print Y "Creating the network namespaces..."
+ip netns add "$CLIENT"
+ip netns add "$SERVER"
+inns "$CLIENT" ip link set lo up
+inns "$SERVER" ip link set lo up
+ip link add mvpn-hs0 netns "$CLIENT" type veth peer name eth0 netns "$SERVER"
+inns "$CLIENT" ip addr add 10.213.0.1/30 dev mvpn-hs0
+inns "$CLIENT" ip link set mvpn-hs0 up
+inns "$SERVER" ip addr add 10.213.0.2/30 dev eth0
+inns "$SERVER" ip link set eth0 up
+inns "$SERVER" tc qdisc add dev eth0 root netem delay "$DELAY" || \
+  error "No netem: the handshake runs without delay"
+
+CLIENT_KEY=$(wg genkey)
+CLIENT_PUB=$(echo "$CLIENT_KEY" | wg pubkey)
+SERVER_KEY=$(wg genkey)
+SERVER_PUB=$(echo "$SERVER_KEY" | wg pubkey)
+
+inns "$SERVER" ip link add wg0 type wireguard
+inns "$SERVER" wg set wg0 private-key <(echo "$SERVER_KEY") \
+  listen-port "$PORT" peer "$CLIENT_PUB" allowed-ips "$CLIENT_ADDRESS/32"
+inns "$SERVER" ip addr add "$GATEWAY/32" dev wg0
+inns "$SERVER" ip link set wg0 up
+inns "$SERVER" ip route add "$CLIENT_ADDRESS/32" dev wg0
+print G "done."
+
+print Y "Starting the daemon..."
+SIGNALS=$(mktemp)
+dbus-monitor --system "type='signal',interface='$DBUS_IFACE'" \
+  > "$SIGNALS" &
+MONITOR_PID=$!
+inns "$CLIENT" "$BIN" linuxdaemon >/dev/null 2>&1 &
+DAEMON_PID=$!
+sleep 2
+print G "done."
+
+CONFIG=$(cat <<JSON
+{
+  "privateKey": "$CLIENT_KEY",
+  "deviceIpv4Address": "$CLIENT_ADDRESS/32",
+  "deviceIpv6Address": "fd00::2/128",
+  "serverPublicKey": "$SERVER_PUB",
+  "serverIpv4AddrIn": "10.213.0.2",
+  "serverIpv6AddrIn": "",
+  "serverPort": $PORT,
+  "serverIpv4Gateway": "$GATEWAY",
+  "serverIpv6Gateway": "fd00::1",
+  "dnsServer": "$GATEWAY",
+  "hopindex": 1,
+  "allowedIPAddressRanges": [
+    {"address": "$GATEWAY", "range": 32, "isIpv6": false}
+  ],
+  "excludedAddresses": [],
+  "vpnDisabledApps": []
+}
+JSON
+)
+
+cpu_ticks() {
+  awk '{print $14 + $15}' "/proc/$DAEMON_PID/stat"
+}
+
+print Y "Activating $ROUNDS times..."
+TOTAL_MSEC=0
+TICKS_START=$(cpu_ticks)
+for round in $(seq "$ROUNDS"); do
+  COUNT=$(grep -c "member=connected" "$SIGNALS" || true)
+  START=$(date +%s%N)
+  dbus-send $DBUS_DEST $DBUS_IFACE.activate string:"$CONFIG" >/dev/null
+
+  for _ in $(seq 1000); do
+    if [[ $(grep -c "member=connected" "$SIGNALS" || true) -gt $COUNT ]]; then
+      break
+    fi
+    sleep 0.005
+  done
+  MSEC=$((($(date +%s%N) - START) / 1000000))
+  TOTAL_MSEC=$((TOTAL_MSEC + MSEC))
+  print N "Round $round: connected in $MSEC msecs"
+
+  dbus-send $DBUS_DEST $DBUS_IFACE.deactivate >/dev/null
+  sleep 0.5
+done
+TICKS=$(($(cpu_ticks) - TICKS_START))
+print G "done."
+
+print N "Average connect time: $((TOTAL_MSEC / ROUNDS)) msecs"
+print N "Daemon CPU time: $((TICKS * 1000 / $(getconf CLK_TCK))) msecs"
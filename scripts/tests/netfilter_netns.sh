@@ -0,0 +1,33 @@
+#!/bin/bash
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+# Runs the tests of the netfilter bridge (linux/netfilter) in a new network
+# namespace: they program the firewall, with thousands of excluded addresses,
+# and must not touch the one of the host.
+#
+# Requires go, nftables support in the kernel, and either root or unprivileged
+# user namespaces. The tests can be tuned with:
+#   NETFILTER_COUNT - the number of excluded addresses of each family (5000)
+
+set -e
+
+. $(dirname $0)/../utils/commons.sh
+
+if ! command -v go >/dev/null; then
+  die "This script requires go"
+fi
+
+UNSHARE="unshare --net"
+if [[ $(id -u) -ne 0 ]]; then
+  UNSHARE="unshare --user --map-root-user --net"
+fi
+
+export MOZVPN_NETFILTER_NETNS=1
+export MOZVPN_NETFILTER_COUNT=${NETFILTER_COUNT:-5000}
+
+print Y "Running the netfilter tests in a network namespace..."
+cd "$(dirname $0)/../../linux/netfilter"
+$UNSHARE go test -v -count=1 . "$@"
+print G "done."
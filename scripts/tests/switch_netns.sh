@@ -0,0 +1,144 @@
+#!/bin/bash
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+# Measures the packet loss of a server switch, between two local WireGuard
+# servers living in network namespaces. The client pings the gateway every
+# 10 msecs, through the tunnel, while it switches:
+#   - break-before-make: the allowed IPs move to the new peer right away, as
+#     in WireguardUtilsLinux::updatePeer();
+#   - make-before-break: the new peer is added without allowed IPs, and they
+#     move once it has completed its handshake, as in the Daemon with
+#     WireguardUtilsLinux::addPendingPeer().
+#
+# The peers are driven with `wg`, not through the daemon. The pending switch
+# logic of the Daemon is covered by TestDaemon, in the unit tests.
+#
+# Requires root, iproute2, wireguard-tools and the wireguard kernel module.
+# The link can be tuned with:
+#   SWITCH_DELAY - the one-way delay to the servers (50ms)
+
+set -e
+
+. $(dirname $0)/../utils/commons.sh
+
+CLIENT=mvpn-switch-client
+SERVERS=(mvpn-switch-srv1 mvpn-switch-srv2)
+GATEWAY=10.64.0.1
+CLIENT_ADDRESS=10.64.0.2
+PORT=51820
+
+DELAY=${SWITCH_DELAY:-50ms}
+
+if [[ $(id -u) -ne 0 ]]; then
+  die "This script must run as root"
+fi
+
+cleanup() {
+  for ns in "$CLIENT" "${SERVERS[@]}"; do
+    ip netns del "$ns" 2>/dev/null
+  done
+}
+trap cleanup EXIT
+
+inns() {
+  local ns=$1
+  shift
+  ip netns exec "$ns" "$@"
+}
+
+print Y "Creating the network namespaces..."
+ip netns add "$CLIENT"
+inns "$CLIENT" ip link set lo up
+CLIENT_KEY=$(wg genkey)
+CLIENT_PUB=$(echo "$CLIENT_KEY" | wg pubkey)
+
+declare -a SERVER_PUBS SERVER_ENDPOINTS
+for i in 0 1; do
+  ns=${SERVERS[$i]}
+  ip netns add "$ns"
+  inns "$ns" ip link set lo up
+
+  ip link add "mvpn-sw$i" netns "$CLIENT" type veth peer name eth0 netns "$ns"
+  inns "$CLIENT" ip addr add "10.213.$i.1/30" dev "mvpn-sw$i"
+  inns "$CLIENT" ip link set "mvpn-sw$i" up
+  inns "$ns" ip addr add "10.213.$i.2/30" dev eth0
+  inns "$ns" ip link set eth0 up
+  inns "$ns" tc qdisc add dev eth0 root netem delay "$DELAY" || \
+    error "No netem: the switch runs without delay"
+
+  key=$(wg genkey)
+  SERVER_PUBS[$i]=$(echo "$key" | wg pubkey)
+  SERVER_ENDPOINTS[$i]="10.213.$i.2:$PORT"
+
+  # Both servers answer on the same gateway address, like VPN servers do.
+  inns "$ns" ip link add wg0 type wireguard
+  inns "$ns" wg set wg0 private-key <(echo "$key") listen-port "$PORT" \
+    peer "$CLIENT_PUB" allowed-ips "$CLIENT_ADDRESS/32"
+  inns "$ns" ip addr add "$GATEWAY/32" dev wg0
+  inns "$ns" ip link set wg0 up
+  inns "$ns" ip route add "$CLIENT_ADDRESS/32" dev wg0
+done
+
+inns "$CLIENT" ip link add wg0 type wireguard
+inns "$CLIENT" wg set wg0 private-key <(echo "$CLIENT_KEY")
+inns "$CLIENT" ip addr add "$CLIENT_ADDRESS/32" dev wg0
+inns "$CLIENT" ip link set wg0 up
+inns "$CLIENT" ip route add "$GATEWAY/32" dev wg0
+print G "done."
+
+set_peer() {
+  inns "$CLIENT" wg set wg0 peer "${SERVER_PUBS[$1]}" \
+    endpoint "${SERVER_ENDPOINTS[$1]}" persistent-keepalive 60 \
+    allowed-ips "$2"
+}
+
+remove_peer() {
+  inns "$CLIENT" wg set wg0 peer "${SERVER_PUBS[$1]}" remove
+}
+
+wait_handshake() {
+  for _ in $(seq 500); do
+    if inns "$CLIENT" wg show wg0 latest-handshakes | \
+        grep -q "^${SERVER_PUBS[$1]}[[:space:]]*[1-9]"; then
+      return 0
+    fi
+    sleep 0.01
+  done
+  return 1
+}
+
+# Starts connected to the first server, switches to the second one with the
+# given strategy, and prints the number of lost pings.
+measure() {
+  remove_peer 1
+  set_peer 0 "$GATEWAY/32"
+  wait_handshake 0 || die "No handshake with the first server"
+
+  local log=$(mktemp)
+  inns "$CLIENT" ping -n -i 0.01 -w 3 "$GATEWAY" > "$log" &
+  local pid=$!
+  sleep 1
+
+  local start=$(date +%s%N)
+  if [[ $1 == "break" ]]; then
+    set_peer 1 "$GATEWAY/32"
+  else
+    set_peer 1 ""
+    wait_handshake 1 || error "No handshake with the second server"
+    set_peer 1 "$GATEWAY/32"
+  fi
+  remove_peer 0
+  local elapsed=$((($(date +%s%N) - start) / 1000000))
+
+  wait $pid || true
+  local stats=$(grep "packets transmitted" "$log")
+  rm -f "$log"
+  print N "$1: switched in $elapsed msecs, $stats"
+}
+
+print Y "Measuring the server switches ($DELAY one-way delay)..."
+measure break
+measure make-before-break
+print G "done."
@@ -7,6 +7,7 @@
 #include "addonguide.h"
 #include "addoni18n.h"
 #include "addonmessage.h"
+#include "addonscriptcache.h"
 #include "addontutorial.h"
 #include "conditionwatchers/addonconditionwatcherfeaturesenabled.h"
 #include "conditionwatchers/addonconditionwatchergroup.h"
@@ -27,6 +28,7 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QFileInfo>
+#include <QJSEngine>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -271,7 +273,8 @@ QList<ConditionCallback> s_conditionCallbacks{
 }  // namespace
 
 // static
-Addon* Addon::create(QObject* parent, const QString& manifestFileName) {
+Addon* Addon::create(QObject* parent, const QString& manifestFileName,
+                     const QByteArray& sha256) {
   QFile file(manifestFileName);
   if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
     logger.warning() << "Unable to read the addon manifest of"
@@ -352,6 +355,8 @@ Addon* Addon::create(QObject* parent, const QString& manifestFileName) {
     return nullptr;
   }
 
+  addon->m_sha256 = sha256;
+
   QJsonObject javascript = obj["javascript"].toObject();
   if (!addon->evaluateJavascript(javascript)) {
     addon->deleteLater();
@@ -513,7 +518,7 @@ void Addon::enable() {
   retranslate();
 
   if (m_jsEnableFunction.isCallable()) {
-    QJSEngine* engine = QmlEngineHolder::instance()->engine();
+    QJSEngine* engine = AddonScriptCache::engine();
     AddonApi* apiObj = api();
     QJSValue api = engine->newQObject(apiObj);
 
@@ -534,7 +539,7 @@ void Addon::disable() {
   QCoreApplication::removeTranslator(&m_translator);
 
   if (m_jsDisableFunction.isCallable()) {
-    QJSEngine* engine = QmlEngineHolder::instance()->engine();
+    QJSEngine* engine = AddonScriptCache::engine();
     AddonApi* apiObj = api();
     QJSValue api = engine->newQObject(apiObj);
 
@@ -574,14 +579,13 @@ bool Addon::evaluateJavascriptInternal(const QString& javascript,
   QFileInfo manifestFileInfo(manifestFileName());
   QDir addonPath = manifestFileInfo.dir();
 
-  QFile file(addonPath.filePath(javascript));
-  if (!file.open(QIODevice::ReadOnly)) {
+  QJSValue output;
+  if (!AddonScriptCache::evaluate(addonPath.filePath(javascript), m_sha256,
+                                  &output)) {
     logger.debug() << "Unable to open the javascript file" << javascript;
     return false;
   }
 
-  QJSValue output =
-      QmlEngineHolder::instance()->engine()->evaluate(file.readAll());
   if (output.isError()) {
     logger.debug() << "Execution throws an error:" << output.toString();
     return false;
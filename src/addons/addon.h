@@ -43,7 +43,8 @@ class Addon : public QObject {
   };
   Q_ENUM(State);
 
-  static Addon* create(QObject* parent, const QString& manifestFileName);
+  static Addon* create(QObject* parent, const QString& manifestFileName,
+                       const QByteArray& sha256 = QByteArray());
 
   static bool evaluateConditions(const QJsonObject& conditions);
 
@@ -55,6 +56,7 @@ class Addon : public QObject {
   const QString& id() const { return m_id; }
   const QString& type() const { return m_type; }
   const QString& manifestFileName() const { return m_manifestFileName; }
+  const QByteArray& sha256() const { return m_sha256; }
 
   virtual void retranslate();
 
@@ -92,6 +94,10 @@ class Addon : public QObject {
   const QString m_name;
   const QString m_type;
 
+  // The hash of the add-on package. Empty for add-ons not loaded by the
+  // AddonManager.
+  QByteArray m_sha256;
+
   QTranslator m_translator;
 
   AddonApi* m_api = nullptr;
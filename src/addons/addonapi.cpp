@@ -4,13 +4,13 @@
 
 #include "addonapi.h"
 #include "addon.h"
+#include "addonscriptcache.h"
 #include "frontend/navigator.h"
 #include "leakdetector.h"
 #include "logger.h"
 #include "models/featuremodel.h"
 #include "models/subscriptiondata.h"
 #include "mozillavpn.h"
-#include "qmlengineholder.h"
 #include "settingsholder.h"
 #include "urlopener.h"
 
@@ -79,7 +79,7 @@ void AddonApiCallbackWrapper::run() {
 }
 
 QJSValue AddonApi::settings() const {
-  QJSEngine* engine = QmlEngineHolder::instance()->engine();
+  QJSEngine* engine = AddonScriptCache::engine();
 
   QObject* obj = SettingsHolder::instance();
   QQmlEngine::setObjectOwnership(obj, QQmlEngine::CppOwnership);
@@ -90,7 +90,7 @@ QJSValue AddonApi::settings() const {
 }
 
 QJSValue AddonApi::navigator() const {
-  QJSEngine* engine = QmlEngineHolder::instance()->engine();
+  QJSEngine* engine = AddonScriptCache::engine();
 
   QObject* obj = Navigator::instance();
   QQmlEngine::setObjectOwnership(obj, QQmlEngine::CppOwnership);
@@ -101,7 +101,7 @@ QJSValue AddonApi::navigator() const {
 }
 
 QJSValue AddonApi::urlOpener() const {
-  QJSEngine* engine = QmlEngineHolder::instance()->engine();
+  QJSEngine* engine = AddonScriptCache::engine();
 
   QObject* obj = UrlOpener::instance();
   QQmlEngine::setObjectOwnership(obj, QQmlEngine::CppOwnership);
@@ -112,7 +112,7 @@ QJSValue AddonApi::urlOpener() const {
 }
 
 QJSValue AddonApi::controller() const {
-  QJSEngine* engine = QmlEngineHolder::instance()->engine();
+  QJSEngine* engine = AddonScriptCache::engine();
 
   QObject* obj = MozillaVPN::instance()->controller();
   QQmlEngine::setObjectOwnership(obj, QQmlEngine::CppOwnership);
@@ -123,7 +123,7 @@ QJSValue AddonApi::controller() const {
 }
 
 QJSValue AddonApi::featureList() const {
-  QJSEngine* engine = QmlEngineHolder::instance()->engine();
+  QJSEngine* engine = AddonScriptCache::engine();
 
   QObject* obj = FeatureModel::instance();
   QQmlEngine::setObjectOwnership(obj, QQmlEngine::CppOwnership);
@@ -134,7 +134,7 @@ QJSValue AddonApi::featureList() const {
 }
 
 QJSValue AddonApi::addon() const {
-  QJSEngine* engine = QmlEngineHolder::instance()->engine();
+  QJSEngine* engine = AddonScriptCache::engine();
 
   QQmlEngine::setObjectOwnership(m_addon, QQmlEngine::CppOwnership);
 
@@ -144,7 +144,7 @@ QJSValue AddonApi::addon() const {
 }
 
 QJSValue AddonApi::subscriptionData() const {
-  QJSEngine* engine = QmlEngineHolder::instance()->engine();
+  QJSEngine* engine = AddonScriptCache::engine();
 
   QObject* obj = MozillaVPN::instance()->subscriptionData();
   QQmlEngine::setObjectOwnership(obj, QQmlEngine::CppOwnership);
@@ -0,0 +1,180 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "addonscriptcache.h"
+#include "logger.h"
+#include "qmlengineholder.h"
+#include "settingsholder.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJSEngine>
+
+namespace {
+Logger logger(LOG_MAIN, "AddonScriptCache");
+
+enum EngineType {
+  EngineTypeUnknown,
+  EngineTypeQml,
+  EngineTypeIsolated,
+};
+
+EngineType s_engineType = EngineTypeUnknown;
+QJSEngine* s_isolatedEngine = nullptr;
+
+// The engine which owns the cached values.
+QJSEngine* s_cacheEngine = nullptr;
+
+// sha256 -> (file name -> evaluated script)
+QHash<QByteArray, QHash<QString, QJSValue>> s_cache;
+
+// The engine keeps the modules it imported, by URL, for its whole life. The
+// add-ons are mounted at the same path whatever their version: this is the
+// version of each module the engine has imported (module file name ->
+// sha256).
+QHash<QString, QByteArray> s_moduleVersions;
+
+// The module compiled from the script `fileName`, if the package has one.
+QString moduleFileName(const QString& fileName) {
+  if (!fileName.endsWith(".js")) {
+    return QString();
+  }
+
+  QString moduleFileName = fileName.chopped(3) + ".mjs";
+  return QFile::exists(moduleFileName) ? moduleFileName : QString();
+}
+}  // namespace
+
+// static
+QJSEngine* AddonScriptCache::engine() {
+  if (s_engineType == EngineTypeUnknown) {
+    SettingsHolder* settingsHolder = SettingsHolder::instance();
+    Q_ASSERT(settingsHolder);
+
+    s_engineType = settingsHolder->addonIsolatedEngine() ? EngineTypeIsolated
+                                                         : EngineTypeQml;
+    logger.debug() << "Add-on scripts run in the"
+                   << (s_engineType == EngineTypeIsolated ? "isolated" : "QML")
+                   << "engine";
+  }
+
+  if (s_engineType == EngineTypeQml) {
+    return QmlEngineHolder::instance()->engine();
+  }
+
+  if (!s_isolatedEngine) {
+    s_isolatedEngine = new QJSEngine(qApp);
+    s_isolatedEngine->installExtensions(QJSEngine::ConsoleExtension);
+    QObject::connect(s_isolatedEngine, &QObject::destroyed,
+                     []() { s_isolatedEngine = nullptr; });
+  }
+
+  return s_isolatedEngine;
+}
+
+// static
+bool AddonScriptCache::evaluate(const QString& fileName,
+                                const QByteArray& sha256, QJSValue* value) {
+  Q_ASSERT(value);
+
+  QJSEngine* jsEngine = engine();
+  Q_ASSERT(jsEngine);
+
+  // Values cannot be shared between engines.
+  if (s_cacheEngine != jsEngine) {
+    clear();
+    s_moduleVersions.clear();
+    s_cacheEngine = jsEngine;
+    QObject::connect(jsEngine, &QObject::destroyed, [jsEngine]() {
+      if (s_cacheEngine == jsEngine) {
+        clear();
+        s_moduleVersions.clear();
+      }
+    });
+  }
+
+  if (!sha256.isEmpty()) {
+    QHash<QByteArray, QHash<QString, QJSValue>>::const_iterator i =
+        s_cache.constFind(sha256);
+    if (i != s_cache.constEnd()) {
+      QHash<QString, QJSValue>::const_iterator j = i->constFind(fileName);
+      if (j != i->constEnd()) {
+        *value = j.value();
+        return true;
+      }
+    }
+  }
+
+  // Another version of the module would be the one imported before: the
+  // script is evaluated instead.
+  QString module = moduleFileName(fileName);
+  if (!module.isEmpty()) {
+    auto i = s_moduleVersions.constFind(module);
+    if (i != s_moduleVersions.constEnd() && i.value() != sha256) {
+      logger.debug() << "Module" << module << "already imported in another"
+                     << "version";
+      module.clear();
+    }
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+
+  QJSValue output;
+  if (!module.isEmpty()) {
+    s_moduleVersions.insert(module, sha256);
+
+    output = jsEngine->importModule(module);
+    if (!output.isError()) {
+      output = output.property("default");
+    }
+
+    logger.debug() << "Module" << module << "imported in" << timer.elapsed()
+                   << "ms";
+  } else {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+      return false;
+    }
+
+    output = jsEngine->evaluate(QString::fromUtf8(file.readAll()), fileName);
+
+    logger.debug() << "Script" << fileName << "evaluated in"
+                   << timer.elapsed() << "ms";
+  }
+
+  // Errors are not cached: the caller will reject the add-on anyway.
+  if (!sha256.isEmpty() && !output.isError()) {
+    s_cache[sha256].insert(fileName, output);
+  }
+
+  *value = output;
+  return true;
+}
+
+// static
+void AddonScriptCache::evict(const QByteArray& sha256) {
+  if (!sha256.isEmpty()) {
+    s_cache.remove(sha256);
+  }
+}
+
+// static
+void AddonScriptCache::clear() {
+  s_cache.clear();
+  s_cacheEngine = nullptr;
+}
+
+#ifdef UNIT_TEST
+// static
+int AddonScriptCache::cacheSize() {
+  int size = 0;
+  for (const QHash<QString, QJSValue>& scripts : s_cache) {
+    size += scripts.size();
+  }
+  return size;
+}
+#endif
@@ -0,0 +1,48 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef ADDONSCRIPTCACHE_H
+#define ADDONSCRIPTCACHE_H
+
+#include <QByteArray>
+#include <QJSValue>
+#include <QString>
+
+class QJSEngine;
+
+// Add-on scripts are evaluated once per add-on version (the sha256 of the
+// add-on package) and file. The evaluated value is kept in memory and returned
+// when the same add-on is loaded again (for instance, after an index refresh
+// or a reload from the inspector), without reading and parsing the source
+// again.
+//
+// When the package contains an ES module next to a script (`foo.mjs` next to
+// `foo.js`, see `scripts/addon/build.py --compile-scripts`), the module is
+// imported instead, and its default export is the value of the script.
+// QJSEngine::importModule() uses the compilation unit that qmlcachegen
+// registered for the module URL, if any, instead of parsing the source.
+class AddonScriptCache final {
+ public:
+  // The JS engine used to evaluate and run add-on scripts. By default, this is
+  // the QML engine. When the `addonIsolatedEngine` setting is set, add-ons run
+  // in a dedicated QJSEngine, with its own heap. The choice is taken at the
+  // first call and it does not change for the rest of the session.
+  static QJSEngine* engine();
+
+  // Evaluates the script `fileName`, or imports its module. If `sha256` is not
+  // empty, the result is cached. Returns false if the file cannot be read.
+  static bool evaluate(const QString& fileName, const QByteArray& sha256,
+                       QJSValue* value);
+
+  // Drops all the cached scripts of an add-on version.
+  static void evict(const QByteArray& sha256);
+
+  static void clear();
+
+#ifdef UNIT_TEST
+  static int cacheSize();
+#endif
+};
+
+#endif  // ADDONSCRIPTCACHE_H
@@ -5,14 +5,13 @@
 #include "addonconditionwatcherjavascript.h"
 #include "addons/addon.h"
 #include "addons/addonapi.h"
+#include "addons/addonscriptcache.h"
 #include "leakdetector.h"
 #include "logger.h"
-#include "qmlengineholder.h"
 
 #include <QDir>
-#include <QFile>
 #include <QFileInfo>
-#include <QQmlEngine>
+#include <QJSEngine>
 
 namespace {
 Logger logger(LOG_MAIN, "AddonConditionWatcherJavascript");
@@ -28,14 +27,13 @@ AddonConditionWatcher* AddonConditionWatcherJavascript::maybeCreate(
   QFileInfo manifestFileInfo(addon->manifestFileName());
   QDir addonPath = manifestFileInfo.dir();
 
-  QFile file(addonPath.filePath(javascript));
-  if (!file.open(QIODevice::ReadOnly)) {
+  QJSValue output;
+  if (!AddonScriptCache::evaluate(addonPath.filePath(javascript),
+                                  addon->sha256(), &output)) {
     logger.debug() << "Unable to open the javascript file" << javascript;
     return nullptr;
   }
 
-  QJSValue output =
-      QmlEngineHolder::instance()->engine()->evaluate(file.readAll());
   if (output.isError()) {
     logger.debug() << "Execution throws an error:" << output.toString();
     return nullptr;
@@ -54,7 +52,7 @@ AddonConditionWatcherJavascript::AddonConditionWatcherJavascript(
     : AddonConditionWatcher(addon) {
   MVPN_COUNT_CTOR(AddonConditionWatcherJavascript);
 
-  QJSEngine* engine = QmlEngineHolder::instance()->engine();
+  QJSEngine* engine = AddonScriptCache::engine();
   QJSValue api = engine->newQObject(addon->api());
   QJSValue self = engine->newQObject(this);
 
@@ -18,7 +18,7 @@ AddonConditionWatcherTimeEnd::AddonConditionWatcherTimeEnd(QObject* parent,
     m_timer.setSingleShot(true);
     m_timer.start((time - currentTime) * 1000);
 
-    connect(&m_timer, &QTimer::timeout, this,
+    connect(&m_timer, &WheelTimer::timeout, this,
             [this]() { emit conditionChanged(false); });
   }
 }
@@ -6,8 +6,7 @@
 #define ADDONCONDITIONWATCHERTIMESTART_H
 
 #include "addonconditionwatcher.h"
-
-#include <QTimer>
+#include "timerwheel.h"
 
 class AddonConditionWatcherTimeStart final : public AddonConditionWatcher {
   Q_OBJECT
@@ -20,7 +19,7 @@ class AddonConditionWatcherTimeStart final : public AddonConditionWatcher {
   bool conditionApplied() const override;
 
  private:
-  QTimer m_timer;
+  WheelTimer m_timer;
 };
 
 #endif  // ADDONCONDITIONWATCHERTIMESTART_H
@@ -32,7 +32,7 @@ AddonConditionWatcherTriggerTimeSecs::AddonConditionWatcherTriggerTimeSecs(
     m_timer.setSingleShot(true);
     m_timer.start(secs * 1000);
 
-    connect(&m_timer, &QTimer::timeout, this,
+    connect(&m_timer, &WheelTimer::timeout, this,
             [this]() { emit conditionChanged(true); });
   }
 }
@@ -6,8 +6,7 @@
 #define ADDONCONDITIONWATCHERTRIGGERTIMESECS_H
 
 #include "addonconditionwatcher.h"
-
-#include <QTimer>
+#include "timerwheel.h"
 
 class AddonConditionWatcherTriggerTimeSecs final
     : public AddonConditionWatcher {
@@ -25,7 +24,7 @@ class AddonConditionWatcherTriggerTimeSecs final
   AddonConditionWatcherTriggerTimeSecs(QObject* parent, qint64 time);
 
  private:
-  QTimer m_timer;
+  WheelTimer m_timer;
 };
 
 #endif  // ADDONCONDITIONWATCHERTRIGGERTIMESECS_H
@@ -0,0 +1,181 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "addonhashcache.h"
+#include "addondirectory.h"
+#include "leakdetector.h"
+#include "logger.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#ifndef MVPN_WINDOWS
+#  include <sys/stat.h>
+#endif
+
+namespace {
+Logger logger(LOG_MAIN, "AddonHashCache");
+}  // namespace
+
+AddonHashCache::AddonHashCache(AddonDirectory* dir) : m_addonDirectory(dir) {
+  MVPN_COUNT_CTOR(AddonHashCache);
+  Q_ASSERT(dir);
+}
+
+AddonHashCache::~AddonHashCache() { MVPN_COUNT_DTOR(AddonHashCache); }
+
+// static
+AddonHashCache::FileStat AddonHashCache::stat(const QString& filePath) {
+  FileStat fileStat;
+
+  QFileInfo fileInfo(filePath);
+  if (!fileInfo.exists() || !fileInfo.isFile()) {
+    return fileStat;
+  }
+
+  fileStat.m_size = fileInfo.size();
+  fileStat.m_mtime = fileInfo.lastModified().toMSecsSinceEpoch();
+  fileStat.m_ctime = fileInfo.metadataChangeTime().toMSecsSinceEpoch();
+
+#ifndef MVPN_WINDOWS
+  struct stat st;
+  if (::stat(QFile::encodeName(filePath).constData(), &st) == 0) {
+    fileStat.m_inode = static_cast<quint64>(st.st_ino);
+  }
+#endif
+
+  return fileStat;
+}
+
+// static
+QByteArray AddonHashCache::hash(const QString& filePath) {
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    logger.warning() << "Unable to open file:" << filePath;
+    return QByteArray();
+  }
+
+  QCryptographicHash hash(QCryptographicHash::Sha256);
+
+  // Let's avoid copying the package in memory: the file is mapped and the
+  // kernel pages it in while hashing.
+  qint64 size = file.size();
+  uchar* data = size > 0 ? file.map(0, size) : nullptr;
+  if (data) {
+    hash.addData(reinterpret_cast<const char*>(data), size);
+    file.unmap(data);
+  } else if (!hash.addData(&file)) {
+    logger.warning() << "Unable to read file:" << filePath;
+    return QByteArray();
+  }
+
+  return hash.result();
+}
+
+bool AddonHashCache::lookup(const QString& fileName, const FileStat& stat,
+                            QByteArray* sha256) {
+  Q_ASSERT(sha256);
+
+  if (!stat.isValid()) {
+    return false;
+  }
+
+  maybeLoad();
+
+  QHash<QString, Entry>::const_iterator i = m_entries.constFind(fileName);
+  if (i == m_entries.constEnd() || !(i->m_stat == stat)) {
+    return false;
+  }
+
+  *sha256 = i->m_sha256;
+  return true;
+}
+
+void AddonHashCache::insert(const QString& fileName, const FileStat& stat,
+                            const QByteArray& sha256) {
+  if (!stat.isValid()) {
+    return;
+  }
+
+  maybeLoad();
+
+  m_entries.insert(fileName, {stat, sha256});
+  m_dirty = true;
+}
+
+void AddonHashCache::remove(const QString& fileName) {
+  maybeLoad();
+
+  if (m_entries.remove(fileName)) {
+    m_dirty = true;
+  }
+}
+
+void AddonHashCache::maybeLoad() {
+  if (m_loaded) {
+    return;
+  }
+
+  m_loaded = true;
+
+  QByteArray content;
+  if (!m_addonDirectory->readFile(ADDON_HASH_CACHE_FILENAME, &content)) {
+    return;
+  }
+
+  QJsonDocument json = QJsonDocument::fromJson(content);
+  if (!json.isObject()) {
+    logger.warning() << "Invalid hash cache file";
+    return;
+  }
+
+  QJsonObject obj = json.object();
+  for (QJsonObject::const_iterator i = obj.constBegin(); i != obj.constEnd();
+       ++i) {
+    QJsonObject entryObj = i.value().toObject();
+
+    Entry entry;
+    entry.m_stat.m_size = entryObj["size"].toInteger(-1);
+    entry.m_stat.m_mtime = entryObj["mtime"].toInteger();
+    entry.m_stat.m_ctime = entryObj["ctime"].toInteger();
+    entry.m_stat.m_inode = entryObj["inode"].toString().toULongLong();
+    entry.m_sha256 =
+        QByteArray::fromHex(entryObj["sha256"].toString().toLocal8Bit());
+
+    if (!entry.m_stat.isValid() || entry.m_sha256.isEmpty()) {
+      continue;
+    }
+
+    m_entries.insert(i.key(), entry);
+  }
+
+  logger.debug() << "Hash cache loaded with" << m_entries.size() << "entries";
+}
+
+void AddonHashCache::save() {
+  if (!m_dirty) {
+    return;
+  }
+
+  QJsonObject obj;
+  for (QHash<QString, Entry>::const_iterator i = m_entries.constBegin();
+       i != m_entries.constEnd(); ++i) {
+    QJsonObject entryObj;
+    entryObj["size"] = i->m_stat.m_size;
+    entryObj["mtime"] = i->m_stat.m_mtime;
+    entryObj["ctime"] = i->m_stat.m_ctime;
+    entryObj["inode"] = QString::number(i->m_stat.m_inode);
+    entryObj["sha256"] = QString(i->m_sha256.toHex());
+    obj[i.key()] = entryObj;
+  }
+
+  if (m_addonDirectory->writeToFile(ADDON_HASH_CACHE_FILENAME,
+                                    QJsonDocument(obj).toJson())) {
+    m_dirty = false;
+  }
+}
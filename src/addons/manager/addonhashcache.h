@@ -0,0 +1,67 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef ADDONHASHCACHE_H
+#define ADDONHASHCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+class AddonDirectory;
+
+constexpr const char* ADDON_HASH_CACHE_FILENAME = "hashcache.json";
+
+// Keeps the sha256 of the add-on packages already verified, together with the
+// file metadata at the time of the verification. If the metadata has not
+// changed, the package does not need to be hashed again at the next startup.
+class AddonHashCache final {
+ public:
+  struct FileStat {
+    qint64 m_size = -1;
+    qint64 m_mtime = 0;
+    qint64 m_ctime = 0;
+    quint64 m_inode = 0;
+
+    bool isValid() const { return m_size >= 0; }
+
+    bool operator==(const FileStat& other) const {
+      return m_size == other.m_size && m_mtime == other.m_mtime &&
+             m_ctime == other.m_ctime && m_inode == other.m_inode;
+    }
+  };
+
+  explicit AddonHashCache(AddonDirectory* dir);
+  ~AddonHashCache();
+
+  // These two methods can be called from any thread.
+  static FileStat stat(const QString& filePath);
+  static QByteArray hash(const QString& filePath);
+
+  bool lookup(const QString& fileName, const FileStat& stat,
+              QByteArray* sha256);
+  void insert(const QString& fileName, const FileStat& stat,
+              const QByteArray& sha256);
+  void remove(const QString& fileName);
+
+  void save();
+
+ private:
+  void maybeLoad();
+
+ private:
+  AddonDirectory* m_addonDirectory = nullptr;
+
+  struct Entry {
+    FileStat m_stat;
+    QByteArray m_sha256;
+  };
+
+  QHash<QString, Entry> m_entries;
+
+  bool m_loaded = false;
+  bool m_dirty = false;
+};
+
+#endif  // ADDONHASHCACHE_H
@@ -10,6 +10,7 @@
 #include "models/feature.h"
 #include "settingsholder.h"
 #include "signature.h"
+#include "workerpool.h"
 
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -114,7 +115,8 @@ bool AddonIndex::write(const QByteArray& index,
  * are valid and different from the currently stored ones.
  *
  * Note: If update is successful `indexUpdated` signal is emited. If nothing has
- * changed, this signal is not emited.
+ * changed, this signal is not emited. The validation runs in the worker pool:
+ * the signal is always emitted asynchronously.
  *
  * @param index The new index data to update.
  * @param indexSignature The new index signature to update.
@@ -132,19 +134,43 @@ void AddonIndex::update(const QByteArray& index,
     return;
   }
 
-  QJsonObject indexObj;
-  if (!validate(index, indexSignature, &indexObj)) {
-    logger.debug() << "Unable to validate the index";
-    return;
+  // The features and the settings are read here: the validation job runs in
+  // the worker pool and cannot touch them.
+  QString publicKeyUrl;
+  if (Feature::get(Feature::Feature_addonSignature)->isSupported()) {
+    publicKeyUrl = indexPublicKeyUrl();
   }
 
-  if (!write(index, indexSignature)) {
-    logger.debug() << "Unable to write to index file";
-    return;
-  }
+  quint64 generation = ++m_updateGeneration;
 
-  QList<AddonData> addons = extractAddonsFromIndex(indexObj);
-  emit indexUpdated(addons);
+  WorkerPool::run([index, indexSignature, publicKeyUrl]() {
+    QJsonObject indexObj;
+    if (!validateIndex(index, &indexObj) ||
+        (!publicKeyUrl.isEmpty() &&
+         !validateIndexSignature(publicKeyUrl, index, indexSignature))) {
+      return QJsonObject();
+    }
+    return indexObj;
+  }).then(this, [this, generation, index,
+                 indexSignature](const QJsonObject& indexObj) {
+    if (generation != m_updateGeneration) {
+      logger.debug() << "A newer index is being validated";
+      return;
+    }
+
+    if (indexObj.isEmpty()) {
+      logger.debug() << "Unable to validate the index";
+      return;
+    }
+
+    if (!write(index, indexSignature)) {
+      logger.debug() << "Unable to write to index file";
+      return;
+    }
+
+    QList<AddonData> addons = extractAddonsFromIndex(indexObj);
+    emit indexUpdated(addons);
+  });
 }
 
 /**
@@ -166,13 +192,14 @@ bool AddonIndex::validate(const QByteArray& index,
   }
 
   if (Feature::get(Feature::Feature_addonSignature)->isSupported() &&
-      !validateIndexSignature(index, indexSignature)) {
+      !validateIndexSignature(indexPublicKeyUrl(), index, indexSignature)) {
     return false;
   }
 
   return true;
 }
 
+// static
 bool AddonIndex::validateIndex(const QByteArray& index, QJsonObject* indexObj) {
   QJsonDocument doc = QJsonDocument::fromJson(index);
   if (!doc.isObject()) {
@@ -226,14 +253,19 @@ bool AddonIndex::validateSingleAddonIndex(const QJsonValue& addonValue) {
 }
 
 // static
-bool AddonIndex::validateIndexSignature(const QByteArray& index,
-                                        const QByteArray& indexSignature) {
-  QString publicKeyUrl(Constants::ADDON_PRODUCTION_KEY);
+QString AddonIndex::indexPublicKeyUrl() {
   if (!Constants::inProduction() &&
       !SettingsHolder::instance()->addonProdKeyInStaging()) {
-    publicKeyUrl = Constants::ADDON_STAGING_KEY;
+    return Constants::ADDON_STAGING_KEY;
   }
 
+  return Constants::ADDON_PRODUCTION_KEY;
+}
+
+// static
+bool AddonIndex::validateIndexSignature(const QString& publicKeyUrl,
+                                        const QByteArray& index,
+                                        const QByteArray& indexSignature) {
   QFile publicKeyFile(publicKeyUrl);
   if (!publicKeyFile.open(QIODevice::ReadOnly)) {
     logger.warning() << "Unable to open the addon public key file";
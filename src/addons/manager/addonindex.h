@@ -49,13 +49,18 @@ class AddonIndex final : public QObject {
   // Helpers
   static bool validateIndex(const QByteArray& index, QJsonObject* indexObj);
   static bool validateSingleAddonIndex(const QJsonValue& addonValue);
-  static bool validateIndexSignature(const QByteArray& index,
+  static QString indexPublicKeyUrl();
+  static bool validateIndexSignature(const QString& publicKeyUrl,
+                                     const QByteArray& index,
                                      const QByteArray& indexSignature);
 
   static QList<AddonData> extractAddonsFromIndex(const QJsonObject& indexObj);
 
  private:
   AddonDirectory* m_addonDirectory = nullptr;
+
+  // Only the result of the last update is applied.
+  quint64 m_updateGeneration = 0;
 };
 
 #endif  // ADDONINDEX_H
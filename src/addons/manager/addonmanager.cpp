@@ -3,9 +3,11 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "addondirectory.h"
+#include "addonhashcache.h"
 #include "addonindex.h"
 #include "addonmanager.h"
 #include "addons/addonmessage.h"
+#include "addons/addonscriptcache.h"
 #include "constants.h"
 #include "leakdetector.h"
 #include "logger.h"
@@ -15,9 +17,11 @@
 #include "tasks/addon/taskaddon.h"
 #include "tasks/function/taskfunction.h"
 #include "taskscheduler.h"
+#include "workerpool.h"
+
+#include <algorithm>
 
 #include <QCoreApplication>
-#include <QCryptographicHash>
 #include <QDir>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -25,6 +29,7 @@
 #include <QFileInfo>
 #include <QResource>
 #include <QQmlEngine>
+#include <QSet>
 #include <QSaveFile>
 
 namespace {
@@ -36,7 +41,6 @@ AddonManager* s_instance = nullptr;
 AddonManager* AddonManager::instance() {
   if (!s_instance) {
     s_instance = new AddonManager(qApp);
-    s_instance->initialize();
   }
   return s_instance;
 }
@@ -58,13 +62,20 @@ QString AddonManager::addonServerAddress() {
 }
 
 AddonManager::AddonManager(QObject* parent)
-    : QAbstractListModel(parent), m_addonIndex(&m_addonDirectory) {
+    : QAbstractListModel(parent),
+      m_addonIndex(&m_addonDirectory),
+      m_hashCache(&m_addonDirectory) {
   MVPN_COUNT_CTOR(AddonManager);
 }
 
 AddonManager::~AddonManager() { MVPN_COUNT_DTOR(AddonManager); }
 
 void AddonManager::initialize() {
+  if (m_initialized) {
+    return;
+  }
+  m_initialized = true;
+
   if (!Feature::get(Feature::Feature_addon)->isSupported()) {
     logger.warning() << "Addons disabled by feature flag";
     return;
@@ -83,52 +94,71 @@ void AddonManager::initialize() {
 
 void AddonManager::updateIndex(const QByteArray& index,
                                const QByteArray& indexSignature) {
+  initialize();
   m_addonIndex.update(index, indexSignature);
 }
 
 void AddonManager::updateAddonsList(QList<AddonData> addons) {
+  if (m_pendingVerifications > 0) {
+    logger.debug() << "Verification in progress. Queue the addons list";
+    m_queuedAddonsList = addons;
+    m_hasQueuedAddonsList = true;
+    return;
+  }
+
   logger.debug() << "Updating addons list";
 
   // Remove unknown addons
+  QSet<QString> addonIds;
+  addonIds.reserve(addons.size());
+  for (const AddonData& addonData : addons) {
+    addonIds.insert(addonData.m_addonId);
+  }
+
   QStringList addonsToBeRemoved;
   for (QMap<QString, AddonData>::const_iterator i(m_addons.constBegin());
        i != m_addons.constEnd(); ++i) {
-    bool found = false;
-    for (const AddonData& addonData : addons) {
-      if (addonData.m_addonId == i.key()) {
-        found = true;
-        break;
-      }
+    if (!addonIds.contains(i.key())) {
+      addonsToBeRemoved.append(i.key());
     }
-
-    if (found) continue;
-    addonsToBeRemoved.append(i.key());
   }
 
   for (const QString& addonId : addonsToBeRemoved) {
+    AddonScriptCache::evict(m_addons[addonId].m_sha256);
     unload(addonId);
     removeAddon(addonId);
   }
 
-  bool taskAdded = false;
+  m_taskAdded = false;
+  m_verificationTimer.start();
 
-  // Fetch new addons
   for (const AddonData& addonData : addons) {
-    if (!m_addons.contains(addonData.m_addonId) &&
-        validateAndLoad(addonData.m_addonId, addonData.m_sha256)) {
+    if (!m_addons.contains(addonData.m_addonId)) {
+      verifyAndLoad(addonData.m_addonId, addonData.m_sha256);
       continue;
     }
 
-    Q_ASSERT(m_addons.contains(addonData.m_addonId));
-
     if (m_addons[addonData.m_addonId].m_sha256 != addonData.m_sha256) {
       TaskScheduler::scheduleTask(
           new TaskAddon(addonData.m_addonId, addonData.m_sha256));
-      taskAdded = true;
+      m_taskAdded = true;
     }
   }
 
-  if (taskAdded) {
+  if (m_pendingVerifications == 0) {
+    updateAddonsListCompleted();
+  }
+}
+
+void AddonManager::updateAddonsListCompleted() {
+  Q_ASSERT(m_pendingVerifications == 0);
+
+  logger.debug() << "Addons verified and loaded in"
+                 << m_verificationTimer.elapsed() << "ms";
+
+  m_hashCache.save();
+
+  if (m_taskAdded) {
     TaskScheduler::scheduleTask(new TaskFunction(
         [this]() {
           m_loadCompleted = true;
@@ -139,51 +169,160 @@ void AddonManager::updateAddonsList(QList<AddonData> addons) {
     m_loadCompleted = true;
     emit loadCompletedChanged();
   }
+
+  if (m_hasQueuedAddonsList) {
+    QList<AddonData> addons = m_queuedAddonsList;
+    m_queuedAddonsList.clear();
+    m_hasQueuedAddonsList = false;
+    updateAddonsList(addons);
+  }
+}
+
+void AddonManager::verifyAndLoad(const QString& addonId,
+                                 const QByteArray& sha256) {
+  logger.debug() << "Verify addon" << addonId;
+
+#ifdef MVPN_WASM
+  if (addonId.startsWith("message_")) {
+    logger.debug() << "Skipping the message addon";
+    return;
+  }
+#endif
+
+  Q_ASSERT(!m_addons.contains(addonId));
+  m_addons.insert(addonId, {QByteArray(), addonId, nullptr});
+
+  QDir dir;
+  if (!m_addonDirectory.getDirectory(&dir)) {
+    addonVerified(addonId, sha256, false);
+    return;
+  }
+
+  QString addonFileName(QString("%1.rcc").arg(addonId));
+  QString addonFilePath(dir.filePath(addonFileName));
+
+  AddonHashCache::FileStat fileStat = AddonHashCache::stat(addonFilePath);
+  if (!fileStat.isValid()) {
+    logger.info() << "File" << addonFilePath << "does not exist yet";
+    addonVerified(addonId, sha256, false);
+    return;
+  }
+
+  // This file has been already verified and it has not changed since then.
+  QByteArray cachedSha256;
+  if (m_hashCache.lookup(addonFileName, fileStat, &cachedSha256) &&
+      cachedSha256 == sha256) {
+    addonVerified(addonId, sha256, true);
+    return;
+  }
+
+  // The hashing runs in a worker thread. Each result is posted back to this
+  // thread, where the addon is registered and its manifest parsed while the
+  // other packages are still being hashed.
+  ++m_pendingVerifications;
+
+  WorkerPool::run([addonFilePath]() {
+    // The file is stat'ed before being hashed: if it changes in the meantime,
+    // the cache entry will not match at the next startup.
+    AddonHashCache::FileStat fileStat = AddonHashCache::stat(addonFilePath);
+    return qMakePair(fileStat, AddonHashCache::hash(addonFilePath));
+  }).then(this, [this, addonId, sha256, addonFileName](
+                    const QPair<AddonHashCache::FileStat, QByteArray>& result) {
+    Q_ASSERT(m_pendingVerifications > 0);
+    --m_pendingVerifications;
+
+    const QByteArray& hash = result.second;
+    bool valid = !hash.isEmpty() && hash == sha256;
+    if (valid) {
+      m_hashCache.insert(addonFileName, result.first, hash);
+    } else {
+      logger.warning() << "Addon hash does not match" << addonId;
+    }
+
+    addonVerified(addonId, sha256, valid);
+
+    if (m_pendingVerifications == 0) {
+      updateAddonsListCompleted();
+    }
+  });
+}
+
+void AddonManager::addonVerified(const QString& addonId,
+                                 const QByteArray& sha256, bool valid) {
+  // The addon could have been replaced or unloaded in the meantime.
+  if (!m_addons.contains(addonId) || m_addons[addonId].m_addon ||
+      !m_addons[addonId].m_sha256.isEmpty()) {
+    return;
+  }
+
+  if (!valid) {
+    // Let's fetch the addon again.
+    TaskScheduler::scheduleTask(new TaskAddon(addonId, sha256));
+    m_taskAdded = true;
+    return;
+  }
+
+  load(addonId, sha256);
 }
 
-bool AddonManager::loadManifest(const QString& manifestFileName) {
-  Addon* addon = Addon::create(this, manifestFileName);
+bool AddonManager::loadManifest(const QString& manifestFileName,
+                                const QByteArray& sha256) {
+  Addon* addon = Addon::create(this, manifestFileName, sha256);
   if (!addon) {
     logger.warning() << "Unable to create an addon from manifest"
                      << manifestFileName;
     return false;
   }
 
-  bool addonEnabled = addon->enabled();
-  if (addonEnabled) {
-    beginResetModel();
-  }
-
   Q_ASSERT(m_addons.contains(addon->id()));
   m_addons[addon->id()].m_addon = addon;
 
-  if (addonEnabled) {
-    endResetModel();
+  if (addon->enabled()) {
+    insertEnabledAddon(addon->id());
   }
 
   connect(addon, &Addon::conditionChanged, this, [this, addon](bool enabled) {
-    int pos = 0;
-    for (QMap<QString, AddonData>::const_iterator i(m_addons.constBegin());
-         i != m_addons.constEnd(); ++i) {
-      if (!i.value().m_addon) continue;
-      if (i.value().m_addon != addon) {
-        if (i.value().m_addon->enabled()) ++pos;
-        continue;
-      }
-      if (!enabled) {
-        beginRemoveRows(QModelIndex(), pos, pos);
-        endRemoveRows();
-      } else {
-        beginInsertRows(QModelIndex(), pos, pos);
-        endInsertRows();
-      }
-      break;
+    if (enabled) {
+      insertEnabledAddon(addon->id());
+    } else {
+      removeEnabledAddon(addon->id());
     }
   });
 
   return true;
 }
 
+void AddonManager::insertEnabledAddon(const QString& addonId) {
+  // m_enabledAddons is sorted as the keys of m_addons.
+  QStringList::iterator i = std::lower_bound(
+      m_enabledAddons.begin(), m_enabledAddons.end(), addonId);
+  if (i != m_enabledAddons.end() && *i == addonId) {
+    return;
+  }
+
+  int pos = i - m_enabledAddons.begin();
+  beginInsertRows(QModelIndex(), pos, pos);
+  m_enabledAddons.insert(pos, addonId);
+  endInsertRows();
+
+  emit countChanged();
+}
+
+void AddonManager::removeEnabledAddon(const QString& addonId) {
+  QStringList::iterator i = std::lower_bound(
+      m_enabledAddons.begin(), m_enabledAddons.end(), addonId);
+  if (i == m_enabledAddons.end() || *i != addonId) {
+    return;
+  }
+
+  int pos = i - m_enabledAddons.begin();
+  beginRemoveRows(QModelIndex(), pos, pos);
+  m_enabledAddons.removeAt(pos);
+  endRemoveRows();
+
+  emit countChanged();
+}
+
 void AddonManager::unload(const QString& addonId) {
   if (!Feature::get(Feature::Feature_addon)->isSupported()) {
     logger.warning() << "Addons disabled by feature flag";
@@ -212,6 +351,9 @@ void AddonManager::unload(const QString& addonId) {
     addon->deleteLater();
   }
 
+  // In case the addon has not emitted the disabling signal.
+  removeEnabledAddon(addonId);
+
   m_addons.remove(addonId);
   emit countChanged();
 }
@@ -229,48 +371,19 @@ void AddonManager::retranslate() {
 void AddonManager::removeAddon(const QString& addonId) {
   QString addonFileName(QString("%1.rcc").arg(addonId));
   instance()->m_addonDirectory.deleteFile(addonFileName);
+  instance()->m_hashCache.remove(addonFileName);
 }
 
-bool AddonManager::validateAndLoad(const QString& addonId,
-                                   const QByteArray& sha256, bool checkSha256) {
+bool AddonManager::load(const QString& addonId, const QByteArray& sha256) {
   logger.debug() << "Load addon" << addonId;
 
-#ifdef MVPN_WASM
-  if (addonId.startsWith("message_")) {
-    logger.debug() << "Skipping the message addon";
-    return true;
-  }
-#endif
-
-  if (m_addons.contains(addonId)) {
-    logger.warning() << "Addon" << addonId << "already loaded";
-    return false;
-  }
-
-  m_addons.insert(addonId, {QByteArray(), addonId, nullptr});
-
-  QString addonFileName(QString("%1.rcc").arg(addonId));
-
   QDir dir;
   if (!m_addonDirectory.getDirectory(&dir)) {
     return false;
   }
-  QString addonFilePath(dir.filePath(addonFileName));
 
-  // Hash validation
-  if (checkSha256) {
-    QByteArray addonFileContents;
-
-    if (!m_addonDirectory.readFile(addonFileName, &addonFileContents)) {
-      return false;
-    }
-
-    if (QCryptographicHash::hash(addonFileContents,
-                                 QCryptographicHash::Sha256) != sha256) {
-      logger.warning() << "Addon hash does not match" << addonFilePath;
-      return false;
-    }
-  }
+  QString addonFileName(QString("%1.rcc").arg(addonId));
+  QString addonFilePath(dir.filePath(addonFileName));
 
   m_addons[addonId].m_sha256 = sha256;
   QString addonMountPath = mountPath(addonId);
@@ -280,7 +393,8 @@ bool AddonManager::validateAndLoad(const QString& addonId,
     return false;
   }
 
-  if (!loadManifest(QString(":%1/manifest.json").arg(addonMountPath))) {
+  if (!loadManifest(QString(":%1/manifest.json").arg(addonMountPath),
+                    sha256)) {
     QResource::unregisterResource(addonFilePath, addonMountPath);
     return false;
   }
@@ -290,18 +404,21 @@ bool AddonManager::validateAndLoad(const QString& addonId,
 }
 
 void AddonManager::storeAndLoadAddon(const QByteArray& addonData,
+                                     const QByteArray& addonDataSha256,
                                      const QString& addonId,
                                      const QByteArray& sha256) {
   logger.debug() << "Store and load addon" << addonId;
 
+  initialize();
+
   // Maybe we have to replace an existing addon. Let's start removing it.
   if (m_addons.contains(addonId)) {
+    AddonScriptCache::evict(m_addons[addonId].m_sha256);
     unload(addonId);
     removeAddon(addonId);
   }
 
-  if (QCryptographicHash::hash(addonData, QCryptographicHash::Sha256) !=
-      sha256) {
+  if (addonDataSha256 != sha256) {
     logger.warning() << "Invalid addon hash";
     return;
   }
@@ -311,7 +428,24 @@ void AddonManager::storeAndLoadAddon(const QByteArray& addonData,
     return;
   }
 
-  if (!validateAndLoad(addonId, sha256, false)) {
+  // The content has been just verified. No need to hash it again at the next
+  // startup.
+  QDir dir;
+  if (m_addonDirectory.getDirectory(&dir)) {
+    m_hashCache.insert(addonFileName,
+                       AddonHashCache::stat(dir.filePath(addonFileName)),
+                       sha256);
+    m_hashCache.save();
+  }
+
+  if (m_addons.contains(addonId)) {
+    logger.warning() << "Addon" << addonId << "already loaded";
+    return;
+  }
+
+  m_addons.insert(addonId, {QByteArray(), addonId, nullptr});
+
+  if (!load(addonId, sha256)) {
     logger.warning() << "Unable to load the addon";
   }
 }
@@ -324,36 +458,17 @@ QHash<int, QByteArray> AddonManager::roleNames() const {
 
 int AddonManager::rowCount(const QModelIndex&) const { return count(); }
 
-int AddonManager::count() const {
-  int count = 0;
-  for (QMap<QString, AddonData>::const_iterator i(m_addons.constBegin());
-       i != m_addons.constEnd(); ++i) {
-    if (i.value().m_addon && i.value().m_addon->enabled()) {
-      ++count;
-    }
-  }
-  return count;
-}
+int AddonManager::count() const { return m_enabledAddons.count(); }
 
 QVariant AddonManager::data(const QModelIndex& index, int role) const {
-  if (!index.isValid()) {
+  if (!index.isValid() || index.row() >= m_enabledAddons.count()) {
     return QVariant();
   }
 
   switch (role) {
-    case AddonRole: {
-      int row = index.row();
-      for (QMap<QString, AddonData>::const_iterator i(m_addons.constBegin());
-           i != m_addons.constEnd(); ++i) {
-        if (!i.value().m_addon || !i.value().m_addon->enabled()) {
-          continue;
-        }
-        if (row == 0) {
-          return QVariant::fromValue(i.value().m_addon);
-        }
-        --row;
-      }
-    }
+    case AddonRole:
+      return QVariant::fromValue(
+          m_addons.value(m_enabledAddons.at(index.row())).m_addon);
 
     default:
       return QVariant();
@@ -6,8 +6,10 @@
 #define ADDONMANAGER_H
 
 #include "addons/addon.h"  // required for the signal
+#include "addonhashcache.h"
 #include "addonindex.h"
 
+#include <QElapsedTimer>
 #include <QJSValue>
 #include <QMap>
 #include <QAbstractListModel>
@@ -37,10 +39,19 @@ class AddonManager final : public QAbstractListModel {
 
   ~AddonManager();
 
-  void storeAndLoadAddon(const QByteArray& addonData, const QString& addonId,
-                         const QByteArray& sha256);
+  // Loads the add-ons stored on disk. This is not done at creation time
+  // because it is not needed to show the first frame. It is a no-op after the
+  // first call.
+  void initialize();
+
+  // `addonDataSha256` is the hash of `addonData`, computed by the caller out
+  // of the main thread.
+  void storeAndLoadAddon(const QByteArray& addonData,
+                         const QByteArray& addonDataSha256,
+                         const QString& addonId, const QByteArray& sha256);
 
-  bool loadManifest(const QString& addonManifestFileName);
+  bool loadManifest(const QString& addonManifestFileName,
+                    const QByteArray& sha256 = QByteArray());
 
   void unload(const QString& addonId);
 
@@ -59,11 +70,16 @@ class AddonManager final : public QAbstractListModel {
  private:
   explicit AddonManager(QObject* parent);
 
-  void initialize();
-
   void updateAddonsList(QList<AddonData> addons);
-  bool validateAndLoad(const QString& addonId, const QByteArray& sha256,
-                       bool checkSha256 = true);
+  void updateAddonsListCompleted();
+
+  void verifyAndLoad(const QString& addonId, const QByteArray& sha256);
+  void addonVerified(const QString& addonId, const QByteArray& sha256,
+                     bool valid);
+  bool load(const QString& addonId, const QByteArray& sha256);
+
+  void insertEnabledAddon(const QString& addonId);
+  void removeEnabledAddon(const QString& addonId);
 
   static void removeAddon(const QString& addonId);
 
@@ -84,10 +100,25 @@ class AddonManager final : public QAbstractListModel {
  private:
   QMap<QString, AddonData> m_addons;
 
+  // The IDs of the enabled addons, in the same order of m_addons. Each
+  // element is a row of the model.
+  QStringList m_enabledAddons;
+
+  bool m_initialized = false;
   bool m_loadCompleted = false;
 
   AddonIndex m_addonIndex;
   AddonDirectory m_addonDirectory;
+  AddonHashCache m_hashCache;
+
+  // Add-on packages being hashed in the thread pool.
+  int m_pendingVerifications = 0;
+  bool m_taskAdded = false;
+  QElapsedTimer m_verificationTimer;
+
+  // An index update received while the previous one is still being verified.
+  QList<AddonData> m_queuedAddonsList;
+  bool m_hasQueuedAddonsList = false;
 };
 
 #endif  // ADDONMANAGER_H
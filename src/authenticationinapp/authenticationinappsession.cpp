@@ -11,6 +11,7 @@
 #include "models/feature.h"
 #include "mozillavpn.h"
 #include "networkrequest.h"
+#include "workerpool.h"
 
 #include "telemetry/gleansample.h"
 
@@ -197,12 +198,14 @@ void AuthenticationInAppSession::accountChecked(bool exists) {
   emit fallbackRequired();
 }
 
-QByteArray AuthenticationInAppSession::generateAuthPw() const {
+// static
+QByteArray AuthenticationInAppSession::generateAuthPw(
+    const QString& emailAddress, const QString& password) {
   // Process the user's password into an FxA auth token
   QString salt = QString("identity.mozilla.com/picl/v1/quickStretch:%1")
-                     .arg(m_emailAddressCaseFix);
+                     .arg(emailAddress);
   QByteArray pbkdf = QPasswordDigestor::deriveKeyPbkdf2(
-      QCryptographicHash::Sha256, m_password.toUtf8(), salt.toUtf8(), 1000, 32);
+      QCryptographicHash::Sha256, password.toUtf8(), salt.toUtf8(), 1000, 32);
 
   HKDF hash(QCryptographicHash::Sha256);
   hash.addData(pbkdf);
@@ -210,6 +213,17 @@ QByteArray AuthenticationInAppSession::generateAuthPw() const {
   return hash.result(32, "identity.mozilla.com/picl/v1/authPW");
 }
 
+void AuthenticationInAppSession::withAuthPw(
+    std::function<void(const QByteArray&)>&& callback) {
+  // The key stretching takes tens of milliseconds on slow devices: the UI
+  // would stutter while showing the spinner.
+  WorkerPool::run(
+      [emailAddress = m_emailAddressCaseFix, password = m_password]() {
+        return generateAuthPw(emailAddress, password);
+      })
+      .then(this, std::move(callback));
+}
+
 void AuthenticationInAppSession::setPassword(const QString& password) {
   m_password = password;
 }
@@ -237,11 +251,17 @@ void AuthenticationInAppSession::signIn(const QString& unblockCode) {
 }
 
 void AuthenticationInAppSession::signInInternal(const QString& unblockCode) {
+  withAuthPw([this, unblockCode](const QByteArray& authPw) {
+    signInWithAuthPw(unblockCode, authPw);
+  });
+}
+
+void AuthenticationInAppSession::signInWithAuthPw(const QString& unblockCode,
+                                                  const QByteArray& authPw) {
   NetworkRequest* request = NetworkRequest::createForFxaLogin(
-      m_task, m_emailAddressCaseFix, generateAuthPw(),
-      m_originalLoginEmailAddress, unblockCode, m_fxaParams.m_clientId,
-      m_fxaParams.m_deviceId, m_fxaParams.m_flowId,
-      m_fxaParams.m_flowBeginTime);
+      m_task, m_emailAddressCaseFix, authPw, m_originalLoginEmailAddress,
+      unblockCode, m_fxaParams.m_clientId, m_fxaParams.m_deviceId,
+      m_fxaParams.m_flowId, m_fxaParams.m_flowBeginTime);
 
   connect(request, &NetworkRequest::requestFailed, this,
           [this, unblockCode](QNetworkReply::NetworkError error,
@@ -298,8 +318,12 @@ void AuthenticationInAppSession::signUp() {
   AuthenticationInApp::instance()->requestState(
       AuthenticationInApp::StateSigningUp, this);
 
+  withAuthPw([this](const QByteArray& authPw) { signUpWithAuthPw(authPw); });
+}
+
+void AuthenticationInAppSession::signUpWithAuthPw(const QByteArray& authPw) {
   NetworkRequest* request = NetworkRequest::createForFxaAccountCreation(
-      m_task, m_emailAddressCaseFix, generateAuthPw(), m_fxaParams.m_clientId,
+      m_task, m_emailAddressCaseFix, authPw, m_fxaParams.m_clientId,
       m_fxaParams.m_deviceId, m_fxaParams.m_flowId,
       m_fxaParams.m_flowBeginTime);
 
@@ -555,8 +579,15 @@ void AuthenticationInAppSession::startAccountDeletionFlow() {
 }
 
 void AuthenticationInAppSession::deleteAccount() {
+  withAuthPw([this](const QByteArray& authPw) {
+    deleteAccountWithAuthPw(authPw);
+  });
+}
+
+void AuthenticationInAppSession::deleteAccountWithAuthPw(
+    const QByteArray& authPw) {
   NetworkRequest* request = NetworkRequest::createForFxaAccountDeletion(
-      m_task, m_sessionToken, m_emailAddress, generateAuthPw());
+      m_task, m_sessionToken, m_emailAddress, authPw);
 
   connect(request, &NetworkRequest::requestFailed, this,
           [this](QNetworkReply::NetworkError error, const QByteArray&) {
@@ -10,6 +10,8 @@
 #include <QObject>
 #include <QNetworkReply>
 
+#include <functional>
+
 class Task;
 
 class AuthenticationInAppSession final : public QObject {
@@ -68,12 +70,18 @@ class AuthenticationInAppSession final : public QObject {
 
  private:
   void signInInternal(const QString& unblockCode);
+  void signInWithAuthPw(const QString& unblockCode, const QByteArray& authPw);
+  void signUpWithAuthPw(const QByteArray& authPw);
+  void deleteAccountWithAuthPw(const QByteArray& authPw);
 
   void processErrorObject(const QJsonObject& obj);
   void processRequestFailure(QNetworkReply::NetworkError error,
                              const QByteArray& data);
 
-  QByteArray generateAuthPw() const;
+  static QByteArray generateAuthPw(const QString& emailAddress,
+                                   const QString& password);
+  // Derives the auth token out of the main thread.
+  void withAuthPw(std::function<void(const QByteArray&)>&& callback);
 
   void accountChecked(bool exists);
   void signInOrUpCompleted(const QString& sessionToken, bool accountVerified,
@@ -150,7 +150,15 @@ void CaptivePortalDetection::settingsChanged() {
 
 void CaptivePortalDetection::detectionCompleted(
     CaptivePortalRequest::CaptivePortalResult detected) {
-  logger.debug() << "Detection completed:" << detected;
+  Q_ASSERT(m_impl);
+
+  ++m_detectionCount;
+  m_lastDetectionLatency = m_impl->elapsed();
+  m_lastDetectionResult = detected;
+
+  logger.info() << "Detection completed:" << detected << "in"
+                << m_lastDetectionLatency << "ms";
+
   m_impl.reset();
   m_shouldRun = false;
   switch (detected) {
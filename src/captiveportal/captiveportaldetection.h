@@ -26,6 +26,13 @@ class CaptivePortalDetection final : public QObject {
   void detectCaptivePortal();
   void captivePortalDetected();
 
+  // Detection metrics, exposed for the inspector.
+  int detectionCount() const { return m_detectionCount; }
+  qint64 lastDetectionLatency() const { return m_lastDetectionLatency; }
+  CaptivePortalRequest::CaptivePortalResult lastDetectionResult() const {
+    return m_lastDetectionResult;
+  }
+
  signals:
   void captivePortalPresent();
 
@@ -49,6 +56,11 @@ class CaptivePortalDetection final : public QObject {
   bool m_active = false;
   bool m_shouldRun = true;
 
+  int m_detectionCount = 0;
+  qint64 m_lastDetectionLatency = -1;
+  CaptivePortalRequest::CaptivePortalResult m_lastDetectionResult =
+      CaptivePortalRequest::CaptivePortalResult::Failure;
+
   // Don't use it directly. Use captivePortalMonitor().
   CaptivePortalMonitor* m_captivePortalMonitor = nullptr;
 
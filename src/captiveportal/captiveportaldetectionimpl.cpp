@@ -24,6 +24,8 @@ CaptivePortalDetectionImpl::~CaptivePortalDetectionImpl() {
 void CaptivePortalDetectionImpl::start() {
   logger.debug() << "Captive portal detection started";
 
+  m_elapsedTimer.start();
+
   CaptivePortalRequestTask* task = new CaptivePortalRequestTask();
   connect(task, &CaptivePortalRequestTask::operationCompleted, this,
           [this](CaptivePortalRequest::CaptivePortalResult detected) {
@@ -31,5 +33,7 @@ void CaptivePortalDetectionImpl::start() {
             emit detectionCompleted(detected);
           });
 
-  TaskScheduler::scheduleTask(task);
+  // The detection does not conflict with any other task. It must not wait for
+  // the tasks in the queue: we could be behind a portal right now.
+  TaskScheduler::scheduleTaskNow(task);
 }
@@ -7,6 +7,7 @@
 
 #include "captiveportalrequest.h"
 
+#include <QElapsedTimer>
 #include <QObject>
 
 class CaptivePortalDetectionImpl : public QObject {
@@ -18,9 +19,15 @@ class CaptivePortalDetectionImpl : public QObject {
 
   virtual void start();
 
+  // Time spent since the beginning of the detection.
+  qint64 elapsed() const { return m_elapsedTimer.elapsed(); }
+
  signals:
   void detectionCompleted(
       CaptivePortalRequest::CaptivePortalResult captivePortalDetected);
+
+ private:
+  QElapsedTimer m_elapsedTimer;
 };
 
 #endif  // CAPTIVEPORTALDETECTIONIMPL_H
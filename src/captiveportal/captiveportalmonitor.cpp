@@ -45,9 +45,16 @@ void CaptivePortalMonitor::maybeCheck() {
 }
 
 void CaptivePortalMonitor::check() {
+  if (m_task) {
+    logger.debug() << "A check is still running";
+    return;
+  }
+
   logger.debug() << "Checking the internet connectivity";
 
   CaptivePortalRequestTask* task = new CaptivePortalRequestTask(false);
+  m_task = task;
+
   connect(task, &CaptivePortalRequestTask::operationCompleted, this,
           [this](CaptivePortalRequest::CaptivePortalResult result) {
             logger.debug() << "Captive portal detection:" << result;
@@ -68,5 +75,5 @@ void CaptivePortalMonitor::check() {
             emit online();
           });
 
-  TaskScheduler::scheduleTask(task);
+  TaskScheduler::scheduleTaskNow(task);
 }
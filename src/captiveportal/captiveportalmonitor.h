@@ -6,8 +6,11 @@
 #define CAPTIVEPORTALMONITOR_H
 
 #include <QObject>
+#include <QPointer>
 #include <QTimer>
 
+class CaptivePortalRequestTask;
+
 class CaptivePortalMonitor final : public QObject {
   Q_OBJECT
 
@@ -28,6 +31,8 @@ class CaptivePortalMonitor final : public QObject {
 
  private:
   QTimer m_timer;
+
+  QPointer<CaptivePortalRequestTask> m_task;
 };
 
 #endif  // CAPTIVEPORTALMONITOR_H
@@ -34,13 +34,12 @@ void CaptivePortalRequest::run() {
     emit completed(NoPortal);
     return;
   }
-  m_running = 0;
-  m_success = 0;
 
-  // We do not care which request succeeds.
-  // Let's make 1 request for any available IP addresses. The first one will
-  // delete all the others.
+  m_elapsedTimer.start();
 
+  // We do not care which request succeeds. Let's race 1 request for any
+  // available IPv4 and IPv6 address. The first conclusive answer aborts all
+  // the others: a slow or unreachable endpoint does not delay the detection.
   for (const QString& address : ipv4Addresses) {
     QUrl url(QString(CAPTIVEPORTAL_URL_IPV4).arg(address));
     createRequest(url);
@@ -52,7 +51,13 @@ void CaptivePortalRequest::run() {
   }
 }
 
-void CaptivePortalRequest::createRequest(const QUrl& url) {
+void CaptivePortalRequest::createRequest(const QUrl& baseUrl) {
+  QUrl url(baseUrl);
+  int port = Constants::captivePortalPort();
+  if (port != 80) {
+    url.setPort(port);
+  }
+
   logger.debug() << "request:" << url.toString();
 
   NetworkRequest* request = NetworkRequest::createForCaptivePortalDetection(
@@ -64,7 +69,7 @@ void CaptivePortalRequest::createRequest(const QUrl& url) {
             logger.info() << "Portal Detected -> Redirect to "
                           << logger.sensitive(url.toString());
             request->abort();
-            onResult(PortalDetected);
+            onResult(request, PortalDetected);
           });
   connect(
       request, &NetworkRequest::requestFailed, this,
@@ -74,7 +79,7 @@ void CaptivePortalRequest::createRequest(const QUrl& url) {
         }
 
         logger.warning() << "Captive portal request failed:" << error;
-        onResult(Failure);
+        onResult(request, Failure);
       });
 
   connect(
@@ -89,41 +94,49 @@ void CaptivePortalRequest::createRequest(const QUrl& url) {
         if (request->statusCode() != 200) {
           logger.debug() << "Captive portal detected. Expected 200, received:"
                          << request->statusCode();
-          onResult(PortalDetected);
+          onResult(request, PortalDetected);
           return;
         }
 
         if (QString(data).trimmed() == CAPTIVEPORTAL_REQUEST_CONTENT) {
           logger.debug() << "No captive portal!";
-          onResult(NoPortal);
+          onResult(request, NoPortal);
           return;
         }
 
         logger.debug() << "Captive portal detected. Content does not match.";
-        onResult(PortalDetected);
+        onResult(request, PortalDetected);
       });
 
-  m_running++;
+  m_requests.append(request);
 }
 
-void CaptivePortalRequest::onResult(CaptivePortalResult portalDetected) {
-  Q_ASSERT(m_running > 0);
-  m_running--;
-  if (portalDetected == NoPortal) {
-    m_success++;
+void CaptivePortalRequest::onResult(NetworkRequest* request,
+                                    CaptivePortalResult portalDetected) {
+  if (m_completed) {
+    return;
   }
 
-  // If any request detects a portal, we can terminate immediately.
-  if (portalDetected == PortalDetected) {
-    deleteLater();
-    emit completed(portalDetected);
+  m_requests.removeOne(request);
+
+  // A failure is not conclusive: let's wait for the other probes.
+  if (portalDetected == Failure && !m_requests.isEmpty()) {
     return;
   }
 
-  // Otherwise, we are complete after all the workers have terminated.
-  if (m_running == 0) {
-    deleteLater();
-    emit completed((m_success > 0) ? NoPortal : Failure);
-    return;
+  m_completed = true;
+
+  // Any other answer would be late. Let's cancel the pending probes.
+  for (const QPointer<NetworkRequest>& pendingRequest : m_requests) {
+    if (pendingRequest) {
+      pendingRequest->abort();
+    }
   }
+  m_requests.clear();
+
+  logger.debug() << "Captive portal probes completed in"
+                 << m_elapsedTimer.elapsed() << "ms";
+
+  deleteLater();
+  emit completed(portalDetected);
 }
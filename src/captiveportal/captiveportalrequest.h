@@ -5,9 +5,13 @@
 #ifndef CAPTIVEPORTALREQUEST_H
 #define CAPTIVEPORTALREQUEST_H
 
+#include <QElapsedTimer>
+#include <QList>
 #include <QObject>
+#include <QPointer>
 #include <QUrl>
 
+class NetworkRequest;
 class Task;
 
 class CaptivePortalRequest final : public QObject {
@@ -28,12 +32,14 @@ class CaptivePortalRequest final : public QObject {
 
  private:
   void createRequest(const QUrl& url);
-  void nextStep();
-  void onResult(CaptivePortalResult portalDetected);
+  void onResult(NetworkRequest* request, CaptivePortalResult portalDetected);
 
  private:
-  int m_running = 0;
-  int m_success = 0;
+  // The probes still running. The first conclusive answer aborts the others.
+  QList<QPointer<NetworkRequest>> m_requests;
+
+  QElapsedTimer m_elapsedTimer;
+  bool m_completed = false;
 };
 
 #endif  // CAPTIVEPORTALREQUEST_H
@@ -22,6 +22,8 @@ target_sources(mozillavpn PRIVATE
     addons/addonproperty.h
     addons/addonpropertylist.cpp
     addons/addonpropertylist.h
+    addons/addonscriptcache.cpp
+    addons/addonscriptcache.h
     addons/addontutorial.cpp
     addons/addontutorial.h
     addons/conditionwatchers/addonconditionwatcher.cpp
@@ -42,6 +44,8 @@ target_sources(mozillavpn PRIVATE
     addons/conditionwatchers/addonconditionwatchertriggertimesecs.h
     addons/manager/addondirectory.cpp
     addons/manager/addondirectory.h
+    addons/manager/addonhashcache.cpp
+    addons/manager/addonhashcache.h
     addons/manager/addonindex.cpp
     addons/manager/addonindex.h
     addons/manager/addonmanager.cpp
@@ -86,6 +90,8 @@ target_sources(mozillavpn PRIVATE
     commands/commanddeactivate.h
     commands/commanddevice.cpp
     commands/commanddevice.h
+    commands/commandlatency.cpp
+    commands/commandlatency.h
     commands/commandlogin.cpp
     commands/commandlogin.h
     commands/commandlogout.cpp
@@ -112,6 +118,8 @@ target_sources(mozillavpn PRIVATE
     composer/composerblocktitle.h
     composer/composerblockunorderedlist.cpp
     composer/composerblockunorderedlist.h
+    connectionbenchmark/benchmarklatencyprobe.cpp
+    connectionbenchmark/benchmarklatencyprobe.h
     connectionbenchmark/benchmarktask.cpp
     connectionbenchmark/benchmarktask.h
     connectionbenchmark/benchmarktaskping.cpp
@@ -119,6 +127,8 @@ target_sources(mozillavpn PRIVATE
     connectionbenchmark/benchmarktasksentinel.h
     connectionbenchmark/benchmarktasktransfer.cpp
     connectionbenchmark/benchmarktasktransfer.h
+    connectionbenchmark/benchmarkthroughput.cpp
+    connectionbenchmark/benchmarkthroughput.h
     connectionbenchmark/connectionbenchmark.cpp
     connectionbenchmark/connectionbenchmark.h
     connectionbenchmark/uploaddatagenerator.cpp
@@ -209,6 +219,8 @@ target_sources(mozillavpn PRIVATE
     models/server.h
     models/servercity.cpp
     models/servercity.h
+    models/servercitymodel.cpp
+    models/servercitymodel.h
     models/servercountry.cpp
     models/servercountry.h
     models/servercountrymodel.cpp
@@ -278,6 +290,8 @@ target_sources(mozillavpn PRIVATE
     signature.h
     simplenetworkmanager.cpp
     simplenetworkmanager.h
+    startuptracer.cpp
+    startuptracer.h
     statusicon.cpp
     statusicon.h
     task.h
@@ -329,6 +343,8 @@ target_sources(mozillavpn PRIVATE
     temporarydir.h
     theme.cpp
     theme.h
+    timerwheel.cpp
+    timerwheel.h
     tutorial/tutorial.cpp
     tutorial/tutorial.h
     tutorial/tutorialstep.cpp
@@ -351,6 +367,8 @@ target_sources(mozillavpn PRIVATE
     websocket/pushmessage.h
     websocket/websockethandler.cpp
     websocket/websockethandler.h
+    workerpool.cpp
+    workerpool.h
 )
 
 # VPN Client UI resources
@@ -387,6 +405,8 @@ if(NOT CMAKE_CROSSCOMPILING)
         server/serverconnection.h
         server/serverhandler.cpp
         server/serverhandler.h
+        server/serverlistcache.cpp
+        server/serverlistcache.h
     )
 
     add_compile_definitions(MVPN_WEBEXTENSION)
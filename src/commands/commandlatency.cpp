@@ -0,0 +1,241 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "commandlatency.h"
+#include "commandlineparser.h"
+#include "leakdetector.h"
+#include "mozillavpn.h"
+#include "pingsender.h"
+#include "pingsenderfactory.h"
+#include "tasks/servers/taskservers.h"
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QHash>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace {
+
+// Pings in flight at the same time.
+constexpr int LATENCY_MAX_PARALLEL = 64;
+
+// In msecs, the time to wait for a reply before sending the ping again.
+constexpr qint64 LATENCY_TIMEOUT_MSEC = 2000;
+
+constexpr int LATENCY_MAX_RETRIES = 2;
+
+// Interval of the timeout checks.
+constexpr int LATENCY_CHECK_MSEC = 100;
+
+struct Target {
+  QString m_hostname;
+  QString m_countryCode;
+  QString m_cityName;
+  QString m_address;
+  qint64 m_latency = -1;
+};
+
+struct PendingPing {
+  int m_target;
+  qint64 m_sentMsec;
+  int m_retries;
+};
+
+}  // namespace
+
+CommandLatency::CommandLatency(QObject* parent)
+    : Command(parent, "latency", "Measure the latency of every server.") {
+  MVPN_COUNT_CTOR(CommandLatency);
+}
+
+CommandLatency::~CommandLatency() { MVPN_COUNT_DTOR(CommandLatency); }
+
+int CommandLatency::run(QStringList& tokens) {
+  Q_ASSERT(!tokens.isEmpty());
+  return runCommandLineApp([&]() {
+    QString appName = tokens[0];
+
+    CommandLineParser::Option hOption = CommandLineParser::helpOption();
+    CommandLineParser::Option cacheOption("c", "cache", "From local cache.");
+    CommandLineParser::Option jsonOption(
+        "j", "json", "One Json object per server and per line.");
+
+    QList<CommandLineParser::Option*> options;
+    options.append(&hOption);
+    options.append(&cacheOption);
+    options.append(&jsonOption);
+
+    CommandLineParser clp;
+    if (clp.parse(tokens, options, false)) {
+      return 1;
+    }
+
+    if (!tokens.isEmpty()) {
+      return clp.unknownOption(this, appName, tokens[0], options, false);
+    }
+
+    if (hOption.m_set) {
+      clp.showHelp(this, appName, options, false, false);
+      return 0;
+    }
+
+    if (!userAuthenticated()) {
+      return 1;
+    }
+
+    MozillaVPN vpn;
+
+    if (!cacheOption.m_set) {
+      TaskServers task(ErrorHandler::PropagateError);
+      task.run();
+
+      QEventLoop loop;
+      QObject::connect(&task, &Task::completed, &task, [&] { loop.exit(); });
+      loop.exec();
+    } else if (!loadModels()) {
+      return 1;
+    }
+
+    QList<Target> targets;
+    ServerCountryModel* scm = vpn.serverCountryModel();
+    for (const ServerCountry& country : scm->countries()) {
+      for (const ServerCity& city : country.cities()) {
+        for (const QString& pubkey : city.servers()) {
+          const Server server = scm->server(pubkey);
+          if (!server.initialized()) {
+            continue;
+          }
+
+          Target target;
+          target.m_hostname = server.hostname();
+          target.m_countryCode = country.code();
+          target.m_cityName = city.name();
+          target.m_address = server.ipv4AddrIn();
+          targets.append(target);
+        }
+      }
+    }
+
+    PingSender* pingSender = PingSenderFactory::create(QHostAddress(), &vpn);
+    if (!pingSender->isValid()) {
+      QTextStream(stderr) << "Unable to send pings. Root privileges might be "
+                             "required."
+                          << Qt::endl;
+      return 1;
+    }
+
+    // All the servers are probed at the same time, up to
+    // LATENCY_MAX_PARALLEL pings in flight.
+    QEventLoop loop;
+    QElapsedTimer elapsedTimer;
+    QHash<quint16, PendingPing> pendingPings;
+    quint16 sequence = 0;
+    int next = 0;
+
+    auto sendPing = [&](int index, int retries) {
+      pendingPings.insert(sequence,
+                          PendingPing{index, elapsedTimer.elapsed(), retries});
+      pingSender->sendPing(QHostAddress(targets.at(index).m_address),
+                           sequence++);
+    };
+
+    auto maybeSendPings = [&]() {
+      qint64 now = elapsedTimer.elapsed();
+
+      QList<PendingPing> timeouts;
+      for (auto i = pendingPings.begin(); i != pendingPings.end();) {
+        if (now - i.value().m_sentMsec < LATENCY_TIMEOUT_MSEC) {
+          ++i;
+          continue;
+        }
+
+        timeouts.append(i.value());
+        i = pendingPings.erase(i);
+      }
+
+      for (const PendingPing& timeout : timeouts) {
+        if (timeout.m_retries < LATENCY_MAX_RETRIES) {
+          sendPing(timeout.m_target, timeout.m_retries + 1);
+        }
+      }
+
+      while (pendingPings.count() < LATENCY_MAX_PARALLEL &&
+             next < targets.count()) {
+        sendPing(next++, 0);
+      }
+
+      if (pendingPings.isEmpty()) {
+        loop.exit();
+      }
+    };
+
+    QObject::connect(pingSender, &PingSender::recvPing, &loop,
+                     [&](quint16 replySequence) {
+                       auto i = pendingPings.find(replySequence);
+                       if (i == pendingPings.end()) {
+                         return;
+                       }
+
+                       targets[i.value().m_target].m_latency =
+                           elapsedTimer.elapsed() - i.value().m_sentMsec;
+                       pendingPings.erase(i);
+                       maybeSendPings();
+                     });
+
+    QTimer timer;
+    QObject::connect(&timer, &QTimer::timeout, &loop, maybeSendPings);
+
+    elapsedTimer.start();
+    timer.start(LATENCY_CHECK_MSEC);
+    maybeSendPings();
+    if (!pendingPings.isEmpty()) {
+      loop.exec();
+    }
+
+    // The unreachable servers go last.
+    std::stable_sort(targets.begin(), targets.end(),
+                     [](const Target& a, const Target& b) {
+                       if (a.m_latency < 0 || b.m_latency < 0) {
+                         return a.m_latency >= 0 && b.m_latency < 0;
+                       }
+                       return a.m_latency < b.m_latency;
+                     });
+
+    QTextStream stream(stdout);
+    for (const Target& target : targets) {
+      if (jsonOption.m_set) {
+        QJsonObject obj;
+        obj["hostname"] = target.m_hostname;
+        obj["country-code"] = target.m_countryCode;
+        obj["city"] = target.m_cityName;
+        obj["ipv4-addr-in"] = target.m_address;
+        obj["latency-msec"] = target.m_latency >= 0
+                                  ? QJsonValue(target.m_latency)
+                                  : QJsonValue();
+        stream << QJsonDocument(obj).toJson(QJsonDocument::Compact)
+               << Qt::endl;
+        continue;
+      }
+
+      stream << target.m_hostname << " (" << target.m_cityName << ", "
+             << target.m_countryCode << "): ";
+      if (target.m_latency >= 0) {
+        stream << target.m_latency << " ms";
+      } else {
+        stream << "timeout";
+      }
+      stream << Qt::endl;
+    }
+
+    return 0;
+  });
+}
+
+static Command::RegistrationProxy<CommandLatency> s_commandLatency;
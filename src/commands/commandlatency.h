@@ -0,0 +1,18 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef COMMANDLATENCY_H
+#define COMMANDLATENCY_H
+
+#include "command.h"
+
+class CommandLatency final : public Command {
+ public:
+  explicit CommandLatency(QObject* parent);
+  ~CommandLatency();
+
+  int run(QStringList& tokens) override;
+};
+
+#endif  // COMMANDLATENCY_H
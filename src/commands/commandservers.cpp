@@ -14,6 +14,21 @@
 #include <QJsonObject>
 #include <QTextStream>
 
+namespace {
+
+QJsonObject serverToJson(const Server& server) {
+  QJsonObject serverObj;
+  serverObj["hostname"] = server.hostname();
+  serverObj["ipv4-addr-in"] = server.ipv4AddrIn();
+  serverObj["ipv4-gateway"] = server.ipv4Gateway();
+  serverObj["ipv6-addr-in"] = server.ipv6AddrIn();
+  serverObj["ipv6-gateway"] = server.ipv6Gateway();
+  serverObj["public-key"] = server.publicKey();
+  return serverObj;
+}
+
+}  // namespace
+
 CommandServers::CommandServers(QObject* parent)
     : Command(parent, "servers", "Show the list of servers.") {
   MVPN_COUNT_CTOR(CommandServers);
@@ -30,12 +45,15 @@ int CommandServers::run(QStringList& tokens) {
     CommandLineParser::Option verboseOption("v", "verbose", "Verbose mode.");
     CommandLineParser::Option cacheOption("c", "cache", "From local cache.");
     CommandLineParser::Option jsonOption("j", "json", "Json format.");
+    CommandLineParser::Option ndjsonOption(
+        "n", "ndjson", "One Json object per server and per line.");
 
     QList<CommandLineParser::Option*> options;
     options.append(&hOption);
     options.append(&verboseOption);
     options.append(&cacheOption);
     options.append(&jsonOption);
+    options.append(&ndjsonOption);
 
     CommandLineParser clp;
     if (clp.parse(tokens, options, false)) {
@@ -68,7 +86,30 @@ int CommandServers::run(QStringList& tokens) {
       return 0;
     }
 
-    if (jsonOption.m_set) {
+    if (ndjsonOption.m_set) {
+      // Each line is written as soon as it is ready: nothing is buffered,
+      // whatever the number of servers.
+      QTextStream stream(stdout);
+      ServerCountryModel* scm = vpn.serverCountryModel();
+      for (const ServerCountry& country : scm->countries()) {
+        for (const ServerCity& city : country.cities()) {
+          for (const QString& pubkey : city.servers()) {
+            const Server server = scm->server(pubkey);
+            if (!server.initialized()) {
+              continue;
+            }
+
+            QJsonObject serverObj = serverToJson(server);
+            serverObj["country"] = country.name();
+            serverObj["country-code"] = country.code();
+            serverObj["city"] = city.name();
+            serverObj["city-code"] = city.code();
+            stream << QJsonDocument(serverObj).toJson(QJsonDocument::Compact)
+                   << Qt::endl;
+          }
+        }
+      }
+    } else if (jsonOption.m_set) {
       ServerCountryModel* scm = vpn.serverCountryModel();
       QJsonArray list;
       for (const ServerCountry& country : scm->countries()) {
@@ -89,14 +130,7 @@ int CommandServers::run(QStringList& tokens) {
               continue;
             }
 
-            QJsonObject serverObj;
-            serverObj["hostname"] = server.hostname();
-            serverObj["ipv4-addr-in"] = server.ipv4AddrIn();
-            serverObj["ipv4-gateway"] = server.ipv4Gateway();
-            serverObj["ipv6-addr-in"] = server.ipv6AddrIn();
-            serverObj["ipv6-gateway"] = server.ipv6Gateway();
-            serverObj["public-key"] = server.publicKey();
-            serverArray.append(serverObj);
+            serverArray.append(serverToJson(server));
           }
 
           cityObj["servers"] = serverArray;
@@ -6,12 +6,134 @@
 #include "commandlineparser.h"
 #include "leakdetector.h"
 #include "mozillavpn.h"
+#include "pinghelper.h"
 #include "settingsholder.h"
 #include "simplenetworkmanager.h"
 #include "tasks/account/taskaccount.h"
 
+#include <QDateTime>
+#include <QElapsedTimer>
 #include <QEventLoop>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QTextStream>
+#include <QTimer>
+
+namespace {
+
+// In msecs, the interval between two status lines in watch mode.
+constexpr int WATCH_INTERVAL_MSEC = 1000;
+
+QString stateName(Controller::State state) {
+  switch (state) {
+    case Controller::StateInitializing:
+      return "initializing";
+    case Controller::StateOff:
+      return "off";
+    case Controller::StateConnecting:
+      return "connecting";
+    case Controller::StateConfirming:
+      return "confirming";
+    case Controller::StateOn:
+      return "on";
+    case Controller::StateDisconnecting:
+      return "disconnecting";
+    case Controller::StateSwitching:
+      return "switching";
+  }
+
+  Q_ASSERT(false);
+  return QString();
+}
+
+QString toJsonLine(const QJsonObject& obj) {
+  return QJsonDocument(obj).toJson(QJsonDocument::Compact);
+}
+
+// Streams the traffic rates and the ping statistics until the process is
+// killed. One line per interval.
+void watch(Controller* controller, bool json) {
+  QTextStream stream(stdout);
+
+  PingHelper pingHelper;
+  QString gateway;
+
+  QElapsedTimer elapsedTimer;
+  qint64 lastMsec = -1;
+  uint64_t lastTxBytes = 0;
+  uint64_t lastRxBytes = 0;
+
+  auto statusReceived = [&](const QString& serverIpv4Gateway,
+                            const QString& deviceIpv4Address,
+                            uint64_t txBytes, uint64_t rxBytes) {
+    if (serverIpv4Gateway != gateway) {
+      gateway = serverIpv4Gateway;
+      pingHelper.stop();
+      if (!gateway.isEmpty()) {
+        pingHelper.start(gateway, deviceIpv4Address);
+      }
+    }
+
+    qint64 now = elapsedTimer.elapsed();
+    double txRate = 0;
+    double rxRate = 0;
+    // The counters are reset when the VPN is activated again.
+    if (lastMsec >= 0 && now > lastMsec && txBytes >= lastTxBytes &&
+        rxBytes >= lastRxBytes) {
+      double seconds = (now - lastMsec) / 1000.0;
+      txRate = (txBytes - lastTxBytes) / seconds;
+      rxRate = (rxBytes - lastRxBytes) / seconds;
+    }
+
+    lastMsec = now;
+    lastTxBytes = txBytes;
+    lastRxBytes = rxBytes;
+
+    QString state = stateName(controller->state());
+    bool pinging = !gateway.isEmpty();
+
+    if (json) {
+      QJsonObject obj;
+      obj["time"] =
+          QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs);
+      obj["state"] = state;
+      obj["tx-bytes"] = static_cast<qint64>(txBytes);
+      obj["rx-bytes"] = static_cast<qint64>(rxBytes);
+      obj["tx-bytes-per-sec"] = qRound64(txRate);
+      obj["rx-bytes-per-sec"] = qRound64(rxRate);
+      if (pinging) {
+        obj["latency-msec"] = static_cast<qint64>(pingHelper.latency());
+        obj["stddev-msec"] = static_cast<qint64>(pingHelper.stddev());
+        obj["loss"] = pingHelper.loss();
+      }
+      stream << toJsonLine(obj) << Qt::endl;
+      return;
+    }
+
+    stream << "VPN state: " << state << " - tx: " << qRound64(txRate)
+           << " B/s - rx: " << qRound64(rxRate) << " B/s";
+    if (pinging) {
+      stream << " - latency: " << pingHelper.latency()
+             << " ms - stddev: " << pingHelper.stddev()
+             << " ms - loss: " << pingHelper.loss() * 100 << "%";
+    }
+    stream << Qt::endl;
+  };
+
+  QTimer timer;
+  QObject::connect(&timer, &QTimer::timeout, &timer,
+                   [&]() { controller->getStatus(statusReceived); });
+
+  elapsedTimer.start();
+  timer.start(WATCH_INTERVAL_MSEC);
+  controller->getStatus(statusReceived);
+
+  QEventLoop loop;
+  loop.exec();
+}
+
+}  // namespace
 
 CommandStatus::CommandStatus(QObject* parent)
     : Command(parent, "status", "Show the current VPN status.") {
@@ -27,10 +149,15 @@ int CommandStatus::run(QStringList& tokens) {
 
     CommandLineParser::Option hOption = CommandLineParser::helpOption();
     CommandLineParser::Option cacheOption("c", "cache", "From local cache.");
+    CommandLineParser::Option jsonOption("j", "json", "Json format.");
+    CommandLineParser::Option watchOption(
+        "w", "watch", "Stream the traffic rates and the ping statistics.");
 
     QList<CommandLineParser::Option*> options;
     options.append(&hOption);
     options.append(&cacheOption);
+    options.append(&jsonOption);
+    options.append(&watchOption);
 
     CommandLineParser clp;
     if (clp.parse(tokens, options, false)) {
@@ -49,13 +176,22 @@ int CommandStatus::run(QStringList& tokens) {
     }
 
     MozillaVPN vpn;
+    QTextStream stream(stdout);
+
+    if (jsonOption.m_set && !SettingsHolder::instance()->hasToken()) {
+      QJsonObject obj;
+      obj["authenticated"] = false;
+      stream << toJsonLine(obj) << Qt::endl;
+      return 0;
+    }
 
     if (!userAuthenticated()) {
       return 0;
     }
 
-    QTextStream stream(stdout);
-    stream << "User status: authenticated" << Qt::endl;
+    if (!jsonOption.m_set) {
+      stream << "User status: authenticated" << Qt::endl;
+    }
 
     if (!loadModels()) {
       return 1;
@@ -70,6 +206,71 @@ int CommandStatus::run(QStringList& tokens) {
       loop.exec();
     }
 
+    Controller controller;
+
+    QEventLoop loop;
+    QObject::connect(&controller, &Controller::stateChanged, &controller, [&] {
+      if (controller.state() == Controller::StateOff ||
+          controller.state() == Controller::StateOn) {
+        loop.exit();
+      }
+    });
+    controller.initialize();
+    loop.exec();
+
+    if (jsonOption.m_set) {
+      User* user = vpn.user();
+      Q_ASSERT(user);
+
+      QJsonObject userObj;
+      userObj["avatar"] = user->avatar();
+      userObj["display-name"] = user->displayName();
+      userObj["email"] = user->email();
+      userObj["max-devices"] = user->maxDevices();
+      userObj["subscription-needed"] = user->subscriptionNeeded();
+
+      DeviceModel* dm = vpn.deviceModel();
+      Q_ASSERT(dm);
+
+      const Device* cd = dm->currentDevice(vpn.keys());
+      QJsonArray deviceArray;
+      for (const Device& device : dm->devices()) {
+        QJsonObject deviceObj;
+        deviceObj["name"] = device.name();
+        deviceObj["creation-time"] =
+            device.createdAt().toString(Qt::ISODate);
+        deviceObj["public-key"] = device.publicKey();
+        deviceObj["ipv4-address"] = device.ipv4Address();
+        deviceObj["ipv6-address"] = device.ipv6Address();
+        deviceObj["current"] = cd && cd->publicKey() == device.publicKey();
+        deviceArray.append(deviceObj);
+      }
+
+      QJsonObject obj;
+      obj["authenticated"] = true;
+      obj["user"] = userObj;
+      obj["active-devices"] = dm->activeDevices();
+      obj["devices"] = deviceArray;
+
+      ServerData* sd = vpn.currentServer();
+      if (sd) {
+        QJsonObject serverObj;
+        serverObj["country-code"] = sd->exitCountryCode();
+        serverObj["country"] =
+            vpn.serverCountryModel()->countryName(sd->exitCountryCode());
+        serverObj["city"] = sd->exitCityName();
+        obj["server"] = serverObj;
+      }
+
+      obj["state"] = stateName(controller.state());
+      stream << toJsonLine(obj) << Qt::endl;
+
+      if (watchOption.m_set) {
+        watch(&controller, true);
+      }
+      return 0;
+    }
+
     User* user = vpn.user();
     Q_ASSERT(user);
     stream << "User avatar: " << user->avatar() << Qt::endl;
@@ -109,51 +310,12 @@ int CommandStatus::run(QStringList& tokens) {
       stream << "Server city: " << sd->exitCityName() << Qt::endl;
     }
 
-    Controller controller;
-
-    QEventLoop loop;
-    QObject::connect(&controller, &Controller::stateChanged, &controller, [&] {
-      if (controller.state() == Controller::StateOff ||
-          controller.state() == Controller::StateOn) {
-        loop.exit();
-      }
-    });
-    controller.initialize();
-    loop.exec();
-
-    stream << "VPN state: ";
-    switch (controller.state()) {
-      case Controller::StateInitializing:
-        stream << "initializing";
-        break;
-
-      case Controller::StateOff:
-        stream << "off";
-        break;
-
-      case Controller::StateConnecting:
-        stream << "connecting";
-        break;
-
-      case Controller::StateConfirming:
-        stream << "confirming";
-        break;
+    stream << "VPN state: " << stateName(controller.state()) << Qt::endl;
 
-      case Controller::StateOn:
-        stream << "on";
-        break;
-
-      case Controller::StateDisconnecting:
-        stream << "disconnecting";
-        break;
-
-      case Controller::StateSwitching:
-        stream << "switching";
-        break;
+    if (watchOption.m_set) {
+      watch(&controller, false);
     }
 
-    stream << Qt::endl;
-
     return 0;
   });
 }
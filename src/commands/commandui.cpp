@@ -26,6 +26,7 @@
 #include "purchasehandler.h"
 #include "qmlengineholder.h"
 #include "settingsholder.h"
+#include "startuptracer.h"
 #include "telemetry/gleansample.h"
 #include "temporarydir.h"
 #include "theme.h"
@@ -39,6 +40,9 @@
 
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
+#include <QQuickWindow>
+
+#include <memory>
 
 #ifdef MVPN_DEBUG
 #  include <QQmlDebuggingEnabler>
@@ -213,6 +217,9 @@ int CommandUI::run(QStringList& tokens) {
       qputenv("QT_ANDROID_NO_EXIT_CALL", "1");
     }
 #endif
+    StartupTracer* tracer = StartupTracer::instance();
+    tracer->begin("QML engine");
+
     // This object _must_ live longer than MozillaVPN to avoid shutdown crashes.
     QQmlApplicationEngine* engine = new QQmlApplicationEngine();
     QmlEngineHolder engineHolder(engine);
@@ -226,10 +233,14 @@ int CommandUI::run(QStringList& tokens) {
     Nebula::Initialize(engine);
     L18nStrings::initialize();
 
+    tracer->end("QML engine");
+
     // Cleanup previous temporary files.
     TemporaryDir::cleanupAll();
 
+    tracer->begin("MozillaVPN");
     MozillaVPN vpn;
+    tracer->end("MozillaVPN");
 
     vpn.setStartMinimized(minimizedOption.m_set ||
                           (qgetenv("MVPN_MINIMIZED") == "1"));
@@ -253,7 +264,9 @@ int CommandUI::run(QStringList& tokens) {
 #endif
 
     // Font loader
+    tracer->begin("Fonts");
     FontLoader::loadFonts();
+    tracer->end("Fonts");
 
     vpn.initialize();
 
@@ -273,6 +286,8 @@ int CommandUI::run(QStringList& tokens) {
     }
 #endif
 
+    tracer->begin("QML singletons");
+
     QQuickImageProvider* provider = ImageProviderFactory::create(qApp);
     if (provider) {
       engine->addImageProvider(QString("app"), provider);
@@ -537,6 +552,8 @@ int CommandUI::run(QStringList& tokens) {
           return obj;
         });
 
+    tracer->end("QML singletons");
+
 #if MVPN_IOS && QT_VERSION >= 0x060000 && QT_VERSION < 0x060300
     QObject::connect(qApp, &QCoreApplication::aboutToQuit, &vpn,
                      &MozillaVPN::quit);
@@ -569,7 +586,27 @@ int CommandUI::run(QStringList& tokens) {
           }
         },
         Qt::QueuedConnection);
+    tracer->begin("Main QML");
     engine->load(url);
+    tracer->end("Main QML");
+
+    // The subsystems not needed to show the UI are initialized when the first
+    // frame is on the screen.
+    QQuickWindow* window =
+        engine->rootObjects().isEmpty()
+            ? nullptr
+            : qobject_cast<QQuickWindow*>(engineHolder.window());
+    if (window) {
+      auto connection = std::make_shared<QMetaObject::Connection>();
+      *connection = QObject::connect(
+          window, &QQuickWindow::frameSwapped, &vpn,
+          [connection]() {
+            QObject::disconnect(*connection);
+            StartupTracer::instance()->instant("First frame");
+            MozillaVPN::instance()->initializeDeferredSubsystems();
+          },
+          Qt::QueuedConnection);
+    }
 
     NotificationHandler* notificationHandler =
         NotificationHandler::create(&engineHolder);
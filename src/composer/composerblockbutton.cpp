@@ -5,15 +5,14 @@
 #include "composerblockbutton.h"
 #include "addons/addon.h"
 #include "addons/addonapi.h"
+#include "addons/addonscriptcache.h"
 #include "leakdetector.h"
 #include "logger.h"
-#include "qmlengineholder.h"
 
 #include <QDir>
 #include <QJsonObject>
-#include <QFile>
 #include <QFileInfo>
-#include <QQmlEngine>
+#include <QJSEngine>
 
 namespace {
 Logger logger(LOG_MAIN, "ComposerBlockButton");
@@ -33,15 +32,14 @@ ComposerBlock* ComposerBlockButton::create(Composer* composer, Addon* addon,
   QFileInfo manifestFileInfo(addon->manifestFileName());
   QDir addonPath = manifestFileInfo.dir();
 
-  QFile file(addonPath.filePath(javascript));
-  if (!file.open(QIODevice::ReadOnly)) {
+  QJSValue function;
+  if (!AddonScriptCache::evaluate(addonPath.filePath(javascript),
+                                  addon->sha256(), &function)) {
     logger.debug() << "Unable to open the javascript file" << javascript
                    << "for button" << blockId;
     return nullptr;
   }
 
-  QJSValue function =
-      QmlEngineHolder::instance()->engine()->evaluate(file.readAll());
   if (function.isError()) {
     logger.debug() << "Execution throws an error:" << function.toString();
     return nullptr;
@@ -89,7 +87,7 @@ ComposerBlockButton::~ComposerBlockButton() {
 }
 
 void ComposerBlockButton::click() const {
-  QJSEngine* engine = QmlEngineHolder::instance()->engine();
+  QJSEngine* engine = AddonScriptCache::engine();
   QJSValue api = engine->newQObject(m_addon->api());
 
   QJSValue output = m_function.call(QJSValueList{api});
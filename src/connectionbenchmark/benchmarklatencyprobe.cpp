@@ -0,0 +1,131 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "benchmarklatencyprobe.h"
+#include "constants.h"
+#include "dnspingsender.h"
+#include "leakdetector.h"
+#include "logger.h"
+#include "pingsender.h"
+#include "pingsenderfactory.h"
+
+#include <QRandomGenerator>
+
+#include <algorithm>
+
+namespace {
+Logger logger(LOG_NETWORKING, "BenchmarkLatencyProbe");
+
+// Replies arriving later than this are lost.
+constexpr qint64 PING_TIMEOUT_MSEC = 3000;
+}  // namespace
+
+BenchmarkLatencyProbe::BenchmarkLatencyProbe() {
+  MVPN_COUNT_CTOR(BenchmarkLatencyProbe);
+
+  connect(&m_pingTimer, &QTimer::timeout, this,
+          &BenchmarkLatencyProbe::sendPing);
+}
+
+BenchmarkLatencyProbe::~BenchmarkLatencyProbe() {
+  MVPN_COUNT_DTOR(BenchmarkLatencyProbe);
+}
+
+void BenchmarkLatencyProbe::start(const QHostAddress& destination,
+                                  const QHostAddress& source, bool dnsPing) {
+  logger.debug() << "Probe started for:"
+                 << logger.sensitive(destination.toString());
+
+  stop();
+
+  m_destination = destination;
+  m_pingSender = dnsPing ? new DnsPingSender(source, this)
+                         : PingSenderFactory::create(source, this);
+
+  // Same fallback as the PingHelper, for the platforms requiring root access
+  // to send ICMP pings.
+  if (!m_pingSender->isValid()) {
+    delete m_pingSender;
+    m_pingSender = new DnsPingSender(source, this);
+  }
+
+  connect(m_pingSender, &PingSender::recvPing, this,
+          &BenchmarkLatencyProbe::pingReceived);
+
+  m_loaded = false;
+  m_pendingPings.clear();
+  m_idleRtts.clear();
+  m_loadedRtts.clear();
+
+  // The PingHelper of the connection health may share our ICMP identifier:
+  // let's not start from the same sequence number.
+  m_sequence = QRandomGenerator::global()->bounded(UINT16_MAX);
+
+  m_elapsedTimer.start();
+  m_pingTimer.start(Constants::BENCHMARK_PROBE_INTERVAL_MSEC);
+  sendPing();
+}
+
+void BenchmarkLatencyProbe::stop() {
+  if (!m_pingSender) {
+    return;
+  }
+
+  logger.debug() << "Probe stopped. Idle:" << idleMsec() << "msec,"
+                 << idleCount() << "replies. Loaded:" << loadedMsec()
+                 << "msec," << loadedCount() << "replies";
+
+  m_pingTimer.stop();
+  m_pendingPings.clear();
+
+  delete m_pingSender;
+  m_pingSender = nullptr;
+}
+
+void BenchmarkLatencyProbe::sendPing() {
+  Q_ASSERT(m_pingSender);
+
+  qint64 now = m_elapsedTimer.elapsed();
+
+  // Forget the lost pings.
+  for (auto i = m_pendingPings.begin(); i != m_pendingPings.end();) {
+    if (now - i.value().m_sentMsec > PING_TIMEOUT_MSEC) {
+      i = m_pendingPings.erase(i);
+    } else {
+      ++i;
+    }
+  }
+
+  // Some senders reply synchronously.
+  quint16 sequence = m_sequence++;
+  m_pendingPings.insert(sequence, PendingPing{now, m_loaded});
+  m_pingSender->sendPing(m_destination, sequence);
+}
+
+void BenchmarkLatencyProbe::pingReceived(quint16 sequence) {
+  auto i = m_pendingPings.find(sequence);
+  if (i == m_pendingPings.end()) {
+    return;
+  }
+
+  qint64 rtt = m_elapsedTimer.elapsed() - i.value().m_sentMsec;
+  if (i.value().m_loaded) {
+    m_loadedRtts.append(rtt);
+  } else {
+    m_idleRtts.append(rtt);
+  }
+
+  m_pendingPings.erase(i);
+}
+
+// static
+uint BenchmarkLatencyProbe::medianMsec(QList<qint64> rtts) {
+  if (rtts.isEmpty()) {
+    return 0;
+  }
+
+  auto middle = rtts.begin() + rtts.count() / 2;
+  std::nth_element(rtts.begin(), middle, rtts.end());
+  return static_cast<uint>(*middle);
+}
@@ -0,0 +1,71 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BENCHMARKLATENCYPROBE_H
+#define BENCHMARKLATENCYPROBE_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+
+class PingSender;
+
+// Pings a host at a fast pace while the connection benchmark runs. The round
+// trip times are split between the idle phase and the loaded phase, when the
+// transfers are saturating the link, to measure the latency inflation caused
+// by oversized buffers along the path.
+class BenchmarkLatencyProbe final : public QObject {
+  Q_OBJECT
+  Q_DISABLE_COPY_MOVE(BenchmarkLatencyProbe)
+
+ public:
+  BenchmarkLatencyProbe();
+  ~BenchmarkLatencyProbe();
+
+  // With `dnsPing`, the probes are DNS queries instead of ICMP echo requests.
+  void start(const QHostAddress& destination, const QHostAddress& source,
+             bool dnsPing = false);
+  void stop();
+  bool isActive() const { return m_pingSender != nullptr; }
+
+  // The next pings are part of the loaded phase.
+  void setLoaded(bool loaded) { m_loaded = loaded; }
+
+  int idleCount() const { return m_idleRtts.count(); }
+  int loadedCount() const { return m_loadedRtts.count(); }
+
+  // Median round trip times, in msecs.
+  uint idleMsec() const { return medianMsec(m_idleRtts); }
+  uint loadedMsec() const { return medianMsec(m_loadedRtts); }
+
+  // 0 without samples.
+  static uint medianMsec(QList<qint64> rtts);
+
+ private:
+  void sendPing();
+  void pingReceived(quint16 sequence);
+
+ private:
+  struct PendingPing {
+    qint64 m_sentMsec;
+    bool m_loaded;
+  };
+
+  QHostAddress m_destination;
+  PingSender* m_pingSender = nullptr;
+
+  QTimer m_pingTimer;
+  QElapsedTimer m_elapsedTimer;
+  quint16 m_sequence = 0;
+  bool m_loaded = false;
+
+  QHash<quint16, PendingPing> m_pendingPings;
+  QList<qint64> m_idleRtts;
+  QList<qint64> m_loadedRtts;
+};
+
+#endif  // BENCHMARKLATENCYPROBE_H
@@ -14,27 +14,35 @@
 #include <QHostAddress>
 #include <QScopeGuard>
 
+#include <algorithm>
+
 #if !defined(MVPN_DUMMY) && !defined(MVPN_ANDROID) && !defined(MVPN_WASM)
 constexpr const char* MULLVAD_DEFAULT_DNS = "10.64.0.1";
 #endif
 
 namespace {
 Logger logger(LOG_MAIN, "BenchmarkTaskTransfer");
-}
+
+// With fewer samples, the throughput is the average of the whole transfer.
+constexpr int MIN_SAMPLES = 3;
+}  // namespace
 
 BenchmarkTaskTransfer::BenchmarkTaskTransfer(const QString& name,
                                              BenchmarkType type,
-                                             const QUrl& url)
+                                             const QUrl& url, int streams)
     : BenchmarkTask(name, Constants::BENCHMARK_MAX_DURATION_TRANSFER),
       m_type(type),
       m_dnsLookup(QDnsLookup::A, url.host()),
-      m_url(url) {
+      m_url(url),
+      m_streams(std::max(1, streams)) {
   MVPN_COUNT_CTOR(BenchmarkTaskTransfer);
 
   connect(this, &BenchmarkTask::stateChanged, this,
           &BenchmarkTaskTransfer::handleState);
   connect(&m_dnsLookup, &QDnsLookup::finished, this,
           &BenchmarkTaskTransfer::dnsLookupFinished);
+  connect(&m_sampleTimer, &QTimer::timeout, this,
+          &BenchmarkTaskTransfer::sample);
 }
 
 BenchmarkTaskTransfer::~BenchmarkTaskTransfer() {
@@ -45,9 +53,17 @@ void BenchmarkTaskTransfer::handleState(BenchmarkTask::State state) {
   logger.debug() << "Handle state" << state;
 
   if (state == BenchmarkTask::StateActive) {
+    QHostAddress address(m_url.host());
+
 #if defined(MVPN_DUMMY) || defined(MVPN_ANDROID) || defined(MVPN_WASM)
-    createNetworkRequest();
+    createNetworkRequests({address});
 #else
+    if (!address.isNull()) {
+      // No need to resolve an IP address.
+      createNetworkRequests({address});
+      return;
+    }
+
     // Start DNS resolution
     m_dnsLookup.setNameserver(QHostAddress(MULLVAD_DEFAULT_DNS));
     m_dnsLookup.lookup();
@@ -56,75 +72,73 @@ void BenchmarkTaskTransfer::handleState(BenchmarkTask::State state) {
 #if QT_VERSION >= 0x060500
 #  error Check if QT added support for QDnsLookup::lookup() on Android
 #endif
-
-    m_elapsedTimer.start();
   } else if (state == BenchmarkTask::StateInactive) {
-    for (NetworkRequest* request : m_requests) {
+    m_sampleTimer.stop();
+    m_dnsLookup.abort();
+
+    // Aborting a request completes it: let's not iterate over m_requests.
+    const QList<NetworkRequest*> requests = m_requests;
+    for (NetworkRequest* request : requests) {
       request->abort();
     }
-    m_requests.clear();
-    m_dnsLookup.abort();
   }
 }
 
-void BenchmarkTaskTransfer::createNetworkRequest() {
-  logger.debug() << "Create network request";
-
-  NetworkRequest* request = nullptr;
-  switch (m_type) {
-    case BenchmarkDownload: {
-      request = NetworkRequest::createForGetUrl(this, m_url.toString());
-      break;
+void BenchmarkTaskTransfer::createNetworkRequests(
+    const QList<QHostAddress>& addresses) {
+  Q_ASSERT(!addresses.isEmpty());
+
+  logger.debug() << "Create" << m_streams << "network requests";
+
+  // The streams are spread over the addresses, and every address is used.
+  int count = std::max(m_streams, static_cast<int>(addresses.count()));
+  for (int i = 0; i < count; ++i) {
+    NetworkRequest* request = createNetworkRequest(addresses.at(
+        i % addresses.count()));
+    if (!request) {
+      m_finished = true;
+      emit finished(0, true);
+      emit completed();
+      return;
     }
-    case BenchmarkUpload: {
-      UploadDataGenerator* uploadData =
-          new UploadDataGenerator(Constants::BENCHMARK_MAX_BITS_UPLOAD);
 
-      if (!uploadData->open(UploadDataGenerator::ReadOnly)) {
-        emit finished(0, true);
-        emit completed();
-      };
-      request = NetworkRequest::createForUploadData(this, m_url.toString(),
-                                                    uploadData);
-      break;
-    }
+    connectNetworkRequest(request);
   }
 
-  Q_ASSERT(request);
-  connectNetworkRequest(request);
+  m_elapsedTimer.start();
+  m_sampleTimer.start(Constants::BENCHMARK_SAMPLE_INTERVAL_MSEC);
 }
 
-void BenchmarkTaskTransfer::createNetworkRequestWithRecord(
-    const QDnsHostAddressRecord& record) {
-  logger.debug() << "Create network request with record";
-
-  NetworkRequest* request = nullptr;
+NetworkRequest* BenchmarkTaskTransfer::createNetworkRequest(
+    const QHostAddress& address) {
   switch (m_type) {
     case BenchmarkDownload: {
-      request = NetworkRequest::createForGetHostAddress(this, m_url.toString(),
-                                                        record.value());
-      break;
+      if (address.isNull()) {
+        return NetworkRequest::createForGetUrl(this, m_url.toString());
+      }
+      return NetworkRequest::createForGetHostAddress(this, m_url.toString(),
+                                                     address);
     }
     case BenchmarkUpload: {
       UploadDataGenerator* uploadData =
-          new UploadDataGenerator(Constants::BENCHMARK_MAX_BITS_UPLOAD);
+          new UploadDataGenerator(Constants::BENCHMARK_MAX_BITS_UPLOAD / 8);
 
       if (!uploadData->open(UploadDataGenerator::ReadOnly)) {
-        emit finished(0, true);
-        emit completed();
-      };
-      request = NetworkRequest::createForUploadDataHostAddress(
-          this, m_url.toString(), uploadData, record.value());
-      break;
-    }
-    default: {
-      logger.error() << "Unhandled benchmark type";
-      break;
+        delete uploadData;
+        return nullptr;
+      }
+
+      if (address.isNull()) {
+        return NetworkRequest::createForUploadData(this, m_url.toString(),
+                                                   uploadData);
+      }
+      return NetworkRequest::createForUploadDataHostAddress(
+          this, m_url.toString(), uploadData, address);
     }
   }
 
-  Q_ASSERT(request);
-  connectNetworkRequest(request);
+  Q_ASSERT(false);
+  return nullptr;
 }
 
 void BenchmarkTaskTransfer::connectNetworkRequest(NetworkRequest* request) {
@@ -133,24 +147,27 @@ void BenchmarkTaskTransfer::connectNetworkRequest(NetworkRequest* request) {
   switch (m_type) {
     case BenchmarkDownload: {
       connect(request, &NetworkRequest::requestUpdated, this,
-              &BenchmarkTaskTransfer::transferProgressed);
+              [this, request](qint64 bytesReceived, qint64, QNetworkReply* r) {
+                transferProgressed(request, bytesReceived, r);
+              });
       break;
     }
     case BenchmarkUpload: {
       connect(request, &NetworkRequest::uploadProgressed, this,
-              &BenchmarkTaskTransfer::transferProgressed);
-      break;
-    }
-    default: {
-      logger.error() << "Unhandled benchmark type";
+              [this, request](qint64 bytesSent, qint64, QNetworkReply* r) {
+                transferProgressed(request, bytesSent, r);
+              });
       break;
     }
   }
   connect(request, &NetworkRequest::requestFailed, this,
-          &BenchmarkTaskTransfer::transferReady);
+          [this, request](QNetworkReply::NetworkError error,
+                          const QByteArray&) {
+            transferReady(request, error);
+          });
   connect(request, &NetworkRequest::requestCompleted, this,
-          [&](const QByteArray& data) {
-            transferReady(QNetworkReply::NoError, data);
+          [this, request](const QByteArray&) {
+            transferReady(request, QNetworkReply::NoError);
           });
 
   logger.debug() << "Starting request";
@@ -177,72 +194,91 @@ void BenchmarkTaskTransfer::dnsLookupFinished() {
   }
 
   logger.debug() << "DNS Lookup Finished";
+  QList<QHostAddress> addresses;
   for (const QDnsHostAddressRecord& record : m_dnsLookup.hostAddressRecords()) {
     logger.debug() << "Host record:" << record.value().toString();
-    createNetworkRequestWithRecord(record);
+    addresses.append(record.value());
   }
 
-  m_elapsedTimer.start();
   guard.dismiss();
+  createNetworkRequests(addresses);
 }
 
-void BenchmarkTaskTransfer::transferProgressed(qint64 bytesSent,
-                                               qint64 bytesTotal,
+void BenchmarkTaskTransfer::transferProgressed(NetworkRequest* request,
+                                               qint64 bytesTransferred,
                                                QNetworkReply* reply) {
 #ifdef MVPN_DEBUG
-  logger.debug() << "Transfer progressed:" << bytesSent << "(transferred)"
-                 << bytesTotal << "(total)";
-#else
-  Q_UNUSED(bytesTotal);
+  logger.debug() << "Transfer progressed:" << bytesTransferred;
 #endif
 
   switch (m_type) {
     case BenchmarkDownload: {
       // Count and discard downloaded data
-      m_bytesTransferred += reply->skip(bytesTotal);
+      m_bytesTransferred += reply->skip(reply->bytesAvailable());
       break;
     }
     case BenchmarkUpload: {
-      Q_UNUSED(reply);
-      if (bytesSent > 0) {
-        m_bytesTransferred = bytesSent;
+      if (bytesTransferred > 0) {
+        qint64& uploaded = m_bytesUploaded[request];
+        m_bytesTransferred += bytesTransferred - uploaded;
+        uploaded = bytesTransferred;
       }
       break;
     }
-    default: {
-      logger.error() << "Unhandled benchmark type";
-      break;
-    }
   }
 }
 
-void BenchmarkTaskTransfer::transferReady(QNetworkReply::NetworkError error,
-                                          const QByteArray& data) {
-  logger.debug() << "Transfer ready" << error;
-  Q_UNUSED(data);
+void BenchmarkTaskTransfer::sample() {
+  m_throughput.addSample(m_elapsedTimer.elapsed(), m_bytesTransferred);
+}
 
-  NetworkRequest* request = qobject_cast<NetworkRequest*>(QObject::sender());
-  m_requests.removeOne(request);
+quint64 BenchmarkTaskTransfer::bitsPerSec() const {
+  if (m_throughput.count() >= MIN_SAMPLES) {
+    return m_throughput.percentileBps(50);
+  }
 
-  quint64 bitsPerSec = 0;
   double msecs = static_cast<double>(m_elapsedTimer.elapsed());
-  if (m_bytesTransferred > 0 && msecs > 0) {
-    bitsPerSec = static_cast<quint64>(
-        static_cast<double>(m_bytesTransferred * 8) / (msecs / 1000.00));
+  if (m_bytesTransferred <= 0 || msecs <= 0) {
+    return 0;
+  }
+
+  return static_cast<quint64>(static_cast<double>(m_bytesTransferred * 8) /
+                              (msecs / 1000.00));
+}
+
+void BenchmarkTaskTransfer::transferReady(NetworkRequest* request,
+                                          QNetworkReply::NetworkError error) {
+  logger.debug() << "Transfer ready" << error;
+
+  if (!m_requests.removeOne(request)) {
+    return;
+  }
+
+  if (error != QNetworkReply::NoError &&
+      error != QNetworkReply::OperationCanceledError &&
+      error != QNetworkReply::TimeoutError) {
+    m_hasUnexpectedError = true;
+  }
+
+  if (!m_requests.isEmpty() || m_finished) {
+    return;
   }
 
-  bool hasUnexpectedError = (error != QNetworkReply::NoError &&
-                             error != QNetworkReply::OperationCanceledError &&
-                             error != QNetworkReply::TimeoutError)
+  m_finished = true;
+  m_sampleTimer.stop();
+
+  quint64 bps = bitsPerSec();
+  logger.debug() << "Transfer completed" << bps << "bps with" << m_streams
+                 << "streams. p10:" << m_throughput.percentileBps(10)
+                 << "p90:" << m_throughput.percentileBps(90)
+                 << "ramp-up:" << m_throughput.rampUpMsec() << "msec";
+
+  bool hasUnexpectedError = m_hasUnexpectedError
 #ifndef MVPN_WASM
-                            || bitsPerSec == 0
+                            || bps == 0
 #endif
       ;
 
-  logger.debug() << "Transfer completed" << bitsPerSec << "baud";
-
-  if (m_requests.isEmpty()) {
-    emit finished(bitsPerSec, hasUnexpectedError);
-    emit completed();
-  }
+  emit finished(bps, hasUnexpectedError);
+  emit completed();
 }
@@ -6,14 +6,20 @@
 #define BENCHMARKTASKTRANSFER_H
 
 #include "benchmarktask.h"
+#include "benchmarkthroughput.h"
 
 #include <QDnsLookup>
 #include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
 #include <QNetworkReply>
+#include <QTimer>
 #include <QUrl>
 
 class NetworkRequest;
 
+// Downloads or uploads data with `streams` parallel requests, spread over the
+// addresses of the host, and samples the aggregated throughput.
 class BenchmarkTaskTransfer : public BenchmarkTask {
   Q_OBJECT
   Q_DISABLE_COPY_MOVE(BenchmarkTaskTransfer)
@@ -26,30 +32,45 @@ class BenchmarkTaskTransfer : public BenchmarkTask {
   };
 
   explicit BenchmarkTaskTransfer(const QString& name, BenchmarkType type,
-                                 const QUrl& url);
+                                 const QUrl& url, int streams);
   virtual ~BenchmarkTaskTransfer();
 
+  const BenchmarkThroughput& throughput() const { return m_throughput; }
+
  signals:
+  // `bitsPerSec` is the median throughput after the ramp-up.
   void finished(quint64 bitsPerSec, bool hasUnexpectedError);
 
  private:
-  void createNetworkRequest();
-  void createNetworkRequestWithRecord(const QDnsHostAddressRecord& record);
+  void createNetworkRequests(const QList<QHostAddress>& addresses);
+  NetworkRequest* createNetworkRequest(const QHostAddress& address);
   void connectNetworkRequest(NetworkRequest* request);
   void dnsLookupFinished();
   void handleState(BenchmarkTask::State state);
-  void transferProgressed(qint64 bytesTransferred, qint64 bytesTotal,
+  void transferProgressed(NetworkRequest* request, qint64 bytesTransferred,
                           QNetworkReply* reply);
-  void transferReady(QNetworkReply::NetworkError error, const QByteArray& data);
+  void transferReady(NetworkRequest* request,
+                     QNetworkReply::NetworkError error);
+  void sample();
+  quint64 bitsPerSec() const;
 
  private:
   BenchmarkType m_type;
   QDnsLookup m_dnsLookup;
   QList<NetworkRequest*> m_requests;
   const QUrl m_url;
+  const int m_streams;
 
   qint64 m_bytesTransferred = 0;
+  // Upload progress is reported per request, as a total.
+  QHash<NetworkRequest*, qint64> m_bytesUploaded;
+
+  bool m_hasUnexpectedError = false;
+  bool m_finished = false;
+
   QElapsedTimer m_elapsedTimer;
+  QTimer m_sampleTimer;
+  BenchmarkThroughput m_throughput;
 };
 
 #endif  // BENCHMARKTASKTRANSFER_H
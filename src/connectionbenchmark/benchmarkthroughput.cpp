@@ -0,0 +1,79 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "benchmarkthroughput.h"
+
+#include <algorithm>
+
+namespace {
+// The peak is the 90th percentile of all the samples: a single burst does
+// not count.
+constexpr int PEAK_PERCENTILE = 90;
+
+// The ramp-up is over at 80% of the peak.
+constexpr double RAMP_UP_RATIO = 0.8;
+
+quint64 percentileOf(QList<quint64>& values, int percentile) {
+  if (values.isEmpty()) {
+    return 0;
+  }
+
+  std::sort(values.begin(), values.end());
+
+  // Nearest rank: ceil(percentile / 100 * count), 1-based.
+  int rank = (percentile * values.count() + 99) / 100;
+  return values.at(std::clamp(rank, 1, static_cast<int>(values.count())) - 1);
+}
+}  // namespace
+
+void BenchmarkThroughput::addSample(qint64 msec, qint64 totalBytes) {
+  qint64 intervalMsec = msec - m_lastMsec;
+  if (intervalMsec <= 0) {
+    return;
+  }
+
+  qint64 bytes = std::max(qint64(0), totalBytes - m_lastBytes);
+  m_samples.append(
+      Sample{msec, static_cast<quint64>(bytes * 8 * 1000 / intervalMsec)});
+
+  m_lastMsec = msec;
+  m_lastBytes = totalBytes;
+}
+
+int BenchmarkThroughput::rampUpIndex() const {
+  QList<quint64> values;
+  values.reserve(m_samples.count());
+  for (const Sample& sample : m_samples) {
+    values.append(sample.m_bitsPerSec);
+  }
+
+  quint64 threshold = static_cast<quint64>(
+      percentileOf(values, PEAK_PERCENTILE) * RAMP_UP_RATIO);
+
+  for (int i = 0; i < m_samples.count(); ++i) {
+    if (m_samples.at(i).m_bitsPerSec >= threshold) {
+      return i;
+    }
+  }
+
+  return 0;
+}
+
+qint64 BenchmarkThroughput::rampUpMsec() const {
+  if (m_samples.isEmpty()) {
+    return -1;
+  }
+
+  int index = rampUpIndex();
+  return index == 0 ? 0 : m_samples.at(index - 1).m_msec;
+}
+
+quint64 BenchmarkThroughput::percentileBps(int percentile) const {
+  QList<quint64> values;
+  for (int i = rampUpIndex(); i < m_samples.count(); ++i) {
+    values.append(m_samples.at(i).m_bitsPerSec);
+  }
+
+  return percentileOf(values, percentile);
+}
@@ -0,0 +1,40 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BENCHMARKTHROUGHPUT_H
+#define BENCHMARKTHROUGHPUT_H
+
+#include <QList>
+
+// Throughput of a transfer, sampled at regular intervals. The first samples,
+// while TCP is ramping up, are not part of the percentiles.
+class BenchmarkThroughput final {
+ public:
+  // `totalBytes` have been transferred `msec` after the start.
+  void addSample(qint64 msec, qint64 totalBytes);
+
+  int count() const { return m_samples.count(); }
+
+  // Time needed to reach 80% of the peak throughput, or -1 without samples.
+  qint64 rampUpMsec() const;
+
+  // Nearest-rank percentile of the samples after the ramp-up, in bits per
+  // second. 0 without samples.
+  quint64 percentileBps(int percentile) const;
+
+ private:
+  struct Sample {
+    qint64 m_msec;
+    quint64 m_bitsPerSec;
+  };
+
+  int rampUpIndex() const;
+
+ private:
+  QList<Sample> m_samples;
+  qint64 m_lastMsec = 0;
+  qint64 m_lastBytes = 0;
+};
+
+#endif  // BENCHMARKTHROUGHPUT_H
@@ -5,6 +5,7 @@
 #include "connectionbenchmark.h"
 #include "benchmarktaskping.h"
 #include "benchmarktasktransfer.h"
+#include "benchmarkthroughput.h"
 #include "connectionhealth.h"
 #include "controller.h"
 #include "leakdetector.h"
@@ -13,6 +14,8 @@
 #include "mozillavpn.h"
 #include "taskscheduler.h"
 
+#include <algorithm>
+
 namespace {
 Logger logger(LOG_MODEL, "ConnectionBenchmark");
 }
@@ -40,7 +43,8 @@ void ConnectionBenchmark::initialize() {
 void ConnectionBenchmark::setConnectionSpeed() {
   logger.debug() << "Set connection speed";
 
-  // TODO: Take uploadBps for calculating speed into account
+  setLatencyUnderLoad();
+
   if (m_downloadBps >= Constants::BENCHMARK_THRESHOLD_SPEED_FAST) {
     m_speed = SpeedFast;
   } else if (m_downloadBps >= Constants::BENCHMARK_THRESHOLD_SPEED_MEDIUM) {
@@ -49,14 +53,112 @@ void ConnectionBenchmark::setConnectionSpeed() {
     m_speed = SpeedSlow;
   }
 
+  // A connection is as fast as its slowest direction.
+  if (Feature::get(Feature::Feature_benchmarkUpload)->isSupported()) {
+    Speed uploadSpeed = SpeedSlow;
+    if (m_uploadBps >= Constants::BENCHMARK_THRESHOLD_UPLOAD_FAST) {
+      uploadSpeed = SpeedFast;
+    } else if (m_uploadBps >= Constants::BENCHMARK_THRESHOLD_UPLOAD_MEDIUM) {
+      uploadSpeed = SpeedMedium;
+    }
+    m_speed = std::min(m_speed, uploadSpeed);
+  }
+
   emit speedChanged();
   setState(StateReady);
 }
 
+void ConnectionBenchmark::setStreams(int streams) {
+  streams = std::clamp(streams, 1, Constants::BENCHMARK_MAX_STREAMS);
+  if (m_streams == streams) {
+    return;
+  }
+
+  m_streams = streams;
+  emit streamsChanged();
+}
+
+void ConnectionBenchmark::setThroughput(const QString& key,
+                                        const BenchmarkThroughput& throughput) {
+  QVariantMap map;
+  map["p10"] = throughput.percentileBps(10);
+  map["p50"] = throughput.percentileBps(50);
+  map["p90"] = throughput.percentileBps(90);
+  map["rampUpMsec"] = throughput.rampUpMsec();
+  map["samples"] = throughput.count();
+
+  m_throughput[key] = map;
+  emit throughputChanged();
+}
+
+void ConnectionBenchmark::startLatencyProbe() {
+  // The address of a stand-in server, answering DNS pings, can be set for
+  // tests.
+  QString address =
+      Constants::envOrDefault("MVPN_BENCHMARK_PING_ADDRESS", QString());
+  if (!address.isEmpty()) {
+    m_latencyProbe.start(QHostAddress(address), QHostAddress(), true);
+    return;
+  }
+
+  ConnectionHealth* connectionHealth =
+      MozillaVPN::instance()->connectionHealth();
+  if (connectionHealth->currentGateway().isEmpty()) {
+    logger.warning() << "No gateway to measure the latency under load";
+    return;
+  }
+
+  m_latencyProbe.start(
+      QHostAddress(connectionHealth->currentGateway()),
+      QHostAddress(connectionHealth->deviceAddress().section('/', 0, 0)));
+}
+
+void ConnectionBenchmark::setLatencyUnderLoad() {
+  m_latencyProbe.stop();
+
+  m_loadedLatency = 0;
+  m_latencyInflation = 0;
+  m_latencyGrade = GradeUnknown;
+
+  if (m_latencyProbe.loadedCount() > 0) {
+    // The idle latency is measured by the probe too, on the same path. If the
+    // transfers started before any reply, the ping benchmark is used instead.
+    uint idleLatency = m_latencyProbe.idleCount() > 0
+                           ? m_latencyProbe.idleMsec()
+                           : m_pingLatency;
+    uint loadedLatency = m_latencyProbe.loadedMsec();
+    uint inflation = loadedLatency > idleLatency ? loadedLatency - idleLatency
+                                                 : 0;
+
+    m_loadedLatency = std::min<uint>(loadedLatency, UINT16_MAX);
+    m_latencyInflation = std::min<uint>(inflation, UINT16_MAX);
+
+    if (inflation < Constants::BENCHMARK_INFLATION_GRADE_A) {
+      m_latencyGrade = GradeA;
+    } else if (inflation < Constants::BENCHMARK_INFLATION_GRADE_B) {
+      m_latencyGrade = GradeB;
+    } else if (inflation < Constants::BENCHMARK_INFLATION_GRADE_C) {
+      m_latencyGrade = GradeC;
+    } else if (inflation < Constants::BENCHMARK_INFLATION_GRADE_D) {
+      m_latencyGrade = GradeD;
+    } else {
+      m_latencyGrade = GradeF;
+    }
+  }
+
+  logger.debug() << "Latency under load" << m_loadedLatency << "inflation"
+                 << m_latencyInflation << "grade" << m_latencyGrade;
+  emit latencyUnderLoadChanged();
+}
+
 void ConnectionBenchmark::setState(State state) {
   logger.debug() << "Set state" << state;
   m_state = state;
 
+  if (m_state != StateRunning) {
+    m_latencyProbe.stop();
+  }
+
   emit stateChanged();
 }
 
@@ -73,6 +175,10 @@ void ConnectionBenchmark::start() {
 
   setState(StateRunning);
 
+  // The probe runs during the whole benchmark: the pings sent before the
+  // transfers measure the idle latency.
+  startLatencyProbe();
+
   // Create ping benchmark
   BenchmarkTaskPing* pingTask = new BenchmarkTaskPing();
   connect(pingTask, &BenchmarkTaskPing::finished, this,
@@ -85,9 +191,18 @@ void ConnectionBenchmark::start() {
   // Create download benchmark
   BenchmarkTaskTransfer* downloadTask = new BenchmarkTaskTransfer(
       "BenchmarkTaskDownload", BenchmarkTaskTransfer::BenchmarkDownload,
-      m_downloadUrl);
+      m_downloadUrl, m_streams);
   connect(downloadTask, &BenchmarkTaskTransfer::finished, this,
-          &ConnectionBenchmark::downloadBenchmarked);
+          [this, downloadTask](quint64 bitsPerSec, bool hasUnexpectedError) {
+            setThroughput("download", downloadTask->throughput());
+            downloadBenchmarked(bitsPerSec, hasUnexpectedError);
+          });
+  connect(downloadTask, &BenchmarkTask::stateChanged, this,
+          [this](BenchmarkTask::State state) {
+            if (state == BenchmarkTask::StateActive) {
+              m_latencyProbe.setLoaded(true);
+            }
+          });
   connect(downloadTask->sentinel(), &BenchmarkTaskSentinel::sentinelDestroyed,
           this,
           [this, downloadTask]() { m_benchmarkTasks.removeOne(downloadTask); });
@@ -98,11 +213,13 @@ void ConnectionBenchmark::start() {
   if (Feature::get(Feature::Feature_benchmarkUpload)->isSupported()) {
     BenchmarkTaskTransfer* uploadTask = new BenchmarkTaskTransfer(
         "BenchmarkTaskUpload", BenchmarkTaskTransfer::BenchmarkUpload,
-        m_uploadUrl);
-    Q_UNUSED(uploadTask);
+        m_uploadUrl, m_streams);
 
     connect(uploadTask, &BenchmarkTaskTransfer::finished, this,
-            &ConnectionBenchmark::uploadBenchmarked);
+            [this, uploadTask](quint64 bitsPerSec, bool hasUnexpectedError) {
+              setThroughput("upload", uploadTask->throughput());
+              uploadBenchmarked(bitsPerSec, hasUnexpectedError);
+            });
     connect(uploadTask->sentinel(), &BenchmarkTask::destroyed, this,
             [this, uploadTask]() { m_benchmarkTasks.removeOne(uploadTask); });
     m_benchmarkTasks.append(uploadTask);
@@ -134,6 +251,13 @@ void ConnectionBenchmark::reset() {
   m_downloadBps = 0;
   m_uploadBps = 0;
   m_pingLatency = 0;
+  m_throughput.clear();
+  emit throughputChanged();
+
+  m_loadedLatency = 0;
+  m_latencyInflation = 0;
+  m_latencyGrade = GradeUnknown;
+  emit latencyUnderLoadChanged();
 
   setState(StateInitial);
 }
@@ -5,13 +5,16 @@
 #ifndef CONNECTIONBENCHMARK_H
 #define CONNECTIONBENCHMARK_H
 
+#include "benchmarklatencyprobe.h"
 #include "benchmarktask.h"
 #include "constants.h"
 
 #include <QList>
 #include <QObject>
 #include <QUrl>
+#include <QVariantMap>
 
+class BenchmarkThroughput;
 class ConnectionHealth;
 
 class ConnectionBenchmark final : public QObject {
@@ -27,6 +30,14 @@ class ConnectionBenchmark final : public QObject {
   Q_PROPERTY(quint64 downloadBps READ downloadBps NOTIFY downloadBpsChanged);
   Q_PROPERTY(quint16 pingLatency READ pingLatency NOTIFY pingLatencyChanged);
   Q_PROPERTY(quint64 uploadBps READ uploadBps NOTIFY uploadBpsChanged);
+  Q_PROPERTY(int streams READ streams WRITE setStreams NOTIFY streamsChanged)
+  Q_PROPERTY(QVariantMap throughput READ throughput NOTIFY throughputChanged)
+  Q_PROPERTY(quint16 loadedLatency READ loadedLatency NOTIFY
+                 latencyUnderLoadChanged)
+  Q_PROPERTY(quint16 latencyInflation READ latencyInflation NOTIFY
+                 latencyUnderLoadChanged)
+  Q_PROPERTY(LatencyGrade latencyGrade READ latencyGrade NOTIFY
+                 latencyUnderLoadChanged)
 
  public:
   ConnectionBenchmark();
@@ -52,11 +63,33 @@ class ConnectionBenchmark final : public QObject {
   };
   Q_ENUM(Speed);
 
+  // How much the latency grows while the link is saturated. A bad grade means
+  // that a queue along the path, often the local router, adds delay.
+  enum LatencyGrade {
+    GradeUnknown,
+    GradeA,
+    GradeB,
+    GradeC,
+    GradeD,
+    GradeF,
+  };
+  Q_ENUM(LatencyGrade);
+
   State state() const { return m_state; }
   Speed speed() const { return m_speed; }
   quint16 pingLatency() const { return m_pingLatency; }
   quint64 downloadBps() const { return m_downloadBps; }
   quint64 uploadBps() const { return m_uploadBps; }
+  quint16 loadedLatency() const { return m_loadedLatency; }
+  quint16 latencyInflation() const { return m_latencyInflation; }
+  LatencyGrade latencyGrade() const { return m_latencyGrade; }
+
+  // The throughput percentiles and the ramp-up time of the last run, keyed by
+  // "download" and "upload".
+  const QVariantMap& throughput() const { return m_throughput; }
+
+  int streams() const { return m_streams; }
+  void setStreams(int streams);
 
   QString downloadUrl() const { return m_downloadUrl.toString(); }
   void setDownloadUrl(QString url) {
@@ -78,6 +111,9 @@ class ConnectionBenchmark final : public QObject {
   void stateChanged();
   void downloadUrlChanged();
   void uploadUrlChanged();
+  void streamsChanged();
+  void throughputChanged();
+  void latencyUnderLoadChanged();
 
  private:
   void downloadBenchmarked(quint64 bitsPerSec, bool hasUnexpectedError);
@@ -86,6 +122,10 @@ class ConnectionBenchmark final : public QObject {
 
   void handleControllerState();
   void handleStabilityChange();
+  void setThroughput(const QString& key,
+                     const BenchmarkThroughput& throughput);
+  void startLatencyProbe();
+  void setLatencyUnderLoad();
   void setConnectionSpeed();
   void setState(State state);
   void stop();
@@ -95,6 +135,7 @@ class ConnectionBenchmark final : public QObject {
   QUrl m_uploadUrl = QUrl(Constants::benchmarkUploadUrl());
 
   QList<BenchmarkTask*> m_benchmarkTasks;
+  int m_streams = Constants::BENCHMARK_DEFAULT_STREAMS;
 
   State m_state = StateInitial;
   Speed m_speed = SpeedSlow;
@@ -102,6 +143,12 @@ class ConnectionBenchmark final : public QObject {
   quint64 m_downloadBps = 0;
   quint16 m_pingLatency = 0;
   quint64 m_uploadBps = 0;
+  QVariantMap m_throughput;
+
+  BenchmarkLatencyProbe m_latencyProbe;
+  quint16 m_loadedLatency = 0;
+  quint16 m_latencyInflation = 0;
+  LatencyGrade m_latencyGrade = GradeUnknown;
 };
 
 #endif  // CONNECTIONBENCHMARK_H
@@ -6,44 +6,33 @@
 #include "leakdetector.h"
 #include "logger.h"
 
-#include <QBuffer>
-#include <QRandomGenerator>
-
 namespace {
 Logger logger(LOG_MAIN, "UploadDataGenerator");
-}
 
-UploadDataGenerator::UploadDataGenerator(const qint64 totalSize)
-    : m_totalSize(totalSize) {
+// The zeros shared by the generators alive. Released with the last one.
+QByteArray s_payload;
+int s_generators = 0;
+}  // namespace
+
+UploadDataGenerator::UploadDataGenerator(const qint64 totalSize) {
   MVPN_COUNT_CTOR(UploadDataGenerator);
 
-  memset(m_dataBuffer, 0x00, sizeof(m_dataBuffer));
+  if (s_payload.size() < totalSize) {
+    logger.debug() << "Allocate upload payload" << totalSize;
+    s_payload = QByteArray(totalSize, 0x00);
+  }
+
+  ++s_generators;
+
+  // Implicitly shared: no copies.
+  setData(s_payload.left(totalSize));
 }
 
 UploadDataGenerator::~UploadDataGenerator() {
   MVPN_COUNT_DTOR(UploadDataGenerator);
-}
 
-qint64 UploadDataGenerator::readData(char* data, qint64 maxSize) {
-  qint64 maxBufferSize = qMin(MAX_BUFFER_SIZE, maxSize);
-  qint64 maxReadSize = qMin(m_totalSize - pos(), maxBufferSize);
-
-#ifdef MVPN_DEBUG
-  logger.debug() << "Read data" << maxReadSize;
-#endif
-
-  if (maxReadSize < 0) {
-    return -1;
+  Q_ASSERT(s_generators > 0);
+  if (--s_generators == 0) {
+    s_payload.clear();
   }
-
-  memcpy(data, m_dataBuffer, maxReadSize);
-  return maxReadSize;
-};
-
-qint64 UploadDataGenerator::writeData(const char* data, qint64 maxSize) {
-  logger.debug() << "Write data";
-  Q_UNUSED(data);
-  Q_UNUSED(maxSize);
-
-  return -1;
-};
+}
@@ -5,27 +5,18 @@
 #ifndef UPLOADDATAGENERATOR_H
 #define UPLOADDATAGENERATOR_H
 
-#include <QIODevice>
+#include <QBuffer>
 
-constexpr int32_t MAX_BUFFER_SIZE = 4096;
-
-class UploadDataGenerator final : public QIODevice {
+// A zero-filled upload payload. All the generators share the same buffer,
+// and QNetworkAccessManager sends the content of a QBuffer in place, without
+// reading it chunk by chunk: the payload is never copied.
+class UploadDataGenerator final : public QBuffer {
   Q_OBJECT
   Q_DISABLE_COPY_MOVE(UploadDataGenerator)
 
  public:
   explicit UploadDataGenerator(const qint64 totalSize);
   ~UploadDataGenerator();
-
-  qint64 size() const override { return m_totalSize; }
-
- private:
-  virtual qint64 readData(char* data, qint64 maxSize) override;
-  virtual qint64 writeData(const char* data, qint64 maxSize) override;
-
- private:
-  const qint64 m_totalSize;
-  char m_dataBuffer[MAX_BUFFER_SIZE];
 };
 
 #endif  // UPLOADDATAGENERATOR_H
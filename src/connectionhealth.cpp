@@ -47,12 +47,12 @@ ConnectionHealth::ConnectionHealth() : m_dnsPingSender(QHostAddress()) {
   m_noSignalTimer.setSingleShot(true);
 
   m_settlingTimer.setSingleShot(true);
-  connect(&m_settlingTimer, &QTimer::timeout, this, [this]() {
+  connect(&m_settlingTimer, &WheelTimer::timeout, this, [this]() {
     logger.debug() << "Unsettled period over.";
     emit unsettledChanged();
   });
 
-  connect(&m_healthCheckTimer, &QTimer::timeout, this,
+  connect(&m_healthCheckTimer, &WheelTimer::timeout, this,
           &ConnectionHealth::healthCheckup);
 
   connect(&m_pingHelper, &PingHelper::pingSentAndReceived, this,
@@ -64,7 +64,7 @@ ConnectionHealth::ConnectionHealth() : m_dnsPingSender(QHostAddress()) {
   connect(&m_dnsPingSender, &DnsPingSender::recvPing, this,
           &ConnectionHealth::dnsPingReceived);
 
-  connect(&m_dnsPingTimer, &QTimer::timeout, this, [this]() {
+  connect(&m_dnsPingTimer, &WheelTimer::timeout, this, [this]() {
     m_dnsPingSequence++;
     m_dnsPingTimestamp = QDateTime::currentMSecsSinceEpoch();
     m_dnsPingSender.sendPing(QHostAddress(PING_WELL_KNOWN_ANYCAST_DNS),
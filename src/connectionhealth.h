@@ -7,6 +7,7 @@
 
 #include "pinghelper.h"
 #include "dnspingsender.h"
+#include "timerwheel.h"
 
 class ConnectionHealth final : public QObject {
  public:
@@ -38,6 +39,10 @@ class ConnectionHealth final : public QObject {
   double stddev() const { return m_pingHelper.stddev(); }
   bool isUnsettled() const { return m_settlingTimer.isActive(); };
 
+  // The addresses pinged by the health check while the VPN is active.
+  const QString& currentGateway() const { return m_currentGateway; }
+  const QString& deviceAddress() const { return m_deviceAddress; }
+
  public slots:
   void connectionStateChanged();
   void applicationStateChanged(Qt::ApplicationState state);
@@ -64,14 +69,14 @@ class ConnectionHealth final : public QObject {
  private:
   ConnectionStability m_stability = Stable;
 
-  QTimer m_settlingTimer;
-  QTimer m_noSignalTimer;
-  QTimer m_healthCheckTimer;
+  WheelTimer m_settlingTimer;
+  WheelTimer m_noSignalTimer;
+  WheelTimer m_healthCheckTimer;
 
   PingHelper m_pingHelper;
 
   DnsPingSender m_dnsPingSender;
-  QTimer m_dnsPingTimer;
+  WheelTimer m_dnsPingTimer;
   quint16 m_dnsPingSequence = 0;
   quint64 m_dnsPingTimestamp = 0;
   quint64 m_dnsPingLatency = 0;
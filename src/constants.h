@@ -38,15 +38,33 @@ constexpr uint32_t DEFAULT_OS_NOTIFICATION_MSEC = 4000;
 // Number of recent connections to retain.
 constexpr int RECENT_CONNECTIONS_MAX_COUNT = 5;
 
+// Subsystems not needed at startup are initialized after the first frame, or
+// after this timeout when the window is not shown.
+constexpr uint32_t DEFERRED_INITIALIZATION_MSEC = 3000;
+
 // Cooldown period for unresponsive servers
 constexpr uint32_t SERVER_UNRESPONSIVE_COOLDOWN_SEC = 300;
 
 // Number of msecs for max runtime of the connection benchmarks.
-constexpr uint32_t BENCHMARK_MAX_BITS_UPLOAD = 80000000;  // 10 Megabyte
+constexpr uint32_t BENCHMARK_MAX_BITS_UPLOAD = 80000000;  // 10 Megabyte/stream
 constexpr uint32_t BENCHMARK_MAX_DURATION_PING = 3000;
 constexpr uint32_t BENCHMARK_MAX_DURATION_TRANSFER = 15000;
 constexpr uint32_t BENCHMARK_THRESHOLD_SPEED_FAST = 25000000;    // 25 Megabit
 constexpr uint32_t BENCHMARK_THRESHOLD_SPEED_MEDIUM = 10000000;  // 10 Megabit
+constexpr uint32_t BENCHMARK_THRESHOLD_UPLOAD_FAST = 10000000;    // 10 Megabit
+constexpr uint32_t BENCHMARK_THRESHOLD_UPLOAD_MEDIUM = 3000000;   // 3 Megabit
+// Parallel streams of the transfer benchmarks, and the interval at which their
+// aggregated throughput is sampled.
+constexpr int BENCHMARK_DEFAULT_STREAMS = 4;
+constexpr int BENCHMARK_MAX_STREAMS = 16;
+constexpr uint32_t BENCHMARK_SAMPLE_INTERVAL_MSEC = 250;
+// Interval of the pings measuring the latency under load, and the latency
+// inflation thresholds of the grades, in msecs: A below 30, B below 60...
+constexpr uint32_t BENCHMARK_PROBE_INTERVAL_MSEC = 200;
+constexpr uint32_t BENCHMARK_INFLATION_GRADE_A = 30;
+constexpr uint32_t BENCHMARK_INFLATION_GRADE_B = 60;
+constexpr uint32_t BENCHMARK_INFLATION_GRADE_C = 200;
+constexpr uint32_t BENCHMARK_INFLATION_GRADE_D = 400;
 constexpr const char* BENCHMARK_DOWNLOAD_URL =
     "https://archive.mozilla.org/pub/vpn/speedtest/50m.data";
 
@@ -138,6 +156,10 @@ PRODBETAEXPR(QString, privacyBundleProductId, "prod_MIex7Q079igFZJ",
 
 PRODBETAEXPR(qint64, keyRegeneratorTimeSec, 604800, 300);
 
+// The functional tests run the captive portal probes against local servers.
+PRODBETAEXPR(int, captivePortalPort, 80,
+             envOrDefault("MVPN_CAPTIVE_PORTAL_PORT", "80").toInt());
+
 #undef PRODBETAEXPR
 
 constexpr const char* PLATFORM_NAME =
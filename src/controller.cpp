@@ -75,12 +75,12 @@ Controller::Controller() {
 
   connect(&m_timer, &QTimer::timeout, this, &Controller::timerTimeout);
 
-  connect(&m_connectingTimer, &QTimer::timeout, this, [this]() {
+  connect(&m_connectingTimer, &WheelTimer::timeout, this, [this]() {
     m_enableDisconnectInConfirming = true;
     emit enableDisconnectInConfirmingChanged();
   });
 
-  connect(&m_handshakeTimer, &QTimer::timeout, this,
+  connect(&m_handshakeTimer, &WheelTimer::timeout, this,
           &Controller::handshakeTimeout);
 }
 
@@ -8,6 +8,7 @@
 #include "models/server.h"
 #include "ipaddress.h"
 #include "pinghelper.h"
+#include "timerwheel.h"
 
 #include <QElapsedTimer>
 #include <QHostAddress>
@@ -178,8 +179,8 @@ class Controller final : public QObject {
   QString m_switchingEntryCountry;
   QString m_switchingEntryCity;
 
-  QTimer m_connectingTimer;
-  QTimer m_handshakeTimer;
+  WheelTimer m_connectingTimer;
+  WheelTimer m_handshakeTimer;
   bool m_enableDisconnectInConfirming = false;
 
   enum NextStep {
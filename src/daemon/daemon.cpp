@@ -15,7 +15,21 @@
 #include <QTimer>
 
 constexpr const char* JSON_ALLOWEDIPADDRESSRANGES = "allowedIPAddressRanges";
-constexpr int HANDSHAKE_POLL_MSEC = 250;
+
+// The handshakes are checked quickly at first, then less and less often: most
+// of them complete within a round trip, some need a retry after 5 seconds.
+constexpr int HANDSHAKE_POLL_MIN_MSEC = 20;
+constexpr int HANDSHAKE_POLL_MAX_MSEC = 1000;
+
+// The RX counter of the interface, when available, is read at each check: a
+// handshake response increments it, and it is much cheaper to get than the
+// status of the peers. The status is still queried at least this often.
+constexpr int HANDSHAKE_STATUS_MAX_MSEC = 1000;
+
+// How long a make-before-break server switch waits for the handshake of the
+// new peer before switching anyway: WireGuard retries a handshake after 5
+// seconds.
+constexpr int PENDING_SWITCH_TIMEOUT_MSEC = 5500;
 
 namespace {
 
@@ -34,7 +48,7 @@ Daemon::Daemon(QObject* parent) : QObject(parent) {
   s_daemon = this;
 
   m_handshakeTimer.setSingleShot(true);
-  connect(&m_handshakeTimer, &QTimer::timeout, this, &Daemon::checkHandshake);
+  connect(&m_handshakeTimer, &QTimer::timeout, this, &Daemon::pollHandshake);
 }
 
 Daemon::~Daemon() {
@@ -61,7 +75,8 @@ bool Daemon::activate(const InterfaceConfig& config) {
   // 2. the VPN is on and the platform doesn't support the server-switching:
   //    this method calls deactivate() and then it continues as 1.
   // 3. the VPN is on and the platform supports the server-switching: this
-  //    method calls switchServer().
+  //    method calls switchServer(). If the platform supports pending peers,
+  //    the new peer gets the traffic once it has completed a handshake.
   //
   // At the end, if the activation succeds, the `connected` signal is emitted.
   logger.debug() << "Activating interface";
@@ -73,8 +88,7 @@ bool Daemon::activate(const InterfaceConfig& config) {
       if (!switchServer(config)) {
         return false;
       }
-      m_connections[config.m_hopindex] = ConnectionState(config);
-      m_handshakeTimer.start(HANDSHAKE_POLL_MSEC);
+      startHandshakeWatch();
       return true;
     }
 
@@ -98,15 +112,7 @@ bool Daemon::activate(const InterfaceConfig& config) {
   }
 
   // Configure routing for excluded addresses.
-  for (const QString& i : config.m_excludedAddresses) {
-    QHostAddress address(i);
-    if (m_excludedAddrSet.contains(address)) {
-      m_excludedAddrSet[address]++;
-      continue;
-    }
-    wgutils()->addExclusionRoute(address);
-    m_excludedAddrSet[address] = 1;
-  }
+  addExclusionRoutes(config);
 
   // Add the peer to this interface.
   if (!wgutils()->updatePeer(config)) {
@@ -151,7 +157,7 @@ bool Daemon::activate(const InterfaceConfig& config) {
   logger.debug() << "Connection status:" << status;
   if (status) {
     m_connections[config.m_hopindex] = ConnectionState(config);
-    m_handshakeTimer.start(HANDSHAKE_POLL_MSEC);
+    startHandshakeWatch();
   }
 
   return status;
@@ -333,11 +339,13 @@ bool Daemon::deactivate(bool emitSignals) {
     }
     wgutils()->deletePeer(config);
   }
+  for (const PendingSwitch& pending : m_pendingSwitches) {
+    wgutils()->deletePeer(pending.m_config);
+  }
+  m_pendingSwitches.clear();
 
   // Cleanup routing for excluded addresses.
-  for (const QHostAddress& address : m_excludedAddrSet.keys()) {
-    wgutils()->deleteExclusionRoute(address);
-  }
+  wgutils()->deleteExclusionRoutes(m_excludedAddrSet.keys());
   m_excludedAddrSet.clear();
 
   // Delete the interface
@@ -385,17 +393,33 @@ bool Daemon::switchServer(const InterfaceConfig& config) {
   const InterfaceConfig& lastConfig =
       m_connections.value(config.m_hopindex).m_config;
 
+  // A switch to another server may still be waiting for its handshake.
+  abortSwitch(config.m_hopindex);
+
   // Configure routing for new excluded addresses.
-  for (const QString& i : config.m_excludedAddresses) {
-    QHostAddress address(i);
-    if (m_excludedAddrSet.contains(address)) {
-      m_excludedAddrSet[address]++;
-      continue;
+  addExclusionRoutes(config);
+
+  // Make before break: the new peer is added next to the current one, without
+  // any route. The traffic keeps flowing through the current peer until the
+  // new one has completed its handshake. See checkHandshake().
+  if (wgutils()->supportPendingPeers() &&
+      config.m_serverPublicKey != lastConfig.m_serverPublicKey) {
+    if (wgutils()->addPendingPeer(config)) {
+      logger.debug() << "Waiting for the handshake of the new peer";
+      m_pendingSwitches[config.m_hopindex] = PendingSwitch(config);
+      return true;
     }
-    wgutils()->addExclusionRoute(address);
-    m_excludedAddrSet[address] = 1;
+    logger.warning() << "Failed to add the pending peer. Switching now.";
   }
 
+  return commitSwitch(config);
+}
+
+bool Daemon::commitSwitch(const InterfaceConfig& config) {
+  Q_ASSERT(m_connections.contains(config.m_hopindex));
+  const InterfaceConfig lastConfig =
+      m_connections.value(config.m_hopindex).m_config;
+
   // Activate the new peer and its routes.
   if (!wgutils()->updatePeer(config)) {
     logger.error() << "Server switch failed to update the wireguard interface";
@@ -409,16 +433,7 @@ bool Daemon::switchServer(const InterfaceConfig& config) {
   }
 
   // Remove routing entries for the old peer.
-  for (const QString& i : lastConfig.m_excludedAddresses) {
-    QHostAddress address(i);
-    Q_ASSERT(m_excludedAddrSet.contains(address));
-    if (m_excludedAddrSet[address] > 1) {
-      m_excludedAddrSet[address]--;
-      continue;
-    }
-    wgutils()->deleteExclusionRoute(address);
-    m_excludedAddrSet.remove(address);
-  }
+  deleteExclusionRoutes(lastConfig);
   for (const IPAddress& ip : lastConfig.m_allowedIPAddressRanges) {
     if (!config.m_allowedIPAddressRanges.contains(ip)) {
       wgutils()->deleteRoutePrefix(ip, config.m_hopindex);
@@ -436,6 +451,57 @@ bool Daemon::switchServer(const InterfaceConfig& config) {
   return true;
 }
 
+void Daemon::abortSwitch(int hopindex) {
+  if (!m_pendingSwitches.contains(hopindex)) {
+    return;
+  }
+
+  const InterfaceConfig config = m_pendingSwitches.take(hopindex).m_config;
+  logger.debug() << "Aborting the switch to"
+                 << logger.keys(config.m_serverPublicKey);
+
+  const InterfaceConfig& current = m_connections.value(hopindex).m_config;
+  if (config.m_serverPublicKey != current.m_serverPublicKey) {
+    wgutils()->deletePeer(config);
+  }
+  deleteExclusionRoutes(config);
+}
+
+void Daemon::addExclusionRoutes(const InterfaceConfig& config) {
+  QList<QHostAddress> addresses;
+  for (const QString& i : config.m_excludedAddresses) {
+    QHostAddress address(i);
+    if (m_excludedAddrSet.contains(address)) {
+      m_excludedAddrSet[address]++;
+      continue;
+    }
+    addresses.append(address);
+    m_excludedAddrSet[address] = 1;
+  }
+
+  if (!addresses.isEmpty()) {
+    wgutils()->addExclusionRoutes(addresses);
+  }
+}
+
+void Daemon::deleteExclusionRoutes(const InterfaceConfig& config) {
+  QList<QHostAddress> addresses;
+  for (const QString& i : config.m_excludedAddresses) {
+    QHostAddress address(i);
+    Q_ASSERT(m_excludedAddrSet.contains(address));
+    if (m_excludedAddrSet[address] > 1) {
+      m_excludedAddrSet[address]--;
+      continue;
+    }
+    addresses.append(address);
+    m_excludedAddrSet.remove(address);
+  }
+
+  if (!addresses.isEmpty()) {
+    wgutils()->deleteExclusionRoutes(addresses);
+  }
+}
+
 QJsonObject Daemon::getStatus() {
   Q_ASSERT(wgutils() != nullptr);
   QJsonObject json;
@@ -467,38 +533,112 @@ QJsonObject Daemon::getStatus() {
   return json;
 }
 
-void Daemon::checkHandshake() {
+void Daemon::startHandshakeWatch() {
+  logger.debug() << "Waiting for the handshakes";
+
+  m_handshakeInterval = HANDSHAKE_POLL_MIN_MSEC;
+  m_handshakeRxPackets = wgutils()->rxPackets();
+  m_handshakeElapsed.start();
+  m_handshakeTimer.start(HANDSHAKE_POLL_MIN_MSEC);
+}
+
+void Daemon::pollHandshake() {
   Q_ASSERT(wgutils() != nullptr);
 
-  logger.debug() << "Checking for handshake...";
+  // Back off, exponentially.
+  m_handshakeInterval =
+      std::min(m_handshakeInterval * 2, HANDSHAKE_POLL_MAX_MSEC);
+
+  // Since the previous status, a handshake response shows up as a change of
+  // the RX counter of the interface. If nothing was received, the status is
+  // not queried.
+  qint64 rxPackets = wgutils()->rxPackets();
+  if (rxPackets >= 0 && rxPackets == m_handshakeRxPackets &&
+      !m_handshakeElapsed.hasExpired(HANDSHAKE_STATUS_MAX_MSEC)) {
+    m_handshakeTimer.start(m_handshakeInterval);
+    return;
+  }
+  m_handshakeRxPackets = rxPackets;
+  m_handshakeElapsed.start();
+
+  if (!checkHandshake()) {
+    return;
+  }
+
+  m_handshakeTimer.start(m_handshakeInterval);
+}
+
+bool Daemon::checkHandshake() {
+  Q_ASSERT(wgutils() != nullptr);
+
+  // Only the peers still waiting for a handshake are queried.
+  QList<QByteArray> pubkeys;
+  for (const ConnectionState& connection : m_connections) {
+    if (!connection.m_date.isValid()) {
+      pubkeys.append(connection.m_pubkey);
+    }
+  }
+  for (const PendingSwitch& pending : m_pendingSwitches) {
+    pubkeys.append(pending.m_pubkey);
+  }
+  if (pubkeys.isEmpty()) {
+    return false;
+  }
 
   int pendingHandshakes = 0;
-  QList<WireguardUtils::PeerStatus> peers = wgutils()->getPeerStatus();
+  QHash<QByteArray, qint64> handshakes = wgutils()->getPeerHandshakes(pubkeys);
   for (ConnectionState& connection : m_connections) {
-    const InterfaceConfig& config = connection.m_config;
     if (connection.m_date.isValid()) {
       continue;
     }
-    logger.debug() << "awaiting" << logger.keys(config.m_serverPublicKey);
 
     // Check if the handshake has completed.
-    for (const WireguardUtils::PeerStatus& status : peers) {
-      if (config.m_serverPublicKey != status.m_pubkey) {
-        continue;
-      }
-      if (status.m_handshake != 0) {
-        connection.m_date.setMSecsSinceEpoch(status.m_handshake);
-        emit connected(status.m_pubkey);
-      }
+    qint64 handshake = handshakes.value(connection.m_pubkey);
+    if (handshake == 0) {
+      pendingHandshakes++;
+      continue;
     }
 
-    if (!connection.m_date.isValid()) {
+    logger.debug() << "Handshake for"
+                   << logger.keys(connection.m_config.m_serverPublicKey);
+    connection.m_date.setMSecsSinceEpoch(handshake);
+    emit connected(connection.m_config.m_serverPublicKey);
+  }
+
+  // Complete the server switches once the new peer has a handshake.
+  for (int hopindex : m_pendingSwitches.keys()) {
+    const PendingSwitch& pending = m_pendingSwitches[hopindex];
+    const InterfaceConfig config = pending.m_config;
+
+    qint64 handshake = handshakes.value(pending.m_pubkey);
+    if (handshake == 0 &&
+        !pending.m_timer.hasExpired(PENDING_SWITCH_TIMEOUT_MSEC)) {
+      pendingHandshakes++;
+      continue;
+    }
+
+    if (handshake == 0) {
+      logger.warning() << "No handshake for the new peer. Switching anyway.";
+    } else {
+      logger.debug() << "Handshake for the new peer after"
+                     << pending.m_timer.elapsed() << "msecs";
+    }
+
+    m_pendingSwitches.remove(hopindex);
+    if (!commitSwitch(config)) {
+      emit backendFailure();
+      continue;
+    }
+
+    if (handshake != 0) {
+      ConnectionState& connection = m_connections[hopindex];
+      connection.m_date.setMSecsSinceEpoch(handshake);
+      emit connected(config.m_serverPublicKey);
+    } else {
       pendingHandshakes++;
     }
   }
 
   // Check again if there were connections that haven't completed a handshake.
-  if (pendingHandshakes > 0) {
-    m_handshakeTimer.start(HANDSHAKE_POLL_MSEC);
-  }
+  return pendingHandshakes > 0;
 }
@@ -11,6 +11,7 @@
 #include "wireguardutils.h"
 
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QTimer>
 
 class Daemon : public QObject {
@@ -53,6 +54,8 @@ class Daemon : public QObject {
   }
   virtual bool supportServerSwitching(const InterfaceConfig& config) const;
   virtual bool switchServer(const InterfaceConfig& config);
+  bool commitSwitch(const InterfaceConfig& config);
+  void abortSwitch(int hopindex);
   virtual WireguardUtils* wgutils() const = 0;
   virtual bool supportIPUtils() const { return false; }
   virtual IPUtils* iputils() { return nullptr; }
@@ -62,18 +65,49 @@ class Daemon : public QObject {
   static bool parseStringList(const QJsonObject& obj, const QString& name,
                               QStringList& list);
 
-  void checkHandshake();
+  // Waits for the handshakes of the new peers, and emits `connected`.
+  void startHandshakeWatch();
+  void pollHandshake();
+  bool checkHandshake();
+
+  // Reference-count the excluded addresses, and update the routing of the
+  // ones added or removed in a single batch.
+  void addExclusionRoutes(const InterfaceConfig& config);
+  void deleteExclusionRoutes(const InterfaceConfig& config);
 
   class ConnectionState {
    public:
     ConnectionState(){};
-    ConnectionState(const InterfaceConfig& config) { m_config = config; }
+    ConnectionState(const InterfaceConfig& config) {
+      m_config = config;
+      m_pubkey = QByteArray::fromBase64(config.m_serverPublicKey.toLatin1());
+    }
     QDateTime m_date;
     InterfaceConfig m_config;
+    QByteArray m_pubkey;
   };
   QMap<int, ConnectionState> m_connections;
+
+  // A server switch waiting for the handshake of the new peer.
+  class PendingSwitch {
+   public:
+    PendingSwitch(){};
+    PendingSwitch(const InterfaceConfig& config) {
+      m_config = config;
+      m_pubkey = QByteArray::fromBase64(config.m_serverPublicKey.toLatin1());
+      m_timer.start();
+    }
+    InterfaceConfig m_config;
+    QByteArray m_pubkey;
+    QElapsedTimer m_timer;
+  };
+  QMap<int, PendingSwitch> m_pendingSwitches;
   QHash<QHostAddress, int> m_excludedAddrSet;
   QTimer m_handshakeTimer;
+  // Since the last query of the status of the peers.
+  QElapsedTimer m_handshakeElapsed;
+  int m_handshakeInterval = 0;
+  qint64 m_handshakeRxPackets = -1;
 };
 
 #endif  // DAEMON_H
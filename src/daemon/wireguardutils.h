@@ -7,6 +7,7 @@
 
 #include "interfaceconfig.h"
 
+#include <QHash>
 #include <QHostAddress>
 #include <QObject>
 #include <QStringList>
@@ -39,13 +40,57 @@ class WireguardUtils : public QObject {
 
   virtual bool updatePeer(const InterfaceConfig& config) = 0;
   virtual bool deletePeer(const InterfaceConfig& config) = 0;
+
+  // Make-before-break server switching: a pending peer starts its handshake
+  // without any allowed IPs. Then updatePeer() moves the allowed IPs to it,
+  // away from the current peer, in a single update.
+  virtual bool supportPendingPeers() const { return false; }
+  virtual bool addPendingPeer(const InterfaceConfig& config) {
+    Q_UNUSED(config);
+    return false;
+  }
   virtual QList<PeerStatus> getPeerStatus() = 0;
 
+  // Returns the time of the last handshake, in msecs since the epoch, of the
+  // peers with the given public keys, in binary. The peers without any
+  // handshake yet are not listed.
+  virtual QHash<QByteArray, qint64> getPeerHandshakes(
+      const QList<QByteArray>& pubkeys) {
+    QHash<QByteArray, qint64> handshakes;
+    for (const PeerStatus& status : getPeerStatus()) {
+      QByteArray pubkey = QByteArray::fromBase64(status.m_pubkey.toLatin1());
+      if (status.m_handshake != 0 && pubkeys.contains(pubkey)) {
+        handshakes.insert(pubkey, status.m_handshake);
+      }
+    }
+    return handshakes;
+  }
+
+  // Returns the number of packets received by the interface, or -1 if it is
+  // unknown. A handshake response increments it.
+  virtual qint64 rxPackets() { return -1; }
+
   virtual bool updateRoutePrefix(const IPAddress& prefix, int hopindex) = 0;
   virtual bool deleteRoutePrefix(const IPAddress& prefix, int hopindex) = 0;
 
   virtual bool addExclusionRoute(const QHostAddress& address) = 0;
   virtual bool deleteExclusionRoute(const QHostAddress& address) = 0;
+
+  // Platforms which can update all the exclusions at once override these.
+  virtual bool addExclusionRoutes(const QList<QHostAddress>& addresses) {
+    bool result = true;
+    for (const QHostAddress& address : addresses) {
+      result = addExclusionRoute(address) && result;
+    }
+    return result;
+  }
+  virtual bool deleteExclusionRoutes(const QList<QHostAddress>& addresses) {
+    bool result = true;
+    for (const QHostAddress& address : addresses) {
+      result = deleteExclusionRoute(address) && result;
+    }
+    return result;
+  }
 };
 
 #endif  // WIREGUARDUTILS_H
@@ -3,6 +3,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "navigator.h"
+#include "constants.h"
 #include "externalophandler.h"
 #include "leakdetector.h"
 #include "logger.h"
@@ -12,11 +13,39 @@
 
 #include <QCoreApplication>
 #include <QQuickItem>
+#include <QQuickWindow>
+
+#include <algorithm>
 
 namespace {
 Navigator* s_instance = nullptr;
 Logger logger(LOG_MAIN, "Navigator");
 
+// Screens are compiled in advance when the user did not navigate for this
+// amount of time.
+constexpr int WARMUP_IDLE_MSEC = 1000;
+
+// Default number of screens compiled in advance and not shown yet. Each of
+// them keeps its compiled types alive in the QML engine.
+constexpr int WARMUP_DEFAULT_BUDGET = 4;
+
+// Screens that are likely to be shown after a given screen, before we learn
+// anything from the user.
+struct ScreenHint {
+  Navigator::Screen m_screen;
+  QList<Navigator::Screen> m_nextScreens;
+};
+
+const QList<ScreenHint> s_screenHints{
+    {Navigator::ScreenHome,
+     {Navigator::ScreenSettings, Navigator::ScreenMessaging,
+      Navigator::ScreenGetHelp}},
+    {Navigator::ScreenSettings,
+     {Navigator::ScreenGetHelp, Navigator::ScreenHome}},
+    {Navigator::ScreenMessaging, {Navigator::ScreenHome}},
+    {Navigator::ScreenGetHelp, {Navigator::ScreenViewLogs}},
+};
+
 struct Layer {
   enum Type {
     eStackView,
@@ -427,6 +456,16 @@ void maybeGenerateComponent(Navigator* navigator, ScreenData* screen) {
   }
 }
 
+ScreenData* findScreen(Navigator::Screen screen) {
+  for (ScreenData& data : s_screens) {
+    if (data.m_screen == screen) {
+      return &data;
+    }
+  }
+
+  return nullptr;
+}
+
 };  // namespace
 
 // static
@@ -440,6 +479,15 @@ Navigator* Navigator::instance() {
 Navigator::Navigator(QObject* parent) : QObject(parent) {
   MVPN_COUNT_CTOR(Navigator);
 
+  m_warmupBudget = Constants::envOrDefault(
+                       "MVPN_NAVIGATOR_WARMUP_BUDGET",
+                       QString::number(WARMUP_DEFAULT_BUDGET))
+                       .toInt();
+
+  m_warmupTimer.setSingleShot(true);
+  connect(&m_warmupTimer, &QTimer::timeout, this,
+          &Navigator::warmupNextScreen);
+
   connect(MozillaVPN::instance(), &MozillaVPN::stateChanged, this,
           &Navigator::computeComponent);
 
@@ -541,10 +589,23 @@ void Navigator::loadScreen(Screen screen, LoadPolicy loadPolicy,
   }
 
   if (m_screenHistory.isEmpty() || screen != m_currentScreen) {
+    if (!m_screenHistory.isEmpty()) {
+      ++m_transitions[m_currentScreen][screen];
+    }
+
     m_screenHistory.append(screen);
     m_currentScreen = screen;
   }
 
+  // A prewarmed screen is not a speculation anymore: it stays out of the
+  // budget.
+  m_loadPrewarmed = m_prewarmedScreens.removeOne(screen) &&
+                    component->status() == QQmlComponent::Ready;
+  m_loadTimer.start();
+  disconnect(m_frameSwappedConnection);
+
+  m_warmupTimer.stop();
+
   m_currentLoadPolicy = loadPolicy;
   m_currentComponent = component;
   m_currentLoadingFlags = loadingFlags;
@@ -552,6 +613,154 @@ void Navigator::loadScreen(Screen screen, LoadPolicy loadPolicy,
   emit currentComponentChanged();
 }
 
+void Navigator::screenLoaded() {
+  if (!m_loadTimer.isValid()) {
+    return;
+  }
+
+  QQuickWindow* window =
+      qobject_cast<QQuickWindow*>(QmlEngineHolder::instance()->window());
+  if (!window) {
+    firstFrameRendered();
+    return;
+  }
+
+  // The screen is created, but the user sees it only when the next frame is
+  // swapped.
+  disconnect(m_frameSwappedConnection);
+  m_frameSwappedConnection =
+      connect(window, &QQuickWindow::frameSwapped, this,
+              &Navigator::firstFrameRendered, Qt::QueuedConnection);
+  window->update();
+}
+
+void Navigator::firstFrameRendered() {
+  disconnect(m_frameSwappedConnection);
+
+  if (!m_loadTimer.isValid()) {
+    return;
+  }
+
+  qint64 msec = m_loadTimer.elapsed();
+  m_loadTimer.invalidate();
+
+  ScreenStats& stats = m_screenStats[m_currentScreen];
+  ++stats.m_samples;
+  if (m_loadPrewarmed) {
+    ++stats.m_prewarmedSamples;
+  }
+  stats.m_lastMsec = msec;
+  stats.m_maxMsec = std::max(stats.m_maxMsec, msec);
+  stats.m_totalMsec += msec;
+  stats.m_lastPrewarmed = m_loadPrewarmed;
+
+  logger.debug() << "First frame of" << m_currentScreen << "in" << msec
+                 << "msec" << (m_loadPrewarmed ? "(prewarmed)" : "");
+
+  scheduleWarmup();
+}
+
+QList<Navigator::Screen> Navigator::predictNextScreens() const {
+  QList<Screen> screens;
+
+  // What the user did before, from this screen.
+  const QHash<Screen, int> transitions = m_transitions.value(m_currentScreen);
+  QList<Screen> learned = transitions.keys();
+  std::stable_sort(learned.begin(), learned.end(),
+                   [&transitions](Screen a, Screen b) {
+                     return transitions.value(a) > transitions.value(b);
+                   });
+  screens.append(learned);
+
+  // The way back.
+  if (m_screenHistory.length() > 1) {
+    screens.append(m_screenHistory.at(m_screenHistory.length() - 2));
+  }
+
+  for (const ScreenHint& hint : s_screenHints) {
+    if (hint.m_screen == m_currentScreen) {
+      screens.append(hint.m_nextScreens);
+      break;
+    }
+  }
+
+  QList<Screen> result;
+  for (Screen screen : screens) {
+    if (screen != m_currentScreen && !result.contains(screen)) {
+      result.append(screen);
+    }
+  }
+
+  return result;
+}
+
+void Navigator::scheduleWarmup() {
+  if (m_warmupBudget > 0 && !m_warmingComponent) {
+    m_warmupTimer.start(WARMUP_IDLE_MSEC);
+  }
+}
+
+void Navigator::warmupNextScreen() {
+  Q_ASSERT(!m_warmingComponent);
+
+  QList<Screen> screens = predictNextScreens();
+  if (screens.length() > m_warmupBudget) {
+    screens.erase(screens.begin() + m_warmupBudget, screens.end());
+  }
+
+  for (Screen screen : screens) {
+    ScreenData* data = findScreen(screen);
+    if (!data || data->m_qmlComponent) {
+      continue;
+    }
+
+    // Let's not compile screens that cannot be shown in the current state.
+    Screen requestedScreen = screen;
+    if (!computeScreen(*data, &requestedScreen)) {
+      continue;
+    }
+
+    // Over budget: the oldest guesses go away first. They were not shown, so
+    // no loader is using their component.
+    while (m_prewarmedScreens.length() >= m_warmupBudget) {
+      ScreenData* evicted = findScreen(m_prewarmedScreens.takeFirst());
+      Q_ASSERT(evicted && evicted->m_qmlComponent);
+      Q_ASSERT(evicted->m_qmlComponent != m_currentComponent);
+
+      logger.debug() << "Evicting the prewarmed screen" << evicted->m_screen;
+      evicted->m_qmlComponent->deleteLater();
+      evicted->m_qmlComponent = nullptr;
+    }
+
+    logger.debug() << "Prewarming screen" << screen;
+    maybeGenerateComponent(this, data);
+    m_prewarmedScreens.append(screen);
+
+    // One compilation at a time: the next one starts when this is done.
+    QQmlComponent* component = data->m_qmlComponent;
+    if (component->isLoading()) {
+      m_warmingComponent = component;
+      connect(component, &QQmlComponent::statusChanged, this,
+              [this, component](QQmlComponent::Status status) {
+                if (status == QQmlComponent::Loading) {
+                  return;
+                }
+
+                if (status == QQmlComponent::Error) {
+                  logger.error() << "Unable to prewarm a screen:"
+                                 << component->errorString();
+                }
+
+                disconnect(component, &QQmlComponent::statusChanged, this,
+                           nullptr);
+                m_warmingComponent = nullptr;
+                scheduleWarmup();
+              });
+      return;
+    }
+  }
+}
+
 void Navigator::addStackView(Screen requestedScreen,
                              const QVariant& stackView) {
   logger.debug() << "Add stack view for screen" << requestedScreen;
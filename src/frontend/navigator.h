@@ -5,8 +5,11 @@
 #ifndef NAVIGATOR_H
 #define NAVIGATOR_H
 
+#include <QElapsedTimer>
+#include <QHash>
 #include <QObject>
 #include <QQmlComponent>
+#include <QTimer>
 
 class NavigatorReloader;
 class QQuickItem;
@@ -84,6 +87,26 @@ class Navigator final : public QObject {
 
   Q_INVOKABLE bool eventHandled();
 
+  // Called by the QML loader when the current screen has been created.
+  Q_INVOKABLE void screenLoaded();
+
+  // Time from the screen request to the first frame rendered with it.
+  struct ScreenStats {
+    int m_samples = 0;
+    int m_prewarmedSamples = 0;
+    qint64 m_lastMsec = 0;
+    qint64 m_maxMsec = 0;
+    qint64 m_totalMsec = 0;
+    bool m_lastPrewarmed = false;
+  };
+
+  const QHash<Screen, ScreenStats>& screenStats() const {
+    return m_screenStats;
+  }
+
+  // Screens compiled in advance and not shown yet.
+  const QList<Screen>& prewarmedScreens() const { return m_prewarmedScreens; }
+
   void registerReloader(NavigatorReloader* reloader);
   void unregisterReloader(NavigatorReloader* reloader);
 
@@ -100,6 +123,11 @@ class Navigator final : public QObject {
 
   void removeItem(QObject* obj);
 
+  QList<Screen> predictNextScreens() const;
+  void scheduleWarmup();
+  void warmupNextScreen();
+  void firstFrameRendered();
+
  private:
   Screen m_currentScreen = ScreenInitialize;
   LoadPolicy m_currentLoadPolicy = LoadTemporarily;
@@ -108,6 +136,20 @@ class Navigator final : public QObject {
 
   QList<Screen> m_screenHistory;
 
+  // How many times we went from a screen to another one. This is used to
+  // guess the next screens and to compile them in advance.
+  QHash<Screen, QHash<Screen, int>> m_transitions;
+
+  QTimer m_warmupTimer;
+  QList<Screen> m_prewarmedScreens;
+  QQmlComponent* m_warmingComponent = nullptr;
+  int m_warmupBudget = 0;
+
+  QElapsedTimer m_loadTimer;
+  bool m_loadPrewarmed = false;
+  QMetaObject::Connection m_frameSwappedConnection;
+  QHash<Screen, ScreenStats> m_screenStats;
+
   QList<NavigatorReloader*> m_reloaders;
 };
 
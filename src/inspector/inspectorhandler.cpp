@@ -14,6 +14,7 @@
 #include "localizer.h"
 #include "logger.h"
 #include "loghandler.h"
+#include "lottieframecache.h"
 #include "models/feature.h"
 #include "models/featuremodel.h"
 #include "mozillavpn.h"
@@ -23,7 +24,12 @@
 #include "qmlengineholder.h"
 #include "serveri18n.h"
 #include "settingsholder.h"
+#include "startuptracer.h"
 #include "task.h"
+#include "tasks/group/taskgroup.h"
+#include "tasks/servers/taskservers.h"
+#include "taskscheduler.h"
+#include "timerwheel.h"
 #include "urlopener.h"
 #include "websocket/pushmessage.h"
 
@@ -34,6 +40,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonValue>
+#include <QMetaEnum>
 #include <QMetaObject>
 #include <QNetworkAccessManager>
 #include <QPixmap>
@@ -530,6 +537,24 @@ static QList<InspectorCommand> s_commands{
                        return QJsonObject();
                      }},
 
+    InspectorCommand{
+        "captive_portal_stats", "Retrieve the captive portal detection stats",
+        0,
+        [](InspectorHandler*, const QList<QByteArray>&) {
+          CaptivePortalDetection* detection =
+              MozillaVPN::instance()->captivePortalDetection();
+
+          QJsonObject value;
+          value["count"] = detection->detectionCount();
+          value["latency"] = detection->lastDetectionLatency();
+          value["result"] =
+              QVariant::fromValue(detection->lastDetectionResult()).toString();
+
+          QJsonObject obj;
+          obj["value"] = value;
+          return obj;
+        }},
+
     InspectorCommand{
         "force_captive_portal_detection", "Simulate a captive portal detection",
         0,
@@ -985,6 +1010,154 @@ static QList<InspectorCommand> s_commands{
                        emit Localizer::instance()->codeChanged();
                        return QJsonObject();
                      }},
+
+    InspectorCommand{"timer_wheel", "Retrieve the timer wheel stats", 0,
+                     [](InspectorHandler*, const QList<QByteArray>&) {
+                       TimerWheel* wheel = TimerWheel::instance();
+
+                       QJsonObject value;
+                       value["slack"] = wheel->slackMsec();
+                       value["timers"] = wheel->count();
+                       value["wakeups"] = static_cast<qint64>(wheel->wakeups());
+                       value["wakeupsPerMinute"] = wheel->wakeupsPerMinute();
+
+                       QJsonObject obj;
+                       obj["value"] = value;
+                       return obj;
+                     }},
+
+    InspectorCommand{"lottie_frame_cache",
+                     "Retrieve the lottie frame cache stats", 0,
+                     [](InspectorHandler*, const QList<QByteArray>&) {
+                       LottieFrameCache* cache = LottieFrameCache::instance();
+
+                       QJsonObject value;
+                       value["frames"] = cache->count();
+                       value["bytes"] = cache->bytes();
+                       value["maxBytes"] = cache->maxBytes();
+                       value["hits"] = static_cast<qint64>(cache->hits());
+                       value["misses"] = static_cast<qint64>(cache->misses());
+
+                       QJsonObject obj;
+                       obj["value"] = value;
+                       return obj;
+                     }},
+
+    InspectorCommand{
+        "navigator_stats",
+        "Retrieve the time-to-first-frame of the screens and the prewarmed "
+        "screens",
+        0,
+        [](InspectorHandler*, const QList<QByteArray>&) {
+          Navigator* navigator = Navigator::instance();
+          QMetaEnum metaEnum = QMetaEnum::fromType<Navigator::Screen>();
+
+          QJsonObject screens;
+          const QHash<Navigator::Screen, Navigator::ScreenStats>& stats =
+              navigator->screenStats();
+          for (auto i = stats.constBegin(); i != stats.constEnd(); ++i) {
+            const Navigator::ScreenStats& screenStats = i.value();
+
+            QJsonObject screen;
+            screen["samples"] = screenStats.m_samples;
+            screen["prewarmedSamples"] = screenStats.m_prewarmedSamples;
+            screen["lastMsec"] = screenStats.m_lastMsec;
+            screen["maxMsec"] = screenStats.m_maxMsec;
+            screen["averageMsec"] =
+                static_cast<double>(screenStats.m_totalMsec) /
+                screenStats.m_samples;
+            screen["lastPrewarmed"] = screenStats.m_lastPrewarmed;
+            screens[metaEnum.valueToKey(i.key())] = screen;
+          }
+
+          QJsonArray prewarmed;
+          for (Navigator::Screen screen : navigator->prewarmedScreens()) {
+            prewarmed.append(metaEnum.valueToKey(screen));
+          }
+
+          QJsonObject value;
+          value["screens"] = screens;
+          value["prewarmed"] = prewarmed;
+
+          QJsonObject obj;
+          obj["value"] = value;
+          return obj;
+        }},
+
+    InspectorCommand{"startup_trace",
+                     "Retrieve the startup trace in the Chrome trace format",
+                     0,
+                     [](InspectorHandler*, const QList<QByteArray>&) {
+                       QJsonObject obj;
+                       obj["value"] = StartupTracer::instance()->toJson();
+                       return obj;
+                     }},
+
+    InspectorCommand{"force_servers_fetch",
+                     "Fetch the server list N times, concurrently", 1,
+                     [](InspectorHandler*, const QList<QByteArray>& arguments) {
+                       QJsonObject obj;
+
+                       bool ok = false;
+                       int count = arguments[1].toInt(&ok);
+                       if (!ok || count <= 0) {
+                         obj["error"] = "Invalid count";
+                         return obj;
+                       }
+
+                       QList<Task*> tasks;
+                       for (int i = 0; i < count; ++i) {
+                         tasks.append(
+                             new TaskServers(ErrorHandler::PropagateError));
+                       }
+
+                       TaskScheduler::scheduleTask(new TaskGroup(tasks));
+                       return obj;
+                     }},
+
+    InspectorCommand{"network_coalescing",
+                     "Retrieve the coalesced network request stats", 0,
+                     [](InspectorHandler*, const QList<QByteArray>&) {
+                       NetworkManager* manager = NetworkManager::instance();
+
+                       QJsonObject value;
+                       value["coalesced"] = static_cast<qint64>(
+                           manager->coalescedRequestCount());
+                       value["fresh"] =
+                           static_cast<qint64>(manager->freshRequestCount());
+
+                       QJsonObject obj;
+                       obj["value"] = value;
+                       return obj;
+                     }},
+
+    InspectorCommand{"network_hosts",
+                     "Retrieve the connect times of the hosts", 0,
+                     [](InspectorHandler*, const QList<QByteArray>&) {
+                       const QHash<QString, NetworkManager::HostMetrics>&
+                           hostMetrics =
+                               NetworkManager::instance()->hostMetrics();
+
+                       QJsonObject value;
+                       for (auto i = hostMetrics.constBegin();
+                            i != hostMetrics.constEnd(); ++i) {
+                         QJsonObject host;
+                         host["connections"] =
+                             static_cast<qint64>(i->m_connections);
+                         host["connectFailures"] =
+                             static_cast<qint64>(i->m_connectFailures);
+                         host["lastConnectMsec"] = i->m_lastConnectMsec;
+                         host["averageConnectMsec"] =
+                             i->m_connections
+                                 ? i->m_totalConnectMsec / i->m_connections
+                                 : -1;
+                         value[i.key()] = host;
+                       }
+
+                       QJsonObject obj;
+                       obj["value"] = value;
+                       return obj;
+                     }},
 };
 
 // static
@@ -8,7 +8,6 @@
 #include "logger.h"
 #include "mozillavpn.h"
 #include "tasks/ipfinder/taskipfinder.h"
-#include "taskscheduler.h"
 
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -16,7 +15,9 @@
 
 namespace {
 Logger logger(LOG_NETWORKING, "IpAddressLookup");
-}
+
+constexpr int IPADDRESS_CACHE_MAX_SIZE = 16;
+}  // namespace
 
 IpAddressLookup::IpAddressLookup() {
   MVPN_COUNT_CTOR(IpAddressLookup);
@@ -27,7 +28,10 @@ IpAddressLookup::IpAddressLookup() {
           [this]() { updateIpAddress(); });
 }
 
-IpAddressLookup::~IpAddressLookup() { MVPN_COUNT_DTOR(IpAddressLookup); }
+IpAddressLookup::~IpAddressLookup() {
+  MVPN_COUNT_DTOR(IpAddressLookup);
+  delete m_ipFinder;
+}
 
 void IpAddressLookup::initialize() {
   MozillaVPN* vpn = MozillaVPN::instance();
@@ -36,11 +40,25 @@ void IpAddressLookup::initialize() {
 
   connect(vpn->controller(), &Controller::stateChanged, this,
           &IpAddressLookup::stateChanged);
+
+  // A new server list can move the servers around: the cached addresses are
+  // not reliable anymore.
+  connect(vpn->serverCountryModel(), &ServerCountryModel::changed, this,
+          [this]() {
+            m_cache.clear();
+            m_cacheOrder.clear();
+          });
 }
 
 void IpAddressLookup::reset() {
   logger.debug() << "Resetting the data";
 
+  if (m_ipFinder) {
+    m_ipFinder->cancel();
+    m_ipFinder->deleteLater();
+    m_ipFinder = nullptr;
+  }
+
   if (m_state != StateWaiting) {
     //% "Loading"
     //: This refers to the current IP address, i.e. "IP: Loading".
@@ -54,15 +72,46 @@ void IpAddressLookup::reset() {
 void IpAddressLookup::updateIpAddress() {
   logger.debug() << "Updating IP address";
 
-  if (m_state == StateUpdating) {
+  QString key = MozillaVPN::instance()->exitServerPublicKey();
+
+  if (m_ipFinder) {
+    if (m_ipFinderKey == key) {
+      return;
+    }
+
+    // The exit server has changed in the meantime.
+    m_ipFinder->cancel();
+    m_ipFinder->deleteLater();
+    m_ipFinder = nullptr;
+  }
+
+  if (!key.isEmpty() && m_cache.contains(key)) {
+    logger.debug() << "IP address from the cache";
+    const CachedAddresses& cached = m_cache[key];
+    setIpAddresses(cached.m_ipv4Address, cached.m_ipv6Address);
+    m_state = StateUpdated;
+    emit ipAddressChecked();
     return;
   }
+
   m_state = StateUpdating;
 
   TaskIPFinder* ipfinder = new TaskIPFinder();
+  m_ipFinder = ipfinder;
+  m_ipFinderKey = key;
+
   connect(
       ipfinder, &TaskIPFinder::operationCompleted, this,
-      [this](const QString& ipv4, const QString& ipv6, const QString& country) {
+      [this, ipfinder, key](const QString& ipv4, const QString& ipv6,
+                            const QString& country) {
+        ipfinder->deleteLater();
+
+        // This lookup has been cancelled.
+        if (m_ipFinder != ipfinder) {
+          return;
+        }
+        m_ipFinder = nullptr;
+
         if (ipv4.isEmpty() && ipv6.isEmpty()) {
           logger.error() << "IP address request failed";
           m_state = StateUpdated;
@@ -72,6 +121,8 @@ void IpAddressLookup::updateIpAddress() {
 
         logger.debug() << "IP address request completed";
 
+        bool cacheable = !key.isEmpty();
+
     // Let's skip this for unit-tests to make them simpler.
 #ifndef UNIT_TEST
         if (country !=
@@ -80,29 +131,44 @@ void IpAddressLookup::updateIpAddress() {
           // connected server we may retry only once.
           logger.warning() << "Reported ip not in the right country, retry!";
           QTimer::singleShot(3000, this, [this]() { updateIpAddress(); });
+          cacheable = false;
         }
 #endif
 
-        if (!ipv4.isEmpty()) {
-          m_ipv4Address = ipv4;
-          emit ipv4AddressChanged();
-        }
-
-        if (!ipv4.isEmpty()) {
-          m_ipv6Address = ipv6;
-          emit ipv6AddressChanged();
-        }
+        setIpAddresses(ipv4, ipv6);
 
         logger.debug() << "Set own Address. ipv4:"
                        << logger.sensitive(m_ipv4Address)
                        << "ipv6:" << logger.sensitive(m_ipv6Address) << "in"
                        << logger.sensitive(country);
 
+        if (cacheable) {
+          m_cache.insert(key, {ipv4, ipv6});
+          m_cacheOrder.removeAll(key);
+          m_cacheOrder.append(key);
+          while (m_cacheOrder.length() > IPADDRESS_CACHE_MAX_SIZE) {
+            m_cache.remove(m_cacheOrder.takeFirst());
+          }
+        }
+
         m_state = StateUpdated;
         emit ipAddressChecked();
       });
 
-  TaskScheduler::scheduleTask(ipfinder);
+  ipfinder->run();
+}
+
+void IpAddressLookup::setIpAddresses(const QString& ipv4,
+                                     const QString& ipv6) {
+  if (!ipv4.isEmpty()) {
+    m_ipv4Address = ipv4;
+    emit ipv4AddressChanged();
+  }
+
+  if (!ipv6.isEmpty()) {
+    m_ipv6Address = ipv6;
+    emit ipv6AddressChanged();
+  }
 }
 
 void IpAddressLookup::stateChanged() {
@@ -5,9 +5,14 @@
 #ifndef IPADDRESSLOOKUP_H
 #define IPADDRESSLOOKUP_H
 
+#include <QHash>
 #include <QObject>
+#include <QPointer>
+#include <QStringList>
 #include <QTimer>
 
+class TaskIPFinder;
+
 #ifdef UNIT_TEST
 class TestIpAddressLookup;
 #endif
@@ -35,6 +40,8 @@ class IpAddressLookup final : public QObject {
 
   void stateChanged();
 
+  void setIpAddresses(const QString& ipv4, const QString& ipv6);
+
  signals:
   // for testing.
   void ipAddressChecked();
@@ -59,6 +66,19 @@ class IpAddressLookup final : public QObject {
   QString m_ipv6Address;
   QTimer m_ipAddressTimer;
 
+  // Runs outside the task scheduler: it must not wait for the other tasks.
+  QPointer<TaskIPFinder> m_ipFinder;
+  QString m_ipFinderKey;
+
+  // The recent results, by exit server public key: switching back to one of
+  // these servers shows the IP addresses without waiting for the network.
+  struct CachedAddresses {
+    QString m_ipv4Address;
+    QString m_ipv6Address;
+  };
+  QHash<QString, CachedAddresses> m_cache;
+  QStringList m_cacheOrder;
+
 #ifdef UNIT_TEST
   friend class TestIpAddressLookup;
 #endif
@@ -4,8 +4,12 @@
 
 #include "commandlineparser.h"
 #include "leakdetector.h"
+#include "startuptracer.h"
 
 Q_DECL_EXPORT int main(int argc, char* argv[]) {
+  // This is the time origin of the startup trace.
+  StartupTracer::instance();
+
 #ifdef MVPN_DEBUG
   LeakDetector leakDetector;
   Q_UNUSED(leakDetector);
@@ -111,6 +111,14 @@ Device& Device::operator=(const Device& other) {
   return *this;
 }
 
+bool Device::operator==(const Device& other) const {
+  return m_deviceName == other.m_deviceName &&
+         m_uniqueId == other.m_uniqueId && m_createdAt == other.m_createdAt &&
+         m_publicKey == other.m_publicKey &&
+         m_ipv4Address == other.m_ipv4Address &&
+         m_ipv6Address == other.m_ipv6Address;
+}
+
 Device::~Device() { MVPN_COUNT_DTOR(Device); }
 
 bool Device::fromJson(const QJsonValue& json) {
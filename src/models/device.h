@@ -16,6 +16,7 @@ class Device final {
   Device();
   Device(const Device& other);
   Device& operator=(const Device& other);
+  bool operator==(const Device& other) const;
   ~Device();
 
   static QString currentDeviceName();
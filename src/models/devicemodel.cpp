@@ -12,6 +12,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonValue>
+#include <QSet>
 
 namespace {
 Logger logger(LOG_MODEL, "DeviceModel");
@@ -69,8 +70,6 @@ bool sortCallback(const Device& a, const Device& b, const Keys* keys) {
 }  // anonymous namespace
 
 bool DeviceModel::fromJsonInternal(const Keys* keys, const QByteArray& json) {
-  beginResetModel();
-
   // Maybe we have to refresh the device list during a removal operation. If
   // this happens, maybe we have to store some of the "incoming" devices in the
   // list of the removed ones.
@@ -82,9 +81,33 @@ bool DeviceModel::fromJsonInternal(const Keys* keys, const QByteArray& json) {
   }
 
   m_rawJson = "";
-  m_devices.clear();
   m_removedDevices.clear();
 
+  QList<Device> devices;
+  if (!parseDevices(json, removedPublicKeys, devices, m_removedDevices)) {
+    beginResetModel();
+    m_devices.clear();
+    m_removedDevices.clear();
+    endResetModel();
+    return false;
+  }
+
+  std::sort(devices.begin(), devices.end(),
+            std::bind(sortCallback, std::placeholders::_1,
+                      std::placeholders::_2, keys));
+
+  // The views keep their delegates for the devices which are still there.
+  updateDevices(keys, devices);
+  emit changed();
+
+  return true;
+}
+
+// static
+bool DeviceModel::parseDevices(const QByteArray& json,
+                               const QStringList& removedPublicKeys,
+                               QList<Device>& devices,
+                               QList<Device>& removedDevices) {
   QJsonDocument doc = QJsonDocument::fromJson(json);
   if (!doc.isObject()) {
     return false;
@@ -96,12 +119,12 @@ bool DeviceModel::fromJsonInternal(const Keys* keys, const QByteArray& json) {
     return false;
   }
 
-  QJsonValue devices = obj.value("devices");
-  if (!devices.isArray()) {
+  QJsonValue devicesValue = obj.value("devices");
+  if (!devicesValue.isArray()) {
     return false;
   }
 
-  const QJsonArray devicesArray = devices.toArray();
+  const QJsonArray devicesArray = devicesValue.toArray();
   for (const QJsonValue& deviceValue : devicesArray) {
     Device device;
     if (!device.fromJson(deviceValue)) {
@@ -109,20 +132,84 @@ bool DeviceModel::fromJsonInternal(const Keys* keys, const QByteArray& json) {
     }
 
     if (removedPublicKeys.contains(device.publicKey())) {
-      m_removedDevices.append(device);
+      removedDevices.append(device);
     } else {
-      m_devices.append(device);
+      devices.append(device);
     }
   }
 
-  std::sort(m_devices.begin(), m_devices.end(),
-            std::bind(sortCallback, std::placeholders::_1,
-                      std::placeholders::_2, keys));
+  return true;
+}
 
-  endResetModel();
-  emit changed();
+void DeviceModel::updateDevices(const Keys* keys,
+                                const QList<Device>& devices) {
+  QSet<QString> publicKeys;
+  for (const Device& device : devices) {
+    publicKeys.insert(device.publicKey());
+  }
 
-  return true;
+  for (int i = m_devices.length() - 1; i >= 0; --i) {
+    if (!publicKeys.contains(m_devices.at(i).publicKey())) {
+      beginRemoveRows(QModelIndex(), i, i);
+      m_devices.removeAt(i);
+      endRemoveRows();
+    }
+  }
+
+  // Now the rows before `i` are in the final order.
+  for (int i = 0; i < devices.length(); ++i) {
+    const Device& device = devices.at(i);
+
+    int j = i;
+    while (j < m_devices.length() &&
+           m_devices.at(j).publicKey() != device.publicKey()) {
+      ++j;
+    }
+
+    if (j == m_devices.length()) {
+      beginInsertRows(QModelIndex(), i, i);
+      m_devices.insert(i, device);
+      endInsertRows();
+      continue;
+    }
+
+    if (j != i) {
+      beginMoveRows(QModelIndex(), j, j, QModelIndex(), i);
+      m_devices.move(j, i);
+      endMoveRows();
+    }
+
+    const Device& current = m_devices.at(i);
+    if (current == device) {
+      continue;
+    }
+
+    QVector<int> roles;
+    if (current.name() != device.name()) {
+      roles << NameRole;
+    }
+    if (current.createdAt() != device.createdAt()) {
+      roles << CreatedAtRole;
+    }
+    if (keys && current.isCurrentDevice(keys) != device.isCurrentDevice(keys)) {
+      roles << CurrentOneRole;
+    }
+
+    // The addresses and the unique ID are not exposed to the views.
+    m_devices[i] = device;
+    if (!roles.isEmpty()) {
+      emit dataChanged(index(i, 0), index(i, 0), roles);
+    }
+  }
+
+  // Only with duplicated public keys.
+  if (m_devices.length() > devices.length()) {
+    beginRemoveRows(QModelIndex(), devices.length(), m_devices.length() - 1);
+    while (m_devices.length() > devices.length()) {
+      m_devices.removeLast();
+    }
+    endRemoveRows();
+  }
 }
 
 void DeviceModel::writeSettings() {
@@ -186,17 +273,16 @@ void DeviceModel::stopDeviceRemovalFromPublicKey(const QString& publicKey,
       // We were not supposed to find the device in this list. If this happens
       // is because something went wrong during the removal operation. Let's
       // bring the device back.
-      beginResetModel();
-
-      m_devices.append(*i);
+      QList<Device> devices = m_devices;
+      devices.append(*i);
 
-      std::sort(m_devices.begin(), m_devices.end(),
+      std::sort(devices.begin(), devices.end(),
                 std::bind(sortCallback, std::placeholders::_1,
                           std::placeholders::_2, keys));
 
       m_removedDevices.erase(i);
 
-      endResetModel();
+      updateDevices(keys, devices);
       emit changed();
       break;
     }
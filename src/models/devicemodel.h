@@ -67,6 +67,14 @@ class DeviceModel final : public QAbstractListModel {
 
  private:
   [[nodiscard]] bool fromJsonInternal(const Keys* keys, const QByteArray& json);
+  [[nodiscard]] static bool parseDevices(const QByteArray& json,
+                                         const QStringList& removedPublicKeys,
+                                         QList<Device>& devices,
+                                         QList<Device>& removedDevices);
+
+  // Applies `devices` to the model with the minimal row insertions, removals,
+  // moves and data changes, matching the devices by public key.
+  void updateDevices(const Keys* keys, const QList<Device>& devices);
 
   bool removeRows(int row, int count,
                   const QModelIndex& parent = QModelIndex()) override;
@@ -153,10 +153,13 @@ QObject* FeatureModel::get(const QString& feature) {
 }
 
 void FeatureModel::updateFeatureList(const QByteArray& data) {
+  updateFeatureList(QJsonDocument::fromJson(data).object());
+}
+
+void FeatureModel::updateFeatureList(const QJsonObject& json) {
   SettingsHolder* settingsHolder = SettingsHolder::instance();
   Q_ASSERT(settingsHolder);
 
-  QJsonObject json = QJsonDocument::fromJson(data).object();
   if (json.contains("featuresOverwrite")) {
     QJsonValue featuresValue = json["featuresOverwrite"];
     if (!featuresValue.isObject()) {
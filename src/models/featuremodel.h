@@ -9,6 +9,7 @@
 #include <QAbstractListModel>
 
 class Feature;
+class QJsonObject;
 
 class FeatureModel final : public QAbstractListModel {
   Q_OBJECT
@@ -25,6 +26,7 @@ class FeatureModel final : public QAbstractListModel {
   static FeatureModel* instance();
 
   void updateFeatureList(const QByteArray& data);
+  void updateFeatureList(const QJsonObject& json);
 
   // QAbstractListModel methods
   QHash<int, QByteArray> roleNames() const override;
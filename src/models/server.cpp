@@ -126,6 +126,12 @@ bool Server::fromJson(const QJsonObject& obj) {
   return true;
 }
 
+void Server::sharePortRanges(const Server& other) {
+  if (m_portRanges == other.m_portRanges) {
+    m_portRanges = other.m_portRanges;
+  }
+}
+
 bool Server::fromMultihop(const Server& exit, const Server& entry) {
   m_hostname = exit.m_hostname;
   m_ipv4Gateway = exit.m_ipv4Gateway;
@@ -21,6 +21,10 @@ class Server final {
   [[nodiscard]] bool fromJson(const QJsonObject& obj);
   bool fromMultihop(const Server& exit, const Server& entry);
 
+  // Most of the servers have the same port ranges: the list of `other` is
+  // shared if it is equal.
+  void sharePortRanges(const Server& other);
+
   static const Server& weightChooser(const QList<Server>& servers);
 
   bool initialized() const { return !m_hostname.isEmpty(); }
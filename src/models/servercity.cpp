@@ -27,10 +27,17 @@ ServerCity& ServerCity::operator=(const ServerCity& other) {
   m_latitude = other.m_latitude;
   m_longitude = other.m_longitude;
   m_servers = other.m_servers;
+  m_serverIndexes = other.m_serverIndexes;
 
   return *this;
 }
 
+bool ServerCity::operator==(const ServerCity& other) const {
+  return m_name == other.m_name && m_code == other.m_code &&
+         m_country == other.m_country && m_latitude == other.m_latitude &&
+         m_longitude == other.m_longitude && m_servers == other.m_servers;
+}
+
 ServerCity::~ServerCity() { MVPN_COUNT_DTOR(ServerCity); }
 
 bool ServerCity::fromJson(const QJsonObject& obj, const QString& country) {
@@ -87,6 +94,19 @@ bool ServerCity::fromJson(const QJsonObject& obj, const QString& country) {
   return true;
 }
 
+void ServerCity::resolveServers(const QHash<QString, int>& indexes) {
+  m_serverIndexes.clear();
+  m_serverIndexes.reserve(m_servers.length());
+
+  for (QString& pubkey : m_servers) {
+    auto i = indexes.constFind(pubkey);
+    if (i != indexes.constEnd()) {
+      pubkey = i.key();
+      m_serverIndexes.append(i.value());
+    }
+  }
+}
+
 const QString ServerCity::localizedName() const {
   return ServerI18N::translateCityName(m_country, m_name);
 }
@@ -7,26 +7,19 @@
 
 #include "server.h"
 
+#include <QHash>
 #include <QList>
-#include <QObject>
 #include <QString>
 
 class QJsonObject;
 
-class ServerCity final : public QObject {
-  Q_OBJECT
-
-  Q_PROPERTY(QString name READ name CONSTANT)
-  Q_PROPERTY(QString code READ code CONSTANT)
-  Q_PROPERTY(QString coutnry READ country CONSTANT)
-  Q_PROPERTY(QString localizedName READ localizedName CONSTANT)
-  Q_PROPERTY(double latitude READ latitude CONSTANT)
-  Q_PROPERTY(double longitude READ longitude CONSTANT)
-
+// The views read the cities through ServerCityModel.
+class ServerCity final {
  public:
   ServerCity();
   ServerCity(const ServerCity& other);
   ServerCity& operator=(const ServerCity& other);
+  bool operator==(const ServerCity& other) const;
   ~ServerCity();
 
   [[nodiscard]] bool fromJson(const QJsonObject& obj, const QString& country);
@@ -43,16 +36,25 @@ class ServerCity final : public QObject {
 
   double longitude() const { return m_longitude; }
 
-  const QList<QString> servers() const { return m_servers; }
+  const QList<QString>& servers() const { return m_servers; }
+
+  // The indexes of the servers in ServerCountryModel::servers(), in the order
+  // of servers(). Empty until resolved by the model.
+  const QList<int>& serverIndexes() const { return m_serverIndexes; }
+
+  // Resolves the indexes of the servers with `indexes`, the index of each
+  // public key. The public keys share the data of the keys of `indexes`.
+  void resolveServers(const QHash<QString, int>& indexes);
 
  private:
   QString m_country;
   QString m_name;
   QString m_code;
-  double m_latitude;
-  double m_longitude;
+  double m_latitude = 0;
+  double m_longitude = 0;
 
   QList<QString> m_servers;
+  QList<int> m_serverIndexes;
 };
 
 #endif  // SERVERCITY_H
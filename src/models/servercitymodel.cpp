@@ -0,0 +1,64 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "servercitymodel.h"
+#include "leakdetector.h"
+
+ServerCityModel::ServerCityModel(QObject* parent)
+    : QAbstractListModel(parent) {
+  MVPN_COUNT_CTOR(ServerCityModel);
+}
+
+ServerCityModel::~ServerCityModel() { MVPN_COUNT_DTOR(ServerCityModel); }
+
+void ServerCityModel::setCities(const QList<ServerCity>& cities) {
+  // Equal cities are still taken: the indexes of their servers follow the
+  // new server list.
+  if (m_cities == cities) {
+    m_cities = cities;
+    return;
+  }
+
+  // A country has a few cities, and they rarely change: a reset of this
+  // model keeps the delegates of the other countries.
+  beginResetModel();
+  m_cities = cities;
+  endResetModel();
+}
+
+void ServerCityModel::retranslate() {
+  if (!m_cities.isEmpty()) {
+    emit dataChanged(index(0, 0), index(m_cities.length() - 1, 0),
+                     {LocalizedNameRole});
+  }
+}
+
+QHash<int, QByteArray> ServerCityModel::roleNames() const {
+  QHash<int, QByteArray> roles;
+  roles[NameRole] = "name";
+  roles[LocalizedNameRole] = "localizedName";
+  roles[CodeRole] = "code";
+  return roles;
+}
+
+QVariant ServerCityModel::data(const QModelIndex& index, int role) const {
+  if (!index.isValid() || index.row() >= m_cities.length()) {
+    return QVariant();
+  }
+
+  const ServerCity& city = m_cities.at(index.row());
+  switch (role) {
+    case NameRole:
+      return QVariant(city.name());
+
+    case LocalizedNameRole:
+      return QVariant(city.localizedName());
+
+    case CodeRole:
+      return QVariant(city.code());
+
+    default:
+      return QVariant();
+  }
+}
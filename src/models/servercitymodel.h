@@ -0,0 +1,47 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SERVERCITYMODEL_H
+#define SERVERCITYMODEL_H
+
+#include "servercity.h"
+
+#include <QAbstractListModel>
+#include <QList>
+
+// The cities of a country, as shown by the server list. ServerCountryModel
+// keeps one of these for each country, across the updates of the server list.
+class ServerCityModel final : public QAbstractListModel {
+  Q_OBJECT
+  Q_DISABLE_COPY_MOVE(ServerCityModel)
+
+ public:
+  enum ServerCityRoles {
+    NameRole = Qt::UserRole + 1,
+    LocalizedNameRole,
+    CodeRole,
+  };
+
+  explicit ServerCityModel(QObject* parent);
+  ~ServerCityModel();
+
+  const QList<ServerCity>& cities() const { return m_cities; }
+
+  void setCities(const QList<ServerCity>& cities);
+
+  void retranslate();
+
+  // QAbstractListModel methods
+
+  QHash<int, QByteArray> roleNames() const override;
+
+  int rowCount(const QModelIndex&) const override { return m_cities.length(); }
+
+  QVariant data(const QModelIndex& index, int role) const override;
+
+ private:
+  QList<ServerCity> m_cities;
+};
+
+#endif  // SERVERCITYMODEL_H
@@ -30,6 +30,11 @@ ServerCountry& ServerCountry::operator=(const ServerCountry& other) {
   return *this;
 }
 
+bool ServerCountry::operator==(const ServerCountry& other) const {
+  return m_name == other.m_name && m_code == other.m_code &&
+         m_cities == other.m_cities;
+}
+
 ServerCountry::~ServerCountry() { MVPN_COUNT_DTOR(ServerCountry); }
 
 bool ServerCountry::fromJson(const QJsonObject& countryObj) {
@@ -78,14 +83,21 @@ bool ServerCountry::fromJson(const QJsonObject& countryObj) {
   return true;
 }
 
-const QList<QString> ServerCountry::servers(const ServerData& data) const {
+const QList<QString>& ServerCountry::servers(const ServerData& data) const {
   for (const ServerCity& city : m_cities) {
     if (city.name() == data.exitCityName()) {
       return city.servers();
     }
   }
 
-  return QList<QString>();
+  static const QList<QString> s_noServers;
+  return s_noServers;
+}
+
+void ServerCountry::resolveServers(const QHash<QString, int>& indexes) {
+  for (ServerCity& city : m_cities) {
+    city.resolveServers(indexes);
+  }
 }
 
 namespace {
@@ -18,6 +18,7 @@ class ServerCountry final {
   ServerCountry();
   ServerCountry(const ServerCountry& other);
   ServerCountry& operator=(const ServerCountry& other);
+  bool operator==(const ServerCountry& other) const;
   ~ServerCountry();
 
   [[nodiscard]] bool fromJson(const QJsonObject& obj);
@@ -28,10 +29,12 @@ class ServerCountry final {
 
   const QList<ServerCity>& cities() const { return m_cities; }
 
-  const QList<QString> servers(const ServerData& data) const;
+  const QList<QString>& servers(const ServerData& data) const;
 
   void sortCities();
 
+  void resolveServers(const QHash<QString, int>& indexes);
+
  private:
   QString m_name;
   QString m_code;
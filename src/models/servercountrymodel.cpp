@@ -7,20 +7,32 @@
 #include "leakdetector.h"
 #include "logger.h"
 #include "models/feature.h"
+#include "servercitymodel.h"
 #include "servercountry.h"
 #include "serverdata.h"
 #include "serveri18n.h"
 #include "settingsholder.h"
 
+#include <QDateTime>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QRandomGenerator>
+#include <QSet>
 
 namespace {
 Logger logger(LOG_MODEL, "ServerCountryModel");
+
+// Seeded with the clock: a generation is never reused, not even by another
+// model or after a restart. The clients of the extension bridge keep it
+// across reconnections.
+quint64 nextGeneration() {
+  static quint64 s_lastGeneration = QDateTime::currentMSecsSinceEpoch();
+  return ++s_lastGeneration;
 }
 
+}  // namespace
+
 ServerCountryModel::ServerCountryModel() {
   MVPN_COUNT_CTOR(ServerCountryModel);
 }
@@ -36,7 +48,7 @@ bool ServerCountryModel::fromSettings() {
   logger.debug() << "Reading the server list from settings";
 
   const QByteArray json = settingsHolder->servers();
-  if (json.isEmpty() || !fromJsonInternal(json)) {
+  if (json.isEmpty() || !fromJsonInternal(QJsonDocument::fromJson(json))) {
     return false;
   }
 
@@ -45,6 +57,11 @@ bool ServerCountryModel::fromSettings() {
 }
 
 bool ServerCountryModel::fromJson(const QByteArray& s) {
+  return fromJson(s, QJsonDocument());
+}
+
+bool ServerCountryModel::fromJson(const QByteArray& s,
+                                  const QJsonDocument& doc) {
   logger.debug() << "Reading from JSON";
 
   if (!s.isEmpty() && m_rawJson == s) {
@@ -52,7 +69,7 @@ bool ServerCountryModel::fromJson(const QByteArray& s) {
     return true;
   }
 
-  if (!fromJsonInternal(s)) {
+  if (!fromJsonInternal(doc.isNull() ? QJsonDocument::fromJson(s) : doc)) {
     return false;
   }
 
@@ -61,26 +78,60 @@ bool ServerCountryModel::fromJson(const QByteArray& s) {
   return true;
 }
 
-bool ServerCountryModel::fromJsonInternal(const QByteArray& s) {
-  beginResetModel();
-
+bool ServerCountryModel::fromJsonInternal(const QJsonDocument& doc) {
   m_rawJson = "";
-  m_countries.clear();
-  m_servers.clear();
+  m_generation = nextGeneration();
+
+  QList<ServerCountry> countries;
+  QList<Server> servers;
+  QHash<QString, int> serverIndexes;
+  if (!parseCountries(doc, countries, servers, serverIndexes)) {
+    beginResetModel();
+    m_countries.clear();
+    m_servers.clear();
+    m_serverIndexes.clear();
+    endResetModel();
+
+    for (ServerCityModel* cityModel : m_cityModels) {
+      cityModel->deleteLater();
+    }
+    m_cityModels.clear();
+    return false;
+  }
 
-  QJsonDocument doc = QJsonDocument::fromJson(s);
+  // The views can query the scores of the current countries while they are
+  // updated: all of them must reference the new servers.
+  for (ServerCountry& country : m_countries) {
+    country.resolveServers(serverIndexes);
+  }
+
+  m_servers.swap(servers);
+  m_serverIndexes.swap(serverIndexes);
+
+  // The views keep their delegates for the countries which are still there.
+  sortCountries(countries);
+  updateCountries(countries);
+
+  return true;
+}
+
+// static
+bool ServerCountryModel::parseCountries(const QJsonDocument& doc,
+                                        QList<ServerCountry>& countries,
+                                        QList<Server>& servers,
+                                        QHash<QString, int>& serverIndexes) {
   if (!doc.isObject()) {
     return false;
   }
 
   QJsonObject obj = doc.object();
 
-  QJsonValue countries = obj.value("countries");
-  if (!countries.isArray()) {
+  QJsonValue countriesValue = obj.value("countries");
+  if (!countriesValue.isArray()) {
     return false;
   }
 
-  QJsonArray countriesArray = countries.toArray();
+  QJsonArray countriesArray = countriesValue.toArray();
   for (const QJsonValue& countryValue : countriesArray) {
     if (!countryValue.isObject()) {
       return false;
@@ -97,42 +148,136 @@ bool ServerCountryModel::fromJsonInternal(const QByteArray& s) {
       continue;
     }
 
-    m_countries.append(country);
+    countries.append(country);
 
-    QJsonValue cities = countryObj.value("cities");
-    if (!cities.isArray()) {
+    QJsonValue citiesValue = countryObj.value("cities");
+    if (!citiesValue.isArray()) {
       return false;
     }
 
-    QJsonArray cityArray = cities.toArray();
+    QJsonArray cityArray = citiesValue.toArray();
     for (const QJsonValue& cityValue : cityArray) {
       if (!cityValue.isObject()) {
         return false;
       }
       QJsonObject cityObj = cityValue.toObject();
-      QJsonValue servers = cityObj.value("servers");
-      if (!servers.isArray()) {
+      QJsonValue serversValue = cityObj.value("servers");
+      if (!serversValue.isArray()) {
         return false;
       }
 
-      QJsonArray serverArray = servers.toArray();
+      QJsonArray serverArray = serversValue.toArray();
       for (const QJsonValue& serverValue : serverArray) {
         Server server;
         if (!server.fromJson(serverValue.toObject())) {
           return false;
         }
-        m_servers[server.publicKey()] = server;
+
+        if (!servers.isEmpty()) {
+          server.sharePortRanges(servers.last());
+        }
+
+        // The last server with a public key wins.
+        auto i = serverIndexes.constFind(server.publicKey());
+        if (i != serverIndexes.constEnd()) {
+          servers[i.value()] = server;
+        } else {
+          serverIndexes.insert(server.publicKey(), servers.length());
+          servers.append(server);
+        }
       }
     }
   }
 
-  sortCountries();
-
-  endResetModel();
+  // The cities reference their servers by index, and keep the same public key
+  // strings as the servers.
+  for (ServerCountry& country : countries) {
+    country.resolveServers(serverIndexes);
+  }
 
   return true;
 }
 
+void ServerCountryModel::updateCountries(
+    const QList<ServerCountry>& countries) {
+  // The city models are kept across the updates: the views bound to them keep
+  // the same object.
+  QSet<QString> codes;
+  for (const ServerCountry& country : countries) {
+    codes.insert(country.code());
+
+    ServerCityModel*& cityModel = m_cityModels[country.code()];
+    if (!cityModel) {
+      cityModel = new ServerCityModel(this);
+    }
+    cityModel->setCities(country.cities());
+  }
+
+  for (int i = m_countries.length() - 1; i >= 0; --i) {
+    if (!codes.contains(m_countries.at(i).code())) {
+      beginRemoveRows(QModelIndex(), i, i);
+      m_countries.removeAt(i);
+      endRemoveRows();
+    }
+  }
+
+  // Now the rows before `i` are in the final order.
+  for (int i = 0; i < countries.length(); ++i) {
+    const ServerCountry& country = countries.at(i);
+
+    int j = i;
+    while (j < m_countries.length() &&
+           m_countries.at(j).code() != country.code()) {
+      ++j;
+    }
+
+    if (j == m_countries.length()) {
+      beginInsertRows(QModelIndex(), i, i);
+      m_countries.insert(i, country);
+      endInsertRows();
+      continue;
+    }
+
+    if (j != i) {
+      beginMoveRows(QModelIndex(), j, j, QModelIndex(), i);
+      m_countries.move(j, i);
+      endMoveRows();
+    }
+
+    if (m_countries.at(i) == country) {
+      continue;
+    }
+
+    // The cities are already updated in their own model.
+    bool nameChanged = m_countries.at(i).name() != country.name();
+    m_countries[i] = country;
+    if (nameChanged) {
+      emit dataChanged(index(i, 0), index(i, 0),
+                       {NameRole, LocalizedNameRole});
+    }
+  }
+
+  // Only with duplicated country codes.
+  if (m_countries.length() > countries.length()) {
+    beginRemoveRows(QModelIndex(), countries.length(),
+                    m_countries.length() - 1);
+    while (m_countries.length() > countries.length()) {
+      m_countries.removeLast();
+    }
+    endRemoveRows();
+  }
+
+  for (auto i = m_cityModels.begin(); i != m_cityModels.end();) {
+    if (codes.contains(i.key())) {
+      ++i;
+      continue;
+    }
+
+    i.value()->deleteLater();
+    i = m_cityModels.erase(i);
+  }
+}
+
 QHash<int, QByteArray> ServerCountryModel::roleNames() const {
   QHash<int, QByteArray> roles;
   roles[NameRole] = "name";
@@ -160,16 +305,9 @@ QVariant ServerCountryModel::data(const QModelIndex& index, int role) const {
     case CodeRole:
       return QVariant(m_countries.at(index.row()).code());
 
-    case CitiesRole: {
-      const ServerCountry& country = m_countries.at(index.row());
-
-      QList<QVariant> list;
-      for (const ServerCity& city : country.cities()) {
-        list.append(QVariant::fromValue(&city));
-      }
-
-      return QVariant(list);
-    }
+    case CitiesRole:
+      return QVariant::fromValue(
+          m_cityModels.value(m_countries.at(index.row()).code()));
 
     default:
       return QVariant();
@@ -204,8 +342,8 @@ int ServerCountryModel::cityConnectionScore(const ServerCity& city) const {
   int score = Poor;
   int activeServerCount = 0;
   uint32_t sumLatencyMsec = 0;
-  for (const QString& pubkey : city.servers()) {
-    const Server& server = m_servers[pubkey];
+  for (int index : city.serverIndexes()) {
+    const Server& server = m_servers.at(index);
     if (server.cooldownTimeout() <= now) {
       sumLatencyMsec += server.latency();
       activeServerCount++;
@@ -305,9 +443,8 @@ bool ServerCountryModel::pickByIPv4Address(const QString& ipv4Address,
 
   for (const ServerCountry& country : m_countries) {
     for (const ServerCity& city : country.cities()) {
-      for (const QString& pubkey : city.servers()) {
-        const Server server = m_servers.value(pubkey);
-        if (server.ipv4AddrIn() == ipv4Address) {
+      for (int index : city.serverIndexes()) {
+        if (m_servers.at(index).ipv4AddrIn() == ipv4Address) {
           data.update(country.code(), city.name());
           return true;
         }
@@ -343,8 +480,9 @@ const QList<Server> ServerCountryModel::servers(const ServerData& data) const {
   for (const ServerCountry& country : m_countries) {
     if (country.code() == data.exitCountryCode()) {
       for (const QString& pubkey : country.servers(data)) {
-        if (m_servers.contains(pubkey)) {
-          results.append(m_servers.value(pubkey));
+        int index = m_serverIndexes.value(pubkey, -1);
+        if (index >= 0) {
+          results.append(m_servers.at(index));
         }
       }
     }
@@ -376,22 +514,44 @@ QString ServerCountryModel::getLocalizedCountryName(
 }
 
 void ServerCountryModel::retranslate() {
-  beginResetModel();
-  sortCountries();
-  endResetModel();
+  // The order of the countries and the cities follows the language: the
+  // serialized server list has to change too.
+  m_generation = nextGeneration();
+
+  QList<ServerCountry> countries = m_countries;
+  sortCountries(countries);
+  updateCountries(countries);
+
+  if (!m_countries.isEmpty()) {
+    emit dataChanged(index(0, 0), index(m_countries.length() - 1, 0),
+                     {LocalizedNameRole});
+  }
+
+  for (ServerCityModel* cityModel : m_cityModels) {
+    cityModel->retranslate();
+  }
+}
+
+const Server& ServerCountryModel::server(const QString& pubkey) const {
+  static const Server s_noServer;
+
+  int index = m_serverIndexes.value(pubkey, -1);
+  return index >= 0 ? m_servers.at(index) : s_noServer;
 }
 
 void ServerCountryModel::setServerLatency(const QString& publicKey,
                                           unsigned int msec) {
-  if (m_servers.contains(publicKey)) {
-    m_servers[publicKey].setLatency(msec);
+  int index = m_serverIndexes.value(publicKey, -1);
+  if (index >= 0) {
+    m_servers[index].setLatency(msec);
   }
 }
 
 void ServerCountryModel::setServerCooldown(const QString& publicKey,
                                            unsigned int duration) {
-  if (m_servers.contains(publicKey)) {
-    m_servers[publicKey].setCooldownTimeout(duration);
+  int index = m_serverIndexes.value(publicKey, -1);
+  if (index >= 0) {
+    m_servers[index].setCooldownTimeout(duration);
   }
 }
 
@@ -428,13 +588,14 @@ bool sortCountryCallback(const ServerCountry& a, const ServerCountry& b,
 
 }  // anonymous namespace
 
-void ServerCountryModel::sortCountries() {
+// static
+void ServerCountryModel::sortCountries(QList<ServerCountry>& countries) {
   Collator collator;
-  std::sort(m_countries.begin(), m_countries.end(),
+  std::sort(countries.begin(), countries.end(),
             std::bind(sortCountryCallback, std::placeholders::_1,
                       std::placeholders::_2, &collator));
 
-  for (ServerCountry& country : m_countries) {
+  for (ServerCountry& country : countries) {
     country.sortCities();
   }
 }
@@ -11,6 +11,8 @@
 #include <QByteArray>
 #include <QObject>
 
+class QJsonDocument;
+class ServerCityModel;
 class ServerData;
 
 class ServerCountryModel final : public QAbstractListModel {
@@ -40,9 +42,16 @@ class ServerCountryModel final : public QAbstractListModel {
   [[nodiscard]] bool fromSettings();
 
   [[nodiscard]] bool fromJson(const QByteArray& data);
+  // `json` is `data` already parsed, e.g. in the worker pool.
+  [[nodiscard]] bool fromJson(const QByteArray& data,
+                              const QJsonDocument& json);
 
   bool initialized() const { return !m_rawJson.isEmpty(); }
 
+  // Changes every time the list of countries, cities or servers changes. It
+  // does not change with the latency and cooldown updates.
+  quint64 generation() const { return m_generation; }
+
   Q_INVOKABLE QStringList pickRandom();
 
   void pickRandom(ServerData& data) const;
@@ -56,8 +65,8 @@ class ServerCountryModel final : public QAbstractListModel {
   bool exists(ServerData& data) const;
 
   const QList<Server> servers(const ServerData& data) const;
-  const QList<Server> servers() const { return m_servers.values(); };
-  Server server(const QString& pubkey) const { return m_servers.value(pubkey); }
+  const QList<Server>& servers() const { return m_servers; }
+  const Server& server(const QString& pubkey) const;
 
   const QString countryName(const QString& countryCode) const;
 
@@ -91,16 +100,31 @@ class ServerCountryModel final : public QAbstractListModel {
   void changed();
 
  private:
-  [[nodiscard]] bool fromJsonInternal(const QByteArray& data);
+  [[nodiscard]] bool fromJsonInternal(const QJsonDocument& json);
+  [[nodiscard]] static bool parseCountries(const QJsonDocument& json,
+                                           QList<ServerCountry>& countries,
+                                           QList<Server>& servers,
+                                           QHash<QString, int>& serverIndexes);
+
+  // Applies `countries` to the model with the minimal row insertions,
+  // removals, moves and data changes, matching the countries by code.
+  void updateCountries(const QList<ServerCountry>& countries);
 
-  void sortCountries();
+  static void sortCountries(QList<ServerCountry>& countries);
   int cityConnectionScore(const ServerCity& city) const;
 
  private:
   QByteArray m_rawJson;
 
   QList<ServerCountry> m_countries;
-  QHash<QString, Server> m_servers;
+  // The servers, in the order of the list, and their indexes by public key.
+  QList<Server> m_servers;
+  QHash<QString, int> m_serverIndexes;
+
+  // The cities of each country, by country code, for CitiesRole.
+  QHash<QString, ServerCityModel*> m_cityModels;
+
+  quint64 m_generation = 0;
 };
 
 #endif  // SERVERCOUNTRYMODEL_H
@@ -16,11 +16,13 @@
 #include "models/feature.h"
 #include "mozillavpn.h"
 #include "networkmanager.h"
+#include "networkrequest.h"
 #include "profileflow.h"
 #include "productshandler.h"
 #include "purchasehandler.h"
 #include "qmlengineholder.h"
 #include "settingsholder.h"
+#include "startuptracer.h"
 #include "tasks/account/taskaccount.h"
 #include "tasks/adddevice/taskadddevice.h"
 #include "tasks/addonindex/taskaddonindex.h"
@@ -227,23 +229,33 @@ void MozillaVPN::initialize() {
   // This is our first state.
   Q_ASSERT(m_state == StateInitialize);
 
-  m_private->m_releaseMonitor.runSoon();
+  StartupTracer* tracer = StartupTracer::instance();
+  StartupTracer::Span initializeSpan("MozillaVPN::initialize", tracer);
 
-  m_private->m_telemetry.initialize();
-
-  m_private->m_connectionBenchmark.initialize();
-
-  m_private->m_ipAddressLookup.initialize();
+  {
+    StartupTracer::Span span("ReleaseMonitor", tracer);
+    m_private->m_releaseMonitor.runSoon();
+  }
 
-  m_private->m_serverLatency.initialize();
+  {
+    StartupTracer::Span span("Telemetry", tracer);
+    m_private->m_telemetry.initialize();
+  }
 
-  if (Feature::get(Feature::Feature_websocket)->isSupported()) {
-    m_private->m_webSocketHandler.initialize();
+  {
+    StartupTracer::Span span("IpAddressLookup", tracer);
+    m_private->m_ipAddressLookup.initialize();
   }
 
-  AddonManager::instance();
+  {
+    StartupTracer::Span span("Glean", tracer);
+    Glean::initialize();
+  }
 
-  Glean::initialize();
+  // The connection benchmark, the server latency, the websocket and the
+  // add-ons are not needed to show the first frame.
+  QTimer::singleShot(Constants::DEFERRED_INITIALIZATION_MSEC, this,
+                     &MozillaVPN::initializeDeferredSubsystems);
 
   QList<Task*> initTasks{new TaskAddonIndex(), new TaskGetFeatureList()};
 
@@ -261,8 +273,15 @@ void MozillaVPN::initialize() {
   AndroidUtils::instance();
 #endif
 
-  m_private->m_captivePortalDetection.initialize();
-  m_private->m_networkWatcher.initialize();
+  {
+    StartupTracer::Span span("CaptivePortalDetection", tracer);
+    m_private->m_captivePortalDetection.initialize();
+  }
+
+  {
+    StartupTracer::Span span("NetworkWatcher", tracer);
+    m_private->m_networkWatcher.initialize();
+  }
 
   if (!settingsHolder->hasToken()) {
     return;
@@ -270,6 +289,8 @@ void MozillaVPN::initialize() {
 
   logger.debug() << "We have a valid token";
 
+  StartupTracer::Span settingsSpan("Load from settings", tracer);
+
   if (!m_private->m_user.fromSettings()) {
     logger.error() << "No user data found";
     return;
@@ -338,6 +359,52 @@ void MozillaVPN::initialize() {
   maybeStateMain();
 }
 
+void MozillaVPN::initializeDeferredSubsystems() {
+  if (m_deferredSubsystemsInitialized) {
+    return;
+  }
+  m_deferredSubsystemsInitialized = true;
+
+  logger.debug() << "Initializing the deferred subsystems";
+
+  StartupTracer* tracer = StartupTracer::instance();
+
+  {
+    StartupTracer::Span span("ConnectionBenchmark", tracer);
+    m_private->m_connectionBenchmark.initialize();
+  }
+
+  {
+    StartupTracer::Span span("ServerLatency", tracer);
+    m_private->m_serverLatency.initialize();
+  }
+
+  if (Feature::get(Feature::Feature_websocket)->isSupported()) {
+    StartupTracer::Span span("WebSocketHandler", tracer);
+    m_private->m_webSocketHandler.initialize();
+  }
+
+  {
+    StartupTracer::Span span("AddonManager", tracer);
+    AddonManager::instance()->initialize();
+  }
+
+#ifndef MVPN_WASM
+  // The hosts are resolved again when the network changes.
+  prefetchHosts();
+  connect(&m_private->m_networkWatcher, &NetworkWatcher::networkChange, this,
+          &MozillaVPN::prefetchHosts);
+#endif
+
+  tracer->finish();
+}
+
+void MozillaVPN::prefetchHosts() {
+  NetworkManager::instance()->prefetchHosts(
+      {QUrl(NetworkRequest::apiBaseUrl()), QUrl(Constants::fxaApiBaseUrl()),
+       QUrl(Constants::fxaUrl()), QUrl(AddonManager::addonServerAddress())});
+}
+
 void MozillaVPN::setState(State state) {
   logger.debug() << "Set state:" << state;
 
@@ -643,8 +710,9 @@ void MozillaVPN::deviceRemoved(const QString& publicKey,
   }));
 }
 
-bool MozillaVPN::setServerList(const QByteArray& serverData) {
-  if (!m_private->m_serverCountryModel.fromJson(serverData)) {
+bool MozillaVPN::setServerList(const QByteArray& serverData,
+                               const QJsonDocument& json) {
+  if (!m_private->m_serverCountryModel.fromJson(serverData, json)) {
     logger.error() << "Failed to store the server-countries";
     return false;
   }
@@ -653,10 +721,11 @@ bool MozillaVPN::setServerList(const QByteArray& serverData) {
   return true;
 }
 
-void MozillaVPN::serversFetched(const QByteArray& serverData) {
+void MozillaVPN::serversFetched(const QByteArray& serverData,
+                                const QJsonDocument& json) {
   logger.debug() << "Server fetched!";
 
-  if (!setServerList(serverData)) {
+  if (!setServerList(serverData, json)) {
     // This is OK. The check is done elsewhere.
     return;
   }
@@ -39,6 +39,7 @@
 #include <QTimer>
 #include <QVariant>
 
+class QJsonDocument;
 class QTextStream;
 
 class MozillaVPN final : public QObject {
@@ -103,6 +104,11 @@ class MozillaVPN final : public QObject {
 
   void initialize();
 
+  // Initializes what is not needed to show the first frame. This is called
+  // when the first frame is rendered or, at the latest, a few seconds after
+  // `initialize()`.
+  void initializeDeferredSubsystems();
+
   State state() const;
 
   const QString& exitServerPublicKey() const { return m_exitServerPublicKey; }
@@ -203,7 +209,7 @@ class MozillaVPN final : public QObject {
                                       const QString& privateKey);
   void resetJournalPublicAndPrivateKeys();
 
-  void serversFetched(const QByteArray& serverData);
+  void serversFetched(const QByteArray& serverData, const QJsonDocument& json);
 
   void accountChecked(const QByteArray& json);
 
@@ -241,7 +247,8 @@ class MozillaVPN final : public QObject {
 
   void setToken(const QString& token);
 
-  [[nodiscard]] bool setServerList(const QByteArray& serverData);
+  [[nodiscard]] bool setServerList(const QByteArray& serverData,
+                                   const QJsonDocument& json);
 
   Q_INVOKABLE void reset(bool forceInitialState);
 
@@ -315,6 +322,8 @@ class MozillaVPN final : public QObject {
 
   bool checkCurrentDevice();
 
+  void prefetchHosts();
+
  public slots:
   void requestSettings();
   void requestAbout();
@@ -346,6 +355,7 @@ class MozillaVPN final : public QObject {
 
  private:
   bool m_initialized = false;
+  bool m_deferredSubsystemsInitialized = false;
 
   // Internal objects.
   struct Private {
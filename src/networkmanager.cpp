@@ -5,17 +5,24 @@
 #include "networkmanager.h"
 #include "constants.h"
 #include "leakdetector.h"
+#include "logger.h"
 #include "models/feature.h"
 
 #if MVPN_WINDOWS
 #  include "platforms/windows/windowscommons.h"
 #endif
 
+#include <QElapsedTimer>
+#include <QHostInfo>
+#include <QNetworkReply>
+#include <QSharedPointer>
 #include <QTextStream>
 
 namespace {
+Logger logger(LOG_NETWORKING, "NetworkManager");
+
 NetworkManager* s_instance = nullptr;
-}
+}  // namespace
 
 NetworkManager::NetworkManager() {
   MVPN_COUNT_CTOR(NetworkManager);
@@ -102,3 +109,65 @@ void NetworkManager::decreaseNetworkRequestCount() {
     clearCacheInternal();
   }
 }
+
+void NetworkManager::prefetchHosts(const QList<QUrl>& urls) {
+  for (const QUrl& url : urls) {
+    QString host = url.host();
+    if (host.isEmpty() || m_pendingHosts.contains(host)) {
+      continue;
+    }
+
+    logger.debug() << "Prefetching" << host;
+    m_pendingHosts.insert(host);
+
+    // QHostInfo resolves the two families in parallel, and it fills the cache
+    // used by QNetworkAccessManager.
+    QHostInfo::lookupHost(host, this, [this, host](const QHostInfo& hostInfo) {
+      m_pendingHosts.remove(host);
+
+      if (hostInfo.error() != QHostInfo::NoError) {
+        logger.warning() << "Unable to resolve" << host << ":"
+                         << hostInfo.errorString();
+      }
+    });
+  }
+}
+
+void NetworkManager::observeReply(QNetworkReply* reply) {
+#if QT_VERSION >= 0x060300
+  // Invalid when no connection is pending: the request goes through a reused
+  // connection, or it has been sent already.
+  QSharedPointer<QElapsedTimer> connectTimer(new QElapsedTimer());
+
+  connect(reply, &QNetworkReply::socketStartedConnecting, this,
+          [connectTimer]() { connectTimer->start(); });
+
+  connect(reply, &QNetworkReply::requestSent, this,
+          [this, reply, connectTimer]() {
+            if (!connectTimer->isValid()) {
+              return;
+            }
+
+            HostMetrics& metrics = m_hostMetrics[reply->url().host()];
+            ++metrics.m_connections;
+            metrics.m_lastConnectMsec = connectTimer->elapsed();
+            metrics.m_totalConnectMsec += metrics.m_lastConnectMsec;
+            connectTimer->invalidate();
+          });
+
+  connect(reply, &QNetworkReply::errorOccurred, this,
+          [this, reply, connectTimer](QNetworkReply::NetworkError) {
+            if (!connectTimer->isValid()) {
+              return;
+            }
+
+            QString host = reply->url().host();
+            logger.debug() << "Unable to connect to" << host << "after"
+                           << connectTimer->elapsed() << "msecs";
+            ++m_hostMetrics[host].m_connectFailures;
+            connectTimer->invalidate();
+          });
+#else
+  Q_UNUSED(reply);
+#endif
+}
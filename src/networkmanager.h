@@ -5,9 +5,14 @@
 #ifndef NETWORKMANAGER_H
 #define NETWORKMANAGER_H
 
+#include <QHash>
+#include <QList>
 #include <QObject>
+#include <QSet>
+#include <QUrl>
 
 class QNetworkAccessManager;
+class QNetworkReply;
 
 class NetworkManager : public QObject {
   Q_OBJECT
@@ -31,11 +36,46 @@ class NetworkManager : public QObject {
   void increaseNetworkRequestCount();
   void decreaseNetworkRequestCount();
 
+  // Requests served by the reply of an identical pending request, or by the
+  // fresh response of the previous one.
+  void increaseCoalescedRequestCount() { ++m_coalescedRequestCount; }
+  void increaseFreshRequestCount() { ++m_freshRequestCount; }
+  uint64_t coalescedRequestCount() const { return m_coalescedRequestCount; }
+  uint64_t freshRequestCount() const { return m_freshRequestCount; }
+
+  // Resolves the hosts of these URLs in parallel, A and AAAA. This warms the
+  // host cache of Qt, which QNetworkAccessManager reads before connecting.
+  void prefetchHosts(const QList<QUrl>& urls);
+
+  // The connections opened by QNetworkAccessManager for the requests, by
+  // host. The connect time goes from the first connection attempt to the
+  // request being sent: it includes the IPv6/IPv4 race of Qt and the TLS
+  // handshake. The requests sent on a reused connection are not counted.
+  struct HostMetrics {
+    uint32_t m_connections = 0;
+    uint32_t m_connectFailures = 0;
+    qint64 m_lastConnectMsec = -1;
+    qint64 m_totalConnectMsec = 0;
+  };
+
+  // Records the connections of the reply in the host metrics. Requires Qt
+  // 6.3: with older versions, the metrics stay empty.
+  void observeReply(QNetworkReply* reply);
+
+  const QHash<QString, HostMetrics>& hostMetrics() const {
+    return m_hostMetrics;
+  }
+
  protected:
   virtual void clearCacheInternal() = 0;
 
  private:
+  QSet<QString> m_pendingHosts;
+  QHash<QString, HostMetrics> m_hostMetrics;
+
   uint32_t m_requestCount = 0;
+  uint64_t m_coalescedRequestCount = 0;
+  uint64_t m_freshRequestCount = 0;
   bool m_clearCacheNeeded = false;
 };
 
@@ -17,7 +17,10 @@
 #  include "platforms/wasm/wasmnetworkrequest.h"
 #endif
 
+#include <QCryptographicHash>
 #include <QDirIterator>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QHostAddress>
 #include <QJsonDocument>
 #include <QJsonArray>
@@ -26,14 +29,15 @@
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QRegularExpression>
+#include <QTimer>
 #include <QUrl>
 
 // Timeout for the network requests.
 constexpr uint32_t REQUEST_TIMEOUT_MSEC = 15000;
 constexpr int REQUEST_MAX_REDIRECTS = 4;
 
-constexpr const char* IPINFO_URL_IPV4 = "https://%1/api/v1/vpn/ipinfo";
-constexpr const char* IPINFO_URL_IPV6 = "https://[%1]/api/v1/vpn/ipinfo";
+// How long the response of a coalesced request is reused.
+constexpr int REQUEST_FRESHNESS_MSEC = 2000;
 
 namespace {
 Logger logger(LOG_NETWORKING, "NetworkRequest");
@@ -41,6 +45,16 @@ Logger logger(LOG_NETWORKING, "NetworkRequest");
 #ifndef QT_NO_SSL
 QList<QSslCertificate> s_intervention_certs;
 #endif
+
+struct FreshResponse {
+  QByteArray m_data;
+  int m_status = 0;
+  QElapsedTimer m_timer;
+};
+
+// The coalesced requests, by method, URL and authorization header.
+QHash<QByteArray, NetworkRequest*> s_pendingRequests;
+QHash<QByteArray, FreshResponse> s_freshResponses;
 }  // namespace
 
 NetworkRequest::NetworkRequest(Task* parent, int status,
@@ -79,8 +93,9 @@ NetworkRequest::NetworkRequest(Task* parent, int status,
 
   m_timer.setSingleShot(true);
 
-  connect(&m_timer, &QTimer::timeout, this, &NetworkRequest::timeout);
-  connect(&m_timer, &QTimer::timeout, this, &NetworkRequest::maybeDeleteLater);
+  connect(&m_timer, &WheelTimer::timeout, this, &NetworkRequest::timeout);
+  connect(&m_timer, &WheelTimer::timeout, this,
+          &NetworkRequest::maybeDeleteLater);
 
   NetworkManager::instance()->increaseNetworkRequestCount();
 
@@ -92,6 +107,11 @@ NetworkRequest::NetworkRequest(Task* parent, int status,
 NetworkRequest::~NetworkRequest() {
   MVPN_COUNT_DTOR(NetworkRequest);
 
+  // The requests waiting for this one go on without it.
+  if (!m_completed && NetworkManager::exists()) {
+    handOverFollowers();
+  }
+
   // During the shutdown, the QML NetworkManager can be released before the
   // deletion of the pending network requests.
   if (NetworkManager::exists()) {
@@ -319,7 +339,7 @@ NetworkRequest* NetworkRequest::createForServers(Task* parent) {
   url.setPath("/api/v1/vpn/servers");
   r->m_request.setUrl(url);
 
-  r->getRequest();
+  r->coalescedGetRequest();
   return r;
 }
 
@@ -345,7 +365,7 @@ NetworkRequest* NetworkRequest::createForAccount(Task* parent) {
   url.setPath("/api/v1/vpn/account");
   r->m_request.setUrl(url);
 
-  r->getRequest();
+  r->coalescedGetRequest();
   return r;
 }
 
@@ -368,15 +388,18 @@ NetworkRequest* NetworkRequest::createForIpInfo(Task* parent,
 
   NetworkRequest* r = new NetworkRequest(parent, 200, true);
 
-  if (address.protocol() == QAbstractSocket::IPv6Protocol) {
-    r->m_request.setUrl(QUrl(QString(IPINFO_URL_IPV6).arg(address.toString())));
-  } else {
-    Q_ASSERT(address.protocol() == QAbstractSocket::IPv4Protocol);
-    r->m_request.setUrl(QUrl(QString(IPINFO_URL_IPV4).arg(address.toString())));
-  }
+  Q_ASSERT(address.protocol() == QAbstractSocket::IPv4Protocol ||
+           address.protocol() == QAbstractSocket::IPv6Protocol);
 
+  // The request goes to the given address of the API host, keeping the scheme
+  // and the port of the API base URL.
   QUrl url(apiBaseUrl());
-  r->m_request.setRawHeader("Host", url.host().toLocal8Bit());
+  QUrl ipInfoUrl(url);
+  ipInfoUrl.setHost(address.toString());
+  ipInfoUrl.setPath("/api/v1/vpn/ipinfo");
+  r->m_request.setUrl(ipInfoUrl);
+
+  r->m_request.setRawHeader("Host", url.authority().toLocal8Bit());
   r->m_request.setPeerVerifyName(url.host());
 
   r->getRequest();
@@ -496,7 +519,7 @@ NetworkRequest* NetworkRequest::createForGetFeatureList(Task* parent) {
   url.setPath("/api/v1/vpn/featurelist");
   r->m_request.setUrl(url);
 
-  r->getRequest();
+  r->coalescedGetRequest();
   return r;
 }
 
@@ -978,9 +1001,11 @@ void NetworkRequest::processData(QNetworkReply::NetworkError error,
   m_completed = true;
   m_timer.stop();
 
-#ifdef MVPN_WASM
   m_finalStatusCode = status;
-#endif
+
+  if (!m_coalescingKey.isEmpty()) {
+    completeCoalescing(error, errorString, status, data);
+  }
 
   if (error != QNetworkReply::NoError) {
     QUrl::FormattingOptions options = QUrl::RemoveQuery | QUrl::RemoveUserInfo;
@@ -1049,8 +1074,9 @@ void NetworkRequest::handleRedirect(const QUrl& redirectUrl) {
 
 void NetworkRequest::timeout() {
 #ifndef MVPN_WASM
-  Q_ASSERT(m_reply);
-  Q_ASSERT(!m_reply->isFinished());
+  // A request coalesced with a pending one has no reply.
+  Q_ASSERT(m_reply || m_leader);
+  Q_ASSERT(!m_reply || !m_reply->isFinished());
 #endif
   Q_ASSERT(!m_completed);
 
@@ -1061,6 +1087,19 @@ void NetworkRequest::timeout() {
   }
 
   logger.error() << "Network request timeout";
+
+  // Without a reply, nothing else deletes it.
+  if (m_leader) {
+    m_leader->m_followers.removeAll(this);
+    m_leader = nullptr;
+    deleteLater();
+  }
+
+  if (!m_coalescingKey.isEmpty()) {
+    completeCoalescing(QNetworkReply::TimeoutError, "Timeout", 0,
+                       QByteArray());
+  }
+
   emit requestFailed(QNetworkReply::TimeoutError, QByteArray());
 }
 
@@ -1075,7 +1114,122 @@ void NetworkRequest::getRequest() {
   m_timer.start(REQUEST_TIMEOUT_MSEC);
 }
 
+void NetworkRequest::coalescedGetRequest() {
+  // The hash of the authorization header is enough to tell the users apart.
+  QByteArray authorization = QCryptographicHash::hash(
+      m_request.rawHeader("Authorization"), QCryptographicHash::Sha256);
+  m_coalescingKey =
+      "GET " + m_request.url().toEncoded() + " " + authorization.toHex();
+
+  auto fresh = s_freshResponses.constFind(m_coalescingKey);
+  if (fresh != s_freshResponses.constEnd() &&
+      !fresh->m_timer.hasExpired(REQUEST_FRESHNESS_MSEC)) {
+    logger.debug() << "Fresh response for" << m_request.url().path();
+    NetworkManager::instance()->increaseFreshRequestCount();
+
+    // The signals are connected after the creation of the request.
+    QByteArray data = fresh->m_data;
+    int status = fresh->m_status;
+    QTimer::singleShot(0, this, [this, data, status]() {
+      if (m_completed) {
+        return;
+      }
+
+      processData(QNetworkReply::NoError, QString(), status, data);
+      deleteLater();
+    });
+    return;
+  }
+
+  NetworkRequest* leader = s_pendingRequests.value(m_coalescingKey);
+  if (leader) {
+    logger.debug() << "Coalescing with a pending request for"
+                   << m_request.url().path();
+    NetworkManager::instance()->increaseCoalescedRequestCount();
+
+    m_leader = leader;
+    leader->m_followers.append(this);
+
+    // The leader could take longer than this request may wait, for instance
+    // if its timeout has been disabled. Joining another leader after a hand
+    // over does not extend the wait.
+    if (!m_timer.isActive()) {
+      m_timer.start(REQUEST_TIMEOUT_MSEC);
+    }
+    return;
+  }
+
+  s_pendingRequests.insert(m_coalescingKey, this);
+  getRequest();
+}
+
+void NetworkRequest::completeCoalescing(QNetworkReply::NetworkError error,
+                                        const QString& errorString,
+                                        int status, const QByteArray& data) {
+  if (s_pendingRequests.value(m_coalescingKey) != this) {
+    return;
+  }
+
+  s_pendingRequests.remove(m_coalescingKey);
+
+  if (error == QNetworkReply::NoError &&
+      (!m_expectedStatusCode || status == m_expectedStatusCode)) {
+    // The expired responses are only skipped by coalescedGetRequest(). Let's
+    // drop them here, or each URL requested once would stay in memory.
+    for (auto i = s_freshResponses.begin(); i != s_freshResponses.end();) {
+      if (i->m_timer.hasExpired(REQUEST_FRESHNESS_MSEC)) {
+        i = s_freshResponses.erase(i);
+      } else {
+        ++i;
+      }
+    }
+
+    FreshResponse& fresh = s_freshResponses[m_coalescingKey];
+    fresh.m_data = data;
+    fresh.m_status = status;
+    fresh.m_timer.start();
+  }
+
+  const QList<QPointer<NetworkRequest>> followers = m_followers;
+  m_followers.clear();
+
+  for (NetworkRequest* follower : followers) {
+    if (!follower || follower->m_completed) {
+      continue;
+    }
+
+    follower->m_leader = nullptr;
+    follower->processData(error, errorString, status, data);
+    follower->deleteLater();
+  }
+}
+
+void NetworkRequest::handOverFollowers() {
+  if (m_coalescingKey.isEmpty() ||
+      s_pendingRequests.value(m_coalescingKey) != this) {
+    return;
+  }
+
+  s_pendingRequests.remove(m_coalescingKey);
+
+  // The first follower sends its own request, and the others wait for it.
+  const QList<QPointer<NetworkRequest>> followers = m_followers;
+  m_followers.clear();
+
+  for (NetworkRequest* follower : followers) {
+    if (!follower || follower->m_completed) {
+      continue;
+    }
+
+    follower->m_leader = nullptr;
+    follower->coalescedGetRequest();
+  }
+}
+
 void NetworkRequest::deleteRequest() {
+  // This request may change what the fresh responses describe.
+  s_freshResponses.clear();
+
 #ifdef MVPN_WASM
   WasmNetworkRequest::deleteRequest(this);
 #else
@@ -1087,6 +1241,9 @@ void NetworkRequest::deleteRequest() {
 }
 
 void NetworkRequest::postRequest(const QByteArray& body) {
+  // This request may change what the fresh responses describe.
+  s_freshResponses.clear();
+
 #ifdef MVPN_WASM
   WasmNetworkRequest::postRequest(this, body);
 #else
@@ -1098,6 +1255,9 @@ void NetworkRequest::postRequest(const QByteArray& body) {
 }
 
 void NetworkRequest::uploadDataRequest(QIODevice* data) {
+  // This request may change what the fresh responses describe.
+  s_freshResponses.clear();
+
   QNetworkAccessManager* manager =
       NetworkManager::instance()->networkAccessManager();
   handleReply(manager->post(m_request, data));
@@ -1111,6 +1271,8 @@ void NetworkRequest::handleReply(QNetworkReply* reply) {
   m_reply = reply;
   m_reply->setParent(this);
 
+  NetworkManager::instance()->observeReply(m_reply);
+
   connect(m_reply, &QNetworkReply::finished, this,
           &NetworkRequest::replyFinished);
 #ifndef QT_NO_SSL
@@ -1139,11 +1301,10 @@ void NetworkRequest::maybeDeleteLater() {
 }
 
 int NetworkRequest::statusCode() const {
-#ifdef MVPN_WASM
-  return m_finalStatusCode;
-#endif
-
-  Q_ASSERT(m_reply);
+  // In wasm, and for the coalesced requests, there is no reply.
+  if (!m_reply) {
+    return m_finalStatusCode;
+  }
 
   QVariant statusCode =
       m_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
@@ -1169,6 +1330,24 @@ QByteArray NetworkRequest::rawHeader(const QByteArray& headerName) const {
 void NetworkRequest::abort() {
   m_aborted = true;
 
+  // A coalesced request without its own reply.
+  if (!m_coalescingKey.isEmpty() && !m_completed && !m_reply &&
+      s_pendingRequests.value(m_coalescingKey) != this) {
+    if (m_leader) {
+      m_leader->m_followers.removeAll(this);
+      m_leader = nullptr;
+    }
+
+    processData(QNetworkReply::OperationCanceledError, "Aborted", 0,
+                QByteArray());
+    deleteLater();
+    return;
+  }
+
+  if (!m_completed) {
+    handOverFollowers();
+  }
+
   if (!m_reply) {
     logger.error() << "INTERNAL ERROR! NetworkRequest::abort called before "
                       "starting the request";
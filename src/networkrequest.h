@@ -5,10 +5,12 @@
 #ifndef NETWORKREQUEST_H
 #define NETWORKREQUEST_H
 
+#include "timerwheel.h"
+
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QObject>
-#include <QTimer>
+#include <QPointer>
 
 class QHostAddress;
 class QNetworkAccessManager;
@@ -175,6 +177,7 @@ class NetworkRequest final : public QObject {
 
   void deleteRequest();
   void getRequest();
+  void coalescedGetRequest();
   void postRequest(const QByteArray& body);
   void uploadDataRequest(QIODevice* data);
 
@@ -190,6 +193,11 @@ class NetworkRequest final : public QObject {
 
   void maybeDeleteLater();
 
+  void completeCoalescing(QNetworkReply::NetworkError error,
+                          const QString& errorString, int status,
+                          const QByteArray& data);
+  void handOverFollowers();
+
  private slots:
   void replyFinished();
   void timeout();
@@ -210,7 +218,7 @@ class NetworkRequest final : public QObject {
 
  private:
   QNetworkRequest m_request;
-  QTimer m_timer;
+  WheelTimer m_timer;
 
 #ifndef QT_NO_SSL
   void enableSSLIntervention();
@@ -218,11 +226,14 @@ class NetworkRequest final : public QObject {
 
   QNetworkReply* m_reply = nullptr;
   int m_expectedStatusCode = 0;
-#ifdef MVPN_WASM
-  // In wasm network request, m_reply is null. So we need to store the "status
-  // code" in a variable member.
+  // In wasm network request, and for the coalesced requests, m_reply is null.
+  // So we need to store the "status code" in a variable member.
   int m_finalStatusCode = 0;
-#endif
+
+  // Identical GET requests share the reply of the pending one: the "leader".
+  QByteArray m_coalescingKey;
+  QPointer<NetworkRequest> m_leader;
+  QList<QPointer<NetworkRequest>> m_followers;
 
   bool m_completed = false;
   bool m_aborted = false;
@@ -18,6 +18,10 @@ class PingHelper final : public QObject {
   Q_OBJECT
   Q_DISABLE_COPY_MOVE(PingHelper)
 
+#ifdef UNIT_TEST
+  friend class BenchPingHelper;
+#endif
+
  public:
   PingHelper();
   ~PingHelper();
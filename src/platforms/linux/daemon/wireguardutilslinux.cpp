@@ -85,6 +85,11 @@ WireguardUtilsLinux::WireguardUtilsLinux(QObject* parent)
     logger.warning() << "Failed to bind netlink socket:" << strerror(errno);
   }
 
+  m_statsock = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_ROUTE);
+  if (m_statsock < 0) {
+    logger.warning() << "Failed to create netlink socket:" << strerror(errno);
+  }
+
   m_notifier = new QSocketNotifier(m_nlsock, QSocketNotifier::Read, this);
   connect(m_notifier, &QSocketNotifier::activated, this,
           &WireguardUtilsLinux::nlsockReady);
@@ -122,6 +127,9 @@ WireguardUtilsLinux::~WireguardUtilsLinux() {
   if (m_nlsock >= 0) {
     close(m_nlsock);
   }
+  if (m_statsock >= 0) {
+    close(m_statsock);
+  }
   logger.debug() << "WireguardUtilsLinux destroyed.";
 }
 
@@ -192,6 +200,15 @@ bool WireguardUtilsLinux::addInterface(const InterfaceConfig& config) {
 }
 
 bool WireguardUtilsLinux::updatePeer(const InterfaceConfig& config) {
+  return setPeer(config, false);
+}
+
+bool WireguardUtilsLinux::addPendingPeer(const InterfaceConfig& config) {
+  return setPeer(config, true);
+}
+
+bool WireguardUtilsLinux::setPeer(const InterfaceConfig& config,
+                                  bool pending) {
   wg_device* device = static_cast<wg_device*>(calloc(1, sizeof(*device)));
   if (!device) {
     logger.error() << "Allocation failure";
@@ -206,7 +223,8 @@ bool WireguardUtilsLinux::updatePeer(const InterfaceConfig& config) {
   }
   device->first_peer = device->last_peer = peer;
 
-  logger.debug() << "Adding peer" << logger.keys(config.m_serverPublicKey);
+  logger.debug() << (pending ? "Adding pending peer" : "Adding peer")
+                 << logger.keys(config.m_serverPublicKey);
 
   // Public Key
   wg_key_from_base64(peer->public_key, qPrintable(config.m_serverPublicKey));
@@ -223,7 +241,12 @@ bool WireguardUtilsLinux::updatePeer(const InterfaceConfig& config) {
   // policy rules are doing all the work for us anyways.
   //
   // To work around the issue, just set default routes for hopindex zero.
-  if (config.m_hopindex == 0) {
+  //
+  // A pending peer has no allowed IPs yet: the traffic keeps going through
+  // the current peer. The persistent keepalive starts its handshake.
+  if (pending) {
+    logger.debug() << "No allowed IPs until the handshake";
+  } else if (config.m_hopindex == 0) {
     if (!config.m_deviceIpv4Address.isNull()) {
       addPeerPrefix(peer, IPAddress("0.0.0.0/0"));
     }
@@ -284,7 +307,7 @@ bool WireguardUtilsLinux::deletePeer(const InterfaceConfig& config) {
   // Clear firewall settings for this server.
   GoString goAddress = {.p = qPrintable(config.m_serverIpv4AddrIn),
                         .n = (ptrdiff_t)config.m_serverIpv4AddrIn.length()};
-  NetfilterClearInbound(goAddress);
+  NetfilterClearInbound(goAddress, config.m_serverPort);
 
   // Set/update device
   strncpy(device->name, WG_INTERFACE, IFNAMSIZ);
@@ -346,6 +369,110 @@ QList<WireguardUtils::PeerStatus> WireguardUtilsLinux::getPeerStatus() {
   return peerList;
 }
 
+QHash<QByteArray, qint64> WireguardUtilsLinux::getPeerHandshakes(
+    const QList<QByteArray>& pubkeys) {
+  wg_device* device = nullptr;
+  wg_peer* peer = nullptr;
+  QHash<QByteArray, qint64> handshakes;
+
+  if (wg_get_device(&device, WG_INTERFACE) != 0) {
+    logger.warning() << "Unable to get stats for" << WG_INTERFACE;
+    return handshakes;
+  }
+
+  // Compare the binary keys: no base64 conversion for every peer.
+  wg_for_each_peer(device, peer) {
+    if (peer->last_handshake_time.tv_sec == 0) {
+      continue;
+    }
+    QByteArray pubkey = QByteArray::fromRawData(
+        reinterpret_cast<const char*>(peer->public_key), sizeof(wg_key));
+    if (!pubkeys.contains(pubkey)) {
+      continue;
+    }
+    qint64 handshake = peer->last_handshake_time.tv_sec * 1000;
+    handshake += peer->last_handshake_time.tv_nsec / 1000000;
+    handshakes.insert(QByteArray(pubkey.constData(), pubkey.length()),
+                      handshake);
+  }
+  wg_free_device(device);
+  return handshakes;
+}
+
+qint64 WireguardUtilsLinux::rxPackets() {
+  if (m_statsock < 0) {
+    return -1;
+  }
+  unsigned int ifindex = if_nametoindex(WG_INTERFACE);
+  if (ifindex == 0) {
+    return -1;
+  }
+
+  /* Request the 64-bit statistics of the interface, and nothing else. This
+   * is equivalent to:
+   *     ip stats show dev $WG_INTERFACE group link
+   */
+  struct {
+    struct nlmsghdr nlmsg;
+    struct if_stats_msg ifsm;
+  } request;
+  memset(&request, 0, sizeof(request));
+  request.nlmsg.nlmsg_len = NLMSG_LENGTH(sizeof(struct if_stats_msg));
+  request.nlmsg.nlmsg_type = RTM_GETSTATS;
+  request.nlmsg.nlmsg_flags = NLM_F_REQUEST;
+  request.nlmsg.nlmsg_seq = ++m_statseq;
+  request.ifsm.family = AF_UNSPEC;
+  request.ifsm.ifindex = ifindex;
+  request.ifsm.filter_mask = IFLA_STATS_FILTER_BIT(IFLA_STATS_LINK_64);
+
+  struct sockaddr_nl nladdr;
+  memset(&nladdr, 0, sizeof(nladdr));
+  nladdr.nl_family = AF_NETLINK;
+  if (sendto(m_statsock, &request, request.nlmsg.nlmsg_len, 0,
+             (struct sockaddr*)&nladdr, sizeof(nladdr)) < 0) {
+    return -1;
+  }
+
+  /* The kernel processes the request within sendto(): the reply, if any, is
+   * already queued and the socket never needs to block.
+   */
+  char buf[1024];
+  while (true) {
+    ssize_t len = recv(m_statsock, buf, sizeof(buf), MSG_DONTWAIT);
+    if (len <= 0) {
+      return -1;
+    }
+
+    struct nlmsghdr* nlmsg = (struct nlmsghdr*)buf;
+    for (; NLMSG_OK(nlmsg, len); nlmsg = NLMSG_NEXT(nlmsg, len)) {
+      // Skip the replies left over by the previous requests.
+      if (nlmsg->nlmsg_seq != (uint32_t)m_statseq) {
+        continue;
+      }
+      if (nlmsg->nlmsg_type != RTM_NEWSTATS) {
+        // Likely an error: this kernel does not support RTM_GETSTATS.
+        return -1;
+      }
+
+      struct if_stats_msg* ifsm =
+          static_cast<struct if_stats_msg*>(NLMSG_DATA(nlmsg));
+      int attrlen = nlmsg->nlmsg_len - NLMSG_LENGTH(sizeof(*ifsm));
+      struct rtattr* attr = reinterpret_cast<struct rtattr*>(
+          reinterpret_cast<char*>(ifsm) + NLMSG_ALIGN(sizeof(*ifsm)));
+      for (; RTA_OK(attr, attrlen); attr = RTA_NEXT(attr, attrlen)) {
+        if (attr->rta_type != IFLA_STATS_LINK_64 ||
+            RTA_PAYLOAD(attr) < sizeof(struct rtnl_link_stats64)) {
+          continue;
+        }
+        struct rtnl_link_stats64 stats;
+        memcpy(&stats, RTA_DATA(attr), sizeof(stats));
+        return stats.rx_packets;
+      }
+      return -1;
+    }
+  }
+}
+
 bool WireguardUtilsLinux::updateRoutePrefix(const IPAddress& prefix,
                                             int hopindex) {
   logger.debug() << "Adding route to" << prefix.toString();
@@ -361,16 +488,53 @@ bool WireguardUtilsLinux::deleteRoutePrefix(const IPAddress& prefix,
 }
 
 bool WireguardUtilsLinux::addExclusionRoute(const QHostAddress& address) {
-  logger.debug() << "Adding exclusion route for"
-                 << logger.sensitive(address.toString());
-  const int flags = NLM_F_REQUEST | NLM_F_CREATE | NLM_F_REPLACE | NLM_F_ACK;
-  return rtmSendExclude(RTM_NEWRULE, flags, address);
+  return addExclusionRoutes(QList<QHostAddress>{address});
 }
 
 bool WireguardUtilsLinux::deleteExclusionRoute(const QHostAddress& address) {
-  logger.debug() << "Removing exclusion route for"
-                 << logger.sensitive(address.toString());
-  return rtmSendExclude(RTM_DELRULE, NLM_F_REQUEST | NLM_F_ACK, address);
+  return deleteExclusionRoutes(QList<QHostAddress>{address});
+}
+
+bool WireguardUtilsLinux::addExclusionRoutes(
+    const QList<QHostAddress>& addresses) {
+  logger.debug() << "Adding exclusion routes for" << addresses.length()
+                 << "addresses";
+
+  // Packets to the excluded addresses are marked by the firewall, and the
+  // marked packets are routed outside of the tunnel. The addresses are
+  // elements of a set: adding thousands of them takes a single transaction,
+  // and the packets are matched with a single lookup.
+  QByteArray list = exclusionList(addresses);
+  GoString goAddresses = {.p = list.constData(),
+                          .n = (ptrdiff_t)list.length()};
+  return NetfilterExcludeAddresses(goAddresses) == 0;
+}
+
+bool WireguardUtilsLinux::deleteExclusionRoutes(
+    const QList<QHostAddress>& addresses) {
+  logger.debug() << "Removing exclusion routes for" << addresses.length()
+                 << "addresses";
+  QByteArray list = exclusionList(addresses);
+  GoString goAddresses = {.p = list.constData(),
+                          .n = (ptrdiff_t)list.length()};
+  return NetfilterResetAddresses(goAddresses) == 0;
+}
+
+// static
+QByteArray WireguardUtilsLinux::exclusionList(
+    const QList<QHostAddress>& addresses) {
+  QByteArray list;
+  for (const QHostAddress& address : addresses) {
+    if (address.protocol() != QAbstractSocket::IPv4Protocol &&
+        address.protocol() != QAbstractSocket::IPv6Protocol) {
+      continue;
+    }
+    if (!list.isEmpty()) {
+      list.append(',');
+    }
+    list.append(address.toString().toLatin1());
+  }
+  return list;
 }
 
 bool WireguardUtilsLinux::rtmSendRoute(int action, int flags,
@@ -603,56 +767,6 @@ bool WireguardUtilsLinux::rtmSendRule(int action, int flags, int addrfamily) {
   return true;
 }
 
-bool WireguardUtilsLinux::rtmSendExclude(int action, int flags,
-                                         const QHostAddress& address) {
-  constexpr size_t fib_max_size =
-      sizeof(struct fib_rule_hdr) + RTA_SPACE(sizeof(struct in6_addr));
-
-  char buf[NLMSG_SPACE(fib_max_size)];
-  struct nlmsghdr* nlmsg = reinterpret_cast<struct nlmsghdr*>(buf);
-  struct fib_rule_hdr* rule =
-      static_cast<struct fib_rule_hdr*>(NLMSG_DATA(nlmsg));
-  struct sockaddr_nl nladdr;
-  memset(&nladdr, 0, sizeof(nladdr));
-  nladdr.nl_family = AF_NETLINK;
-
-  /* Create a routing policy rule to select the main routing table for
-   * packets matching the destination address. This is equivalent to:
-   *     ip rule add to $ADDRESS table main
-   */
-  memset(buf, 0, sizeof(buf));
-  nlmsg->nlmsg_len = NLMSG_LENGTH(sizeof(struct fib_rule_hdr));
-  nlmsg->nlmsg_type = action;
-  nlmsg->nlmsg_flags = flags;
-  nlmsg->nlmsg_pid = getpid();
-  nlmsg->nlmsg_seq = m_nlseq++;
-  rule->table = RT_TABLE_MAIN;
-  rule->action = FR_ACT_TO_TBL;
-  rule->flags = 0;
-
-  if (address.protocol() == QAbstractSocket::IPv6Protocol) {
-    Q_IPV6ADDR dst = address.toIPv6Address();
-    nlmsg_append_attr(nlmsg, sizeof(buf), FRA_DST, &dst, sizeof(dst));
-    rule->family = AF_INET6;
-    rule->dst_len = 128;
-  } else if (address.protocol() == QAbstractSocket::IPv4Protocol) {
-    quint32 dst = address.toIPv4Address();
-    nlmsg_append_attr32(nlmsg, sizeof(buf), FRA_DST, htonl(dst));
-    rule->family = AF_INET;
-    rule->dst_len = 32;
-  } else {
-    return false;
-  }
-
-  ssize_t result = sendto(m_nlsock, buf, nlmsg->nlmsg_len, 0,
-                          (struct sockaddr*)&nladdr, sizeof(nladdr));
-  if (result != nlmsg->nlmsg_len) {
-    return false;
-  }
-
-  return true;
-}
-
 void WireguardUtilsLinux::nlsockReady() {
   char buf[1024];
   ssize_t len = recv(m_nlsock, buf, sizeof(buf), MSG_DONTWAIT);
@@ -23,13 +23,20 @@ class WireguardUtilsLinux final : public WireguardUtils {
 
   bool updatePeer(const InterfaceConfig& config) override;
   bool deletePeer(const InterfaceConfig& config) override;
+  bool supportPendingPeers() const override { return true; }
+  bool addPendingPeer(const InterfaceConfig& config) override;
   QList<PeerStatus> getPeerStatus() override;
+  QHash<QByteArray, qint64> getPeerHandshakes(
+      const QList<QByteArray>& pubkeys) override;
+  qint64 rxPackets() override;
 
   bool updateRoutePrefix(const IPAddress& prefix, int hopindex) override;
   bool deleteRoutePrefix(const IPAddress& prefix, int hopindex) override;
 
   bool addExclusionRoute(const QHostAddress& address) override;
   bool deleteExclusionRoute(const QHostAddress& address) override;
+  bool addExclusionRoutes(const QList<QHostAddress>& addresses) override;
+  bool deleteExclusionRoutes(const QList<QHostAddress>& addresses) override;
 
   void excludeCgroup(const QString& cgroup);
   void resetCgroup(const QString& cgroup);
@@ -37,18 +44,23 @@ class WireguardUtilsLinux final : public WireguardUtils {
 
  private:
   QStringList currentInterfaces();
+  bool setPeer(const InterfaceConfig& config, bool pending);
   bool setPeerEndpoint(struct sockaddr* sa, const QString& address, int port);
   bool addPeerPrefix(struct wg_peer* peer, const IPAddress& prefix);
   bool rtmSendRule(int action, int flags, int addrfamily);
   bool rtmSendRoute(int action, int flags, const IPAddress& prefix,
                     int hopindex);
-  bool rtmSendExclude(int action, int flags, const QHostAddress& address);
+  static QByteArray exclusionList(const QList<QHostAddress>& addresses);
   static bool setupCgroupClass(const QString& path, unsigned long classid);
   static bool moveCgroupProcs(const QString& src, const QString& dest);
   static bool buildAllowedIp(struct wg_allowedip*, const IPAddress& prefix);
 
   int m_nlsock = -1;
   int m_nlseq = 0;
+  // Synchronous requests, without the notifier of m_nlsock: the kernel
+  // answers them before sendto() returns.
+  int m_statsock = -1;
+  int m_statseq = 0;
   QSocketNotifier* m_notifier = nullptr;
 
   int m_cgroupVersion = 0;
@@ -10,6 +10,7 @@ SOURCES += \
         addons/addonmessage.cpp \
         addons/addonproperty.cpp \
         addons/addonpropertylist.cpp \
+        addons/addonscriptcache.cpp \
         addons/addontutorial.cpp \
         addons/conditionwatchers/addonconditionwatcher.cpp \
         addons/conditionwatchers/addonconditionwatcherfeaturesenabled.cpp \
@@ -20,6 +21,7 @@ SOURCES += \
         addons/conditionwatchers/addonconditionwatchertimestart.cpp \
         addons/conditionwatchers/addonconditionwatchertriggertimesecs.cpp \
         addons/manager/addondirectory.cpp \
+        addons/manager/addonhashcache.cpp \
         addons/manager/addonindex.cpp \
         addons/manager/addonmanager.cpp \
         apppermission.cpp \
@@ -41,6 +43,7 @@ SOURCES += \
         commands/commandactivate.cpp \
         commands/commanddeactivate.cpp \
         commands/commanddevice.cpp \
+        commands/commandlatency.cpp \
         commands/commandlogin.cpp \
         commands/commandlogout.cpp \
         commands/commandselect.cpp \
@@ -54,9 +57,11 @@ SOURCES += \
         composer/composerblocktitle.cpp \
         composer/composerblockorderedlist.cpp \
         composer/composerblockunorderedlist.cpp \
+        connectionbenchmark/benchmarklatencyprobe.cpp \
         connectionbenchmark/benchmarktask.cpp \
         connectionbenchmark/benchmarktaskping.cpp \
         connectionbenchmark/benchmarktasktransfer.cpp \
+        connectionbenchmark/benchmarkthroughput.cpp \
         connectionbenchmark/connectionbenchmark.cpp \
         connectionbenchmark/uploaddatagenerator.cpp \
         connectionhealth.cpp \
@@ -104,6 +109,7 @@ SOURCES += \
         models/licensemodel.cpp \
         models/server.cpp \
         models/servercity.cpp \
+        models/servercitymodel.cpp \
         models/servercountry.cpp \
         models/servercountrymodel.cpp \
         models/serverdata.cpp \
@@ -138,6 +144,7 @@ SOURCES += \
         settingsholder.cpp \
         signature.cpp \
         simplenetworkmanager.cpp \
+        startuptracer.cpp \
         statusicon.cpp \
         tasks/account/taskaccount.cpp \
         tasks/adddevice/taskadddevice.cpp \
@@ -163,6 +170,7 @@ SOURCES += \
         telemetry.cpp \
         temporarydir.cpp \
         theme.cpp \
+        timerwheel.cpp \
         tutorial/tutorial.cpp \
         tutorial/tutorialstep.cpp \
         tutorial/tutorialstepbefore.cpp \
@@ -173,7 +181,8 @@ SOURCES += \
         update/webupdater.cpp \
         websocket/exponentialbackoffstrategy.cpp \
         websocket/pushmessage.cpp \
-        websocket/websockethandler.cpp
+        websocket/websockethandler.cpp \
+        workerpool.cpp
 
 HEADERS += \
         addons/addon.h \
@@ -183,6 +192,7 @@ HEADERS += \
         addons/addonmessage.h \
         addons/addonproperty.h \
         addons/addonpropertylist.h \
+        addons/addonscriptcache.h \
         addons/addontutorial.h \
         addons/conditionwatchers/addonconditionwatcher.h \
         addons/conditionwatchers/addonconditionwatcherfeaturesenabled.h \
@@ -193,6 +203,7 @@ HEADERS += \
         addons/conditionwatchers/addonconditionwatchertimestart.h \
         addons/conditionwatchers/addonconditionwatchertriggertimesecs.h \
         addons/manager/addondirectory.h \
+        addons/manager/addonhashcache.h \
         addons/manager/addonindex.h \
         addons/manager/addonmanager.h \
         appimageprovider.h \
@@ -216,6 +227,7 @@ HEADERS += \
         commands/commandactivate.h \
         commands/commanddeactivate.h \
         commands/commanddevice.h \
+        commands/commandlatency.h \
         commands/commandlogin.h \
         commands/commandlogout.h \
         commands/commandselect.h \
@@ -229,10 +241,12 @@ HEADERS += \
         composer/composerblocktitle.h \
         composer/composerblockorderedlist.h \
         composer/composerblockunorderedlist.h \
+        connectionbenchmark/benchmarklatencyprobe.h \
         connectionbenchmark/benchmarktask.h \
         connectionbenchmark/benchmarktaskping.h \
         connectionbenchmark/benchmarktasksentinel.h \
         connectionbenchmark/benchmarktasktransfer.h \
+        connectionbenchmark/benchmarkthroughput.h \
         connectionbenchmark/connectionbenchmark.h \
         connectionbenchmark/uploaddatagenerator.h \
         connectionhealth.h \
@@ -277,6 +291,7 @@ HEADERS += \
         models/licensemodel.h \
         models/server.h \
         models/servercity.h \
+        models/servercitymodel.h \
         models/servercountry.h \
         models/servercountrymodel.h \
         models/serverdata.h \
@@ -312,6 +327,7 @@ HEADERS += \
         settingsholder.h \
         signature.h \
         simplenetworkmanager.h \
+        startuptracer.h \
         statusicon.h \
         task.h \
         tasks/account/taskaccount.h \
@@ -338,6 +354,7 @@ HEADERS += \
         telemetry.h \
         temporarydir.h \
         theme.h \
+        timerwheel.h \
         tutorial/tutorial.h \
         tutorial/tutorialstep.h \
         tutorial/tutorialstepbefore.h \
@@ -348,7 +365,8 @@ HEADERS += \
         urlopener.h \
         websocket/exponentialbackoffstrategy.h \
         websocket/pushmessage.h \
-        websocket/websockethandler.h
+        websocket/websockethandler.h \
+        workerpool.h
 
 # Signal handling for unix platforms
 unix {
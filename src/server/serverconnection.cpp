@@ -7,10 +7,13 @@
 #include "leakdetector.h"
 #include "localizer.h"
 #include "logger.h"
+#include "models/servercountrymodel.h"
 #include "mozillavpn.h"
+#include "serverlistcache.h"
 
 #include <functional>
 
+#include <QHash>
 #include <QHostAddress>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -24,63 +27,7 @@ namespace {
 
 Logger logger(LOG_SERVER, "ServerConnection");
 
-struct RequestType {
-  QString m_name;
-  std::function<QJsonObject(const QJsonObject&)> m_callback;
-};
-
-void serializeServerCountry(ServerCountryModel* model, QJsonObject& obj) {
-  QJsonArray countries;
-
-  for (const ServerCountry& country : model->countries()) {
-    QJsonObject countryObj;
-    countryObj["name"] = country.name();
-    countryObj["code"] = country.code();
-
-    QJsonArray cities;
-    for (const ServerCity& city : country.cities()) {
-      QJsonObject cityObj;
-      cityObj["name"] = city.name();
-      cityObj["code"] = city.code();
-      cityObj["latitude"] = city.latitude();
-      cityObj["longitude"] = city.longitude();
-
-      QJsonArray servers;
-      for (const QString& pubkey : city.servers()) {
-        const Server server = model->server(pubkey);
-        if (!server.initialized()) {
-          continue;
-        }
-
-        QJsonObject serverObj;
-        serverObj["hostname"] = server.hostname();
-        serverObj["ipv4_gateway"] = server.ipv4Gateway();
-        serverObj["ipv6_gateway"] = server.ipv6Gateway();
-        serverObj["weight"] = (double)server.weight();
-
-        const QString& socksName = server.socksName();
-        if (!socksName.isEmpty()) {
-          serverObj["socksName"] = socksName;
-        }
-
-        uint32_t multihopPort = server.multihopPort();
-        if (multihopPort) {
-          serverObj["multihopPort"] = (double)multihopPort;
-        }
-
-        servers.append(serverObj);
-      }
-
-      cityObj["servers"] = servers;
-      cities.append(cityObj);
-    }
-
-    countryObj["cities"] = cities;
-    countries.append(countryObj);
-  }
-
-  obj["countries"] = countries;
-}
+ServerListCache s_serverListCache;
 
 QJsonObject serializeStatus() {
   MozillaVPN* vpn = MozillaVPN::instance();
@@ -106,55 +53,73 @@ QJsonObject serializeStatus() {
   return obj;
 }
 
-static QList<RequestType> s_types{
-    RequestType{"activate",
-                [](const QJsonObject&) {
-                  MozillaVPN::instance()->activate();
-                  return QJsonObject();
-                }},
-
-    RequestType{"deactivate",
-                [](const QJsonObject&) {
-                  MozillaVPN::instance()->deactivate();
-                  return QJsonObject();
-                }},
-
-    RequestType{"servers",
-                [](const QJsonObject&) {
-                  QJsonObject servers;
-                  serializeServerCountry(
-                      MozillaVPN::instance()->serverCountryModel(), servers);
-
-                  QJsonObject obj;
-                  obj["servers"] = servers;
-                  return obj;
-                }},
-
-    RequestType{"disabled_apps",
-                [](const QJsonObject&) {
-                  QJsonArray apps;
-                  for (const QString& app :
-                       SettingsHolder::instance()->vpnDisabledApps()) {
-                    apps.append(app);
-                  }
-
-                  QJsonObject obj;
-                  obj["disabled_apps"] = apps;
-                  return obj;
-                }},
-
-    RequestType{"status",
-                [](const QJsonObject&) {
-                  QJsonObject obj;
-                  obj["status"] = serializeStatus();
-                  return obj;
-                }},
+// A handler returns the whole serialized response, its type included.
+using RequestCallback =
+    std::function<QByteArray(const QJsonObject&, const ServerCountryModel*)>;
+
+// Most of the handlers build a JSON object: this completes it with its type
+// and serializes it.
+RequestCallback jsonCallback(
+    const QString& type,
+    std::function<QJsonObject(const QJsonObject&)> callback) {
+  return [type, callback](const QJsonObject& request,
+                          const ServerCountryModel*) {
+    QJsonObject responseObj = callback(request);
+    responseObj["t"] = type;
+    return QJsonDocument(responseObj).toJson(QJsonDocument::Compact);
+  };
+}
+
+static const QHash<QString, RequestCallback> s_types{
+    {"activate", jsonCallback("activate",
+                              [](const QJsonObject&) {
+                                MozillaVPN::instance()->activate();
+                                return QJsonObject();
+                              })},
+
+    {"deactivate", jsonCallback("deactivate",
+                                [](const QJsonObject&) {
+                                  MozillaVPN::instance()->deactivate();
+                                  return QJsonObject();
+                                })},
+
+    {"servers",
+     [](const QJsonObject& request, const ServerCountryModel* model) {
+       // Generations fit in the 53 bits of the JSON numbers.
+       quint64 knownGeneration =
+           (quint64)request.value("generation").toDouble();
+       return s_serverListCache.response(model, knownGeneration);
+     }},
+
+    {"disabled_apps",
+     jsonCallback("disabled_apps",
+                  [](const QJsonObject&) {
+                    QJsonArray apps;
+                    for (const QString& app :
+                         SettingsHolder::instance()->vpnDisabledApps()) {
+                      apps.append(app);
+                    }
+
+                    QJsonObject obj;
+                    obj["disabled_apps"] = apps;
+                    return obj;
+                  })},
+
+    {"status", jsonCallback("status",
+                            [](const QJsonObject&) {
+                              QJsonObject obj;
+                              obj["status"] = serializeStatus();
+                              return obj;
+                            })},
 };
 
 }  // namespace
 
-ServerConnection::ServerConnection(QObject* parent, QTcpSocket* connection)
-    : QObject(parent), m_connection(connection) {
+ServerConnection::ServerConnection(QObject* parent, QTcpSocket* connection,
+                                   const ServerCountryModel* serverCountryModel)
+    : QObject(parent),
+      m_connection(connection),
+      m_serverCountryModel(serverCountryModel) {
   MVPN_COUNT_CTOR(ServerConnection);
 
 #if !defined(MVPN_ANDROID) && !defined(MVPN_IOS)
@@ -168,6 +133,7 @@ ServerConnection::ServerConnection(QObject* parent, QTcpSocket* connection)
   logger.debug() << "New connection received";
 
   Q_ASSERT(m_connection);
+  Q_ASSERT(m_serverCountryModel);
   connect(m_connection, &QTcpSocket::readyRead, this,
           &ServerConnection::readData);
 
@@ -263,16 +229,12 @@ void ServerConnection::processMessage(const QByteArray& message) {
   }
 
   QJsonObject obj = json.object();
-  QString typeName = obj["t"].toString();
-
-  for (const RequestType& type : s_types) {
-    if (typeName == type.m_name) {
-      QJsonObject responseObj = type.m_callback(obj);
-      responseObj["t"] = typeName;
-      writeData(QJsonDocument(responseObj).toJson(QJsonDocument::Compact));
-      return;
-    }
+
+  auto i = s_types.constFind(obj["t"].toString());
+  if (i == s_types.constEnd()) {
+    writeInvalidRequest();
+    return;
   }
 
-  writeInvalidRequest();
+  writeData((*i)(obj, m_serverCountryModel));
 }
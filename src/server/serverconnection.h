@@ -9,13 +9,23 @@
 #include <QObject>
 
 class QTcpSocket;
-
+class ServerCountryModel;
+
+// A connection of the browser extension bridge. Each message is a JSON object
+// prefixed by its length, as a native-endian uint32. The requests and the
+// responses have their type in `t`.
+//
+// The `servers` responses carry the `generation` of the server list. A client
+// sending back the generation it has receives `"unchanged": true`, a `delta`
+// (the changed countries, the removed country codes and the new order) or,
+// if its generation is too old, the whole list in `servers`.
 class ServerConnection final : public QObject {
   Q_OBJECT
   Q_DISABLE_COPY_MOVE(ServerConnection)
 
  public:
-  ServerConnection(QObject* parent, QTcpSocket* connection);
+  ServerConnection(QObject* parent, QTcpSocket* connection,
+                   const ServerCountryModel* serverCountryModel);
   ~ServerConnection();
 
  private:
@@ -29,6 +39,7 @@ class ServerConnection final : public QObject {
 
  private:
   QTcpSocket* m_connection;
+  const ServerCountryModel* m_serverCountryModel;
 
   enum {
     // Reading the length of the body. This step consists in the reading of 4
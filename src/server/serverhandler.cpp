@@ -6,6 +6,7 @@
 #include "serverconnection.h"
 #include "leakdetector.h"
 #include "logger.h"
+#include "mozillavpn.h"
 
 #include <QHostAddress>
 #include <QTcpSocket>
@@ -36,6 +37,7 @@ void ServerHandler::newConnectionReceived() {
   QTcpSocket* child = nextPendingConnection();
   Q_ASSERT(child);
 
-  ServerConnection* connection = new ServerConnection(this, child);
+  ServerConnection* connection = new ServerConnection(
+      this, child, MozillaVPN::instance()->serverCountryModel());
   connect(child, &QTcpSocket::disconnected, connection, &QObject::deleteLater);
 }
@@ -0,0 +1,180 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "serverlistcache.h"
+#include "logger.h"
+#include "models/servercountrymodel.h"
+
+#include <QByteArrayList>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+// How many previous server lists are kept to compute the deltas. A client
+// older than that gets the whole list.
+constexpr int SERVER_LIST_HISTORY = 8;
+
+namespace {
+
+Logger logger(LOG_SERVER, "ServerListCache");
+
+QJsonObject serializeServerCountry(const ServerCountryModel* model,
+                                   const ServerCountry& country) {
+  QJsonObject countryObj;
+  countryObj["name"] = country.name();
+  countryObj["code"] = country.code();
+
+  QJsonArray cities;
+  for (const ServerCity& city : country.cities()) {
+    QJsonObject cityObj;
+    cityObj["name"] = city.name();
+    cityObj["code"] = city.code();
+    cityObj["latitude"] = city.latitude();
+    cityObj["longitude"] = city.longitude();
+
+    QJsonArray servers;
+    for (const QString& pubkey : city.servers()) {
+      const Server server = model->server(pubkey);
+      if (!server.initialized()) {
+        continue;
+      }
+
+      QJsonObject serverObj;
+      serverObj["hostname"] = server.hostname();
+      serverObj["ipv4_gateway"] = server.ipv4Gateway();
+      serverObj["ipv6_gateway"] = server.ipv6Gateway();
+      serverObj["weight"] = (double)server.weight();
+
+      const QString& socksName = server.socksName();
+      if (!socksName.isEmpty()) {
+        serverObj["socksName"] = socksName;
+      }
+
+      uint32_t multihopPort = server.multihopPort();
+      if (multihopPort) {
+        serverObj["multihopPort"] = (double)multihopPort;
+      }
+
+      servers.append(serverObj);
+    }
+
+    cityObj["servers"] = servers;
+    cities.append(cityObj);
+  }
+
+  countryObj["cities"] = cities;
+  return countryObj;
+}
+
+}  // namespace
+
+const QByteArray& ServerListCache::response(const ServerCountryModel* model,
+                                            quint64 knownGeneration) {
+  update(model);
+
+  if (knownGeneration && knownGeneration == m_current.m_generation) {
+    return m_unchangedResponse;
+  }
+
+  for (const Snapshot& base : m_history) {
+    if (base.m_generation != knownGeneration) {
+      continue;
+    }
+
+    auto i = m_deltaResponses.constFind(knownGeneration);
+    if (i == m_deltaResponses.constEnd()) {
+      QByteArray delta = serializeDelta(base);
+      // Most of the list changed: the whole list is simpler to apply.
+      if (delta.length() >= m_fullResponse.length()) {
+        delta = m_fullResponse;
+      }
+      i = m_deltaResponses.insert(knownGeneration, delta);
+    }
+
+    return *i;
+  }
+
+  return m_fullResponse;
+}
+
+void ServerListCache::update(const ServerCountryModel* model) {
+  if (!m_fullResponse.isEmpty() &&
+      m_current.m_generation == model->generation()) {
+    return;
+  }
+
+  Snapshot snapshot;
+  snapshot.m_generation = model->generation();
+
+  QByteArrayList countries;
+  for (const ServerCountry& country : model->countries()) {
+    QByteArray json =
+        QJsonDocument(serializeServerCountry(model, country))
+            .toJson(QJsonDocument::Compact);
+
+    // An unchanged country shares its data with the previous snapshot:
+    // the history costs only the countries that changed.
+    auto previous = m_current.m_countries.constFind(country.code());
+    if (previous != m_current.m_countries.constEnd() && *previous == json) {
+      json = *previous;
+    }
+
+    snapshot.m_order.append(country.code());
+    snapshot.m_countries.insert(country.code(), json);
+    countries.append(json);
+  }
+
+  if (!m_fullResponse.isEmpty()) {
+    m_history.prepend(m_current);
+    while (m_history.length() > SERVER_LIST_HISTORY) {
+      m_history.removeLast();
+    }
+  }
+
+  m_current = snapshot;
+  m_deltaResponses.clear();
+
+  QByteArray generation = QByteArray::number(m_current.m_generation);
+
+  m_fullResponse = "{\"generation\":" + generation +
+                   ",\"servers\":{\"countries\":[" + countries.join(',') +
+                   "]},\"t\":\"servers\"}";
+
+  QJsonObject unchanged;
+  unchanged["generation"] = (qint64)m_current.m_generation;
+  unchanged["unchanged"] = true;
+  unchanged["t"] = "servers";
+  m_unchangedResponse =
+      QJsonDocument(unchanged).toJson(QJsonDocument::Compact);
+
+  logger.debug() << "Server list serialized. Generation:" << generation
+                 << "size:" << m_fullResponse.length();
+}
+
+QByteArray ServerListCache::serializeDelta(const Snapshot& base) const {
+  QByteArrayList countries;
+  QJsonArray order;
+  for (const QString& code : m_current.m_order) {
+    const QByteArray& json = m_current.m_countries[code];
+    if (base.m_countries.value(code) != json) {
+      countries.append(json);
+    }
+    order.append(code);
+  }
+
+  QJsonArray removed;
+  for (const QString& code : base.m_order) {
+    if (!m_current.m_countries.contains(code)) {
+      removed.append(code);
+    }
+  }
+
+  return "{\"delta\":{\"base\":" + QByteArray::number(base.m_generation) +
+         ",\"countries\":[" + countries.join(',') + "],\"order\":" +
+         QJsonDocument(order).toJson(QJsonDocument::Compact) +
+         ",\"removed\":" +
+         QJsonDocument(removed).toJson(QJsonDocument::Compact) +
+         "},\"generation\":" + QByteArray::number(m_current.m_generation) +
+         ",\"t\":\"servers\"}";
+}
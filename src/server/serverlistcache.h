@@ -0,0 +1,49 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SERVERLISTCACHE_H
+#define SERVERLISTCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+
+class ServerCountryModel;
+
+// The responses to the `servers` requests, serialized once per generation of
+// the server list. The browser extensions poll it: most of the requests are
+// answered with a cached "unchanged" or with a delta of a few countries.
+class ServerListCache final {
+ public:
+  // `knownGeneration` is the generation the client has already received, or
+  // 0.
+  const QByteArray& response(const ServerCountryModel* model,
+                             quint64 knownGeneration);
+
+ private:
+  struct Snapshot {
+    quint64 m_generation = 0;
+    QStringList m_order;
+    // The compact JSON of each country, by country code.
+    QHash<QString, QByteArray> m_countries;
+  };
+
+  void update(const ServerCountryModel* model);
+
+  // The countries added or changed since `base`, the codes of the removed
+  // ones, and the new order of the country codes.
+  QByteArray serializeDelta(const Snapshot& base) const;
+
+  Snapshot m_current;
+  QByteArray m_fullResponse;
+  QByteArray m_unchangedResponse;
+
+  // The previous snapshots, the most recent first.
+  QList<Snapshot> m_history;
+  // The deltas already requested for the current generation, by base.
+  QHash<quint64, QByteArray> m_deltaResponses;
+};
+
+#endif  // SERVERLISTCACHE_H
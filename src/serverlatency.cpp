@@ -38,10 +38,10 @@ void ServerLatency::initialize() {
   connect(vpn->controller(), &Controller::stateChanged, this,
           &ServerLatency::stateChanged);
 
-  connect(&m_pingTimeout, &QTimer::timeout, this,
+  connect(&m_pingTimeout, &WheelTimer::timeout, this,
           &ServerLatency::maybeSendPings);
 
-  connect(&m_refreshTimer, &QTimer::timeout, this, &ServerLatency::start);
+  connect(&m_refreshTimer, &WheelTimer::timeout, this, &ServerLatency::start);
 
   m_refreshTimer.start(SERVER_LATENCY_INITIAL_MSEC);
 }
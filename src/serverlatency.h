@@ -7,9 +7,9 @@
 
 #include "pingsender.h"
 #include "task.h"
+#include "timerwheel.h"
 
 #include <QObject>
-#include <QTimer>
 
 class ServerLatency final : public QObject {
   Q_OBJECT
@@ -38,8 +38,8 @@ class ServerLatency final : public QObject {
   QList<QString> m_pingSendQueue;
   QList<ServerPingRecord> m_pingReplyList;
 
-  QTimer m_pingTimeout;
-  QTimer m_refreshTimer;
+  WheelTimer m_pingTimeout;
+  WheelTimer m_refreshTimer;
   bool m_wantRefresh = false;
 
  private slots:
@@ -51,6 +51,15 @@ SETTING_STRING(
     false                                                   // remove when reset
 )
 
+SETTING_BOOL(addonIsolatedEngine,     // getter
+             setAddonIsolatedEngine,  // setter
+             hasAddonIsolatedEngine,  // has
+             "addon/isolatedEngine",  // key
+             false,                   // default value
+             false,                   // user setting
+             false                    // remove when reset
+)
+
 SETTING_BOOL(addonProdKeyInStaging,     // getter
              setAddonProdKeyInStaging,  // setter
              hasAddonProdKeyInStaging,  // has
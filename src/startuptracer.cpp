@@ -0,0 +1,149 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "startuptracer.h"
+#include "logger.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <cstring>
+
+namespace {
+Logger logger(LOG_MAIN, "StartupTracer");
+}  // namespace
+
+StartupTracer::Span::Span(const char* name, StartupTracer* tracer)
+    : m_tracer(tracer), m_name(name), m_startUsec(tracer->elapsedUsec()) {}
+
+StartupTracer::Span::~Span() {
+  m_tracer->record(m_name, 'X', m_startUsec,
+                   m_tracer->elapsedUsec() - m_startUsec);
+}
+
+// static
+StartupTracer* StartupTracer::instance() {
+  static StartupTracer s_instance;
+  return &s_instance;
+}
+
+StartupTracer::StartupTracer() { m_timer.start(); }
+
+qint64 StartupTracer::elapsedUsec() const {
+  return m_timer.nsecsElapsed() / 1000;
+}
+
+void StartupTracer::instant(const char* name) {
+  record(name, 'i', elapsedUsec(), 0);
+}
+
+void StartupTracer::begin(const char* name) {
+  record(name, 'B', elapsedUsec(), 0);
+}
+
+void StartupTracer::end(const char* name) {
+  record(name, 'E', elapsedUsec(), 0);
+}
+
+void StartupTracer::record(const char* name, char phase, qint64 startUsec,
+                           qint64 durationUsec) {
+  QMutexLocker locker(&m_mutex);
+  if (m_finished) {
+    return;
+  }
+
+  Qt::HANDLE thread = QThread::currentThreadId();
+  int threadId = m_threads.indexOf(thread);
+  if (threadId < 0) {
+    threadId = m_threads.length();
+    m_threads.append(thread);
+  }
+
+  m_events.append(Event{name, phase, startUsec, durationUsec, threadId + 1});
+}
+
+void StartupTracer::finish() {
+  {
+    QMutexLocker locker(&m_mutex);
+    if (m_finished) {
+      return;
+    }
+  }
+
+  instant("Startup completed");
+
+  {
+    QMutexLocker locker(&m_mutex);
+    m_finished = true;
+  }
+
+  qint64 firstFrameUsec = instantUsec("First frame");
+  logger.info() << "Startup completed in" << elapsedUsec() / 1000
+                << "msec. First frame:"
+                << (firstFrameUsec < 0 ? -1 : firstFrameUsec / 1000) << "msec";
+
+  QByteArray fileName = qgetenv("MVPN_STARTUP_TRACE");
+  if (fileName.isEmpty()) {
+    return;
+  }
+
+  QFile file(QString::fromLocal8Bit(fileName));
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    logger.error() << "Unable to write the startup trace" << file.fileName();
+    return;
+  }
+
+  file.write(QJsonDocument(toJson()).toJson(QJsonDocument::Compact));
+  logger.info() << "Startup trace written to" << file.fileName();
+}
+
+bool StartupTracer::isFinished() const {
+  QMutexLocker locker(&m_mutex);
+  return m_finished;
+}
+
+qint64 StartupTracer::instantUsec(const char* name) const {
+  QMutexLocker locker(&m_mutex);
+  for (const Event& event : m_events) {
+    if (event.m_phase == 'i' && !strcmp(event.m_name, name)) {
+      return event.m_startUsec;
+    }
+  }
+  return -1;
+}
+
+QJsonObject StartupTracer::toJson() const {
+  QMutexLocker locker(&m_mutex);
+
+  qint64 pid = QCoreApplication::applicationPid();
+
+  QJsonArray events;
+  for (const Event& event : m_events) {
+    QJsonObject obj;
+    obj["name"] = event.m_name;
+    obj["cat"] = "startup";
+    obj["ph"] = QString(QChar(event.m_phase));
+    obj["ts"] = event.m_startUsec;
+    obj["pid"] = pid;
+    obj["tid"] = event.m_threadId;
+
+    if (event.m_phase == 'X') {
+      obj["dur"] = event.m_durationUsec;
+    } else if (event.m_phase == 'i') {
+      // Global instant events are drawn across all the threads.
+      obj["s"] = "g";
+    }
+
+    events.append(obj);
+  }
+
+  QJsonObject trace;
+  trace["traceEvents"] = events;
+  trace["displayTimeUnit"] = "ms";
+  return trace;
+}
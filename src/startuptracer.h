@@ -0,0 +1,83 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef STARTUPTRACER_H
+#define STARTUPTRACER_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QVector>
+
+// Records the startup steps and exports them in the Chrome trace event
+// format, which can be opened with chrome://tracing or ui.perfetto.dev.
+//
+// Nothing is recorded after `finish()`. At that point, the trace is written
+// to the file set by the MVPN_STARTUP_TRACE env variable, if any. The
+// "startup_trace" inspector command returns it too.
+class StartupTracer final {
+ public:
+  // Records a span from its creation to its destruction. `name` must be a
+  // string literal.
+  class Span final {
+   public:
+    explicit Span(const char* name, StartupTracer* tracer = instance());
+    ~Span();
+
+   private:
+    Q_DISABLE_COPY_MOVE(Span)
+
+    StartupTracer* m_tracer;
+    const char* m_name;
+    qint64 m_startUsec;
+  };
+
+  // The time origin of the trace is the creation of the tracer: the first
+  // call should happen as early as possible.
+  static StartupTracer* instance();
+
+  StartupTracer();
+  ~StartupTracer() = default;
+
+  // Marks a point in time. `name` must be a string literal.
+  void instant(const char* name);
+
+  // Like Span, for steps which do not match a C++ scope.
+  void begin(const char* name);
+  void end(const char* name);
+
+  // The startup is completed.
+  void finish();
+  bool isFinished() const;
+
+  // Time of the first instant event called `name`, or -1.
+  qint64 instantUsec(const char* name) const;
+
+  QJsonObject toJson() const;
+
+ private:
+  Q_DISABLE_COPY_MOVE(StartupTracer)
+
+  struct Event {
+    const char* m_name;
+    char m_phase;
+    qint64 m_startUsec;
+    qint64 m_durationUsec;
+    int m_threadId;
+  };
+
+  qint64 elapsedUsec() const;
+  void record(const char* name, char phase, qint64 startUsec,
+              qint64 durationUsec);
+
+ private:
+  mutable QMutex m_mutex;
+  QElapsedTimer m_timer;
+  QVector<Event> m_events;
+  QList<Qt::HANDLE> m_threads;
+  bool m_finished = false;
+};
+
+#endif  // STARTUPTRACER_H
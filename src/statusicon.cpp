@@ -57,13 +57,33 @@ StatusIcon::~StatusIcon() { MVPN_COUNT_DTOR(StatusIcon); }
 
 const QIcon& StatusIcon::icon() {
   if (m_icon.isNull()) {
-    m_icon = drawStatusIndicator();
+    QImage iconImage = image();
+
+    auto i = m_icons.constFind(m_iconKey);
+    if (i == m_icons.constEnd()) {
+      i = m_icons.insert(m_iconKey, QIcon(QPixmap::fromImage(iconImage)));
+    }
+
+    m_icon = i.value();
     Q_ASSERT(!m_icon.isNull());
   }
 
   return m_icon;
 }
 
+QImage StatusIcon::image() {
+  if (m_iconKey.isEmpty()) {
+    m_iconKey = iconKey();
+  }
+
+  auto i = m_images.constFind(m_iconKey);
+  if (i == m_images.constEnd()) {
+    i = m_images.insert(m_iconKey, drawStatusIndicator());
+  }
+
+  return i.value();
+}
+
 void StatusIcon::activateAnimation() {
   logger.debug() << "Activate animation";
   m_animatedIconIndex = 0;
@@ -129,7 +149,13 @@ const QColor StatusIcon::indicatorColor() const {
     return INVALID_COLOR;
   }
 
-  switch (vpn->connectionHealth()->stability()) {
+  // The connection health is not available in the unit tests.
+  ConnectionHealth* connectionHealth = vpn->connectionHealth();
+  if (!connectionHealth) {
+    return INVALID_COLOR;
+  }
+
+  switch (connectionHealth->stability()) {
     case ConnectionHealth::Stable:
       return GREEN_COLOR;
     case ConnectionHealth::Unstable:
@@ -145,29 +171,47 @@ const QColor StatusIcon::indicatorColor() const {
 void StatusIcon::refreshNeeded() {
   logger.debug() << "Refresh needed";
 
-  if (!m_icon.isNull()) {
-    m_icon = QIcon();
+  QString key = iconKey();
+  if (key == m_iconKey) {
+    // The icon would look exactly the same.
+    return;
   }
+
+  m_iconKey = key;
+  m_icon = QIcon();
   emit iconUpdateNeeded();
 }
 
-QIcon StatusIcon::drawStatusIndicator() {
-  logger.debug() << "Get icon from URL";
+QString StatusIcon::iconKey() {
+  QString key = iconString();
+
+  if (MozillaVPN::instance()->controller()->state() == Controller::StateOn) {
+    key.append('|').append(indicatorColor().name(QColor::HexArgb));
+  }
+
+  return key;
+}
+
+QImage StatusIcon::drawStatusIndicator() {
+  logger.debug() << "Render icon" << m_iconKey;
+
+  ++m_paintCount;
 
-  // Create pixmap so that we can paint on the original resource.
-  QPixmap iconPixmap = QPixmap(iconString());
+  // Let's paint on a copy of the original resource.
+  QImage iconImage =
+      QImage(iconString()).convertToFormat(QImage::Format_ARGB32_Premultiplied);
 
   MozillaVPN* vpn = MozillaVPN::instance();
 
   // Only draw a status indicator if the VPN is connected
   if (vpn->controller()->state() == Controller::StateOn) {
-    QPainter painter(&iconPixmap);
+    QPainter painter(&iconImage);
     painter.setRenderHint(QPainter::Antialiasing);
     painter.setPen(Qt::NoPen);
 
     // Create mask for the indicator.
-    float maskSize = iconPixmap.width() * 0.5;
-    float maskPosition = iconPixmap.width() - maskSize;
+    float maskSize = iconImage.width() * 0.5;
+    float maskPosition = iconImage.width() - maskSize;
     QRectF indicatorMask(maskPosition, maskPosition, maskSize, maskSize);
     painter.setBrush(QColor(0, 0, 0, 255));  // black
     painter.drawEllipse(indicatorMask);
@@ -181,5 +225,5 @@ QIcon StatusIcon::drawStatusIndicator() {
     painter.drawEllipse(indicatorDot);
   }
 
-  return QIcon(iconPixmap);
+  return iconImage;
 }
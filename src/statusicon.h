@@ -7,7 +7,9 @@
 
 #include "connectionhealth.h"
 
+#include <QHash>
 #include <QIcon>
+#include <QImage>
 #include <QObject>
 #include <QTimer>
 #include <QUrl>
@@ -24,6 +26,12 @@ class StatusIcon final : public QObject {
   const QString iconString();
   const QColor indicatorColor() const;
 
+  // The icon as an image. Unlike icon(), this works without a GUI.
+  QImage image();
+
+  // Number of icons rendered since the creation of this object.
+  int paintCount() const { return m_paintCount; }
+
  signals:
   void iconUpdateNeeded();
 
@@ -35,12 +43,21 @@ class StatusIcon final : public QObject {
 
  private:
   void activateAnimation();
-  QIcon drawStatusIndicator();
-  void generateIcon();
+  QString iconKey();
+  QImage drawStatusIndicator();
 
  private:
   QIcon m_icon;
 
+  // What the current icon shows: the logo and the indicator color.
+  QString m_iconKey;
+
+  // Every icon rendered so far. There are just a few of them: the animation
+  // frames, the on/off logos and one per indicator color.
+  QHash<QString, QImage> m_images;
+  QHash<QString, QIcon> m_icons;
+  int m_paintCount = 0;
+
   // Animated icon.
   QTimer m_animatedIconTimer;
   uint8_t m_animatedIconIndex = 0;
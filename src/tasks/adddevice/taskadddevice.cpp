@@ -9,6 +9,7 @@
 #include "logger.h"
 #include "mozillavpn.h"
 #include "networkrequest.h"
+#include "workerpool.h"
 
 #include <QRandomGenerator>
 
@@ -43,8 +44,17 @@ void TaskAddDevice::run() {
   logger.debug() << "Adding the device" << logger.sensitive(m_deviceName);
 
   QByteArray privateKey = generatePrivateKey();
-  QByteArray publicKey = Curve25519::generatePublicKey(privateKey);
 
+  // The scalar multiplication is not free on slow devices.
+  WorkerPool::run([privateKey]() {
+    return Curve25519::generatePublicKey(privateKey);
+  }).then(this, [this, privateKey](const QByteArray& publicKey) {
+    addDevice(publicKey, privateKey);
+  });
+}
+
+void TaskAddDevice::addDevice(const QByteArray& publicKey,
+                              const QByteArray& privateKey) {
   logger.debug() << "Private key: " << logger.sensitive(privateKey);
   logger.debug() << "Public key: " << logger.sensitive(publicKey);
 
@@ -20,6 +20,9 @@ class TaskAddDevice final : public Task {
 
   DeletePolicy deletePolicy() const override { return NonDeletable; }
 
+ private:
+  void addDevice(const QByteArray& publicKey, const QByteArray& privateKey);
+
  private:
   QString m_deviceName;
   QString m_deviceID;
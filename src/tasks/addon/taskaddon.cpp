@@ -7,6 +7,9 @@
 #include "leakdetector.h"
 #include "logger.h"
 #include "networkrequest.h"
+#include "workerpool.h"
+
+#include <QCryptographicHash>
 
 namespace {
 Logger logger(LOG_MAIN, "TaskAddon");
@@ -34,8 +37,14 @@ void TaskAddon::run() {
   connect(request, &NetworkRequest::requestCompleted, this,
           [this](const QByteArray& data) {
             logger.debug() << "Get addon completed";
-            AddonManager::instance()->storeAndLoadAddon(data, m_addonId,
-                                                        m_sha256);
-            emit completed();
+
+            WorkerPool::run([data]() {
+              return QCryptographicHash::hash(data,
+                                              QCryptographicHash::Sha256);
+            }).then(this, [this, data](const QByteArray& dataSha256) {
+              AddonManager::instance()->storeAndLoadAddon(data, dataSha256,
+                                                          m_addonId, m_sha256);
+              emit completed();
+            });
           });
 }
@@ -8,6 +8,7 @@
 #include "logger.h"
 #include "models/featuremodel.h"
 #include "networkrequest.h"
+#include "workerpool.h"
 
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -36,7 +37,12 @@ void TaskGetFeatureList::run() {
   connect(request, &NetworkRequest::requestCompleted, this,
           [this](const QByteArray& data) {
             logger.debug() << "Get feature list is completed" << data;
-            FeatureModel::instance()->updateFeatureList(data);
-            emit completed();
+
+            WorkerPool::run([data]() {
+              return QJsonDocument::fromJson(data).object();
+            }).then(this, [this](const QJsonObject& json) {
+              FeatureModel::instance()->updateFeatureList(json);
+              emit completed();
+            });
           });
 }
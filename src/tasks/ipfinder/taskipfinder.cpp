@@ -19,7 +19,10 @@
 
 namespace {
 Logger logger(LOG_NETWORKING, "TaskIPFinder");
-}
+
+// Once a family has its result, the time left to the other one.
+constexpr int IPFINDER_RACE_MSEC = 1000;
+}  // namespace
 
 TaskIPFinder::TaskIPFinder() : Task("TaskIPFinder") {
   MVPN_COUNT_CTOR(TaskIPFinder);
@@ -27,6 +30,12 @@ TaskIPFinder::TaskIPFinder() : Task("TaskIPFinder") {
   // Queued to avoid this task to be deleted before the processing of the slots.
   connect(this, &TaskIPFinder::operationCompleted, this, &Task::completed,
           Qt::QueuedConnection);
+
+  m_raceTimer.setSingleShot(true);
+  connect(&m_raceTimer, &QTimer::timeout, this, [this]() {
+    logger.debug() << "The slowest family lost the race";
+    completeLookup();
+  });
 }
 
 TaskIPFinder::~TaskIPFinder() {
@@ -68,33 +77,44 @@ void TaskIPFinder::dnsLookupCompleted(const QHostInfo& hostInfo) {
 
     if (address.protocol() == QAbstractSocket::IPv4Protocol) {
       logger.debug() << "Ipv4:" << logger.sensitive(address.toString());
-      createRequest(address, false);
+      m_ipv4.m_addresses.append(address);
     }
 
     if (address.protocol() == QAbstractSocket::IPv6Protocol) {
       logger.debug() << "Ipv6:" << logger.sensitive(address.toString());
-      createRequest(address, true);
+      m_ipv6.m_addresses.append(address);
     }
   }
 
-  if (m_requestCount == 0) {
+  if (m_ipv4.m_addresses.isEmpty() && m_ipv6.m_addresses.isEmpty()) {
     logger.debug() << "No requests created. Let's abort the lookup";
     emit operationCompleted(QString(), QString(), QString());
     return;
   }
+
+  // The two families run in parallel.
+  if (!m_ipv4.m_addresses.isEmpty()) {
+    createRequest(m_ipv4);
+  }
+  if (!m_ipv6.m_addresses.isEmpty()) {
+    createRequest(m_ipv6);
+  }
 }
 
-void TaskIPFinder::createRequest(const QHostAddress& address, bool ipv6) {
-  NetworkRequest* request = NetworkRequest::createForIpInfo(this, address);
+void TaskIPFinder::createRequest(IPLookup& lookup) {
+  Q_ASSERT(!lookup.m_addresses.isEmpty());
 
-  ++m_requestCount;
+  NetworkRequest* request =
+      NetworkRequest::createForIpInfo(this, lookup.m_addresses.takeFirst());
+  lookup.m_running = true;
 
   connect(request, &NetworkRequest::requestFailed, this,
-          [this](QNetworkReply::NetworkError error, const QByteArray&) {
+          [this, &lookup](QNetworkReply::NetworkError error,
+                          const QByteArray&) {
             logger.error() << "IP address request failed" << error;
 
-            // This lookup has been canceled in the meantime.
-            if (m_requestCount == 0) {
+            // This lookup has been completed in the meantime.
+            if (m_completed) {
               return;
             }
 
@@ -104,66 +124,61 @@ void TaskIPFinder::createRequest(const QHostAddress& address, bool ipv6) {
               ErrorHandler::instance()->errorHandle(errorType);
             }
 
-            m_requestCount = 0;
-            emit operationCompleted(QString(), QString(), QString());
+            // Let's try the next address of the same family.
+            if (!lookup.m_addresses.isEmpty()) {
+              createRequest(lookup);
+              return;
+            }
+
+            lookup.m_running = false;
+            maybeCompleteLookup();
           });
 
   connect(request, &NetworkRequest::requestCompleted, this,
-          [this, ipv6](const QByteArray& data) {
+          [this, &lookup](const QByteArray& data) {
             logger.debug() << "IP address request completed";
 
-            // This lookup has been canceled in the meantime.
-            if (m_requestCount == 0) {
+            // This lookup has been completed in the meantime.
+            if (m_completed) {
               return;
             }
 
             QJsonDocument json = QJsonDocument::fromJson(data);
             if (json.isObject()) {
               QJsonObject obj = json.object();
-
-              QJsonValue country = obj.take("country");
-              QJsonValue value = obj.value("ip");
-
-              m_results.append(IPLookup{country.toString().toLower(),
-                                        value.toString(), ipv6});
+              lookup.m_country = obj.value("country").toString().toLower();
+              lookup.m_ipAddress = obj.value("ip").toString();
             }
 
-            --m_requestCount;
-            if (m_requestCount == 0) {
-              completeLookup();
-            }
+            lookup.m_running = false;
+            maybeCompleteLookup();
           });
 }
 
-void TaskIPFinder::completeLookup() {
-  Q_ASSERT(m_requestCount == 0);
-
-  logger.debug() << "Lookup completed!";
+void TaskIPFinder::maybeCompleteLookup() {
+  if (!m_ipv4.m_running && !m_ipv6.m_running) {
+    completeLookup();
+    return;
+  }
 
-  QString ipv4Address;
-  QString ipv6Address;
-  QString country;
+  // One family is done: the other one has a little more time.
+  if (!m_raceTimer.isActive() &&
+      (!m_ipv4.m_ipAddress.isEmpty() || !m_ipv6.m_ipAddress.isEmpty())) {
+    m_raceTimer.start(IPFINDER_RACE_MSEC);
+  }
+}
 
-  // In theory, we should have one ipv4 result and maybe an ipv6 too, but we do
-  // not know how the API host has been resolved. Let's use only the first
-  // result per type.
-  for (const IPLookup& ipLookup : m_results) {
-    if (ipLookup.m_ipAddress.isEmpty()) {
-      continue;
-    }
+void TaskIPFinder::completeLookup() {
+  Q_ASSERT(!m_completed);
 
-    if (ipLookup.m_ipv6 && ipv6Address.isEmpty()) {
-      ipv6Address = ipLookup.m_ipAddress;
-    }
+  logger.debug() << "Lookup completed!";
 
-    if (!ipLookup.m_ipv6 && ipv4Address.isEmpty()) {
-      ipv4Address = ipLookup.m_ipAddress;
-    }
+  m_completed = true;
+  m_raceTimer.stop();
 
-    if (country.isEmpty()) {
-      country = ipLookup.m_country;
-    }
-  }
+  // The country seen through IPv4 wins, if any.
+  QString country = m_ipv4.m_ipAddress.isEmpty() ? m_ipv6.m_country
+                                                 : m_ipv4.m_country;
 
-  emit operationCompleted(ipv4Address, ipv6Address, country);
+  emit operationCompleted(m_ipv4.m_ipAddress, m_ipv6.m_ipAddress, country);
 }
@@ -7,11 +7,16 @@
 
 #include "task.h"
 
+#include <QHostAddress>
+#include <QList>
 #include <QObject>
+#include <QTimer>
 
-class QHostAddress;
 class QHostInfo;
 
+// Looks up the IPv4 and the IPv6 addresses of the device, as seen by the API
+// host, racing the two families: once one of them has a result, the other one
+// has a short time to complete.
 class TaskIPFinder final : public Task {
   Q_OBJECT
   Q_DISABLE_COPY_MOVE(TaskIPFinder)
@@ -29,19 +34,25 @@ class TaskIPFinder final : public Task {
  private slots:
   void dnsLookupCompleted(const QHostInfo& hostInfo);
 
- private:
-  void createRequest(const QHostAddress& address, bool ipv6);
-  void completeLookup();
-
  private:
   struct IPLookup {
-    QString m_country;
+    // The addresses of the API host not tried yet.
+    QList<QHostAddress> m_addresses;
     QString m_ipAddress;
-    bool m_ipv6;
+    QString m_country;
+    bool m_running = false;
   };
 
-  QList<IPLookup> m_results;
-  uint32_t m_requestCount = 0;
+  void createRequest(IPLookup& lookup);
+  void maybeCompleteLookup();
+  void completeLookup();
+
+ private:
+  IPLookup m_ipv4;
+  IPLookup m_ipv6;
+
+  QTimer m_raceTimer;
+  bool m_completed = false;
   int m_lookupId = -1;
 };
 
@@ -8,6 +8,9 @@
 #include "logger.h"
 #include "mozillavpn.h"
 #include "networkrequest.h"
+#include "workerpool.h"
+
+#include <QJsonDocument>
 
 namespace {
 Logger logger(LOG_MAIN, "TaskServers");
@@ -34,7 +37,12 @@ void TaskServers::run() {
   connect(request, &NetworkRequest::requestCompleted, this,
           [this](const QByteArray& data) {
             logger.debug() << "Servers obtained";
-            MozillaVPN::instance()->serversFetched(data);
-            emit completed();
+
+            // The server list is big. Let's parse it out of the main thread.
+            WorkerPool::run([data]() { return QJsonDocument::fromJson(data); })
+                .then(this, [this, data](const QJsonDocument& json) {
+                  MozillaVPN::instance()->serversFetched(data, json);
+                  emit completed();
+                });
           });
 }
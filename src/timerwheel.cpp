@@ -0,0 +1,298 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "timerwheel.h"
+#include "constants.h"
+#include "leakdetector.h"
+#include "logger.h"
+
+#include <QCoreApplication>
+
+namespace {
+Logger logger(LOG_MAIN, "TimerWheel");
+TimerWheel* s_instance = nullptr;
+
+constexpr int TIMER_WHEEL_DEFAULT_SLACK_MSEC = 250;
+
+// QTimer intervals are int. Let's wake up at least once per hour when the
+// next deadline is further than that.
+constexpr qint64 TIMER_WHEEL_MAX_SLEEP_MSEC = 3600000;
+
+int slackFromEnv() {
+  bool ok = false;
+  int slack = Constants::envOrDefault("MVPN_TIMER_WHEEL_SLACK_MSEC",
+                                      QString::number(
+                                          TIMER_WHEEL_DEFAULT_SLACK_MSEC))
+                  .toInt(&ok);
+  if (!ok || slack <= 0) {
+    return TIMER_WHEEL_DEFAULT_SLACK_MSEC;
+  }
+  return slack;
+}
+}  // namespace
+
+// static
+TimerWheel* TimerWheel::instance() {
+  if (!s_instance) {
+    s_instance = new TimerWheel(qApp);
+  }
+  return s_instance;
+}
+
+TimerWheel::TimerWheel(QObject* parent)
+    : QObject(parent), m_slackMsec(slackFromEnv()) {
+  MVPN_COUNT_CTOR(TimerWheel);
+
+  logger.debug() << "Timer wheel slack:" << m_slackMsec << "msecs";
+
+  m_clock.start();
+
+  // The wheel does its own coalescing. A coarse timer could fire earlier than
+  // the deadline and wake us up for nothing.
+  m_timer.setSingleShot(true);
+  m_timer.setTimerType(Qt::PreciseTimer);
+  connect(&m_timer, &QTimer::timeout, this, [this]() {
+    ++m_wakeups;
+    advance();
+  });
+}
+
+TimerWheel::~TimerWheel() {
+  MVPN_COUNT_DTOR(TimerWheel);
+
+  for (const Entry& entry : m_entries) {
+    entry.m_timer->m_id = 0;
+  }
+
+  Q_ASSERT(s_instance == this);
+  s_instance = nullptr;
+}
+
+double TimerWheel::wakeupsPerMinute() const {
+  qint64 elapsed = m_clock.elapsed();
+  if (elapsed <= 0) {
+    return 0;
+  }
+  return m_wakeups * 60000.0 / elapsed;
+}
+
+qint64 TimerWheel::currentTick() const {
+  return m_clock.elapsed() / m_slackMsec;
+}
+
+quint64 TimerWheel::add(WheelTimer* timer, qint64 msec) {
+  Q_ASSERT(timer);
+
+  qint64 now = currentTick();
+
+  // If nothing is due, we can move the wheel forward without firing anything.
+  // This keeps the placement of the new timer close to its real level and
+  // avoids useless cascading wakeups.
+  if (!m_advancing) {
+    qint64 next = nextTick();
+    if (next < 0 || next > now) {
+      m_now = std::max(m_now, now);
+    }
+  }
+
+  // Round the deadline up: a timer never fires earlier than requested. A
+  // timer added while advancing is never served by the same wakeup, so that a
+  // repeating timer with a 0 interval cannot starve the event loop.
+  qint64 deadline = m_clock.elapsed() + std::max(msec, qint64(0));
+  qint64 tick = (deadline + m_slackMsec - 1) / m_slackMsec;
+  tick = std::max(tick, std::max(m_now, now) + 1);
+
+  quint64 id = ++m_lastId;
+  m_entries.insert(id, {timer, tick, -1, -1});
+  place(id, tick);
+
+  rearm();
+  return id;
+}
+
+// static
+void TimerWheel::remove(quint64 id) {
+  // The wheel could be gone at shutdown.
+  if (!s_instance) {
+    return;
+  }
+
+  QHash<quint64, Entry>::iterator i = s_instance->m_entries.find(id);
+  if (i == s_instance->m_entries.end()) {
+    return;
+  }
+
+  if (i->m_level < 0) {
+    s_instance->m_overflow.removeOne(id);
+  } else {
+    s_instance->m_slots[i->m_level][i->m_slot].removeOne(id);
+  }
+
+  s_instance->m_entries.erase(i);
+  s_instance->rearm();
+}
+
+void TimerWheel::place(quint64 id, qint64 tick) {
+  Q_ASSERT(m_entries.contains(id));
+  Entry& entry = m_entries[id];
+
+  // A tick goes in the first level where it shares the block of the current
+  // tick: level 0 for the next 64 ticks in the current block of 64 ticks,
+  // level 1 for the following blocks in the current block of 4096 ticks, and
+  // so on.
+  for (int level = 0; level < LEVELS; ++level) {
+    int blockBits = SLOT_BITS * (level + 1);
+    if ((tick >> blockBits) == (m_now >> blockBits)) {
+      int slot = (tick >> (SLOT_BITS * level)) & (SLOTS - 1);
+      m_slots[level][slot].append(id);
+      entry.m_level = level;
+      entry.m_slot = slot;
+      return;
+    }
+  }
+
+  m_overflow.append(id);
+  entry.m_level = -1;
+  entry.m_slot = -1;
+}
+
+qint64 TimerWheel::nextTick() const {
+  // Level 0: the next non-empty slot is the next expiration.
+  for (int slot = (m_now & (SLOTS - 1)) + 1; slot < SLOTS; ++slot) {
+    if (!m_slots[0][slot].isEmpty()) {
+      return (m_now & ~qint64(SLOTS - 1)) | slot;
+    }
+  }
+
+  // Other levels: the beginning of the next non-empty slot is when its timers
+  // need to be cascaded to the lower levels.
+  for (int level = 1; level < LEVELS; ++level) {
+    int shift = SLOT_BITS * level;
+    int current = (m_now >> shift) & (SLOTS - 1);
+    for (int slot = current + 1; slot < SLOTS; ++slot) {
+      if (!m_slots[level][slot].isEmpty()) {
+        qint64 blockMask = (qint64(1) << (shift + SLOT_BITS)) - 1;
+        return (m_now & ~blockMask) | (qint64(slot) << shift);
+      }
+    }
+  }
+
+  if (!m_overflow.isEmpty()) {
+    qint64 blockMask = (qint64(1) << (SLOT_BITS * LEVELS)) - 1;
+    return (m_now | blockMask) + 1;
+  }
+
+  return -1;
+}
+
+void TimerWheel::advance() {
+  m_advancing = true;
+
+  qint64 now = currentTick();
+
+  while (true) {
+    qint64 tick = nextTick();
+    if (tick < 0 || tick > now) {
+      // Nothing to do until `now`. Jumping ahead keeps every timer in the
+      // right level: none of them needed to be cascaded before `now`.
+      m_now = std::max(m_now, now);
+      break;
+    }
+
+    m_now = tick;
+
+    // Cascade the timers of the higher levels starting in this tick.
+    for (int level = LEVELS; level > 0; --level) {
+      int shift = SLOT_BITS * level;
+      if (tick & ((qint64(1) << shift) - 1)) {
+        continue;
+      }
+
+      QList<quint64> ids;
+      if (level == LEVELS) {
+        ids.swap(m_overflow);
+      } else {
+        ids.swap(m_slots[level][(tick >> shift) & (SLOTS - 1)]);
+      }
+
+      for (quint64 id : ids) {
+        place(id, m_entries[id].m_tick);
+      }
+    }
+
+    QList<quint64> expired;
+    expired.swap(m_slots[0][tick & (SLOTS - 1)]);
+
+    for (quint64 id : expired) {
+      // The timer could have been stopped by a previous callback.
+      QHash<quint64, Entry>::iterator i = m_entries.find(id);
+      if (i == m_entries.end()) {
+        continue;
+      }
+
+      Q_ASSERT(i->m_tick == tick);
+      WheelTimer* timer = i->m_timer;
+      m_entries.erase(i);
+
+      timer->expired();
+    }
+  }
+
+  m_advancing = false;
+  rearm();
+}
+
+void TimerWheel::rearm() {
+  if (m_advancing) {
+    return;
+  }
+
+  qint64 tick = nextTick();
+  if (tick < 0) {
+    m_timer.stop();
+    return;
+  }
+
+  qint64 msec = tick * m_slackMsec - m_clock.elapsed();
+  msec = std::min(std::max(msec, qint64(0)), TIMER_WHEEL_MAX_SLEEP_MSEC);
+  m_timer.start(static_cast<int>(msec));
+}
+
+WheelTimer::WheelTimer(QObject* parent) : QObject(parent) {
+  MVPN_COUNT_CTOR(WheelTimer);
+}
+
+WheelTimer::~WheelTimer() {
+  MVPN_COUNT_DTOR(WheelTimer);
+  stop();
+}
+
+void WheelTimer::start(qint64 msec) {
+  m_interval = msec;
+  start();
+}
+
+void WheelTimer::start() {
+  stop();
+  m_id = TimerWheel::instance()->add(this, m_interval);
+}
+
+void WheelTimer::stop() {
+  if (!m_id) {
+    return;
+  }
+
+  TimerWheel::remove(m_id);
+  m_id = 0;
+}
+
+void WheelTimer::expired() {
+  m_id = 0;
+
+  if (!m_singleShot) {
+    m_id = TimerWheel::instance()->add(this, m_interval);
+  }
+
+  emit timeout();
+}
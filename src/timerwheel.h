@@ -0,0 +1,125 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QTimer>
+
+class WheelTimer;
+
+// A hierarchical timer wheel driven by a single QTimer. Deadlines are rounded
+// up to the wheel slack, so timers expiring close to each other are served by
+// the same wakeup. Each level has 64 slots, 64 times larger than the slots of
+// the previous level. Timers too far in the future are kept in an overflow
+// list.
+//
+// The slack is 250 msecs by default. It can be changed with the
+// MVPN_TIMER_WHEEL_SLACK_MSEC env variable.
+class TimerWheel final : public QObject {
+  Q_OBJECT
+  Q_DISABLE_COPY_MOVE(TimerWheel)
+
+ public:
+  static TimerWheel* instance();
+
+  ~TimerWheel();
+
+  int slackMsec() const { return m_slackMsec; }
+
+  // Number of timers currently active.
+  int count() const { return m_entries.count(); }
+
+  // Number of wakeups since the creation of the wheel.
+  quint64 wakeups() const { return m_wakeups; }
+
+  // Number of wakeups per minute since the creation of the wheel.
+  double wakeupsPerMinute() const;
+
+ private:
+  friend class WheelTimer;
+
+  explicit TimerWheel(QObject* parent);
+
+  static constexpr int LEVELS = 4;
+  static constexpr int SLOT_BITS = 6;
+  static constexpr int SLOTS = 1 << SLOT_BITS;
+
+  quint64 add(WheelTimer* timer, qint64 msec);
+  static void remove(quint64 id);
+
+  void place(quint64 id, qint64 tick);
+  qint64 nextTick() const;
+  qint64 currentTick() const;
+
+  void advance();
+  void rearm();
+
+ private:
+  const int m_slackMsec;
+
+  QElapsedTimer m_clock;
+  QTimer m_timer;
+
+  // The last tick processed.
+  qint64 m_now = 0;
+
+  quint64 m_lastId = 0;
+
+  struct Entry {
+    WheelTimer* m_timer;
+    qint64 m_tick;
+    int m_level;  // -1 for the overflow list
+    int m_slot;
+  };
+
+  QHash<quint64, Entry> m_entries;
+  QList<quint64> m_slots[LEVELS][SLOTS];
+  QList<quint64> m_overflow;
+
+  bool m_advancing = false;
+  quint64 m_wakeups = 0;
+};
+
+// A QTimer-like object scheduled by the TimerWheel. It can fire up to
+// `TimerWheel::slackMsec()` later than requested, never earlier.
+class WheelTimer final : public QObject {
+  Q_OBJECT
+  Q_DISABLE_COPY_MOVE(WheelTimer)
+
+ public:
+  explicit WheelTimer(QObject* parent = nullptr);
+  ~WheelTimer();
+
+  void setSingleShot(bool singleShot) { m_singleShot = singleShot; }
+  bool isSingleShot() const { return m_singleShot; }
+
+  void setInterval(qint64 msec) { m_interval = msec; }
+  qint64 interval() const { return m_interval; }
+
+  void start(qint64 msec);
+  void start();
+  void stop();
+
+  bool isActive() const { return m_id != 0; }
+
+ signals:
+  void timeout();
+
+ private:
+  friend class TimerWheel;
+
+  void expired();
+
+ private:
+  quint64 m_id = 0;
+  qint64 m_interval = 0;
+  bool m_singleShot = false;
+};
+
+#endif  // TIMERWHEEL_H
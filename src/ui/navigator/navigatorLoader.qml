@@ -54,6 +54,9 @@ StackView {
           (VPNNavigator.loadingFlags === VPNNavigator.ForceReload)) {
         stackView.get(pos+1).sourceComponent = null;
         stackView.get(pos+1).sourceComponent = VPNNavigator.component;
+      } else {
+        // The loader is not going to load anything: the screen is ready.
+        VPNNavigator.screenLoaded();
       }
 
       for (let i = 0; i < stackView.screens.length; ++i) {
@@ -13,4 +13,6 @@ Loader {
     // Let's use `onCompleted` to take the current value of
     // VPNNavigator.component without creating a property binding.
     Component.onCompleted: () => { loader.sourceComponent = VPNNavigator.component }
+
+    onLoaded: VPNNavigator.screenLoaded()
 }
@@ -10,7 +10,9 @@
 #include "mozillavpn.h"
 #include "networkrequest.h"
 #include "telemetry/gleansample.h"
+#include "workerpool.h"
 
+#include <QCryptographicHash>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonValue>
@@ -346,40 +348,43 @@ bool Balrog::processData(Task* task, const QByteArray& data) {
   connect(request, &NetworkRequest::requestCompleted, this,
           [this, hashValue, hashFunction, url](const QByteArray& data) {
             logger.debug() << "Request completed";
-
-            if (!computeHash(url, data, hashValue, hashFunction)) {
-              logger.error() << "Ignore failure.";
-              deleteLater();
-            }
+            computeHash(url, data, hashValue, hashFunction);
           });
 
   return true;
 }
 
-bool Balrog::computeHash(const QString& url, const QByteArray& data,
+void Balrog::computeHash(const QString& url, const QByteArray& data,
                          const QString& hashValue,
                          const QString& hashFunction) {
   logger.debug() << "Compute the hash";
 
   if (hashFunction != "sha512") {
-    logger.error() << "Invalid hash function";
-    return false;
+    logger.error() << "Invalid hash function. Ignore failure.";
+    deleteLater();
+    return;
   }
 
-  QCryptographicHash hash(QCryptographicHash::Sha512);
-  hash.addData(data);
-  QByteArray hashHex = hash.result().toHex();
-
-  if (hashHex != hashValue) {
-    logger.error() << "Hash doesn't match";
-    return false;
-  }
+  // Hashing the whole installer takes a while: let's not freeze the UI.
+  WorkerPool::run([data]() {
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha512).toHex();
+  }).then(this, [this, url, data, hashValue](const QByteArray& hashHex) {
+    if (hashHex != hashValue) {
+      logger.error() << "Hash doesn't match. Ignore failure.";
+      deleteLater();
+      return;
+    }
 
-  emit MozillaVPN::instance()->recordGleanEventWithExtraKeys(
-      GleanSample::updateStep,
-      {{"state", QVariant::fromValue(BalrogValidationCompleted).toString()}});
+    emit MozillaVPN::instance()->recordGleanEventWithExtraKeys(
+        GleanSample::updateStep,
+        {{"state",
+          QVariant::fromValue(BalrogValidationCompleted).toString()}});
 
-  return saveFileAndInstall(url, data);
+    if (!saveFileAndInstall(url, data)) {
+      logger.error() << "Ignore failure.";
+      deleteLater();
+    }
+  });
 }
 
 bool Balrog::saveFileAndInstall(const QString& url, const QByteArray& data) {
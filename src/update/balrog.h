@@ -36,7 +36,7 @@ class Balrog final : public Updater {
   bool validateSignature(const QByteArray& x5uData,
                          const QByteArray& updateData,
                          const QByteArray& signatureBlob);
-  bool computeHash(const QString& url, const QByteArray& data,
+  void computeHash(const QString& url, const QByteArray& data,
                    const QString& hashValue, const QString& hashFunction);
   bool saveFileAndInstall(const QString& url, const QByteArray& data);
   bool install(const QString& filePath);
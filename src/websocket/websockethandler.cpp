@@ -87,6 +87,12 @@ void WebSocketHandler::initialize() {
 
   connect(vpn, &MozillaVPN::userStateChanged, this,
           &WebSocketHandler::onUserStateChanged);
+
+  // We are initialized after the first frame: the user may be already
+  // authenticated.
+  if (MozillaVPN::isUserAuthenticated()) {
+    open();
+  }
 }
 
 /**
@@ -0,0 +1,34 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "workerpool.h"
+
+#include <QGlobalStatic>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+
+namespace {
+
+// The jobs are short and the GUI thread must keep a core: one thread less
+// than the number of cores, and at least 2 threads to not serialize a long
+// job and a short one.
+class Pool final : public QThreadPool {
+ public:
+  Pool() {
+    setMaxThreadCount(std::max(2, QThread::idealThreadCount() - 1));
+    setObjectName("WorkerPool");
+  }
+};
+
+Q_GLOBAL_STATIC(Pool, s_pool);
+
+}  // namespace
+
+// static
+QThreadPool* WorkerPool::threadPool() { return s_pool; }
+
+// static
+void WorkerPool::start(QRunnable* runnable) { s_pool->start(runnable); }
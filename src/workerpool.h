@@ -0,0 +1,155 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QObject>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QWaitCondition>
+
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+class QThreadPool;
+
+// Emits `completed` from the worker thread when a job is done. The
+// continuations are connected to it with a queued connection: Qt drops them
+// if their context object is deleted in the meantime.
+class WorkerNotifier final : public QObject {
+  Q_OBJECT
+  Q_DISABLE_COPY_MOVE(WorkerNotifier)
+
+ public:
+  WorkerNotifier() = default;
+
+ signals:
+  void completed();
+};
+
+template <typename T>
+class WorkerFuture final {
+  static_assert(!std::is_void_v<T>, "Jobs must return a value");
+
+ public:
+  // Invokes `continuation` with the result of the job, in the thread of
+  // `context`. Never synchronously, even if the job is already completed. A
+  // future has at most one continuation.
+  template <typename Continuation>
+  void then(QObject* context, Continuation&& continuation) const {
+    Q_ASSERT(context);
+
+    QMutexLocker locker(&m_state->m_mutex);
+    Q_ASSERT(!m_state->m_notifier);
+
+    // The notifier lives in the current thread. The connection keeps the
+    // state alive until the continuation is invoked, or until the context is
+    // deleted; then the state deletes the notifier.
+    m_state->m_notifier = new WorkerNotifier();
+
+    QSharedPointer<State> state = m_state;
+    QObject::connect(
+        m_state->m_notifier, &WorkerNotifier::completed, context,
+        [state, continuation = std::forward<Continuation>(continuation)]() {
+          WorkerNotifier* notifier = nullptr;
+          {
+            QMutexLocker locker(&state->m_mutex);
+            std::swap(notifier, state->m_notifier);
+          }
+
+          if (notifier) {
+            // This releases the connection, and the state with it.
+            notifier->deleteLater();
+            continuation(std::as_const(state->m_result));
+          }
+        },
+        Qt::QueuedConnection);
+
+    if (m_state->m_finished) {
+      emit m_state->m_notifier->completed();
+    }
+  }
+
+  bool isFinished() const {
+    QMutexLocker locker(&m_state->m_mutex);
+    return m_state->m_finished;
+  }
+
+  // Blocks until the job is completed.
+  T result() const {
+    QMutexLocker locker(&m_state->m_mutex);
+    while (!m_state->m_finished) {
+      m_state->m_condition.wait(&m_state->m_mutex);
+    }
+    return m_state->m_result;
+  }
+
+ private:
+  friend class WorkerPool;
+
+  struct State {
+    ~State() {
+      if (m_notifier) {
+        m_notifier->deleteLater();
+      }
+    }
+
+    void complete(T&& result) {
+      QMutexLocker locker(&m_mutex);
+      m_result = std::move(result);
+      m_finished = true;
+      m_condition.wakeAll();
+
+      if (m_notifier) {
+        emit m_notifier->completed();
+      }
+    }
+
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    bool m_finished = false;
+    T m_result{};
+    WorkerNotifier* m_notifier = nullptr;
+  };
+
+  WorkerFuture() : m_state(new State()) {}
+
+  QSharedPointer<State> m_state;
+};
+
+// The thread pool for the CPU-bound jobs that would block the main thread for
+// too long: key derivation, hashing, parsing of large JSON documents...
+//
+// The jobs must not touch any QObject living in another thread. Their results
+// are given back to the continuations of the returned futures.
+//
+//   WorkerPool::run([data]() { return QJsonDocument::fromJson(data); })
+//       .then(this, [this](const QJsonDocument& json) { ... });
+class WorkerPool final {
+ public:
+  WorkerPool() = delete;
+
+  template <typename Job>
+  static auto run(Job&& job) {
+    using Result = std::decay_t<std::invoke_result_t<Job>>;
+
+    WorkerFuture<Result> future;
+    auto state = future.m_state;
+    start(QRunnable::create([state, job = std::forward<Job>(job)]() mutable {
+      state->complete(job());
+    }));
+    return future;
+  }
+
+  static QThreadPool* threadPool();
+
+ private:
+  static void start(QRunnable* runnable);
+};
+
+#endif  // WORKERPOOL_H
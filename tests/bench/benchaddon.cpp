@@ -0,0 +1,267 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "benchaddon.h"
+#include "../../src/addons/addon.h"
+#include "../../src/addons/addonscriptcache.h"
+#include "../../src/addons/manager/addondirectory.h"
+#include "../../src/addons/manager/addonhashcache.h"
+#include "../../src/qmlengineholder.h"
+#include "../../src/settingsholder.h"
+#include "../../src/systemtraynotificationhandler.h"
+#include "../../src/workerpool.h"
+#include "fixtures.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QList>
+#include <QJSValue>
+#include <QPair>
+#include <QQmlEngine>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QTemporaryDir>
+
+#include <utility>
+#include <vector>
+
+namespace {
+
+// A synthetic index: 100 packages of 100 KB each.
+constexpr int ADDON_COUNT = 100;
+constexpr int ADDON_PACKAGE_SIZE = 100 * 1024;
+
+// The add-ons with a script loaded at startup.
+constexpr int ADDON_SCRIPT_COUNT = 50;
+
+QByteArray conditionScript() {
+  QByteArray script("(function(vpn, condition) {\n");
+  for (int i = 0; i < 200; ++i) {
+    script.append(QString("  if (vpn.foo === %1) { condition.enable(); }\n")
+                      .arg(i)
+                      .toUtf8());
+  }
+  script.append("})\n");
+  return script;
+}
+
+}  // namespace
+
+void BenchAddon::create_data() {
+  QTest::addColumn<int>("blocks");
+
+  QTest::addRow("empty") << 0;
+  QTest::addRow("blocks") << 50;
+}
+
+// AddonManager loads each add-on of the index with Addon::create(). The
+// manager itself needs a signed index, so we measure the add-on creation.
+void BenchAddon::create() {
+  QFETCH(int, blocks);
+
+  SettingsHolder settingsHolder;
+
+  QObject parent;
+  SystemTrayNotificationHandler nh(&parent);
+
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+
+  QString manifest = dir.filePath("manifest.json");
+  {
+    QFile file(manifest);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(Fixtures::messageAddon("bench_message", blocks));
+  }
+
+  QBENCHMARK {
+    Addon* addon = Addon::create(&parent, manifest);
+    QVERIFY(addon);
+    delete addon;
+  }
+}
+
+void BenchAddon::verify_data() {
+  QTest::addColumn<bool>("warm");
+
+  QTest::addRow("cold") << false;
+  QTest::addRow("warm") << true;
+}
+
+// One iteration verifies the packages of the index against their signed
+// sha256, as AddonManager::verifyAndLoad() does at startup: a cache hit costs
+// a stat, a miss hashes the package in the worker pool. The cold cache is
+// empty, like at the first startup; the warm one is read from the disk.
+void BenchAddon::verify() {
+  QFETCH(bool, warm);
+
+  SettingsHolder settingsHolder;
+
+  AddonDirectory addonDirectory;
+  addonDirectory.testReset();
+
+  QDir dir;
+  QVERIFY(addonDirectory.getDirectory(&dir));
+
+  QRandomGenerator rng(1);
+  QList<QPair<QString, QByteArray>> index;
+  for (int i = 0; i < ADDON_COUNT; ++i) {
+    QByteArray package(ADDON_PACKAGE_SIZE, Qt::Uninitialized);
+    rng.fillRange(reinterpret_cast<quint32*>(package.data()),
+                  package.size() / sizeof(quint32));
+
+    QString fileName = QString("addon_%1.rcc").arg(i);
+    QVERIFY(addonDirectory.writeToFile(fileName, package));
+    index.append(qMakePair(
+        fileName,
+        QCryptographicHash::hash(package, QCryptographicHash::Sha256)));
+  }
+
+  auto verifyAll = [&](AddonHashCache& cache) {
+    using Result = QPair<AddonHashCache::FileStat, QByteArray>;
+    // WorkerFuture has no default constructor.
+    std::vector<std::pair<int, WorkerFuture<Result>>> pending;
+
+    int verified = 0;
+    for (int i = 0; i < index.length(); ++i) {
+      const QString& fileName = index.at(i).first;
+      QString filePath = dir.filePath(fileName);
+
+      QByteArray cachedSha256;
+      if (cache.lookup(fileName, AddonHashCache::stat(filePath),
+                       &cachedSha256) &&
+          cachedSha256 == index.at(i).second) {
+        ++verified;
+        continue;
+      }
+
+      pending.emplace_back(i, WorkerPool::run([filePath]() {
+        return qMakePair(AddonHashCache::stat(filePath),
+                         AddonHashCache::hash(filePath));
+      }));
+    }
+
+    for (const auto& job : pending) {
+      Result result = job.second.result();
+      if (result.second == index.at(job.first).second) {
+        cache.insert(index.at(job.first).first, result.first, result.second);
+        ++verified;
+      }
+    }
+
+    return verified;
+  };
+
+  if (warm) {
+    AddonHashCache cache(&addonDirectory);
+    QCOMPARE(verifyAll(cache), ADDON_COUNT);
+    cache.save();
+  }
+
+  QBENCHMARK {
+    AddonHashCache cache(&addonDirectory);
+    QCOMPARE(verifyAll(cache), ADDON_COUNT);
+  }
+
+  addonDirectory.testReset();
+}
+
+void BenchAddon::evaluateScript_data() {
+  QTest::addColumn<bool>("cached");
+
+  QTest::addRow("cold") << false;
+  QTest::addRow("cached") << true;
+}
+
+// One iteration evaluates the script of a JavaScript condition. Each add-on
+// script is evaluated cold at every startup: the cache only serves the
+// reloads of the same add-on version within a session.
+void BenchAddon::evaluateScript() {
+  QFETCH(bool, cached);
+
+  SettingsHolder settingsHolder;
+  QQmlEngine engine;
+  QmlEngineHolder qml(&engine);
+
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+
+  QString script = dir.filePath("condition.js");
+  {
+    QFile file(script);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(conditionScript());
+  }
+
+  AddonScriptCache::clear();
+
+  QBENCHMARK {
+    if (!cached) {
+      AddonScriptCache::clear();
+    }
+
+    QJSValue value;
+    QVERIFY(AddonScriptCache::evaluate(script, "bench", &value));
+    QVERIFY(value.isCallable());
+  }
+
+  AddonScriptCache::clear();
+}
+
+void BenchAddon::evaluateStartup_data() {
+  QTest::addColumn<bool>("modules");
+
+  QTest::addRow("scripts") << false;
+  QTest::addRow("modules") << true;
+}
+
+// The scripts of the add-ons are evaluated on the UI thread, one after the
+// other, when the add-ons are loaded at startup: the result is how long the
+// UI is blocked. The modules are the ones generated by `build.py
+// --compile-scripts`. Each add-on is a new version, in a new engine, like at
+// startup.
+void BenchAddon::evaluateStartup() {
+  QFETCH(bool, modules);
+
+  SettingsHolder settingsHolder;
+  QQmlEngine engine;
+  QmlEngineHolder qml(&engine);
+
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+
+  QStringList scripts;
+  for (int i = 0; i < ADDON_SCRIPT_COUNT; ++i) {
+    QString script = dir.filePath(QString("condition_%1.js").arg(i));
+    QByteArray source = conditionScript();
+    {
+      QFile file(script);
+      QVERIFY(file.open(QIODevice::WriteOnly));
+      file.write(source);
+    }
+
+    if (modules) {
+      QFile file(script.chopped(3) + ".mjs");
+      QVERIFY(file.open(QIODevice::WriteOnly));
+      file.write("export default " + source);
+    }
+
+    scripts.append(script);
+  }
+
+  AddonScriptCache::clear();
+
+  QBENCHMARK_ONCE {
+    for (int i = 0; i < scripts.length(); ++i) {
+      QJSValue value;
+      QVERIFY(AddonScriptCache::evaluate(scripts.at(i),
+                                         QByteArray::number(i), &value));
+      QVERIFY(value.isCallable());
+    }
+  }
+
+  AddonScriptCache::clear();
+}
+
+static BenchAddon s_benchAddon;
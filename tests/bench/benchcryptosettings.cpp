@@ -0,0 +1,57 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "benchcryptosettings.h"
+#include "../../src/cryptosettings.h"
+#include "fixtures.h"
+
+#include <QBuffer>
+
+void BenchCryptoSettings::readFile_data() {
+  QTest::addColumn<int>("entries");
+
+  QTest::addRow("small") << 20;
+  QTest::addRow("large") << 200;
+}
+
+void BenchCryptoSettings::readFile() {
+  QFETCH(int, entries);
+
+  QByteArray content;
+  {
+    QBuffer buffer(&content);
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QVERIFY(CryptoSettings::writeFile(buffer, Fixtures::settingsMap(entries)));
+  }
+
+  QSettings::SettingsMap map;
+  QBENCHMARK {
+    map.clear();
+    QBuffer buffer(&content);
+    QVERIFY(buffer.open(QIODevice::ReadOnly));
+    QVERIFY(CryptoSettings::readFile(buffer, map));
+  }
+
+  QVERIFY(map.count() == entries + 1);
+}
+
+void BenchCryptoSettings::writeFile_data() { readFile_data(); }
+
+void BenchCryptoSettings::writeFile() {
+  QFETCH(int, entries);
+
+  QSettings::SettingsMap map = Fixtures::settingsMap(entries);
+
+  QByteArray content;
+  QBENCHMARK {
+    content.clear();
+    QBuffer buffer(&content);
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QVERIFY(CryptoSettings::writeFile(buffer, map));
+  }
+
+  QVERIFY(!content.isEmpty());
+}
+
+static BenchCryptoSettings s_benchCryptoSettings;
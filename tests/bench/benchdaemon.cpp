@@ -0,0 +1,46 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "benchdaemon.h"
+#include "../../src/daemon/daemon.h"
+#include "fixtures.h"
+
+#include <QJsonDocument>
+
+void BenchDaemon::parseCommand_data() {
+  QTest::addColumn<int>("allowedRanges");
+  QTest::addColumn<int>("excludedAddresses");
+
+  // A full tunnel.
+  QTest::addRow("default") << 2 << 2;
+  // Local networks and many excluded addresses.
+  QTest::addRow("split") << 200 << 50;
+}
+
+// What the daemon does for each `activate` command received from the client.
+void BenchDaemon::parseCommand() {
+  QFETCH(int, allowedRanges);
+  QFETCH(int, excludedAddresses);
+
+  QByteArray command =
+      QJsonDocument(
+          Fixtures::daemonActivateCommand(allowedRanges, excludedAddresses))
+          .toJson(QJsonDocument::Compact);
+
+  InterfaceConfig config;
+  QBENCHMARK {
+    QJsonDocument json = QJsonDocument::fromJson(command);
+    QVERIFY(json.isObject());
+
+    QJsonObject obj = json.object();
+    QCOMPARE(obj.value("type").toString(), QString("activate"));
+
+    config = InterfaceConfig();
+    QVERIFY(Daemon::parseConfig(obj, config));
+  }
+
+  QVERIFY(config.m_allowedIPAddressRanges.count() == allowedRanges);
+}
+
+static BenchDaemon s_benchDaemon;
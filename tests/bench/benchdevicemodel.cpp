@@ -0,0 +1,114 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "benchdevicemodel.h"
+#include "../../src/models/devicemodel.h"
+#include "../../src/models/keys.h"
+#include "delegatecounter.h"
+#include "fixtures.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+
+// The maximum number of devices of an account.
+constexpr int DEVICES = 5;
+
+// The same list, with a renamed device.
+QByteArray renameDevice(const QByteArray& list) {
+  QJsonObject obj = QJsonDocument::fromJson(list).object();
+  QJsonArray devices = obj["devices"].toArray();
+  QJsonObject device = devices[0].toObject();
+
+  device["name"] = "Renamed device";
+  devices[0] = device;
+  obj["devices"] = devices;
+
+  return QJsonDocument(obj).toJson(QJsonDocument::Compact);
+}
+
+// The same list, without the first device.
+QByteArray removeDevice(const QByteArray& list) {
+  QJsonObject obj = QJsonDocument::fromJson(list).object();
+  QJsonArray devices = obj["devices"].toArray();
+  devices.removeFirst();
+  obj["devices"] = devices;
+
+  return QJsonDocument(obj).toJson(QJsonDocument::Compact);
+}
+
+// The list alternated with the original one by the refresh benchmarks.
+QByteArray refreshedList(const QString& change, const QByteArray& list) {
+  if (change == "name") return renameDevice(list);
+  if (change == "device") return removeDevice(list);
+
+  // Same content, different bytes: the model parses it again.
+  return QJsonDocument::fromJson(list).toJson(QJsonDocument::Indented);
+}
+
+}  // namespace
+
+void BenchDeviceModel::refresh_data() {
+  QTest::addColumn<QString>("change");
+
+  // The periodic fetch of an account which has not changed.
+  QTest::addRow("unchanged") << "unchanged";
+  // A device was renamed.
+  QTest::addRow("name") << "name";
+  // A device was removed, and is added back by the next refresh.
+  QTest::addRow("device") << "device";
+}
+
+// Refreshes the device list while a view shows it.
+void BenchDeviceModel::refresh() {
+  QFETCH(QString, change);
+
+  QByteArray list = Fixtures::deviceList(DEVICES);
+  QByteArray lists[2] = {list, refreshedList(change, list)};
+
+  Keys keys;
+  keys.storeKeys("private", "currentDevicePubkey");
+
+  DeviceModel model;
+  QVERIFY(model.fromJson(&keys, list));
+
+  DelegateCounter delegates(&model, {"name", "publicKey", "createdAt"});
+  QVERIFY(delegates.isValid());
+
+  int i = 1;
+  QBENCHMARK {
+    QVERIFY(model.fromJson(&keys, lists[i++ % 2]));
+  }
+}
+
+// The number of QML delegates created by a refresh of the device list.
+void BenchDeviceModel::refreshDelegates() {
+  QFETCH(QString, change);
+
+  QByteArray list = Fixtures::deviceList(DEVICES);
+  QByteArray lists[2] = {list, refreshedList(change, list)};
+
+  Keys keys;
+  keys.storeKeys("private", "currentDevicePubkey");
+
+  DeviceModel model;
+  QVERIFY(model.fromJson(&keys, list));
+
+  DelegateCounter delegates(&model, {"name", "publicKey", "createdAt"});
+  QVERIFY(delegates.isValid());
+  int created = delegates.created();
+
+  const int refreshes = 10;
+  for (int i = 1; i <= refreshes; ++i) {
+    QVERIFY(model.fromJson(&keys, lists[i % 2]));
+    QCOMPARE(delegates.count(), model.rowCount(QModelIndex()));
+  }
+
+  QTest::setBenchmarkResult(
+      qreal(delegates.created() - created) / refreshes, QTest::Events);
+}
+
+static BenchDeviceModel s_benchDeviceModel;
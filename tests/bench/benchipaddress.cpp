@@ -0,0 +1,34 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "benchipaddress.h"
+#include "../../src/ipaddress.h"
+#include "fixtures.h"
+
+void BenchIpAddress::excludeAddresses_data() {
+  QTest::addColumn<int>("ipv4");
+  QTest::addColumn<int>("ipv6");
+
+  // A server and the local networks.
+  QTest::addRow("few") << 4 << 2;
+  // A long list of excluded addresses.
+  QTest::addRow("many") << 64 << 32;
+}
+
+void BenchIpAddress::excludeAddresses() {
+  QFETCH(int, ipv4);
+  QFETCH(int, ipv6);
+
+  // What the controller does when the VPN is activated: everything, minus the
+  // excluded addresses.
+  QList<IPAddress> allowed{IPAddress("0.0.0.0/0"), IPAddress("::/0")};
+  QList<IPAddress> excluded = Fixtures::hostAddresses(ipv4, ipv6);
+
+  QList<IPAddress> result;
+  QBENCHMARK { result = IPAddress::excludeAddresses(allowed, excluded); }
+
+  QVERIFY(!result.isEmpty());
+}
+
+static BenchIpAddress s_benchIpAddress;
@@ -0,0 +1,28 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "benchloghandler.h"
+#include "../../src/logger.h"
+
+namespace {
+Logger logger(LOG_MAIN, "BenchLogHandler");
+}
+
+void BenchLogHandler::addLog_data() {
+  QTest::addColumn<int>("length");
+
+  QTest::addRow("short") << 32;
+  QTest::addRow("long") << 1024;
+}
+
+void BenchLogHandler::addLog() {
+  QFETCH(int, length);
+
+  QString message(length, 'x');
+
+  // LogHandler::addLog is private. Every logger message goes through it.
+  QBENCHMARK { logger.debug() << message << 42; }
+}
+
+static BenchLogHandler s_benchLogHandler;
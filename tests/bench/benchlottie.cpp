@@ -0,0 +1,217 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "benchlottie.h"
+#include "lottieframecache.h"
+#include "lottierenderer.h"
+#include "lottiescene.h"
+
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QList>
+#include <QPair>
+
+namespace {
+
+// The size of the animations in the main view, on a HiDPI screen.
+constexpr int FRAME_WIDTH = 360;
+constexpr int FRAME_HEIGHT = 206;
+constexpr qreal FRAME_DEVICE_PIXEL_RATIO = 2;
+
+// The size of the loader of the connection info screen.
+constexpr int LOADER_SIZE = 119;
+
+// The animation of that loader, with `cacheFrames` set.
+constexpr const char* LOADER_ANIMATION = "vpnlogo-kinetic_animation.json";
+
+QList<QPair<QString, QByteArray>> animations() {
+  QList<QPair<QString, QByteArray>> list;
+
+  QDir dir(MVPN_ANIMATIONS_DIR);
+  const QStringList files =
+      dir.entryList(QStringList{"*_animation.json"}, QDir::Files, QDir::Name);
+  for (const QString& fileName : files) {
+    QFile file(dir.filePath(fileName));
+    if (!file.open(QIODevice::ReadOnly)) {
+      continue;
+    }
+
+    QString name = fileName;
+    name.remove("_animation.json");
+    list.append(qMakePair(name, file.readAll()));
+  }
+
+  return list;
+}
+
+void addAnimations() {
+  QTest::addColumn<QByteArray>("json");
+
+  for (const QPair<QString, QByteArray>& animation : animations()) {
+    QTest::addRow("%s", qPrintable(animation.first)) << animation.second;
+  }
+}
+
+}  // namespace
+
+void BenchLottie::parse_data() { addAnimations(); }
+
+void BenchLottie::parse() {
+  QFETCH(QByteArray, json);
+
+  QString errorString;
+  QSharedPointer<const LottieScene> scene;
+  QBENCHMARK { scene = LottieScene::fromJson(json, &errorString); }
+
+  QVERIFY2(scene, qPrintable(errorString));
+}
+
+void BenchLottie::renderFrame_data() { addAnimations(); }
+
+// One iteration renders one frame. The frames of the animation are rendered
+// in order, as during the playback.
+void BenchLottie::renderFrame() {
+  QFETCH(QByteArray, json);
+
+  QString errorString;
+  QSharedPointer<const LottieScene> scene =
+      LottieScene::fromJson(json, &errorString);
+  QVERIFY2(scene, qPrintable(errorString));
+  QVERIFY2(scene->isSupported(), qPrintable(scene->unsupportedFeature()));
+
+  int frame = 0;
+  QImage image;
+  QBENCHMARK {
+    image = LottieRenderer::render(*scene, frame,
+                                   QSize(FRAME_WIDTH, FRAME_HEIGHT),
+                                   FRAME_DEVICE_PIXEL_RATIO,
+                                   LottieRenderer::PreserveAspectFit);
+    frame = (frame + 1) % scene->totalFrames();
+  }
+
+  QVERIFY(!image.isNull());
+}
+
+void BenchLottie::cachedLoop_data() {
+  QTest::addColumn<QByteArray>("json");
+  QTest::addColumn<bool>("cached");
+
+  for (const QPair<QString, QByteArray>& animation : animations()) {
+    QTest::addRow("%s:rendered", qPrintable(animation.first))
+        << animation.second << false;
+    QTest::addRow("%s:cached", qPrintable(animation.first))
+        << animation.second << true;
+  }
+}
+
+// One iteration plays one frame of the loader, with and without the frame
+// cache. The first loop fills the cache and is not measured: this is the cost
+// of the following loops.
+void BenchLottie::cachedLoop() {
+  QFETCH(QByteArray, json);
+  QFETCH(bool, cached);
+
+  QString errorString;
+  QSharedPointer<const LottieScene> scene =
+      LottieScene::fromJson(json, &errorString);
+  QVERIFY2(scene, qPrintable(errorString));
+
+  const QSize size(LOADER_SIZE, LOADER_SIZE);
+  const QString source = QTest::currentDataTag();
+
+  LottieFrameCache* cache = LottieFrameCache::instance();
+  cache->clear();
+
+  const QString key =
+      LottieFrameCache::animationKey(source, size, FRAME_DEVICE_PIXEL_RATIO,
+                                     LottieRenderer::PreserveAspectFit);
+
+  auto playFrame = [&](int frame) {
+    QImage image = cached ? cache->find(key, frame) : QImage();
+    if (image.isNull()) {
+      image = LottieRenderer::render(*scene, frame, size,
+                                     FRAME_DEVICE_PIXEL_RATIO,
+                                     LottieRenderer::PreserveAspectFit);
+      if (cached) {
+        cache->insert(key, frame, image);
+      }
+    }
+    return image;
+  };
+
+  for (int frame = 0; frame < scene->totalFrames(); ++frame) {
+    playFrame(frame);
+  }
+
+  int frame = 0;
+  QImage image;
+  QBENCHMARK {
+    image = playFrame(frame);
+    frame = (frame + 1) % scene->totalFrames();
+  }
+
+  QVERIFY(!image.isNull());
+  if (cached) {
+    QCOMPARE(cache->count(), scene->totalFrames());
+    qDebug() << "Cache:" << cache->count() << "frames," << cache->bytes()
+             << "bytes";
+  }
+
+  cache->clear();
+}
+
+void BenchLottie::logoFootprint_data() {
+  QTest::addColumn<qreal>("devicePixelRatio");
+
+  QTest::addRow("1x") << 1.0;
+  QTest::addRow("2x") << 2.0;
+}
+
+// The first loop of the loader, as the render worker plays it with the frame
+// cache: each frame is rendered and compressed. Then the whole loop must fit
+// in the default budget of the cache, or the loader is never cached.
+void BenchLottie::logoFootprint() {
+  QFETCH(qreal, devicePixelRatio);
+
+  QFile file(QDir(MVPN_ANIMATIONS_DIR).filePath(LOADER_ANIMATION));
+  QVERIFY(file.open(QIODevice::ReadOnly));
+
+  QString errorString;
+  QSharedPointer<const LottieScene> scene =
+      LottieScene::fromJson(file.readAll(), &errorString);
+  QVERIFY2(scene, qPrintable(errorString));
+  QVERIFY2(scene->isSupported(), qPrintable(scene->unsupportedFeature()));
+
+  const QSize size(LOADER_SIZE, LOADER_SIZE);
+
+  LottieFrameCache* cache = LottieFrameCache::instance();
+  cache->clear();
+
+  const QString key = LottieFrameCache::animationKey(
+      LOADER_ANIMATION, size, devicePixelRatio,
+      LottieRenderer::PreserveAspectFit);
+
+  qint64 rawBytes = 0;
+  QBENCHMARK_ONCE {
+    for (int frame = 0; frame < scene->totalFrames(); ++frame) {
+      QImage image = LottieRenderer::render(*scene, frame, size,
+                                            devicePixelRatio,
+                                            LottieRenderer::PreserveAspectFit);
+      rawBytes += image.sizeInBytes();
+      cache->insert(key, frame, image);
+    }
+  }
+
+  qDebug() << "Loader:" << cache->count() << "frames," << rawBytes
+           << "bytes raw," << cache->bytes() << "bytes compressed, budget"
+           << cache->maxBytes() << "bytes";
+
+  QVERIFY(cache->accepts(key, scene->totalFrames()));
+  QCOMPARE(cache->count(), scene->totalFrames());
+
+  cache->clear();
+}
+
+static BenchLottie s_benchLottie;
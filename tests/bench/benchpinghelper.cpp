@@ -0,0 +1,45 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "benchpinghelper.h"
+#include "../../src/pinghelper.h"
+
+#include <QDateTime>
+#include <QRandomGenerator>
+
+void BenchPingHelper::stats_data() {
+  QTest::addColumn<int>("lossPercent");
+
+  QTest::addRow("no-loss") << 0;
+  QTest::addRow("lossy") << 30;
+}
+
+// ConnectionHealth reads the statistics at each ping received.
+void BenchPingHelper::stats() {
+  QFETCH(int, lossPercent);
+
+  PingHelper pingHelper;
+  QRandomGenerator rng(1);
+
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+  for (int i = 0; i < pingHelper.m_pingData.count(); ++i) {
+    PingHelper::PingSendData& data = pingHelper.m_pingData[i];
+    data.sequence = i;
+    data.timestamp = now - (pingHelper.m_pingData.count() - i) * 1000 - 10000;
+    data.latency =
+        int(rng.bounded(100)) < lossPercent ? -1 : rng.bounded(20, 200);
+  }
+
+  uint result = 0;
+  QBENCHMARK {
+    result += pingHelper.latency();
+    result += pingHelper.stddev();
+    result += pingHelper.maximum();
+    result += static_cast<uint>(pingHelper.loss() * 100);
+  }
+
+  QVERIFY(result > 0);
+}
+
+static BenchPingHelper s_benchPingHelper;
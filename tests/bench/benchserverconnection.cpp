@@ -0,0 +1,130 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "benchserverconnection.h"
+#include "../../src/models/servercountrymodel.h"
+#include "../../src/server/serverconnection.h"
+#include "../../src/settingsholder.h"
+#include "fixtures.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+namespace {
+
+// Sends a request with the framing of the extension bridge and waits for the
+// response.
+QByteArray roundTrip(QTcpSocket* socket, const QJsonObject& request) {
+  QByteArray body = QJsonDocument(request).toJson(QJsonDocument::Compact);
+  uint32_t length = (uint32_t)body.length();
+  socket->write(reinterpret_cast<const char*>(&length), sizeof(uint32_t));
+  socket->write(body);
+
+  QByteArray buffer;
+  QElapsedTimer timer;
+  timer.start();
+  while (timer.elapsed() < 5000) {
+    buffer.append(socket->readAll());
+
+    if (buffer.length() >= (int)sizeof(uint32_t)) {
+      length = *reinterpret_cast<const uint32_t*>(buffer.constData());
+      if (buffer.length() >= (int)(sizeof(uint32_t) + length)) {
+        return buffer.mid(sizeof(uint32_t), length);
+      }
+    }
+
+    QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+  }
+
+  return QByteArray();
+}
+
+// The same list, with another weight for a server of the first country.
+QByteArray changeOneCountry(const QByteArray& list) {
+  QJsonObject obj = QJsonDocument::fromJson(list).object();
+  QJsonArray countries = obj["countries"].toArray();
+  QJsonObject country = countries[0].toObject();
+  QJsonArray cities = country["cities"].toArray();
+  QJsonObject city = cities[0].toObject();
+  QJsonArray servers = city["servers"].toArray();
+  QJsonObject server = servers[0].toObject();
+
+  server["weight"] = server["weight"].toInt() + 1;
+  servers[0] = server;
+  city["servers"] = servers;
+  cities[0] = city;
+  country["cities"] = cities;
+  countries[0] = country;
+  obj["countries"] = countries;
+
+  return QJsonDocument(obj).toJson(QJsonDocument::Compact);
+}
+
+}  // namespace
+
+void BenchServerConnection::servers_data() {
+  QTest::addColumn<QString>("response");
+
+  // A client without a generation, or with a too old one.
+  QTest::addRow("full") << "servers";
+  // The polling of a client which is up to date.
+  QTest::addRow("unchanged") << "unchanged";
+  // A client one update behind. One country changed.
+  QTest::addRow("delta") << "delta";
+}
+
+void BenchServerConnection::servers() {
+  QFETCH(QString, response);
+
+  SettingsHolder settingsHolder;
+
+  QByteArray list = Fixtures::serverList(40, 3, 7);
+
+  ServerCountryModel model;
+  QVERIFY(model.fromJson(list));
+  quint64 previousGeneration = model.generation();
+
+  QVERIFY(model.fromJson(changeOneCountry(list)));
+
+  QTcpServer server;
+  QVERIFY(server.listen(QHostAddress::LocalHost));
+
+  QTcpSocket client;
+  client.connectToHost(QHostAddress::LocalHost, server.serverPort());
+  QVERIFY(client.waitForConnected(5000));
+  QVERIFY(server.waitForNewConnection(5000));
+
+  QTcpSocket* socket = server.nextPendingConnection();
+  QVERIFY(socket);
+  ServerConnection connection(nullptr, socket, &model);
+
+  QJsonObject request;
+  request["t"] = "servers";
+  if (response == "unchanged") {
+    request["generation"] = (qint64)model.generation();
+  } else if (response == "delta") {
+    request["generation"] = (qint64)previousGeneration;
+  }
+
+  // The first response is serialized, the next ones come from the cache.
+  QByteArray first = roundTrip(&client, request);
+  QJsonObject obj = QJsonDocument::fromJson(first).object();
+  QVERIFY(obj.contains(response));
+  QCOMPARE((quint64)obj["generation"].toDouble(), model.generation());
+
+  if (response == "delta") {
+    QCOMPARE(obj["delta"].toObject()["countries"].toArray().count(), 1);
+  }
+
+  QBENCHMARK {
+    QCOMPARE(roundTrip(&client, request).length(), first.length());
+  }
+}
+
+static BenchServerConnection s_benchServerConnection;
@@ -0,0 +1,249 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "benchservercountrymodel.h"
+#include "../../src/models/servercitymodel.h"
+#include "../../src/models/servercountrymodel.h"
+#include "../../src/settingsholder.h"
+#include "delegatecounter.h"
+#include "fixtures.h"
+
+#ifdef Q_OS_LINUX
+#  include <unistd.h>
+#endif
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+
+// The same list, with another weight for a server of the first country.
+QByteArray changeWeight(const QByteArray& list) {
+  QJsonObject obj = QJsonDocument::fromJson(list).object();
+  QJsonArray countries = obj["countries"].toArray();
+  QJsonObject country = countries[0].toObject();
+  QJsonArray cities = country["cities"].toArray();
+  QJsonObject city = cities[0].toObject();
+  QJsonArray servers = city["servers"].toArray();
+  QJsonObject server = servers[0].toObject();
+
+  server["weight"] = server["weight"].toInt() + 1;
+  servers[0] = server;
+  city["servers"] = servers;
+  cities[0] = city;
+  country["cities"] = cities;
+  countries[0] = country;
+  obj["countries"] = countries;
+
+  return QJsonDocument(obj).toJson(QJsonDocument::Compact);
+}
+
+// The same list, with a new city in the first country.
+QByteArray addCity(const QByteArray& list) {
+  QJsonObject obj = QJsonDocument::fromJson(list).object();
+  QJsonArray countries = obj["countries"].toArray();
+  QJsonObject country = countries[0].toObject();
+  QJsonArray cities = country["cities"].toArray();
+  QJsonObject city = cities[0].toObject();
+
+  city["name"] = "New city";
+  city["code"] = "new";
+  cities.append(city);
+  country["cities"] = cities;
+  countries[0] = country;
+  obj["countries"] = countries;
+
+  return QJsonDocument(obj).toJson(QJsonDocument::Compact);
+}
+
+// The same list, without the first country.
+QByteArray removeCountry(const QByteArray& list) {
+  QJsonObject obj = QJsonDocument::fromJson(list).object();
+  QJsonArray countries = obj["countries"].toArray();
+  countries.removeFirst();
+  obj["countries"] = countries;
+
+  return QJsonDocument(obj).toJson(QJsonDocument::Compact);
+}
+
+// The resident set size of the process, in bytes, or -1 if unknown.
+qint64 residentMemory() {
+#ifdef Q_OS_LINUX
+  QFile file("/proc/self/statm");
+  if (!file.open(QIODevice::ReadOnly)) {
+    return -1;
+  }
+
+  // The second field is the number of resident pages.
+  QList<QByteArray> fields = file.readAll().split(' ');
+  if (fields.length() < 2) {
+    return -1;
+  }
+
+  return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+#else
+  return -1;
+#endif
+}
+
+// The list alternated with the production one by the refresh benchmarks.
+QByteArray refreshedList(const QString& change, const QByteArray& list) {
+  if (change == "weight") return changeWeight(list);
+  if (change == "city") return addCity(list);
+  if (change == "country") return removeCountry(list);
+
+  // Same content, different bytes: the model parses it again.
+  return QJsonDocument::fromJson(list).toJson(QJsonDocument::Indented);
+}
+
+}  // namespace
+
+void BenchServerCountryModel::fromJson_data() {
+  QTest::addColumn<int>("countries");
+  QTest::addColumn<int>("cities");
+  QTest::addColumn<int>("servers");
+
+  QTest::addRow("small") << 5 << 2 << 2;
+  // Close to the size of the real server list.
+  QTest::addRow("production") << 40 << 3 << 7;
+  QTest::addRow("large") << 100 << 5 << 10;
+}
+
+void BenchServerCountryModel::fromJson() {
+  QFETCH(int, countries);
+  QFETCH(int, cities);
+  QFETCH(int, servers);
+
+  SettingsHolder settingsHolder;
+
+  // The model ignores a list identical to the current one. Let's alternate
+  // two lists of the same size.
+  QByteArray lists[2] = {Fixtures::serverList(countries, cities, servers, 1),
+                         Fixtures::serverList(countries, cities, servers, 2)};
+
+  ServerCountryModel model;
+  int i = 0;
+  QBENCHMARK {
+    QVERIFY(model.fromJson(lists[i++ % 2]));
+  }
+
+  QCOMPARE(model.rowCount(QModelIndex()), countries);
+}
+
+void BenchServerCountryModel::refresh_data() {
+  QTest::addColumn<QString>("change");
+
+  // The periodic fetch of a list which has not changed.
+  QTest::addRow("unchanged") << "unchanged";
+  // Only the weight of a server changed: no row changes.
+  QTest::addRow("weight") << "weight";
+  // One country changed.
+  QTest::addRow("city") << "city";
+  // One country was removed, and is added back by the next refresh.
+  QTest::addRow("country") << "country";
+}
+
+// Refreshes the production-sized list while a view shows it.
+void BenchServerCountryModel::refresh() {
+  QFETCH(QString, change);
+
+  SettingsHolder settingsHolder;
+
+  QByteArray list = Fixtures::serverList(40, 3, 7);
+  QByteArray lists[2] = {list, refreshedList(change, list)};
+
+  ServerCountryModel model;
+  QVERIFY(model.fromJson(list));
+
+  DelegateCounter delegates(&model, {"name", "code", "cities"});
+  QVERIFY(delegates.isValid());
+
+  int i = 1;
+  QBENCHMARK {
+    QVERIFY(model.fromJson(lists[i++ % 2]));
+  }
+}
+
+// The number of QML delegates created by a refresh of the production-sized
+// list.
+void BenchServerCountryModel::refreshDelegates() {
+  QFETCH(QString, change);
+
+  SettingsHolder settingsHolder;
+
+  QByteArray list = Fixtures::serverList(40, 3, 7);
+  QByteArray lists[2] = {list, refreshedList(change, list)};
+
+  ServerCountryModel model;
+  QVERIFY(model.fromJson(list));
+
+  DelegateCounter delegates(&model, {"name", "code", "cities"});
+  QVERIFY(delegates.isValid());
+  int created = delegates.created();
+
+  const int refreshes = 10;
+  for (int i = 1; i <= refreshes; ++i) {
+    QVERIFY(model.fromJson(lists[i % 2]));
+    QCOMPARE(delegates.count(), model.rowCount(QModelIndex()));
+  }
+
+  QTest::setBenchmarkResult(
+      qreal(delegates.created() - created) / refreshes, QTest::Events);
+}
+
+// The roles read by the delegates of the server list, for every country and
+// city, as when scrolling through the whole list.
+void BenchServerCountryModel::bindAll() {
+  SettingsHolder settingsHolder;
+
+  ServerCountryModel model;
+  QVERIFY(model.fromJson(Fixtures::serverList(40, 3, 7)));
+
+  int cities = 0;
+  QBENCHMARK {
+    cities = 0;
+    for (int i = 0; i < model.rowCount(QModelIndex()); ++i) {
+      QModelIndex index = model.index(i, 0);
+      index.data(ServerCountryModel::LocalizedNameRole);
+      index.data(ServerCountryModel::CodeRole);
+
+      ServerCityModel* cityModel = index.data(ServerCountryModel::CitiesRole)
+                                       .value<ServerCityModel*>();
+      QVERIFY(cityModel);
+      for (int j = 0; j < cityModel->rowCount(QModelIndex()); ++j) {
+        QModelIndex cityIndex = cityModel->index(j, 0);
+        cityIndex.data(ServerCityModel::NameRole);
+        cityIndex.data(ServerCityModel::LocalizedNameRole);
+        cityIndex.data(ServerCityModel::CodeRole);
+        ++cities;
+      }
+    }
+  }
+
+  QCOMPARE(cities, 40 * 3);
+}
+
+// The memory taken by a list of 10000 servers, once loaded.
+void BenchServerCountryModel::residentMemory() {
+  SettingsHolder settingsHolder;
+
+  QByteArray list = Fixtures::serverList(100, 10, 10);
+  QJsonDocument json = QJsonDocument::fromJson(list);
+
+  qint64 before = ::residentMemory();
+  if (before < 0) {
+    QSKIP("The resident memory is not available on this platform");
+  }
+
+  ServerCountryModel model;
+  QVERIFY(model.fromJson(list, json));
+  QCOMPARE(model.servers().length(), 10000);
+
+  QTest::setBenchmarkResult(::residentMemory() - before,
+                            QTest::BytesAllocated);
+}
+
+static BenchServerCountryModel s_benchServerCountryModel;
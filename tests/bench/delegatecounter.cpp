@@ -0,0 +1,53 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "delegatecounter.h"
+
+#include <QAbstractItemModel>
+#include <QQmlComponent>
+
+DelegateCounter::DelegateCounter(QAbstractItemModel* model,
+                                 const QStringList& roles) {
+  QString properties;
+  for (const QString& role : roles) {
+    properties.append(
+        QString("    readonly property var %1: model.%1\n").arg(role));
+  }
+
+  QByteArray qml = QString(
+                       "import QtQml\n"
+                       "import QtQml.Models\n"
+                       "Instantiator {\n"
+                       "  id: root\n"
+                       "  property int created: 0\n"
+                       "  delegate: QtObject {\n"
+                       "%1"
+                       "    Component.onCompleted: root.created++\n"
+                       "  }\n"
+                       "}\n")
+                       .arg(properties)
+                       .toUtf8();
+
+  QQmlComponent component(&m_engine);
+  component.setData(qml, QUrl());
+
+  m_instantiator = component.create();
+  if (!m_instantiator) {
+    qWarning() << "Unable to create the instantiator:"
+               << component.errorString();
+    return;
+  }
+
+  m_instantiator->setProperty("model", QVariant::fromValue<QObject*>(model));
+}
+
+DelegateCounter::~DelegateCounter() { delete m_instantiator; }
+
+int DelegateCounter::created() const {
+  return m_instantiator ? m_instantiator->property("created").toInt() : 0;
+}
+
+int DelegateCounter::count() const {
+  return m_instantiator ? m_instantiator->property("count").toInt() : 0;
+}
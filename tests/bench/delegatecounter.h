@@ -0,0 +1,34 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef DELEGATECOUNTER_H
+#define DELEGATECOUNTER_H
+
+#include <QQmlEngine>
+#include <QStringList>
+
+class QAbstractItemModel;
+
+// Instantiates a QML delegate for each row of a model, reading the given
+// roles as the views do, and counts the delegates created. A model reset
+// recreates all of them.
+class DelegateCounter final {
+ public:
+  DelegateCounter(QAbstractItemModel* model, const QStringList& roles);
+  ~DelegateCounter();
+
+  bool isValid() const { return m_instantiator != nullptr; }
+
+  // The number of delegates created so far.
+  int created() const;
+
+  // The number of delegates alive.
+  int count() const;
+
+ private:
+  QQmlEngine m_engine;
+  QObject* m_instantiator = nullptr;
+};
+
+#endif  // DELEGATECOUNTER_H
@@ -0,0 +1,229 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "fixtures.h"
+
+#include <QDateTime>
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+
+namespace {
+
+QString randomString(QRandomGenerator& rng, int length) {
+  static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+  QString str;
+  str.reserve(length);
+  for (int i = 0; i < length; ++i) {
+    int index = rng.bounded(int(sizeof(alphabet) - 1));
+    str.append(QLatin1Char(alphabet[index]));
+  }
+  return str;
+}
+
+QString randomKey(QRandomGenerator& rng) {
+  QByteArray key(32, 0);
+  for (int i = 0; i < key.length(); ++i) {
+    key[i] = static_cast<char>(rng.bounded(256));
+  }
+  return QString(key.toBase64());
+}
+
+QString randomIpv4(QRandomGenerator& rng) {
+  return QHostAddress(rng.generate()).toString();
+}
+
+QString randomIpv6(QRandomGenerator& rng) {
+  Q_IPV6ADDR addr;
+  for (int i = 0; i < 16; ++i) {
+    addr[i] = static_cast<quint8>(rng.bounded(256));
+  }
+  return QHostAddress(addr).toString();
+}
+
+}  // namespace
+
+namespace Fixtures {
+
+QByteArray serverList(int countries, int citiesPerCountry, int serversPerCity,
+                      quint32 seed) {
+  QRandomGenerator rng(seed);
+
+  QJsonArray countryArray;
+  for (int c = 0; c < countries; ++c) {
+    QJsonArray cityArray;
+    for (int i = 0; i < citiesPerCountry; ++i) {
+      QJsonArray serverArray;
+      for (int s = 0; s < serversPerCity; ++s) {
+        QJsonObject server;
+        server["hostname"] =
+            QString("%1-wg-%2").arg(randomString(rng, 6)).arg(s);
+        server["ipv4_addr_in"] = randomIpv4(rng);
+        server["ipv4_gateway"] = randomIpv4(rng);
+        server["ipv6_addr_in"] = randomIpv6(rng);
+        server["ipv6_gateway"] = randomIpv6(rng);
+        server["public_key"] = randomKey(rng);
+        server["weight"] = rng.bounded(1, 200);
+        server["port_ranges"] =
+            QJsonArray{QJsonArray{53, 53}, QJsonArray{4000, 33433},
+                       QJsonArray{33565, 51820}, QJsonArray{52000, 60000}};
+        server["multihop_port"] = rng.bounded(3000, 4000);
+        server["socks5_name"] =
+            QString("%1.relays.mullvad.net").arg(randomString(rng, 10));
+        serverArray.append(server);
+      }
+
+      QJsonObject city;
+      city["name"] = randomString(rng, 10);
+      city["code"] = randomString(rng, 3);
+      city["latitude"] = rng.bounded(180.0) - 90;
+      city["longitude"] = rng.bounded(360.0) - 180;
+      city["servers"] = serverArray;
+      cityArray.append(city);
+    }
+
+    QJsonObject country;
+    country["name"] = randomString(rng, 12);
+    country["code"] = randomString(rng, 2);
+    country["cities"] = cityArray;
+    countryArray.append(country);
+  }
+
+  QJsonObject obj;
+  obj["countries"] = countryArray;
+  return QJsonDocument(obj).toJson(QJsonDocument::Compact);
+}
+
+QByteArray deviceList(int devices, quint32 seed) {
+  QRandomGenerator rng(seed);
+
+  QJsonArray deviceArray;
+  for (int i = 0; i < devices; ++i) {
+    QJsonObject device;
+    device["name"] = randomString(rng, 16);
+    device["unique_id"] = randomString(rng, 32);
+    device["pubkey"] = randomKey(rng);
+    device["created_at"] =
+        QDateTime::fromSecsSinceEpoch(1500000000 + rng.bounded(100000000),
+                                      Qt::UTC)
+            .toString(Qt::ISODate);
+    device["ipv4_address"] = QString("%1/32").arg(randomIpv4(rng));
+    device["ipv6_address"] = QString("%1/128").arg(randomIpv6(rng));
+    deviceArray.append(device);
+  }
+
+  QJsonObject obj;
+  obj["devices"] = deviceArray;
+  return QJsonDocument(obj).toJson(QJsonDocument::Compact);
+}
+
+QList<IPAddress> hostAddresses(int ipv4Count, int ipv6Count, quint32 seed) {
+  QRandomGenerator rng(seed);
+
+  QList<IPAddress> list;
+  for (int i = 0; i < ipv4Count; ++i) {
+    list.append(IPAddress(QHostAddress(randomIpv4(rng)), 32));
+  }
+  for (int i = 0; i < ipv6Count; ++i) {
+    list.append(IPAddress(QHostAddress(randomIpv6(rng)), 128));
+  }
+  return list;
+}
+
+QSettings::SettingsMap settingsMap(int entries, quint32 seed) {
+  QRandomGenerator rng(seed);
+
+  QSettings::SettingsMap map;
+  for (int i = 0; i < entries; ++i) {
+    QString key =
+        QString("%1/%2").arg(randomString(rng, 8), randomString(rng, 12));
+    switch (i % 4) {
+      case 0:
+        map.insert(key, rng.bounded(2) == 1);
+        break;
+      case 1:
+        map.insert(key, rng.generate());
+        break;
+      case 2:
+        map.insert(key, randomString(rng, 64));
+        break;
+      default:
+        map.insert(key, QStringList{randomString(rng, 16),
+                                    randomString(rng, 16)});
+        break;
+    }
+  }
+
+  // The server list is the largest entry of the real settings.
+  map.insert("servers", QString(serverList(8, 2, 2, seed)));
+  return map;
+}
+
+QByteArray messageAddon(const QString& id, int blocks) {
+  QJsonArray blockArray;
+  for (int i = 0; i < blocks; ++i) {
+    QJsonObject block;
+    block["id"] = QString("b_%1").arg(i);
+    block["type"] = i % 4 ? "text" : "title";
+    block["content"] = QString("Block %1 of the message %2").arg(i).arg(id);
+    blockArray.append(block);
+  }
+
+  QJsonObject message;
+  message["id"] = id;
+  message["title"] = QString("%1 - Title").arg(id);
+  message["subtitle"] = QString("%1 - Subtitle").arg(id);
+  message["date"] = 1641406997;
+  message["blocks"] = blockArray;
+
+  QJsonObject obj;
+  obj["api_version"] = "0.1";
+  obj["id"] = id;
+  obj["name"] = id;
+  obj["translatable"] = false;
+  obj["type"] = "message";
+  obj["conditions"] = QJsonObject();
+  obj["message"] = message;
+  return QJsonDocument(obj).toJson();
+}
+
+QJsonObject daemonActivateCommand(int allowedRanges, int excludedAddresses,
+                                  quint32 seed) {
+  QRandomGenerator rng(seed);
+
+  QJsonArray allowedIPAddressRanges;
+  for (int i = 0; i < allowedRanges; ++i) {
+    bool isIpv6 = i % 2;
+    QJsonObject range;
+    range["address"] = isIpv6 ? randomIpv6(rng) : randomIpv4(rng);
+    range["range"] = isIpv6 ? rng.bounded(16, 129) : rng.bounded(8, 33);
+    range["isIpv6"] = isIpv6;
+    allowedIPAddressRanges.append(range);
+  }
+
+  QJsonArray excludedAddressesArray;
+  for (int i = 0; i < excludedAddresses; ++i) {
+    excludedAddressesArray.append(randomIpv4(rng));
+  }
+
+  QJsonObject obj;
+  obj["type"] = "activate";
+  obj["privateKey"] = randomKey(rng);
+  obj["deviceIpv4Address"] = randomIpv4(rng) + "/32";
+  obj["deviceIpv6Address"] = randomIpv6(rng) + "/128";
+  obj["serverPublicKey"] = randomKey(rng);
+  obj["serverIpv4AddrIn"] = randomIpv4(rng);
+  obj["serverIpv4Gateway"] = randomIpv4(rng);
+  obj["serverIpv6AddrIn"] = randomIpv6(rng);
+  obj["serverIpv6Gateway"] = randomIpv6(rng);
+  obj["serverPort"] = rng.bounded(1024, 65536);
+  obj["hopindex"] = 0;
+  obj["allowedIPAddressRanges"] = allowedIPAddressRanges;
+  obj["excludedAddresses"] = excludedAddressesArray;
+  obj["vpnDisabledApps"] = QJsonArray();
+  return obj;
+}
+
+}  // namespace Fixtures
@@ -0,0 +1,42 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef FIXTURES_H
+#define FIXTURES_H
+
+#include "../../src/ipaddress.h"
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QList>
+#include <QSettings>
+
+// Synthetic inputs for the benchmarks. They are generated with a fixed seed,
+// so every run measures the same data without storing large blobs in the
+// repository.
+namespace Fixtures {
+
+// A server list in the format of the `servers` API response.
+QByteArray serverList(int countries, int citiesPerCountry, int serversPerCity,
+                      quint32 seed = 1);
+
+// A device list in the format of the `account` API response.
+QByteArray deviceList(int devices, quint32 seed = 1);
+
+// Random IPv4 and IPv6 host addresses.
+QList<IPAddress> hostAddresses(int ipv4Count, int ipv6Count, quint32 seed = 1);
+
+// A settings map similar to the one of a long-running client.
+QSettings::SettingsMap settingsMap(int entries, quint32 seed = 1);
+
+// The manifest of a message add-on with `blocks` text blocks.
+QByteArray messageAddon(const QString& id, int blocks);
+
+// A daemon `activate` command.
+QJsonObject daemonActivateCommand(int allowedRanges, int excludedAddresses,
+                                  quint32 seed = 1);
+
+}  // namespace Fixtures
+
+#endif  // FIXTURES_H
@@ -0,0 +1,288 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "../../src/leakdetector.h"
+#include "helper.h"
+#include "l18nstrings.h"
+
+#include <QCommandLineParser>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QXmlStreamReader>
+
+QVector<TestHelper::NetworkConfig> TestHelper::networkConfig;
+MozillaVPN::State TestHelper::vpnState = MozillaVPN::StateInitialize;
+Controller::State TestHelper::controllerState = Controller::StateInitializing;
+MozillaVPN::UserState TestHelper::userState = MozillaVPN::UserNotAuthenticated;
+QVector<QObject*> TestHelper::testList;
+TestHelper::SystemNotification TestHelper::lastSystemNotification;
+
+QObject* TestHelper::findTest(const QString& name) {
+  for (QObject* obj : TestHelper::testList) {
+    const QMetaObject* meta = obj->metaObject();
+    if (meta->className() == name) {
+      return obj;
+    }
+  }
+
+  return nullptr;
+}
+
+TestHelper::TestHelper() { testList.append(this); }
+
+namespace {
+
+// Reads the benchmark results out of a QTest XML report. Keys are
+// "Class::function" or "Class::function:tag" when the benchmark is data
+// driven. Values are the cost of one iteration, in the unit of the metric
+// (msecs for the walltime metric).
+bool parseReport(const QString& className, const QString& fileName,
+                 QJsonObject& results) {
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly)) {
+    qWarning() << "Unable to open the report" << fileName;
+    return false;
+  }
+
+  QXmlStreamReader xml(&file);
+  QString function;
+  while (!xml.atEnd()) {
+    xml.readNext();
+    if (!xml.isStartElement()) {
+      continue;
+    }
+
+    if (xml.name() == QLatin1String("TestFunction")) {
+      function = xml.attributes().value("name").toString();
+      continue;
+    }
+
+    if (xml.name() != QLatin1String("BenchmarkResult")) {
+      continue;
+    }
+
+    QXmlStreamAttributes attributes = xml.attributes();
+    double value = attributes.value("value").toDouble();
+    int iterations = attributes.value("iterations").toInt();
+    if (iterations > 0) {
+      value /= iterations;
+    }
+
+    QString key = QString("%1::%2").arg(className, function);
+    QString tag = attributes.value("tag").toString();
+    if (!tag.isEmpty()) {
+      key.append(":").append(tag);
+    }
+
+    QJsonObject result;
+    result["metric"] = attributes.value("metric").toString();
+    result["value"] = value;
+    results[key] = result;
+  }
+
+  if (xml.hasError()) {
+    qWarning() << "Unable to parse the report" << fileName << xml.errorString();
+    return false;
+  }
+
+  return true;
+}
+
+bool writeJson(const QString& fileName, const QJsonObject& obj) {
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qWarning() << "Unable to write" << fileName;
+    return false;
+  }
+
+  file.write(QJsonDocument(obj).toJson());
+  return true;
+}
+
+bool readJson(const QString& fileName, QJsonObject& obj) {
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly)) {
+    qWarning() << "Unable to read" << fileName;
+    return false;
+  }
+
+  obj = QJsonDocument::fromJson(file.readAll()).object();
+  return true;
+}
+
+// The results replace the entries of the benchmarks which have run, and keep
+// the others.
+bool updateBaseline(const QJsonObject& results, const QString& fileName) {
+  QJsonObject baseline;
+  if (QFile::exists(fileName) && !readJson(fileName, baseline)) {
+    return false;
+  }
+
+  for (QJsonObject::const_iterator i = results.constBegin();
+       i != results.constEnd(); ++i) {
+    baseline[i.key()] = i.value();
+  }
+
+  return writeJson(fileName, baseline);
+}
+
+// Returns the number of benchmarks slower than the baseline by more than
+// `tolerance` percent, or missing from the baseline: a benchmark without a
+// baseline would never fail. Until a baseline is recorded, the missing
+// entries are only reported.
+int compareWithBaseline(const QJsonObject& results, const QString& fileName,
+                        double tolerance) {
+  QJsonObject baseline;
+  if (!readJson(fileName, baseline)) {
+    return 1;
+  }
+
+  if (baseline.isEmpty()) {
+    qWarning().noquote() << "No baseline recorded in" << fileName
+                         << "(run with -update-baseline)";
+  }
+
+  int regressions = 0;
+  for (QJsonObject::const_iterator i = results.constBegin();
+       i != results.constEnd(); ++i) {
+    QJsonObject result = i.value().toObject();
+    double value = result["value"].toDouble();
+
+    if (!baseline.contains(i.key())) {
+      if (!baseline.isEmpty()) {
+        ++regressions;
+      }
+      qWarning().noquote() << "MISSING   " << i.key() << value
+                           << "(run with -update-baseline)";
+      continue;
+    }
+
+    QJsonObject expected = baseline[i.key()].toObject();
+    if (expected["metric"] != result["metric"]) {
+      ++regressions;
+      qWarning().noquote() << "MISSING   " << i.key()
+                           << "(metric changed, run with -update-baseline)";
+      continue;
+    }
+
+    double expectedValue = expected["value"].toDouble();
+    double delta = expectedValue > 0
+                       ? (value - expectedValue) * 100 / expectedValue
+                       : 0;
+
+    if (delta > tolerance) {
+      ++regressions;
+      qWarning().noquote() << "REGRESSION" << i.key() << expectedValue << "->"
+                           << value << QString("(+%1%)").arg(delta, 0, 'f', 1);
+      continue;
+    }
+
+    qInfo().noquote() << "OK      " << i.key() << expectedValue << "->"
+                      << value << QString("(%1%)").arg(delta, 0, 'f', 1);
+  }
+
+  return regressions;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+#ifdef MVPN_DEBUG
+  LeakDetector leakDetector;
+  Q_UNUSED(leakDetector);
+#endif
+  // Unlike the unit tests, the benchmarks run in production mode: in staging,
+  // every log line is also written to stderr and that would be measured too.
+
+  QCoreApplication app(argc, argv);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Mozilla VPN benchmarks");
+  parser.setSingleDashWordOptionMode(QCommandLineParser::ParseAsLongOptions);
+  parser.addHelpOption();
+
+  QCommandLineOption jsonOption("json", "Write the results to <file>.",
+                                "file");
+  parser.addOption(jsonOption);
+
+  QCommandLineOption baselineOption(
+      "baseline", "Compare the results with the baseline <file>.", "file");
+  parser.addOption(baselineOption);
+
+  QCommandLineOption updateBaselineOption(
+      "update-baseline", "Replace the baseline file with the results.");
+  parser.addOption(updateBaselineOption);
+
+  QCommandLineOption toleranceOption(
+      "tolerance", "Allowed slowdown, in percent (default: 20).", "percent",
+      "20");
+  parser.addOption(toleranceOption);
+
+  parser.addPositionalArgument("classes", "The benchmark classes to run.",
+                               "[classes...]");
+  parser.process(app);
+
+  L18nStrings::initialize();
+
+  QVector<QObject*> benchList;
+  const QStringList classes = parser.positionalArguments();
+  if (classes.isEmpty()) {
+    benchList = TestHelper::testList;
+  } else {
+    for (const QString& x : classes) {
+      QObject* obj = TestHelper::findTest(x);
+      if (obj == nullptr) {
+        qWarning() << "No such benchmark found:" << x;
+        return 1;
+      }
+      benchList.append(obj);
+    }
+  }
+
+  QTemporaryDir tmpDir;
+  if (!tmpDir.isValid()) {
+    qWarning() << "Unable to create a temporary folder";
+    return 1;
+  }
+
+  int failures = 0;
+  QJsonObject results;
+
+  for (QObject* obj : benchList) {
+    QString className = obj->metaObject()->className();
+    QString report = tmpDir.filePath(className + ".xml");
+
+    // One report for us, one for the humans.
+    QStringList args{app.arguments().first(), "-o", report + ",xml", "-o",
+                     "-,txt"};
+    if (QTest::qExec(obj, args) != 0) {
+      ++failures;
+    }
+
+    if (!parseReport(className, report, results)) {
+      ++failures;
+    }
+  }
+
+  if (parser.isSet(jsonOption) &&
+      !writeJson(parser.value(jsonOption), results)) {
+    ++failures;
+  }
+
+  if (parser.isSet(baselineOption)) {
+    QString baseline = parser.value(baselineOption);
+    if (parser.isSet(updateBaselineOption)) {
+      if (!updateBaseline(results, baseline)) {
+        ++failures;
+      }
+    } else {
+      failures += compareWithBaseline(
+          results, baseline, parser.value(toleranceOption).toDouble());
+    }
+  }
+
+  return failures;
+}
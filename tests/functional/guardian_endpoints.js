@@ -43,6 +43,8 @@ exports.endpoints = {
   GETs: {
     '/api/v1/vpn/featurelist': {status: 200, body: {features: {}}},
     '/api/v1/vpn/versions': {status: 200, body: {}},
+    '/api/v1/vpn/ipinfo':
+        {status: 200, body: {ip: '169.254.0.1', country: 'au'}},
     '/__heartbeat__': {status: 200, body: {mullvadOK: true, dbOK: true}},
     '/api/v2/vpn/login/': {
       status: 200,
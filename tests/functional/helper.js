@@ -131,6 +131,21 @@ module.exports = {
         `Command failed: ${json.error}`);
   },
 
+  async forceCaptivePortalCheck() {
+    const json = await this._writeCommand('force_captive_portal_check');
+    assert(
+        json.type === 'force_captive_portal_check' && !('error' in json),
+        `Command failed: ${json.error}`);
+  },
+
+  async captivePortalStats() {
+    const json = await this._writeCommand('captive_portal_stats');
+    assert(
+        json.type === 'captive_portal_stats' && !('error' in json),
+        `Command failed: ${json.error}`);
+    return json.value;
+  },
+
   async quit() {
     const json = await this._writeCommand('quit');
     assert(
@@ -443,6 +458,21 @@ module.exports = {
     return json.value;
   },
 
+  async forceServersFetch(count) {
+    const json = await this._writeCommand(`force_servers_fetch ${count}`);
+    assert(
+        json.type === 'force_servers_fetch' && !('error' in json),
+        `Command failed: ${json.error}`);
+  },
+
+  async networkCoalescing() {
+    const json = await this._writeCommand('network_coalescing');
+    assert(
+        json.type === 'network_coalescing' && !('error' in json),
+        `Command failed: ${json.error}`);
+    return json.value;
+  },
+
   async guides() {
     const json = await this._writeCommand('guides');
     assert(
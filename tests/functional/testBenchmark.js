@@ -3,7 +3,27 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 const vpn = require('./helper.js');
 const assert = require('assert');
+const http = require('http');
 const { homeScreen, generalElements } = require('./elements.js');
+const { BENCHMARK_PORT } = require('./constants.js');
+
+// A connection is as fast as its slowest direction. Without the upload
+// benchmark, uploadBps stays 0 and only the download counts.
+function expectedSpeed(downloadBps, uploadBps) {
+  let speed = (downloadBps >= 25000000) ?
+      2 :
+      ((downloadBps >= 10000000) ? 1 : 0);
+  if (uploadBps > 0) {
+    speed = Math.min(
+        speed, (uploadBps >= 10000000) ? 2 : ((uploadBps >= 3000000) ? 1 : 0));
+  }
+  return ['SpeedSlow', 'SpeedMedium', 'SpeedFast'][speed];
+}
+
+async function benchmarkValue(property) {
+  return parseInt(
+      await vpn.getElementProperty(homeScreen.CONNECTION_BENCHMARK, property));
+}
 
 describe('Benchmark', function() {
   this.timeout(120000);
@@ -30,14 +50,12 @@ describe('Benchmark', function() {
     await vpn.wait(3000);
     let state = await vpn.getElementProperty(homeScreen.CONNECTION_BENCHMARK, 'state');
     let speed = await vpn.getElementProperty(homeScreen.CONNECTION_BENCHMARK, 'speed');
-    let bps = parseInt(
-        await vpn.getElementProperty(homeScreen.CONNECTION_BENCHMARK, 'downloadBps'));
     assert.strictEqual(state, 'StateReady');
 
     assert.strictEqual(
         speed,
-        (bps >= 25000000) ? 'SpeedFast' :
-                            ((bps >= 10000000) ? 'SpeedMedium' : 'SpeedSlow'));
+        expectedSpeed(
+            await benchmarkValue('downloadBps'), await benchmarkValue('uploadBps')));
 
     // Exit the benchmark
     await vpn.waitForElement(homeScreen.CONNECTION_INFO_TOGGLE);
@@ -129,12 +147,10 @@ describe('Benchmark', function() {
     // This time we expect the benchmark to succeed.
     await vpn.wait();
     let speed = await vpn.getElementProperty(homeScreen.CONNECTION_BENCHMARK, 'speed');
-    let bps = parseInt(
-        await vpn.getElementProperty(homeScreen.CONNECTION_BENCHMARK, 'downloadBps'));
     assert.strictEqual(
         speed,
-        (bps >= 25000000) ? 'SpeedFast' :
-                            ((bps >= 10000000) ? 'SpeedMedium' : 'SpeedSlow'));
+        expectedSpeed(
+            await benchmarkValue('downloadBps'), await benchmarkValue('uploadBps')));
 
     // Exit the benchmark    
     await vpn.waitForElementAndClick(homeScreen.CONNECTION_INFO_TOGGLE);
@@ -177,4 +193,162 @@ describe('Benchmark', function() {
     // Exit the benchmark    
     await vpn.waitForElementAndClick(homeScreen.CONNECTION_INFO_TOGGLE);
   });
+
+  describe('Parallel streams', function() {
+    // 64 MB per download, sent in 64 KB chunks.
+    const CHUNK = Buffer.alloc(65536);
+    const CHUNKS = 1024;
+
+    let server;
+    let downloads = 0;
+    let uploads = 0;
+
+    before(async () => {
+      server = http.createServer((req, res) => {
+        if (req.method === 'GET') {
+          ++downloads;
+          res.writeHead(200, {
+            'Content-Type': 'application/octet-stream',
+            'Content-Length': CHUNK.length * CHUNKS,
+          });
+
+          let sent = 0;
+          const write = () => {
+            while (sent < CHUNKS) {
+              ++sent;
+              if (!res.write(CHUNK)) {
+                res.once('drain', write);
+                return;
+              }
+            }
+            res.end();
+          };
+          write();
+          return;
+        }
+
+        ++uploads;
+        req.on('data', () => {});
+        req.on('end', () => {
+          res.writeHead(200, {'Content-Type': 'text/plain'});
+          res.end('OK');
+        });
+      });
+
+      await new Promise(
+          resolve => server.listen(BENCHMARK_PORT, '127.0.0.1', resolve));
+    });
+
+    after(() => {
+      server.close();
+    });
+
+    it('Runs one request per stream', async () => {
+      await vpn.waitForElement(generalElements.CONTROLLER_TITLE);
+      await vpn.activate(true);
+
+      // An IP address is used as it is, without DNS lookup.
+      const url = `http://127.0.0.1:${BENCHMARK_PORT}/`;
+      await vpn.setElementProperty(
+          homeScreen.CONNECTION_BENCHMARK, 'downloadUrl', 's', url);
+      await vpn.setElementProperty(
+          homeScreen.CONNECTION_BENCHMARK, 'uploadUrl', 's', url);
+      await vpn.setElementProperty(
+          homeScreen.CONNECTION_BENCHMARK, 'streams', 'i', 3);
+      assert.strictEqual(
+          await vpn.getElementProperty(
+              homeScreen.CONNECTION_BENCHMARK, 'streams'),
+          '3');
+
+      await vpn.waitForElementAndClick(homeScreen.CONNECTION_INFO_TOGGLE);
+      await vpn.waitForCondition(async () => {
+        let state = await vpn.getElementProperty(
+            homeScreen.CONNECTION_BENCHMARK, 'state');
+        return state == 'StateReady' || state == 'StateError';
+      });
+
+      assert.strictEqual(
+          await vpn.getElementProperty(homeScreen.CONNECTION_BENCHMARK, 'state'),
+          'StateReady');
+      assert.strictEqual(downloads, 3);
+
+      const downloadBps = await benchmarkValue('downloadBps');
+      const uploadBps = await benchmarkValue('uploadBps');
+      assert(downloadBps > 0);
+      if (uploads > 0) {
+        assert.strictEqual(uploads, 3);
+        assert(uploadBps > 0);
+      }
+
+      assert.strictEqual(
+          await vpn.getElementProperty(homeScreen.CONNECTION_BENCHMARK, 'speed'),
+          expectedSpeed(downloadBps, uploadBps));
+
+      // The dummy pings are answered right away, even under load.
+      if (!process.env.MVPN_BENCHMARK_PING_ADDRESS) {
+        assert.strictEqual(
+            await vpn.getElementProperty(
+                homeScreen.CONNECTION_BENCHMARK, 'latencyGrade'),
+            'GradeA');
+      }
+
+      // Exit the benchmark
+      await vpn.waitForElementAndClick(homeScreen.CONNECTION_INFO_TOGGLE);
+    });
+  });
+
+  // Run by scripts/tests/benchmark_netns.sh, with a stand-in server behind a
+  // shaped link.
+  describe('Latency under load', function() {
+    before(function() {
+      if (!process.env.MVPN_BENCHMARK_URL ||
+          !process.env.MVPN_BENCHMARK_PING_ADDRESS) {
+        this.skip();
+      }
+    });
+
+    it('Grades the latency inflation', async () => {
+      await vpn.waitForElement(generalElements.CONTROLLER_TITLE);
+      await vpn.activate(true);
+
+      await vpn.setElementProperty(
+          homeScreen.CONNECTION_BENCHMARK, 'downloadUrl', 's',
+          process.env.MVPN_BENCHMARK_URL);
+      await vpn.setElementProperty(
+          homeScreen.CONNECTION_BENCHMARK, 'uploadUrl', 's',
+          process.env.MVPN_BENCHMARK_URL);
+
+      await vpn.waitForElementAndClick(homeScreen.CONNECTION_INFO_TOGGLE);
+      await vpn.waitForCondition(async () => {
+        let state = await vpn.getElementProperty(
+            homeScreen.CONNECTION_BENCHMARK, 'state');
+        return state == 'StateReady' || state == 'StateError';
+      });
+
+      assert.strictEqual(
+          await vpn.getElementProperty(homeScreen.CONNECTION_BENCHMARK, 'state'),
+          'StateReady');
+
+      const loadedLatency = await benchmarkValue('loadedLatency');
+      const inflation = await benchmarkValue('latencyInflation');
+      assert(loadedLatency >= inflation);
+
+      // The queue of the shaped link fills up during the transfers.
+      assert(inflation >= 30);
+
+      const grade = (inflation < 30) ?
+          'GradeA' :
+          (inflation < 60) ?
+          'GradeB' :
+          (inflation < 200) ? 'GradeC' :
+                              (inflation < 400) ? 'GradeD' : 'GradeF';
+      assert.strictEqual(
+          await vpn.getElementProperty(
+              homeScreen.CONNECTION_BENCHMARK, 'latencyGrade'),
+          grade);
+
+      // Exit the benchmark
+      await vpn.waitForElementAndClick(homeScreen.CONNECTION_INFO_TOGGLE);
+    });
+  });
 });
@@ -2,7 +2,9 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 const assert = require('assert');
+const http = require('http');
 const { initialScreen, telemetryScreen, generalElements } = require('./elements.js');
+const { CAPTIVE_PORTAL_PORT } = require('./constants.js');
 const vpn = require('./helper.js');
 
 describe('Captive portal', function() {
@@ -200,4 +202,85 @@ describe('Captive portal', function() {
          assert(true);
        });
   });
+
+  describe('Captive portal probes', function() {
+    this.ctx.authenticationNeeded = true;
+    this.ctx.guardianOverrideEndpoints = {
+      GETs: {
+        '/api/v1/vpn/dns/detectportal': {
+          status: 200,
+          body: [{address: '127.0.0.1', family: 4}, {address: '::1', family: 6}]
+        },
+      },
+    };
+
+    // Local stand-in for the captive portal endpoints. The IPv4 and the IPv6
+    // probes can be delayed and answered independently.
+    const probes = {
+      ipv4: {delay: 0, body: 'success'},
+      ipv6: {delay: 0, body: 'success'},
+    };
+    let server = null;
+
+    before(async () => {
+      process.env['MVPN_CAPTIVE_PORTAL_PORT'] = CAPTIVE_PORTAL_PORT;
+
+      server = http.createServer((req, res) => {
+        const probe =
+            req.socket.remoteAddress === '::1' ? probes.ipv6 : probes.ipv4;
+        setTimeout(() => {
+          res.writeHead(200, {'Content-Type': 'text/plain'});
+          res.end(probe.body);
+        }, probe.delay);
+      });
+
+      await new Promise(
+          resolve => server.listen(CAPTIVE_PORTAL_PORT, '::', resolve));
+    });
+
+    after(() => {
+      delete process.env['MVPN_CAPTIVE_PORTAL_PORT'];
+      server.close();
+    });
+
+    async function activateAndDetect() {
+      await vpn.activate();
+      await vpn.waitForCondition(async () => {
+        return await vpn.getElementProperty(
+                   generalElements.CONTROLLER_TITLE, 'text') === 'VPN is on';
+      });
+
+      // The activation runs a detection too. Let's wait for it.
+      await vpn.waitForCondition(async () => {
+        return (await vpn.captivePortalStats()).count > 0;
+      });
+      await vpn.wait();
+
+      const stats = await vpn.captivePortalStats();
+      await vpn.forceCaptivePortalCheck();
+      await vpn.waitForCondition(async () => {
+        return (await vpn.captivePortalStats()).count > stats.count;
+      });
+
+      return await vpn.captivePortalStats();
+    }
+
+    it('The first conclusive answer wins', async () => {
+      probes.ipv4 = {delay: 0, body: 'success'};
+      probes.ipv6 = {delay: 8000, body: 'success'};
+
+      const stats = await activateAndDetect();
+      assert(stats.result === 'NoPortal');
+      assert(stats.latency < probes.ipv6.delay);
+    });
+
+    it('A slow probe does not delay the portal detection', async () => {
+      probes.ipv4 = {delay: 8000, body: 'success'};
+      probes.ipv6 = {delay: 0, body: '<html>Welcome to the hotel</html>'};
+
+      const stats = await activateAndDetect();
+      assert(stats.result === 'PortalDetected');
+      assert(stats.latency < probes.ipv4.delay);
+    });
+  });
 });
@@ -3,7 +3,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 const assert = require('assert');
-const { generalElements } = require('./elements.js');
+const { generalElements, homeScreen } = require('./elements.js');
 const vpn = require('./helper.js');
 
 describe('Connectivity', function() {
@@ -58,6 +58,21 @@ describe('Connectivity', function() {
     assert(vpn.lastNotification().message.startsWith('Connected to '));
   });
 
+  it('Shows the IP address', async () => {
+    await vpn.waitForElement(generalElements.CONTROLLER_TITLE);
+
+    await vpn.activate();
+    await vpn.waitForCondition(async () => {
+      return await vpn.getElementProperty(generalElements.CONTROLLER_TITLE, 'text') ==
+          'VPN is on';
+    });
+
+    // The address comes from the ipinfo endpoint of the guardian stand-in.
+    await vpn.waitForElementAndClick(homeScreen.CONNECTION_INFO_TOGGLE);
+    await vpn.waitForElementProperty(
+        'connectionInfoIpv4', 'ipAddressText', '169.254.0.1');
+  });
+
   it('Disconnecting and disconnected', async () => {
     await vpn.waitForElement(generalElements.CONTROLLER_TITLE);
 
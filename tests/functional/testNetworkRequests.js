@@ -0,0 +1,45 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+const assert = require('assert');
+const { generalElements } = require('./elements.js');
+const guardianEndpoints = require('./guardian_endpoints.js');
+const vpn = require('./helper.js');
+
+describe('Network requests', function() {
+  let serverRequests = 0;
+
+  this.ctx.authenticationNeeded = true;
+  this.ctx.guardianOverrideEndpoints = {
+    GETs: {
+      '/api/v1/vpn/servers': {
+        ...guardianEndpoints.endpoints.GETs['/api/v1/vpn/servers'],
+        callback: () => ++serverRequests,
+      },
+    },
+  };
+
+  it('Identical requests share one reply', async () => {
+    await vpn.waitForElement(generalElements.CONTROLLER_TITLE);
+
+    const stats = await vpn.networkCoalescing();
+    const requests = serverRequests;
+
+    // Concurrent fetches: one request reaches the server.
+    await vpn.forceServersFetch(3);
+    await vpn.waitForCondition(async () => {
+      const current = await vpn.networkCoalescing();
+      return current.coalesced >= stats.coalesced + 2;
+    });
+    await vpn.waitForCondition(() => serverRequests === requests + 1);
+
+    // Right after, the response is still fresh.
+    await vpn.forceServersFetch(1);
+    await vpn.waitForCondition(async () => {
+      const current = await vpn.networkCoalescing();
+      return current.fresh >= stats.fresh + 1;
+    });
+    assert.strictEqual(serverRequests, requests + 1);
+  });
+});
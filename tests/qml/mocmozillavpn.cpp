@@ -64,7 +64,7 @@ void MozillaVPN::deviceRemoved(const QString&, const QString&) {}
 
 void MozillaVPN::deviceRemovalCompleted(const QString&) {}
 
-void MozillaVPN::serversFetched(const QByteArray&) {}
+void MozillaVPN::serversFetched(const QByteArray&, const QJsonDocument&) {}
 
 void MozillaVPN::removeDeviceFromPublicKey(const QString&) {}
 
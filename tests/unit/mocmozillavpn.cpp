@@ -46,7 +46,9 @@ void MozillaVPN::initialize() {}
 
 void MozillaVPN::setState(State) {}
 
-bool MozillaVPN::setServerList(QByteArray const&) { return true; }
+bool MozillaVPN::setServerList(const QByteArray&, const QJsonDocument&) {
+  return true;
+}
 
 void MozillaVPN::getStarted() {}
 
@@ -63,7 +65,7 @@ void MozillaVPN::deviceRemoved(const QString&, const QString&) {}
 
 void MozillaVPN::deviceRemovalCompleted(const QString&) {}
 
-void MozillaVPN::serversFetched(const QByteArray&) {}
+void MozillaVPN::serversFetched(const QByteArray&, const QJsonDocument&) {}
 
 void MozillaVPN::removeDeviceFromPublicKey(const QString&) {}
 
@@ -178,3 +180,7 @@ void MozillaVPN::resetJournalPublicAndPrivateKeys() {}
 bool MozillaVPN::checkCurrentDevice() { return true; }
 
 void MozillaVPN::scheduleRefreshDataTasks(bool refreshProducts) {}
+
+void MozillaVPN::setExitServerPublicKey(const QString& publicKey) {
+  m_exitServerPublicKey = publicKey;
+}
@@ -8,6 +8,7 @@
 #include "../../src/addons/addonmessage.h"
 #include "../../src/addons/addonproperty.h"
 #include "../../src/addons/addonpropertylist.h"
+#include "../../src/addons/addonscriptcache.h"
 #include "../../src/addons/addontutorial.h"
 #include "../../src/addons/conditionwatchers/addonconditionwatcherfeaturesenabled.h"
 #include "../../src/addons/conditionwatchers/addonconditionwatchergroup.h"
@@ -279,6 +280,82 @@ void TestAddon::conditionWatcher_javascript() {
   }
 }
 
+void TestAddon::scriptCache() {
+  QQmlApplicationEngine engine;
+  QmlEngineHolder qml(&engine);
+  SettingsHolder settingsHolder;
+
+  AddonScriptCache::clear();
+  QCOMPARE(AddonScriptCache::engine(), &engine);
+
+  QJSValue value;
+  QVERIFY(!AddonScriptCache::evaluate(":/addons_test/foo.js", "abc", &value));
+  QCOMPARE(AddonScriptCache::cacheSize(), 0);
+
+  // No sha256, no cache.
+  QVERIFY(AddonScriptCache::evaluate(":/addons_test/condition2.js",
+                                     QByteArray(), &value));
+  QVERIFY(value.isCallable());
+  QCOMPARE(AddonScriptCache::cacheSize(), 0);
+
+  QJSValue a;
+  QVERIFY(
+      AddonScriptCache::evaluate(":/addons_test/condition2.js", "abc", &a));
+  QVERIFY(a.isCallable());
+  QCOMPARE(AddonScriptCache::cacheSize(), 1);
+
+  // Same version: the evaluated function is reused.
+  QJSValue b;
+  QVERIFY(
+      AddonScriptCache::evaluate(":/addons_test/condition2.js", "abc", &b));
+  QVERIFY(a.strictlyEquals(b));
+  QCOMPARE(AddonScriptCache::cacheSize(), 1);
+
+  // A different version is evaluated again.
+  QJSValue c;
+  QVERIFY(
+      AddonScriptCache::evaluate(":/addons_test/condition2.js", "def", &c));
+  QVERIFY(!a.strictlyEquals(c));
+  QCOMPARE(AddonScriptCache::cacheSize(), 2);
+
+  AddonScriptCache::evict("abc");
+  QCOMPARE(AddonScriptCache::cacheSize(), 1);
+
+  QVERIFY(
+      AddonScriptCache::evaluate(":/addons_test/condition2.js", "abc", &b));
+  QVERIFY(!a.strictlyEquals(b));
+  QCOMPARE(AddonScriptCache::cacheSize(), 2);
+
+  AddonScriptCache::clear();
+  QCOMPARE(AddonScriptCache::cacheSize(), 0);
+}
+
+void TestAddon::scriptCacheModule() {
+  QQmlApplicationEngine engine;
+  QmlEngineHolder qml(&engine);
+  SettingsHolder settingsHolder;
+
+  AddonScriptCache::clear();
+
+  // The module next to the script is imported instead.
+  QJSValue a;
+  QVERIFY(AddonScriptCache::evaluate(":/addons_test/module1.js", "abc", &a));
+  QVERIFY(a.isCallable());
+  QCOMPARE(a.call().toString(), "module");
+
+  // The engine keeps the module imported for another version: the script is
+  // evaluated.
+  QJSValue b;
+  QVERIFY(AddonScriptCache::evaluate(":/addons_test/module1.js", "def", &b));
+  QCOMPARE(b.call().toString(), "script");
+
+  AddonScriptCache::evict("abc");
+  QVERIFY(AddonScriptCache::evaluate(":/addons_test/module1.js", "abc", &a));
+  QCOMPARE(a.call().toString(), "module");
+
+  AddonScriptCache::clear();
+}
+
 void TestAddon::conditionWatcher_locale() {
   SettingsHolder settingsHolder;
 
@@ -22,6 +22,9 @@ class TestAddon final : public TestHelper {
   void conditionWatcher_endTime();
   void conditionWatcher_javascript();
 
+  void scriptCache();
+  void scriptCacheModule();
+
   void guide_create_data();
   void guide_create();
 
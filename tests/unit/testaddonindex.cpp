@@ -4,6 +4,7 @@
 
 #include "testaddonindex.h"
 #include "../../src/addons/manager/addondirectory.h"
+#include "../../src/addons/manager/addonhashcache.h"
 #include "../../src/addons/manager/addonindex.h"
 #include "../../src/models/feature.h"
 #include "../../src/settingsholder.h"
@@ -144,4 +145,67 @@ void TestAddonIndex::testSignatureChecksCanBeToggled() {
   QTRY_COMPARE(indexUpdatedSpy.count(), 2);
 }
 
+void TestAddonIndex::hashCache() {
+  AddonDirectory addonDirectory;
+  addonDirectory.testReset();
+
+  QDir dir;
+  QVERIFY(addonDirectory.getDirectory(&dir));
+  QString filePath = dir.filePath("foo.rcc");
+
+  // No file, no stat.
+  QVERIFY(!AddonHashCache::stat(filePath).isValid());
+  QVERIFY(AddonHashCache::hash(filePath).isEmpty());
+
+  QVERIFY(addonDirectory.writeToFile("foo.rcc", "Hello world!"));
+
+  AddonHashCache::FileStat fileStat = AddonHashCache::stat(filePath);
+  QVERIFY(fileStat.isValid());
+  QCOMPARE(fileStat.m_size, qint64(12));
+
+  QByteArray sha256 =
+      QCryptographicHash::hash("Hello world!", QCryptographicHash::Sha256);
+  QCOMPARE(AddonHashCache::hash(filePath), sha256);
+
+  {
+    AddonHashCache cache(&addonDirectory);
+
+    QByteArray cachedSha256;
+    QVERIFY(!cache.lookup("foo.rcc", fileStat, &cachedSha256));
+
+    cache.insert("foo.rcc", fileStat, sha256);
+    QVERIFY(cache.lookup("foo.rcc", fileStat, &cachedSha256));
+    QCOMPARE(cachedSha256, sha256);
+
+    cache.save();
+  }
+
+  // The cache is persisted.
+  {
+    AddonHashCache cache(&addonDirectory);
+
+    QByteArray cachedSha256;
+    QVERIFY(cache.lookup("foo.rcc", fileStat, &cachedSha256));
+    QCOMPARE(cachedSha256, sha256);
+
+    // Different metadata, cache miss.
+    AddonHashCache::FileStat otherFileStat = fileStat;
+    ++otherFileStat.m_size;
+    QVERIFY(!cache.lookup("foo.rcc", otherFileStat, &cachedSha256));
+
+    cache.remove("foo.rcc");
+    QVERIFY(!cache.lookup("foo.rcc", fileStat, &cachedSha256));
+    cache.save();
+  }
+
+  {
+    AddonHashCache cache(&addonDirectory);
+
+    QByteArray cachedSha256;
+    QVERIFY(!cache.lookup("foo.rcc", fileStat, &cachedSha256));
+  }
+
+  addonDirectory.testReset();
+}
+
 static TestAddonIndex s_testAddonIndex;
@@ -12,4 +12,6 @@ class TestAddonIndex final : public TestHelper {
 
   void update_data();
   void update();
+
+  void hashCache();
 };
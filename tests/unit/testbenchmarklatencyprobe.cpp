@@ -0,0 +1,45 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "testbenchmarklatencyprobe.h"
+#include "../../src/connectionbenchmark/benchmarklatencyprobe.h"
+
+void TestBenchmarkLatencyProbe::median() {
+  QCOMPARE(BenchmarkLatencyProbe::medianMsec({}), 0u);
+  QCOMPARE(BenchmarkLatencyProbe::medianMsec({42}), 42u);
+  QCOMPARE(BenchmarkLatencyProbe::medianMsec({300, 20, 25}), 25u);
+
+  // A few late replies do not move the median.
+  QCOMPARE(BenchmarkLatencyProbe::medianMsec({20, 900, 22, 21, 800}), 22u);
+}
+
+void TestBenchmarkLatencyProbe::phases() {
+  BenchmarkLatencyProbe probe;
+  QVERIFY(!probe.isActive());
+
+  // The dummy ping sender replies right away.
+  probe.start(QHostAddress("127.0.0.1"), QHostAddress());
+  QVERIFY(probe.isActive());
+  QCOMPARE(probe.idleCount(), 1);
+  QCOMPARE(probe.loadedCount(), 0);
+
+  probe.setLoaded(true);
+  QTRY_VERIFY_WITH_TIMEOUT(probe.loadedCount() >= 2, 5000);
+
+  int idleCount = probe.idleCount();
+  probe.stop();
+  QVERIFY(!probe.isActive());
+
+  // The results survive the end of the probe, until the next start.
+  QCOMPARE(probe.idleCount(), idleCount);
+  QVERIFY(probe.loadedCount() >= 2);
+  QVERIFY(probe.loadedMsec() < 1000);
+
+  probe.start(QHostAddress("127.0.0.1"), QHostAddress());
+  QCOMPARE(probe.idleCount(), 1);
+  QCOMPARE(probe.loadedCount(), 0);
+  probe.stop();
+}
+
+static TestBenchmarkLatencyProbe s_testBenchmarkLatencyProbe;
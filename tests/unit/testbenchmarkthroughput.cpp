@@ -0,0 +1,55 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "testbenchmarkthroughput.h"
+#include "../../src/connectionbenchmark/benchmarkthroughput.h"
+
+void TestBenchmarkThroughput::empty() {
+  BenchmarkThroughput throughput;
+  QCOMPARE(throughput.count(), 0);
+  QCOMPARE(throughput.rampUpMsec(), qint64(-1));
+  QCOMPARE(throughput.percentileBps(50), 0ULL);
+
+  // Samples without a time delta are dropped.
+  throughput.addSample(0, 1000);
+  QCOMPARE(throughput.count(), 0);
+}
+
+void TestBenchmarkThroughput::steady() {
+  BenchmarkThroughput throughput;
+
+  // 1000 bytes every 100 msecs: 80 kbit/s.
+  for (int i = 1; i <= 10; ++i) {
+    throughput.addSample(i * 100, i * 1000);
+  }
+
+  QCOMPARE(throughput.count(), 10);
+  QCOMPARE(throughput.rampUpMsec(), qint64(0));
+  QCOMPARE(throughput.percentileBps(10), 80000ULL);
+  QCOMPARE(throughput.percentileBps(50), 80000ULL);
+  QCOMPARE(throughput.percentileBps(90), 80000ULL);
+}
+
+void TestBenchmarkThroughput::rampUp() {
+  BenchmarkThroughput throughput;
+
+  // Slow start: 100, 200, 400 bytes, then 1000 bytes per 100 msecs.
+  qint64 total = 0;
+  const QList<qint64> steps{100, 200, 400, 1000, 1000, 1000,
+                            900, 1100, 1000, 1000};
+  for (int i = 0; i < steps.count(); ++i) {
+    total += steps.at(i);
+    throughput.addSample((i + 1) * 100, total);
+  }
+
+  // The peak is 1000 bytes/100 msecs: the ramp-up ends with the third sample.
+  QCOMPARE(throughput.rampUpMsec(), qint64(300));
+
+  // The slow start is not part of the percentiles.
+  QCOMPARE(throughput.percentileBps(10), 72000ULL);
+  QCOMPARE(throughput.percentileBps(50), 80000ULL);
+  QCOMPARE(throughput.percentileBps(90), 88000ULL);
+}
+
+static TestBenchmarkThroughput s_testBenchmarkThroughput;
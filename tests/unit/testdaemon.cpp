@@ -0,0 +1,287 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "testdaemon.h"
+#include "../../src/daemon/daemon.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+
+namespace {
+
+// Keeps the peers, their allowed IPs and the excluded addresses in memory.
+// The handshakes complete when the test says so.
+class MockWireguardUtils final : public WireguardUtils {
+ public:
+  explicit MockWireguardUtils(QObject* parent) : WireguardUtils(parent) {}
+
+  bool interfaceExists() override { return m_interface; }
+  bool addInterface(const InterfaceConfig& config) override {
+    Q_UNUSED(config);
+    m_interface = true;
+    return true;
+  }
+  bool deleteInterface() override {
+    m_interface = false;
+    return true;
+  }
+
+  bool updatePeer(const InterfaceConfig& config) override {
+    m_peers[config.m_serverPublicKey] = config.m_allowedIPAddressRanges;
+    return true;
+  }
+  bool deletePeer(const InterfaceConfig& config) override {
+    m_peers.remove(config.m_serverPublicKey);
+    return true;
+  }
+
+  bool supportPendingPeers() const override { return true; }
+  bool addPendingPeer(const InterfaceConfig& config) override {
+    m_peers[config.m_serverPublicKey] = QList<IPAddress>();
+    return true;
+  }
+
+  QList<PeerStatus> getPeerStatus() override {
+    ++m_statusQueries;
+    QList<PeerStatus> list;
+    for (const QString& pubkey : m_peers.keys()) {
+      PeerStatus status(pubkey);
+      status.m_handshake = m_handshakes.value(pubkey);
+      list.append(status);
+    }
+    return list;
+  }
+
+  qint64 rxPackets() override {
+    ++m_rxQueries;
+    return m_rxPackets;
+  }
+
+  bool updateRoutePrefix(const IPAddress& prefix, int hopindex) override {
+    Q_UNUSED(prefix);
+    Q_UNUSED(hopindex);
+    return true;
+  }
+  bool deleteRoutePrefix(const IPAddress& prefix, int hopindex) override {
+    Q_UNUSED(prefix);
+    Q_UNUSED(hopindex);
+    return true;
+  }
+
+  bool addExclusionRoute(const QHostAddress& address) override {
+    m_exclusions.append(address);
+    return true;
+  }
+  bool deleteExclusionRoute(const QHostAddress& address) override {
+    m_exclusions.removeAll(address);
+    return true;
+  }
+
+  // A handshake response is also a received packet.
+  void completeHandshake(const QString& pubkey) {
+    m_handshakes[pubkey] = QDateTime::currentMSecsSinceEpoch();
+    ++m_rxPackets;
+  }
+
+  bool m_interface = false;
+  QHash<QString, QList<IPAddress>> m_peers;
+  QHash<QString, qint64> m_handshakes;
+  QList<QHostAddress> m_exclusions;
+  qint64 m_rxPackets = 0;
+  int m_rxQueries = 0;
+  int m_statusQueries = 0;
+};
+
+class MockDaemon final : public Daemon {
+ public:
+  MockDaemon() : Daemon(nullptr) { m_wgutils = new MockWireguardUtils(this); }
+
+  MockWireguardUtils* m_wgutils = nullptr;
+
+ protected:
+  WireguardUtils* wgutils() const override { return m_wgutils; }
+};
+
+// The same device, on the server `key`, which is also the excluded address.
+InterfaceConfig serverConfig(char key, const QString& serverAddress) {
+  InterfaceConfig config;
+  config.m_privateKey = QByteArray(32, 'p').toBase64();
+  config.m_deviceIpv4Address = "10.64.0.2/32";
+  config.m_serverIpv4Gateway = "10.64.0.1";
+  config.m_serverPublicKey = QByteArray(32, key).toBase64();
+  config.m_serverIpv4AddrIn = serverAddress;
+  config.m_serverPort = 51820;
+  config.m_allowedIPAddressRanges.append(IPAddress(QHostAddress("0.0.0.0"), 0));
+  config.m_excludedAddresses.append(serverAddress);
+  return config;
+}
+
+}  // namespace
+
+void TestDaemon::handshakeWatch() {
+  MockDaemon daemon;
+  MockWireguardUtils* wg = daemon.m_wgutils;
+  QSignalSpy connected(&daemon, &Daemon::connected);
+
+  InterfaceConfig config = serverConfig('a', "192.0.2.1");
+  QVERIFY(daemon.activate(config));
+
+  // While nothing is received, the checks back off and only read the RX
+  // counter. The status of the peers is still dumped once per second.
+  QTest::qWait(2000);
+  QVERIFY(wg->m_rxQueries >= 6);
+  QVERIFY(wg->m_statusQueries <= 2);
+  QCOMPARE(connected.count(), 0);
+
+  // A late handshake is noticed within the longest interval, with a single
+  // dump of the status.
+  int statusQueries = wg->m_statusQueries;
+  QElapsedTimer elapsed;
+  elapsed.start();
+  wg->completeHandshake(config.m_serverPublicKey);
+  QTRY_COMPARE(connected.count(), 1);
+  QVERIFY(elapsed.elapsed() < 1000 + 500);
+  QCOMPARE(wg->m_statusQueries - statusQueries, 1);
+
+  // Then the watch stops.
+  int rxQueries = wg->m_rxQueries;
+  QTest::qWait(1500);
+  QCOMPARE(wg->m_rxQueries, rxQueries);
+}
+
+void TestDaemon::switchOnHandshake() {
+  MockDaemon daemon;
+  MockWireguardUtils* wg = daemon.m_wgutils;
+  QSignalSpy connected(&daemon, &Daemon::connected);
+
+  InterfaceConfig first = serverConfig('a', "192.0.2.1");
+  InterfaceConfig second = serverConfig('b', "192.0.2.2");
+  QVERIFY(daemon.activate(first));
+  wg->completeHandshake(first.m_serverPublicKey);
+  QTRY_COMPARE(connected.count(), 1);
+
+  // The new peer is added without allowed IPs: the traffic keeps going
+  // through the first one.
+  QVERIFY(daemon.activate(second));
+  QCOMPARE(wg->m_peers.count(), 2);
+  QCOMPARE(wg->m_peers[first.m_serverPublicKey].count(), 1);
+  QVERIFY(wg->m_peers[second.m_serverPublicKey].isEmpty());
+  QCOMPARE(wg->m_exclusions.count(), 2);
+
+  // Nothing changes until the handshake.
+  QTest::qWait(500);
+  QCOMPARE(wg->m_peers.count(), 2);
+  QVERIFY(wg->m_peers[second.m_serverPublicKey].isEmpty());
+  QCOMPARE(connected.count(), 1);
+
+  wg->completeHandshake(second.m_serverPublicKey);
+  QTRY_COMPARE(connected.count(), 2);
+  QCOMPARE(connected.last().at(0).toString(), second.m_serverPublicKey);
+
+  QCOMPARE(wg->m_peers.keys(), QList<QString>{second.m_serverPublicKey});
+  QCOMPARE(wg->m_peers[second.m_serverPublicKey].count(), 1);
+  QCOMPARE(wg->m_exclusions, QList<QHostAddress>{QHostAddress("192.0.2.2")});
+}
+
+void TestDaemon::switchOnTimeout() {
+  MockDaemon daemon;
+  MockWireguardUtils* wg = daemon.m_wgutils;
+  QSignalSpy connected(&daemon, &Daemon::connected);
+
+  InterfaceConfig first = serverConfig('a', "192.0.2.1");
+  InterfaceConfig second = serverConfig('b', "192.0.2.2");
+  QVERIFY(daemon.activate(first));
+  wg->completeHandshake(first.m_serverPublicKey);
+  QTRY_COMPARE(connected.count(), 1);
+
+  QElapsedTimer elapsed;
+  elapsed.start();
+  QVERIFY(daemon.activate(second));
+
+  // Without a handshake, the switch happens after 5.5 seconds anyway.
+  QTRY_VERIFY_WITH_TIMEOUT(!wg->m_peers.contains(first.m_serverPublicKey),
+                           10000);
+  QVERIFY(elapsed.elapsed() >= 5500);
+  QCOMPARE(wg->m_peers[second.m_serverPublicKey].count(), 1);
+  QCOMPARE(wg->m_exclusions, QList<QHostAddress>{QHostAddress("192.0.2.2")});
+  QCOMPARE(connected.count(), 1);
+
+  // The connection is reported once the handshake completes.
+  wg->completeHandshake(second.m_serverPublicKey);
+  QTRY_COMPARE(connected.count(), 2);
+  QCOMPARE(connected.last().at(0).toString(), second.m_serverPublicKey);
+}
+
+void TestDaemon::switchAbort() {
+  MockDaemon daemon;
+  MockWireguardUtils* wg = daemon.m_wgutils;
+  QSignalSpy connected(&daemon, &Daemon::connected);
+
+  InterfaceConfig first = serverConfig('a', "192.0.2.1");
+  InterfaceConfig second = serverConfig('b', "192.0.2.2");
+  InterfaceConfig third = serverConfig('c', "192.0.2.3");
+  QVERIFY(daemon.activate(first));
+  wg->completeHandshake(first.m_serverPublicKey);
+  QTRY_COMPARE(connected.count(), 1);
+
+  // A new switch aborts the pending one, which never got any traffic.
+  QVERIFY(daemon.activate(second));
+  QVERIFY(daemon.activate(third));
+  QCOMPARE(wg->m_peers.count(), 2);
+  QVERIFY(!wg->m_peers.contains(second.m_serverPublicKey));
+  QCOMPARE(wg->m_peers[first.m_serverPublicKey].count(), 1);
+  QVERIFY(wg->m_peers[third.m_serverPublicKey].isEmpty());
+  QCOMPARE(wg->m_exclusions.count(), 2);
+  QVERIFY(!wg->m_exclusions.contains(QHostAddress("192.0.2.2")));
+
+  // A late handshake of the aborted peer is ignored.
+  wg->completeHandshake(second.m_serverPublicKey);
+  QTest::qWait(500);
+  QCOMPARE(connected.count(), 1);
+  QVERIFY(!wg->m_peers.contains(second.m_serverPublicKey));
+
+  wg->completeHandshake(third.m_serverPublicKey);
+  QTRY_COMPARE(connected.count(), 2);
+  QCOMPARE(connected.last().at(0).toString(), third.m_serverPublicKey);
+  QCOMPARE(wg->m_peers.keys(), QList<QString>{third.m_serverPublicKey});
+
+  // Going back to the current server while a switch is pending only aborts
+  // the switch.
+  QVERIFY(daemon.activate(second));
+  QVERIFY(daemon.activate(third));
+  QCOMPARE(wg->m_peers.keys(), QList<QString>{third.m_serverPublicKey});
+  QCOMPARE(wg->m_peers[third.m_serverPublicKey].count(), 1);
+  QCOMPARE(wg->m_exclusions, QList<QHostAddress>{QHostAddress("192.0.2.3")});
+}
+
+void TestDaemon::deactivateWithPendingSwitch() {
+  MockDaemon daemon;
+  MockWireguardUtils* wg = daemon.m_wgutils;
+  QSignalSpy connected(&daemon, &Daemon::connected);
+  QSignalSpy disconnected(&daemon, &Daemon::disconnected);
+
+  InterfaceConfig first = serverConfig('a', "192.0.2.1");
+  InterfaceConfig second = serverConfig('b', "192.0.2.2");
+  QVERIFY(daemon.activate(first));
+  wg->completeHandshake(first.m_serverPublicKey);
+  QTRY_COMPARE(connected.count(), 1);
+
+  QVERIFY(daemon.activate(second));
+  QCOMPARE(wg->m_peers.count(), 2);
+
+  // Both peers and all the exclusions go away.
+  QVERIFY(daemon.deactivate());
+  QCOMPARE(disconnected.count(), 1);
+  QVERIFY(!wg->m_interface);
+  QVERIFY(wg->m_peers.isEmpty());
+  QVERIFY(wg->m_exclusions.isEmpty());
+
+  // The pending switch is gone too: a late handshake commits nothing.
+  wg->completeHandshake(second.m_serverPublicKey);
+  QTest::qWait(1500);
+  QCOMPARE(connected.count(), 1);
+  QVERIFY(wg->m_peers.isEmpty());
+}
+
+static TestDaemon s_testDaemon;
@@ -5,6 +5,7 @@
 #include "testipaddresslookup.h"
 #include "../../src/ipaddresslookup.h"
 #include "../../src/constants.h"
+#include "../../src/mozillavpn.h"
 #include "../../src/settingsholder.h"
 #include "helper.h"
 
@@ -14,16 +15,20 @@ void TestIpAddressLookup::checkIpAddressFailure() {
 
   SettingsHolder settingsHolder;
 
-  TestHelper::networkConfig.append(TestHelper::NetworkConfig(
-      TestHelper::NetworkConfig::Failure, QByteArray()));
-  TestHelper::networkConfig.append(TestHelper::NetworkConfig(
-      TestHelper::NetworkConfig::Failure, QByteArray()));
+  // Each address of the API host is tried before giving up.
+  TestHelper::networkConfig.clear();
+  for (int i = 0; i < 16; ++i) {
+    TestHelper::networkConfig.append(TestHelper::NetworkConfig(
+        TestHelper::NetworkConfig::Failure, QByteArray()));
+  }
 
   QEventLoop loop;
   connect(&ial, &IpAddressLookup::ipAddressChecked, &ial, [&] { loop.exit(); });
 
   ial.updateIpAddress();
   loop.exec();
+
+  TestHelper::networkConfig.clear();
 }
 
 void TestIpAddressLookup::checkIpAddressSucceess_data() {
@@ -76,4 +81,38 @@ void TestIpAddressLookup::checkIpAddressSucceess() {
   loop.exec();
 }
 
+void TestIpAddressLookup::checkIpAddressCache() {
+  IpAddressLookup ial;
+  ial.reset();
+
+  SettingsHolder settingsHolder;
+
+  MozillaVPN::instance()->setExitServerPublicKey("exit");
+
+  TestHelper::networkConfig.clear();
+  TestHelper::networkConfig.append(TestHelper::NetworkConfig(
+      TestHelper::NetworkConfig::Success, "{\"ip\":\"42\"}"));
+  TestHelper::networkConfig.append(TestHelper::NetworkConfig(
+      TestHelper::NetworkConfig::Success, "{\"ip\":\"42\"}"));
+
+  QEventLoop loop;
+  connect(&ial, &IpAddressLookup::ipAddressChecked, &ial, [&] { loop.exit(); });
+
+  ial.updateIpAddress();
+  loop.exec();
+  QCOMPARE(ial.ipv4Address(), "42");
+
+  // The same exit server again: no network requests.
+  ial.reset();
+  TestHelper::networkConfig.clear();
+  QCOMPARE(ial.ipv4Address(), "vpn.connectionInfo.loading");
+
+  QSignalSpy spy(&ial, &IpAddressLookup::ipAddressChecked);
+  ial.updateIpAddress();
+  QCOMPARE(spy.count(), 1);
+  QCOMPARE(ial.ipv4Address(), "42");
+
+  MozillaVPN::instance()->setExitServerPublicKey("");
+}
+
 static TestIpAddressLookup s_testIpAddressLookup;
@@ -12,6 +12,7 @@ class TestIpAddressLookup final : public TestHelper {
   void checkIpAddressFailure();
   void checkIpAddressSucceess_data();
   void checkIpAddressSucceess();
+  void checkIpAddressCache();
 
   void cleanupTestCase() {
     TestHelper::controllerState = Controller::StateInitializing;
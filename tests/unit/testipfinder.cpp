@@ -26,7 +26,10 @@ void TestIpFinder::ipv4AndIpv6() {
       for (const QHostAddress& address : hostInfo.addresses()) {
         if (address.isNull() || address.isBroadcast()) continue;
 
+        // The addresses of a family are tried one after the other: only the
+        // first one is needed.
         if (address.protocol() == QAbstractSocket::IPv4Protocol) {
+          if (ipv4Expected) continue;
           TestHelper::networkConfig.append(TestHelper::NetworkConfig(
               TestHelper::NetworkConfig::Success,
               QString("{\"ip\":\"42\", \"country\": \"123\"}").toUtf8()));
@@ -35,6 +38,7 @@ void TestIpFinder::ipv4AndIpv6() {
         }
 
         if (address.protocol() == QAbstractSocket::IPv6Protocol) {
+          if (ipv6Expected) continue;
           TestHelper::networkConfig.append(TestHelper::NetworkConfig(
               TestHelper::NetworkConfig::Success,
               QString("{\"ip\":\"43\", \"country\": \"123\"}").toUtf8()));
@@ -7,6 +7,7 @@
 #include "../../src/models/devicemodel.h"
 #include "../../src/models/keys.h"
 #include "../../src/models/servercity.h"
+#include "../../src/models/servercitymodel.h"
 #include "../../src/models/servercountry.h"
 #include "../../src/models/servercountrymodel.h"
 #include "../../src/models/serverdata.h"
@@ -456,6 +457,84 @@ void TestModels::deviceModelRemoval() {
   QCOMPARE(dm.rowCount(QModelIndex()), 1);
 }
 
+void TestModels::deviceModelUpdate() {
+  auto device = [](const QString& pubkey, const QString& name,
+                   const QString& createdAt) {
+    QJsonObject d;
+    d.insert("name", name);
+    d.insert("unique_id", pubkey);
+    d.insert("pubkey", pubkey);
+    d.insert("created_at", createdAt);
+    d.insert("ipv4_address", "deviceIpv4");
+    d.insert("ipv6_address", "deviceIpv6");
+    return d;
+  };
+
+  auto toJson = [](const QJsonArray& devices) {
+    QJsonObject obj;
+    obj.insert("devices", devices);
+    return QJsonDocument(obj).toJson();
+  };
+
+  Keys keys;
+  keys.storeKeys("private", "currentDevicePubkey");
+
+  QJsonArray devices;
+  devices.append(device("devicePubkey1", "device1", "2017-07-24T15:46:29"));
+  devices.append(device("devicePubkey2", "device2", "2018-07-24T15:46:29"));
+
+  DeviceModel dm;
+  QVERIFY(dm.fromJson(&keys, toJson(devices)));
+  QCOMPARE(dm.rowCount(QModelIndex()), 2);
+  QCOMPARE(dm.data(dm.index(0, 0), DeviceModel::PublicKeyRole).toString(),
+           "devicePubkey2");
+
+  QSignalSpy resetSpy(&dm, &DeviceModel::modelReset);
+  QSignalSpy insertSpy(&dm, &DeviceModel::rowsInserted);
+  QSignalSpy removeSpy(&dm, &DeviceModel::rowsRemoved);
+  QSignalSpy moveSpy(&dm, &DeviceModel::rowsMoved);
+  QSignalSpy dataSpy(&dm, &DeviceModel::dataChanged);
+
+  // Same devices, another JSON document.
+  QVERIFY(dm.fromJson(&keys, QJsonDocument(QJsonObject{{"devices", devices}})
+                                 .toJson(QJsonDocument::Compact)));
+  QCOMPARE(dataSpy.count(), 0);
+
+  // A device is renamed.
+  devices[0] = device("devicePubkey1", "renamed", "2017-07-24T15:46:29");
+  QVERIFY(dm.fromJson(&keys, toJson(devices)));
+  QCOMPARE(dataSpy.count(), 1);
+  QCOMPARE(dataSpy.at(0).at(0).toModelIndex().row(), 1);
+  QCOMPARE(dataSpy.at(0).at(2).value<QVector<int>>(),
+           QVector<int>{DeviceModel::NameRole});
+  QCOMPARE(dm.data(dm.index(1, 0), DeviceModel::NameRole).toString(),
+           "renamed");
+
+  // A device is added, in the middle.
+  devices.append(device("devicePubkey3", "device3", "2017-12-24T15:46:29"));
+  QVERIFY(dm.fromJson(&keys, toJson(devices)));
+  QCOMPARE(insertSpy.count(), 1);
+  QCOMPARE(insertSpy.at(0).at(1).toInt(), 1);
+  QCOMPARE(dm.data(dm.index(1, 0), DeviceModel::PublicKeyRole).toString(),
+           "devicePubkey3");
+
+  // The newest device becomes the oldest one.
+  devices[1] = device("devicePubkey2", "device2", "2016-07-24T15:46:29");
+  QVERIFY(dm.fromJson(&keys, toJson(devices)));
+  QCOMPARE(moveSpy.count(), 2);
+  QCOMPARE(dataSpy.count(), 2);
+  QCOMPARE(dm.data(dm.index(2, 0), DeviceModel::PublicKeyRole).toString(),
+           "devicePubkey2");
+
+  // A device is removed.
+  devices.removeAt(0);
+  QVERIFY(dm.fromJson(&keys, toJson(devices)));
+  QCOMPARE(removeSpy.count(), 1);
+  QCOMPARE(dm.rowCount(QModelIndex()), 2);
+
+  QCOMPARE(resetSpy.count(), 0);
+}
+
 // Feedback Category
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
@@ -1061,14 +1140,18 @@ void TestModels::serverCountryModelFromJson() {
         QFETCH(QVariant, cities);
         Q_ASSERT(cities.typeId() == QVariant::List);
         QVariant cityData = m.data(index, ServerCountryModel::CitiesRole);
-        QCOMPARE(cityData.typeId(), QVariant::List);
-        QCOMPARE(cities.toList().length(), cityData.toList().length());
+        QVERIFY(cityData.canConvert<ServerCityModel*>());
+        ServerCityModel* cityModel = cityData.value<ServerCityModel*>();
+        QVERIFY(cityModel);
+        QCOMPARE(cities.toList().length(), cityModel->rowCount(QModelIndex()));
         for (int i = 0; i < cities.toList().length(); i++) {
-          QVERIFY(cityData.toList().at(0).canConvert<ServerCity*>());
-          ServerCity* cityObj = cityData.toList().at(i).value<ServerCity*>();
+          QModelIndex cityIndex = cityModel->index(i, 0);
           QStringList cityList = cities.toList().at(i).toStringList();
-          QCOMPARE(cityObj->name(), cityList.at(0));
-          QCOMPARE(cityObj->localizedName(), cityList.at(1));
+          QCOMPARE(cityIndex.data(ServerCityModel::NameRole).toString(),
+                   cityList.at(0));
+          QCOMPARE(
+              cityIndex.data(ServerCityModel::LocalizedNameRole).toString(),
+              cityList.at(1));
         }
 
         QCOMPARE(m.countryName(code.toString()), name.toString());
@@ -1113,14 +1196,18 @@ void TestModels::serverCountryModelFromJson() {
 
         QFETCH(QVariant, cities);
         QVariant cityData = m.data(index, ServerCountryModel::CitiesRole);
-        QCOMPARE(cityData.typeId(), QVariant::List);
-        QCOMPARE(cities.toList().length(), cityData.toList().length());
+        QVERIFY(cityData.canConvert<ServerCityModel*>());
+        ServerCityModel* cityModel = cityData.value<ServerCityModel*>();
+        QVERIFY(cityModel);
+        QCOMPARE(cities.toList().length(), cityModel->rowCount(QModelIndex()));
         for (int i = 0; i < cities.toList().length(); i++) {
-          QVERIFY(cityData.toList().at(0).canConvert<ServerCity*>());
-          ServerCity* cityObj = cityData.toList().at(i).value<ServerCity*>();
+          QModelIndex cityIndex = cityModel->index(i, 0);
           QStringList cityList = cities.toList().at(i).toStringList();
-          QCOMPARE(cityObj->name(), cityList.at(0));
-          QCOMPARE(cityObj->localizedName(), cityList.at(1));
+          QCOMPARE(cityIndex.data(ServerCityModel::NameRole).toString(),
+                   cityList.at(0));
+          QCOMPARE(
+              cityIndex.data(ServerCityModel::LocalizedNameRole).toString(),
+              cityList.at(1));
         }
 
         QCOMPARE(m.data(index, ServerCountryModel::CitiesRole + 1), QVariant());
@@ -1213,6 +1300,103 @@ void TestModels::serverCountryModelPick() {
   }
 }
 
+void TestModels::serverCountryModelUpdate() {
+  auto country = [](const QString& code, const QString& pubkey, int weight) {
+    QJsonObject server;
+    server.insert("hostname", "hostname");
+    server.insert("ipv4_addr_in", "ipv4AddrIn");
+    server.insert("ipv4_gateway", "ipv4Gateway");
+    server.insert("ipv6_addr_in", "ipv6AddrIn");
+    server.insert("ipv6_gateway", "ipv6Gateway");
+    server.insert("public_key", pubkey);
+    server.insert("weight", weight);
+    server.insert("port_ranges", QJsonArray());
+    server.insert("multihop_port", 1234);
+    server.insert("socks5_name", "socks5_name");
+
+    QJsonObject city;
+    city.insert("code", "serverCityCode");
+    city.insert("name", "serverCityName");
+    city.insert("latitude", 12.34);
+    city.insert("longitude", 34.56);
+    city.insert("servers", QJsonArray{server});
+
+    QJsonObject c;
+    c.insert("name", code);
+    c.insert("code", code);
+    c.insert("cities", QJsonArray{city});
+    return c;
+  };
+
+  auto toJson = [](const QJsonArray& countries) {
+    QJsonObject obj;
+    obj.insert("countries", countries);
+    return QJsonDocument(obj).toJson();
+  };
+
+  SettingsHolder settingsHolder;
+
+  QJsonArray countries;
+  countries.append(country("aa", "publicKey1", 1));
+  countries.append(country("bb", "publicKey2", 1));
+
+  ServerCountryModel m;
+  QVERIFY(m.fromJson(toJson(countries)));
+  QCOMPARE(m.rowCount(QModelIndex()), 2);
+  QVariant cities = m.data(m.index(1, 0), ServerCountryModel::CitiesRole);
+  ServerCityModel* cityModel = cities.value<ServerCityModel*>();
+  QVERIFY(cityModel);
+
+  QSignalSpy resetSpy(&m, &ServerCountryModel::modelReset);
+  QSignalSpy insertSpy(&m, &ServerCountryModel::rowsInserted);
+  QSignalSpy removeSpy(&m, &ServerCountryModel::rowsRemoved);
+  QSignalSpy dataSpy(&m, &ServerCountryModel::dataChanged);
+  QSignalSpy cityResetSpy(cityModel, &ServerCityModel::modelReset);
+
+  // Only the weight of a server changes.
+  countries[0] = country("aa", "publicKey1", 2);
+  quint64 generation = m.generation();
+  QVERIFY(m.fromJson(toJson(countries)));
+  QVERIFY(m.generation() != generation);
+  QCOMPARE(dataSpy.count(), 0);
+  QCOMPARE(m.server("publicKey1").weight(), 2u);
+
+  // A server moves to another city: the country keeps its city model.
+  countries[1] = country("bb", "publicKey3", 1);
+  QVERIFY(m.fromJson(toJson(countries)));
+  QCOMPARE(dataSpy.count(), 0);
+  QCOMPARE(cityResetSpy.count(), 1);
+  QCOMPARE(m.data(m.index(1, 0), ServerCountryModel::CitiesRole), cities);
+  QCOMPARE(cityModel->cities().at(0).servers(), QStringList{"publicKey3"});
+
+  // The city and the server share the public key.
+  QCOMPARE(m.servers().length(), 2);
+  QCOMPARE(cityModel->cities().at(0).servers().at(0).constData(),
+           m.server("publicKey3").publicKey().constData());
+  QVERIFY(!m.server("publicKey2").initialized());
+
+  // A country is removed and added back.
+  countries.removeAt(0);
+  QVERIFY(m.fromJson(toJson(countries)));
+  QCOMPARE(removeSpy.count(), 1);
+  QCOMPARE(m.rowCount(QModelIndex()), 1);
+
+  countries.append(country("aa", "publicKey1", 2));
+  QVERIFY(m.fromJson(toJson(countries)));
+  QCOMPARE(insertSpy.count(), 1);
+  QCOMPARE(insertSpy.at(0).at(1).toInt(), 0);
+  QCOMPARE(m.data(m.index(0, 0), ServerCountryModel::CodeRole).toString(),
+           "aa");
+
+  // The servers are in a new order, and the unchanged city follows it.
+  QCOMPARE(m.servers().at(1).publicKey(), "publicKey1");
+  const QList<int>& indexes = cityModel->cities().at(0).serverIndexes();
+  QCOMPARE(indexes.length(), 1);
+  QCOMPARE(m.servers().at(indexes.at(0)).publicKey(), "publicKey3");
+
+  QCOMPARE(resetSpy.count(), 0);
+}
+
 // ServerData
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
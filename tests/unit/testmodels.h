@@ -17,6 +17,7 @@ class TestModels final : public TestHelper {
   void deviceModelFromJson_data();
   void deviceModelFromJson();
   void deviceModelRemoval();
+  void deviceModelUpdate();
 
   void feedbackCategoryBasic();
 
@@ -39,6 +40,7 @@ class TestModels final : public TestHelper {
   void serverCountryModelFromJson_data();
   void serverCountryModelFromJson();
   void serverCountryModelPick();
+  void serverCountryModelUpdate();
 
   void serverDataBasic();
 
@@ -7,6 +7,12 @@
 #include "../../src/simplenetworkmanager.h"
 #include "helper.h"
 
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTcpServer>
+#include <QTcpSocket>
+
 void TestNetworkManager::basic() {
   SimpleNetworkManager snm;
   SettingsHolder settingsHolder;
@@ -15,4 +21,70 @@ void TestNetworkManager::basic() {
   QCOMPARE(snm.networkAccessManager(), snm.networkAccessManager());
 }
 
+void TestNetworkManager::hostMetrics() {
+#if QT_VERSION < 0x060300
+  QSKIP("The connect times require Qt 6.3");
+#else
+  SimpleNetworkManager snm;
+  SettingsHolder settingsHolder;
+
+  // A local stand-in for the API host, answering every request.
+  QTcpServer server;
+  QVERIFY(server.listen(QHostAddress::LocalHost));
+  connect(&server, &QTcpServer::newConnection, &server, [&server]() {
+    QTcpSocket* socket = server.nextPendingConnection();
+    connect(socket, &QTcpSocket::readyRead, socket, [socket]() {
+      socket->readAll();
+      socket->write("HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+    });
+  });
+
+  QUrl url(QString("http://127.0.0.1:%1/").arg(server.serverPort()));
+  for (int i = 0; i < 2; ++i) {
+    QNetworkReply* reply =
+        snm.networkAccessManager()->get(QNetworkRequest(url));
+    snm.observeReply(reply);
+
+    QSignalSpy spy(reply, &QNetworkReply::finished);
+    QVERIFY(spy.wait(5000));
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    reply->deleteLater();
+  }
+
+  // The second request reuses the connection of the first one.
+  NetworkManager::HostMetrics metrics = snm.hostMetrics().value("127.0.0.1");
+  QCOMPARE(metrics.m_connections, 1u);
+  QCOMPARE(metrics.m_connectFailures, 0u);
+  QVERIFY(metrics.m_lastConnectMsec >= 0);
+  QCOMPARE(metrics.m_totalConnectMsec, metrics.m_lastConnectMsec);
+#endif
+}
+
+void TestNetworkManager::hostMetricsBlackholed() {
+#if QT_VERSION < 0x060300
+  QSKIP("The connect times require Qt 6.3");
+#else
+  SimpleNetworkManager snm;
+  SettingsHolder settingsHolder;
+
+  // 100::/64 is a discard-only prefix (RFC 6666): the connection either never
+  // completes, or fails right away without a route.
+  QNetworkRequest request(QUrl("http://[100::1]:8080/"));
+  request.setTransferTimeout(1000);
+
+  QNetworkReply* reply = snm.networkAccessManager()->get(request);
+  snm.observeReply(reply);
+
+  QSignalSpy spy(reply, &QNetworkReply::finished);
+  QVERIFY(spy.wait(5000));
+  QVERIFY(reply->error() != QNetworkReply::NoError);
+  reply->deleteLater();
+
+  NetworkManager::HostMetrics metrics = snm.hostMetrics().value("100::1");
+  QCOMPARE(metrics.m_connections, 0u);
+  QCOMPARE(metrics.m_connectFailures, 1u);
+  QCOMPARE(metrics.m_lastConnectMsec, qint64(-1));
+#endif
+}
+
 static TestNetworkManager s_testNetworkManager;
@@ -9,4 +9,6 @@ class TestNetworkManager final : public TestHelper {
 
  private slots:
   void basic();
+  void hostMetrics();
+  void hostMetricsBlackholed();
 };
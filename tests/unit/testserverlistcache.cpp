@@ -0,0 +1,77 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "testserverlistcache.h"
+#include "../../src/models/servercountrymodel.h"
+#include "../../src/server/serverlistcache.h"
+#include "../../src/settingsholder.h"
+#include "helper.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+QJsonObject country(const QString& code, const QString& name) {
+  QJsonObject obj;
+  obj.insert("code", code);
+  obj.insert("name", name);
+  obj.insert("cities", QJsonArray());
+  return obj;
+}
+
+QStringList order(const QByteArray& response) {
+  QJsonObject obj = QJsonDocument::fromJson(response).object();
+  QJsonArray countries = obj["servers"].toObject()["countries"].toArray();
+  if (obj.contains("delta")) {
+    countries = obj["delta"].toObject()["order"].toArray();
+  }
+
+  QStringList codes;
+  for (const QJsonValue& value : countries) {
+    codes.append(value.isObject() ? value.toObject()["code"].toString()
+                                  : value.toString());
+  }
+  return codes;
+}
+}  // namespace
+
+void TestServerListCache::languageChange() {
+  SettingsHolder settingsHolder;
+  settingsHolder.setLanguageCode("fr");
+
+  // "au" is "au_EN" in English, and "au_SK" in Slovak: the two countries swap
+  // places when the language changes.
+  QJsonArray countries;
+  countries.append(country("au", "FOO"));
+  countries.append(country("zz", "au_M"));
+  QJsonObject obj;
+  obj.insert("countries", countries);
+
+  ServerCountryModel model;
+  QVERIFY(model.fromJson(QJsonDocument(obj).toJson()));
+
+  ServerListCache cache;
+  QByteArray response = cache.response(&model, 0);
+  QCOMPARE(order(response), QStringList({"au", "zz"}));
+
+  quint64 generation = QJsonDocument::fromJson(response)
+                           .object()["generation"]
+                           .toVariant()
+                           .toULongLong();
+  QVERIFY(QJsonDocument::fromJson(cache.response(&model, generation))
+              .object()["unchanged"]
+              .toBool());
+
+  settingsHolder.setLanguageCode("sk");
+  model.retranslate();
+
+  // Neither the whole list nor the "unchanged" response keep the old order.
+  response = cache.response(&model, generation);
+  QVERIFY(!QJsonDocument::fromJson(response).object().contains("unchanged"));
+  QCOMPARE(order(response), QStringList({"zz", "au"}));
+  QCOMPARE(order(cache.response(&model, 0)), QStringList({"zz", "au"}));
+}
+
+static TestServerListCache s_testServerListCache;
@@ -0,0 +1,93 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "teststartuptracer.h"
+#include "../../src/startuptracer.h"
+
+#include <QJsonArray>
+
+void TestStartupTracer::spans() {
+  StartupTracer tracer;
+
+  {
+    StartupTracer::Span outer("outer", &tracer);
+    QTest::qSleep(10);
+    StartupTracer::Span inner("inner", &tracer);
+  }
+
+  QJsonArray events = tracer.toJson()["traceEvents"].toArray();
+  QCOMPARE(events.count(), 2);
+
+  // Spans are recorded when they end.
+  QJsonObject inner = events[0].toObject();
+  QCOMPARE(inner["name"].toString(), "inner");
+  QCOMPARE(inner["ph"].toString(), "X");
+  QCOMPARE(inner["cat"].toString(), "startup");
+  QCOMPARE(inner["tid"].toInt(), 1);
+  QVERIFY(inner.contains("pid"));
+
+  QJsonObject outer = events[1].toObject();
+  QCOMPARE(outer["name"].toString(), "outer");
+  QVERIFY(outer["dur"].toDouble() >= 10000);
+
+  // The inner span is inside the outer one.
+  QVERIFY(inner["ts"].toDouble() >= outer["ts"].toDouble());
+  QVERIFY(inner["ts"].toDouble() + inner["dur"].toDouble() <=
+          outer["ts"].toDouble() + outer["dur"].toDouble());
+}
+
+void TestStartupTracer::beginEnd() {
+  StartupTracer tracer;
+  tracer.begin("step");
+  tracer.end("step");
+
+  QJsonArray events = tracer.toJson()["traceEvents"].toArray();
+  QCOMPARE(events.count(), 2);
+  QCOMPARE(events[0].toObject()["ph"].toString(), "B");
+  QCOMPARE(events[1].toObject()["ph"].toString(), "E");
+  QVERIFY(!events[0].toObject().contains("dur"));
+  QVERIFY(events[1].toObject()["ts"].toDouble() >=
+          events[0].toObject()["ts"].toDouble());
+}
+
+void TestStartupTracer::instant() {
+  StartupTracer tracer;
+  QCOMPARE(tracer.instantUsec("frame"), qint64(-1));
+
+  QTest::qSleep(5);
+  tracer.instant("frame");
+  tracer.instant("frame");
+
+  qint64 usec = tracer.instantUsec("frame");
+  QVERIFY(usec >= 5000);
+
+  QJsonArray events = tracer.toJson()["traceEvents"].toArray();
+  QCOMPARE(events.count(), 2);
+
+  QJsonObject event = events[0].toObject();
+  QCOMPARE(event["ph"].toString(), "i");
+  QCOMPARE(event["s"].toString(), "g");
+  QCOMPARE(qint64(event["ts"].toDouble()), usec);
+}
+
+void TestStartupTracer::finish() {
+  StartupTracer tracer;
+  tracer.instant("before");
+  QVERIFY(!tracer.isFinished());
+
+  tracer.finish();
+  QVERIFY(tracer.isFinished());
+
+  // Nothing is recorded after the end of the startup.
+  tracer.instant("after");
+  { StartupTracer::Span span("after", &tracer); }
+
+  QJsonArray events = tracer.toJson()["traceEvents"].toArray();
+  QCOMPARE(events.count(), 2);
+  QCOMPARE(events[0].toObject()["name"].toString(), "before");
+  QCOMPARE(events[1].toObject()["name"].toString(), "Startup completed");
+  QCOMPARE(tracer.toJson()["displayTimeUnit"].toString(), "ms");
+}
+
+static TestStartupTracer s_testStartupTracer;
@@ -6,6 +6,7 @@
 #include "../../src/statusicon.h"
 
 #include <QEventLoop>
+#include <QSignalSpy>
 
 void TestStatusIcon::basic() {
   StatusIcon si;
@@ -49,4 +50,52 @@ void TestStatusIcon::basic() {
   loop.exec();
 }
 
+void TestStatusIcon::paintCount() {
+  TestHelper::vpnState = MozillaVPN::StateMain;
+  TestHelper::controllerState = Controller::StateOff;
+
+  StatusIcon si;
+  QSignalSpy spy(&si, &StatusIcon::iconUpdateNeeded);
+
+  // The tray handlers fetch the icon when it changes.
+  connect(&si, &StatusIcon::iconUpdateNeeded, &si, [&]() { si.image(); });
+
+  si.refreshNeeded();
+  QCOMPARE(spy.count(), 1);
+  QCOMPARE(si.paintCount(), 1);
+  QVERIFY(!si.image().isNull());
+
+  // Nothing changed: no updates and no repaints.
+  si.refreshNeeded();
+  si.refreshNeeded();
+  QCOMPARE(spy.count(), 1);
+  QCOMPARE(si.paintCount(), 1);
+
+  // Two connect cycles. Each animation frame is rendered once.
+  for (int cycle = 0; cycle < 2; ++cycle) {
+    spy.clear();
+    TestHelper::controllerState = Controller::StateConnecting;
+    si.refreshNeeded();
+    QTRY_VERIFY(spy.count() >= 10);
+
+    TestHelper::controllerState = Controller::StateOn;
+    si.refreshNeeded();
+    si.refreshNeeded();
+
+    TestHelper::controllerState = Controller::StateDisconnecting;
+    si.refreshNeeded();
+
+    TestHelper::controllerState = Controller::StateOff;
+    si.refreshNeeded();
+
+    // Off + 4 animation frames + On.
+    QCOMPARE(si.paintCount(), 6);
+  }
+
+  // The animation is over.
+  spy.clear();
+  QTest::qWait(100);
+  QCOMPARE(spy.count(), 0);
+}
+
 static TestStatusIcon s_testStatusIcon;
@@ -9,4 +9,5 @@ class TestStatusIcon : public TestHelper {
 
  private slots:
   void basic();
+  void paintCount();
 };
@@ -0,0 +1,109 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "testtimerwheel.h"
+#include "../../src/timerwheel.h"
+
+#include <QElapsedTimer>
+
+void TestTimerWheel::singleShot() {
+  WheelTimer timer;
+  timer.setSingleShot(true);
+
+  int fired = 0;
+  connect(&timer, &WheelTimer::timeout, [&]() { ++fired; });
+
+  QElapsedTimer elapsed;
+  elapsed.start();
+
+  timer.start(300);
+  QVERIFY(timer.isActive());
+
+  QTRY_COMPARE_WITH_TIMEOUT(fired, 1, 5000);
+  QVERIFY(!timer.isActive());
+
+  // Never earlier than requested, at most one slack later (plus some room for
+  // a busy CI).
+  QVERIFY(elapsed.elapsed() >= 300);
+  QVERIFY(elapsed.elapsed() <
+          300 + TimerWheel::instance()->slackMsec() + 1000);
+
+  // Nothing else happens.
+  QTest::qWait(TimerWheel::instance()->slackMsec() * 2 + 300);
+  QCOMPARE(fired, 1);
+}
+
+void TestTimerWheel::repeating() {
+  WheelTimer timer;
+  QVERIFY(!timer.isSingleShot());
+
+  int fired = 0;
+  connect(&timer, &WheelTimer::timeout, [&]() { ++fired; });
+
+  timer.start(100);
+  QTRY_VERIFY_WITH_TIMEOUT(fired >= 3, 10000);
+  QVERIFY(timer.isActive());
+
+  timer.stop();
+  QVERIFY(!timer.isActive());
+}
+
+void TestTimerWheel::stop() {
+  int count = TimerWheel::instance()->count();
+
+  int fired = 0;
+  {
+    WheelTimer timer;
+    timer.setSingleShot(true);
+    connect(&timer, &WheelTimer::timeout, [&]() { ++fired; });
+
+    timer.start(100);
+    QCOMPARE(TimerWheel::instance()->count(), count + 1);
+
+    timer.stop();
+    QCOMPARE(TimerWheel::instance()->count(), count);
+
+    // Restarting a timer reschedules it.
+    timer.start(100);
+    timer.start(200);
+    QCOMPARE(TimerWheel::instance()->count(), count + 1);
+  }
+
+  // The destruction of the timer removes it from the wheel.
+  QCOMPARE(TimerWheel::instance()->count(), count);
+
+  QTest::qWait(TimerWheel::instance()->slackMsec() * 2 + 200);
+  QCOMPARE(fired, 0);
+}
+
+void TestTimerWheel::coalescing() {
+  TimerWheel* wheel = TimerWheel::instance();
+
+  // Timers expiring in the same slack window are served by the same wakeup.
+  QList<WheelTimer*> timers;
+  int fired = 0;
+  for (int i = 0; i < 100; ++i) {
+    WheelTimer* timer = new WheelTimer(this);
+    timer->setSingleShot(true);
+    connect(timer, &WheelTimer::timeout, [&]() { ++fired; });
+    timer->start(wheel->slackMsec() + (i % 10));
+    timers.append(timer);
+  }
+
+  quint64 wakeups = wheel->wakeups();
+
+  QTRY_COMPARE_WITH_TIMEOUT(fired, 100, 5000);
+  QVERIFY(wheel->wakeups() - wakeups <= 2);
+
+  // Far away timers go through the upper levels and the overflow list.
+  WheelTimer far;
+  far.setSingleShot(true);
+  far.start(qint64(wheel->slackMsec()) * (1 << 25));
+  QVERIFY(far.isActive());
+  far.stop();
+
+  qDeleteAll(timers);
+}
+
+static TestTimerWheel s_testTimerWheel;
@@ -0,0 +1,76 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "testworkerpool.h"
+#include "../../src/workerpool.h"
+
+#include <QSemaphore>
+#include <QThread>
+
+void TestWorkerPool::continuation() {
+  QThread* mainThread = QThread::currentThread();
+
+  QThread* jobThread = nullptr;
+  QThread* continuationThread = nullptr;
+  int value = 0;
+
+  WorkerPool::run([&jobThread]() {
+    jobThread = QThread::currentThread();
+    return 42;
+  }).then(this, [&](int result) {
+    continuationThread = QThread::currentThread();
+    value = result;
+  });
+
+  QTRY_COMPARE(value, 42);
+  QVERIFY(jobThread != mainThread);
+  QCOMPARE(continuationThread, mainThread);
+}
+
+void TestWorkerPool::finishedBeforeThen() {
+  auto future = WorkerPool::run([]() { return QByteArray("done"); });
+  QTRY_VERIFY(future.isFinished());
+
+  QByteArray value;
+  future.then(this, [&](const QByteArray& result) { value = result; });
+
+  // Never synchronously.
+  QVERIFY(value.isEmpty());
+  QTRY_COMPARE(value, QByteArray("done"));
+}
+
+void TestWorkerPool::contextDeleted() {
+  QSemaphore started;
+  QSemaphore release;
+
+  QObject* context = new QObject();
+
+  bool called = false;
+  auto future = WorkerPool::run([&]() {
+    started.release();
+    release.acquire();
+    return true;
+  });
+  future.then(context, [&](bool) { called = true; });
+
+  started.acquire();
+  delete context;
+  release.release();
+
+  QTRY_VERIFY(future.isFinished());
+  QTest::qWait(100);
+  QVERIFY(!called);
+}
+
+void TestWorkerPool::result() {
+  auto future = WorkerPool::run([]() {
+    QThread::msleep(50);
+    return QString("blocking");
+  });
+
+  QCOMPARE(future.result(), QString("blocking"));
+  QVERIFY(future.isFinished());
+}
+
+static TestWorkerPool s_testWorkerPool;